@@ -0,0 +1,458 @@
+//...... @FECORO, 2023 .......
+/*
+Banco de pruebas reproducible del núcleo SPH (sin SFML).
+
+Arma escenas estándar a varios tamaños y mide por separado cada etapa del paso:
+    grid        SpatialGrid::updateGrid
+    neighbors   SpatialGrid::getNeighbors para todas las partículas
+    density     SPHSolver::calculateDensityPressure
+    forces      SPHSolver::calculateForces
+    integrate   ParticleSystem::update (integración + colisiones)
+    step        SPHSolver::advance completo (reordenamiento, grid, densidad, fuerzas, integración)
+
+Escenas (todas con separación 8, h = 15 y celdas de lado h; el dominio crece con la cantidad):
+    dam_break       columna de agua 1:2 contra la pared izquierda
+    block_drop      bloque cuadrado que cae desde arriba al centro
+    obstacle_field  bloque que cae sobre una grilla de círculos y cajas
+    sparse_drop     el mismo bloque en un dominio 12 veces más ancho y alto (el fluido
+                    ocupa menos del 1%), para comparar --grid dense y hashed; no entra
+                    en las escenas por defecto
+
+Cada escena se calienta unos pasos (para medir un estado ya en movimiento y no la grilla
+perfecta del inicio) y cada etapa se repite hasta juntar un tiempo mínimo; se reporta la
+mediana y el mínimo, en ms y en ns por partícula. Al final, por escena y etapa, la curva
+de escalado y su exponente (pendiente de log(tiempo) contra log(N); 1 = lineal).
+
+La salida es JSON, a stdout o al archivo de --json, para comparar corridas y detectar
+regresiones. Todo es determinista salvo los tiempos: posiciones con semilla fija, y con
+--deterministic las reducciones no dependen de la cantidad de hilos.
+
+Uso:
+    nsfluidsph_benchmark [--sizes 1000,4000,...] [--scenes dam_break,block_drop,obstacle_field]
+                         [--threads T] [--deterministic] [--simd scalar|avx2|avx512|neon]
+                         [--grid dense|hashed] [--compact] [--warmup N] [--min-time S]
+                         [--json archivo.json]
+
+Por defecto: tamaños 1k, 4k, 16k, 64k, 256k y 1M, las tres escenas, 10 pasos de
+calentamiento y 0.25 s por etapa, grid denso. Cada resultado informa también los bytes
+que reservó el grid. Con --compact densidad, fuerzas y el paso usan la copia compacta
+de las partículas (ver compact_particles.h).
+*/
+
+//.... benchmark_main.cpp
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sph_solver.h"
+#include "particle_system.h"
+#include "spatial_grid.h"
+#include "constants.h"
+#include "thread_pool.h"
+
+static const float BENCH_SPACING = 8.0f;
+static const int MIN_REPETITIONS = 3;
+static const int MAX_REPETITIONS = 1000;
+
+static void printUsage(const char* program) {
+    std::cerr << "Uso: " << program
+              << " [--sizes 1000,4000,...] [--scenes dam_break,block_drop,obstacle_field]"
+              << " [--threads T] [--deterministic] [--simd scalar|avx2|avx512|neon]"
+              << " [--grid dense|hashed] [--compact] [--warmup N] [--min-time S] [--json archivo.json]\n";
+}
+
+static std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+//.... escena armada: dominio, partículas y obstáculos
+struct Scene {
+    int width;
+    int height;
+    ParticleData particles;
+    std::vector<Obstacle> obstacles;
+};
+
+//.... bloque de cols x rows partículas con la esquina superior izquierda en (x0, y0) y un
+//.... pequeño desorden fijo, para no medir la grilla perfecta
+static void fillBlock(ParticleData& particles, int cols, int rows, float x0, float y0,
+                      std::mt19937& rng) {
+    std::uniform_real_distribution<float> jitter(-0.1f * BENCH_SPACING, 0.1f * BENCH_SPACING);
+    particles.reserve(particles.size() + static_cast<size_t>(cols) * rows);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            Particle p;
+            p.position = Vec2(x0 + c * BENCH_SPACING + jitter(rng), y0 + r * BENCH_SPACING + jitter(rng));
+            p.velocity = Vec2(0.0f, 0.0f);
+            p.force = Vec2(0.0f, 0.0f);
+            p.density = 0.0f;
+            p.pressure = 0.0f;
+            particles.push_back(p);
+        }
+    }
+}
+
+static bool buildScene(const std::string& name, int count, Scene& scene) {
+    std::mt19937 rng(12345);
+    if (name == "dam_break") {
+        //.... columna el doble de alta que de ancha, en un tanque 4 veces más ancho
+        int cols = std::max(1, static_cast<int>(std::round(std::sqrt(count / 2.0))));
+        int rows = std::max(1, (count + cols - 1) / cols);
+        scene.width = static_cast<int>(std::ceil(cols * BENCH_SPACING * 4.0f));
+        scene.height = static_cast<int>(std::ceil(rows * BENCH_SPACING * 1.5f));
+        fillBlock(scene.particles, cols, rows, BENCH_SPACING * 0.5f,
+                  scene.height - rows * BENCH_SPACING, rng);
+        return true;
+    }
+    if (name == "block_drop" || name == "obstacle_field" || name == "sparse_drop") {
+        int side = std::max(1, static_cast<int>(std::round(std::sqrt(static_cast<double>(count)))));
+        int rows = std::max(1, (count + side - 1) / side);
+        float blockSize = side * BENCH_SPACING;
+        const float scale = name == "sparse_drop" ? 12.0f : 3.0f;
+        scene.width = static_cast<int>(std::ceil(blockSize * scale));
+        scene.height = static_cast<int>(std::ceil(rows * BENCH_SPACING * scale));
+        fillBlock(scene.particles, side, rows, blockSize, scene.height * 0.1f, rng);
+
+        if (name == "obstacle_field") {
+            //.... grilla de obstáculos en la mitad inferior, uno cada 6 separaciones
+            const float pitch = BENCH_SPACING * 6.0f;
+            int index = 0;
+            for (float y = scene.height * 0.55f; y < scene.height - pitch * 0.5f; y += pitch) {
+                for (float x = pitch * 0.5f; x < scene.width - pitch * 0.5f; x += pitch, index++) {
+                    Obstacle obstacle = Obstacle();
+                    obstacle.center = Vec2(x + ((static_cast<int>(y / pitch) & 1) ? pitch * 0.5f : 0.0f), y);
+                    if (index % 2 == 0) {
+                        obstacle.shape = ObstacleShape::Circle;
+                        obstacle.radius = BENCH_SPACING;
+                    } else {
+                        obstacle.shape = ObstacleShape::Box;
+                        obstacle.halfExtents = Vec2(BENCH_SPACING, BENCH_SPACING * 0.5f);
+                        obstacle.angle = 0.3f;
+                    }
+                    scene.obstacles.push_back(obstacle);
+                }
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+struct Timing {
+    std::string phase;
+    double medianMs;
+    double minMs;
+    int repetitions;
+};
+
+//.... repite fn hasta juntar minSeconds (y al menos MIN_REPETITIONS veces); prepare()
+//.... corre antes de cada vuelta sin medirse: las fases que cambian la escena la vuelven
+//.... al mismo estado, así todas las vueltas miden lo mismo
+template <typename Fn, typename Prepare>
+static Timing measure(const std::string& phase, double minSeconds, Fn&& fn, Prepare&& prepare) {
+    typedef std::chrono::steady_clock Clock;
+    std::vector<double> samples;
+    double total = 0.0;
+    prepare();
+    fn();   //.... una vuelta en frío, no cuenta
+    while ((total < minSeconds || static_cast<int>(samples.size()) < MIN_REPETITIONS) &&
+           static_cast<int>(samples.size()) < MAX_REPETITIONS) {
+        prepare();
+        auto start = Clock::now();
+        fn();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        samples.push_back(seconds * 1000.0);
+        total += seconds;
+    }
+    std::sort(samples.begin(), samples.end());
+    Timing timing;
+    timing.phase = phase;
+    timing.medianMs = samples[samples.size() / 2];
+    timing.minMs = samples.front();
+    timing.repetitions = static_cast<int>(samples.size());
+    return timing;
+}
+
+//.... para las fases que no cambian el estado
+template <typename Fn>
+static Timing measure(const std::string& phase, double minSeconds, Fn&& fn) {
+    return measure(phase, minSeconds, fn, [] {});
+}
+
+struct Result {
+    std::string scene;
+    int particles;
+    int width, height;
+    size_t obstacles;
+    size_t gridBytes;
+    double averageCandidates;
+    double setupSeconds;
+    std::vector<Timing> timings;
+};
+
+//.... pendiente de mínimos cuadrados de log(t) contra log(N)
+static double scalingExponent(const std::vector<std::pair<double, double>>& points) {
+    if (points.size() < 2) return 0.0;
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    for (const auto& point : points) {
+        double lx = std::log(point.first), ly = std::log(point.second);
+        sx += lx;
+        sy += ly;
+        sxx += lx * lx;
+        sxy += lx * ly;
+    }
+    double n = static_cast<double>(points.size());
+    double denominator = n * sxx - sx * sx;
+    return denominator != 0.0 ? (n * sxy - sx * sy) / denominator : 0.0;
+}
+
+static std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes = {1000, 4000, 16000, 64000, 256000, 1000000};
+    std::vector<std::string> scenes = {"dam_break", "block_drop", "obstacle_field"};
+    unsigned threads = 0;
+    bool deterministic = false;
+    std::string simdName;
+    GridLayout gridLayout = GridLayout::Dense;
+    bool compactStorage = false;
+    int warmupSteps = 10;
+    double minSeconds = 0.25;
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc) {
+            sizes.clear();
+            for (const auto& item : splitList(argv[++i])) {
+                sizes.push_back(std::max(1, std::atoi(item.c_str())));
+            }
+        } else if (arg == "--scenes" && i + 1 < argc) {
+            scenes = splitList(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "--deterministic") {
+            deterministic = true;
+        } else if (arg == "--simd" && i + 1 < argc) {
+            simdName = argv[++i];
+        } else if (arg == "--grid" && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (value == "hashed") {
+                gridLayout = GridLayout::Hashed;
+            } else if (value != "dense") {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--compact") {
+            compactStorage = true;
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            warmupSteps = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            minSeconds = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    for (const auto& name : scenes) {
+        Scene probe;
+        if (!buildScene(name, 1, probe)) {
+            std::cerr << "Escena desconocida: " << name << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    ThreadPool threadPool(threads);
+    threadPool.setDeterministic(deterministic);
+    SimdLevel simdLevel = preferredSimdLevel();
+    if (simdName == "scalar") simdLevel = SimdLevel::Scalar;
+    else if (simdName == "avx2") simdLevel = SimdLevel::AVX2;
+    else if (simdName == "avx512") simdLevel = SimdLevel::AVX512;
+    else if (simdName == "neon") simdLevel = SimdLevel::NEON;
+
+    std::vector<Result> results;
+    float smoothingLength = 0.0f;
+    float cellSize = 0.0f;
+    for (const auto& sceneName : scenes) {
+        for (int size : sizes) {
+            auto setupStart = std::chrono::steady_clock::now();
+            Scene scene;
+            buildScene(sceneName, size, scene);
+
+            ParticleSystem particleSystem(scene.width, scene.height);
+            particleSystem.setThreadPool(&threadPool);
+            particleSystem.setParticleSpacing(BENCH_SPACING);
+            SPHSolver solver(scene.width, scene.height);
+            solver.setThreadPool(&threadPool);
+            solver.setSimdLevel(simdLevel);
+            solver.setGridLayout(gridLayout);
+            solver.setCompactStorage(compactStorage);
+            particleSystem.restore(std::move(scene.particles), scene.obstacles, 0, 0.0);
+            smoothingLength = particleSystem.getSmoothingLength();
+
+            for (int step = 0; step < warmupSteps; step++) {
+                solver.advance(particleSystem, DEFAULT_TIMESTEP);
+            }
+
+            Result result;
+            result.scene = sceneName;
+            result.particles = static_cast<int>(particleSystem.getParticleCount());
+            result.width = scene.width;
+            result.height = scene.height;
+            result.obstacles = particleSystem.getObstacles().size();
+            result.setupSeconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - setupStart).count();
+            std::cerr << sceneName << " " << result.particles << " partículas ("
+                      << scene.width << "x" << scene.height << ")...\n";
+
+            const ParticleData& particles = particleSystem.getData();
+            //.... el mismo lado de celda que eligió el solver a partir de h
+            cellSize = solver.getGrid().getCellSize();
+            SpatialGrid grid(scene.width, scene.height, cellSize);
+            grid.setLayout(gridLayout);
+            result.timings.push_back(measure("grid", minSeconds, [&] { grid.updateGrid(particles); }));
+            result.gridBytes = grid.getMemoryBytes();
+
+            std::vector<int> neighbors;
+            size_t candidates = 0;
+            result.timings.push_back(measure("neighbors", minSeconds, [&] {
+                candidates = 0;
+                for (size_t i = 0; i < particles.size(); i++) {
+                    grid.getNeighbors(Vec2(particles.x[i], particles.y[i]), neighbors);
+                    candidates += neighbors.size();
+                }
+            }));
+            result.averageCandidates = particles.empty() ? 0.0 : double(candidates) / particles.size();
+
+            //.... un update() deja el grid del solver al día con estas posiciones; densidad
+            //.... y fuerzas se repiten sobre el mismo estado
+            solver.update(particleSystem);
+            result.timings.push_back(measure("density", minSeconds, [&] {
+                solver.calculateDensityPressure(particleSystem);
+            }));
+            result.timings.push_back(measure("forces", minSeconds, [&] {
+                solver.calculateForces(particleSystem);
+            }));
+            //.... integrar y avanzar mueven la escena (partículas, emisores, lista de vecinos...):
+            //.... cada vuelta arranca de una copia de este estado, con las fuerzas recién calculadas
+            const ParticleSystem savedSystem = particleSystem;
+            const SPHSolver savedSolver = solver;
+            result.timings.push_back(measure("integrate", minSeconds, [&] { particleSystem.update(); },
+                                             [&] { particleSystem = savedSystem; }));
+            result.timings.push_back(measure("step", minSeconds, [&] {
+                solver.advance(particleSystem, DEFAULT_TIMESTEP);
+            }, [&] {
+                particleSystem = savedSystem;
+                solver = savedSolver;
+            }));
+            results.push_back(result);
+        }
+    }
+
+    std::ostringstream json;
+    json << std::setprecision(6);
+    json << "{\n"
+         << "  \"benchmark\": \"nsfluidsph\",\n"
+         << "  \"format\": 1,\n"
+         << "  \"config\": {\"threads\": " << threadPool.getThreadCount()
+         << ", \"deterministic\": " << (deterministic ? "true" : "false")
+         << ", \"simd\": " << jsonString(simdLevelName(simdLevel))
+         << ", \"grid\": " << jsonString(gridLayout == GridLayout::Hashed ? "hashed" : "dense")
+         << ", \"compact\": " << (compactStorage ? "true" : "false")
+         << ", \"warmup_steps\": " << warmupSteps
+         << ", \"min_time_s\": " << minSeconds
+         << ", \"spacing\": " << BENCH_SPACING
+         << ", \"smoothing_length\": " << smoothingLength
+         << ", \"cell_size\": " << cellSize << "},\n"
+         << "  \"results\": [\n";
+    for (size_t r = 0; r < results.size(); r++) {
+        const Result& result = results[r];
+        json << "    {\"scene\": " << jsonString(result.scene)
+             << ", \"particles\": " << result.particles
+             << ", \"domain\": [" << result.width << ", " << result.height << "]"
+             << ", \"obstacles\": " << result.obstacles
+             << ", \"grid_bytes\": " << result.gridBytes
+             << ", \"average_candidates\": " << result.averageCandidates
+             << ", \"setup_s\": " << result.setupSeconds
+             << ", \"phases\": {";
+        for (size_t t = 0; t < result.timings.size(); t++) {
+            const Timing& timing = result.timings[t];
+            json << (t ? ", " : "") << jsonString(timing.phase) << ": {"
+                 << "\"median_ms\": " << timing.medianMs
+                 << ", \"min_ms\": " << timing.minMs
+                 << ", \"ns_per_particle\": " << timing.medianMs * 1.0e6 / std::max(1, result.particles)
+                 << ", \"repetitions\": " << timing.repetitions << "}";
+        }
+        json << "}}" << (r + 1 < results.size() ? "," : "") << "\n";
+    }
+    json << "  ],\n"
+         << "  \"scaling\": [\n";
+
+    //.... una curva por escena y etapa: (N, ns por partícula) y el exponente del ajuste
+    bool firstCurve = true;
+    for (const auto& sceneName : scenes) {
+        if (results.empty()) break;
+        for (size_t t = 0; t < results.front().timings.size(); t++) {
+            const std::string& phase = results.front().timings[t].phase;
+            std::vector<std::pair<double, double>> points;
+            std::ostringstream curve;
+            curve << std::setprecision(6);
+            for (const auto& result : results) {
+                if (result.scene != sceneName) continue;
+                double ms = result.timings[t].medianMs;
+                curve << (points.empty() ? "" : ", ") << "[" << result.particles << ", "
+                      << ms * 1.0e6 / std::max(1, result.particles) << "]";
+                points.push_back(std::make_pair(static_cast<double>(result.particles), ms));
+            }
+            json << (firstCurve ? "" : ",\n")
+                 << "    {\"scene\": " << jsonString(sceneName)
+                 << ", \"phase\": " << jsonString(phase)
+                 << ", \"exponent\": " << scalingExponent(points)
+                 << ", \"ns_per_particle\": [" << curve.str() << "]}";
+            firstCurve = false;
+        }
+    }
+    json << "\n  ]\n}\n";
+
+    if (jsonPath.empty()) {
+        std::cout << json.str();
+    } else {
+        std::ofstream out(jsonPath);
+        if (!out) {
+            std::cerr << "No se pudo escribir " << jsonPath << "\n";
+            return 1;
+        }
+        out << json.str();
+    }
+    return 0;
+}
+
+//...............................................| Fin del código |...............................................
+// Todos los derechos reservados. @FECORO, 2023.
+
+// Compilo como (sin SFML):
+// g++ -std=c++17 -O2 -pthread -o nsfluidsph_benchmark benchmark_main.cpp particle_system.cpp sph_solver.cpp spatial_grid.cpp thread_pool.cpp sph_simd.cpp sph_simd_x86.cpp profiler.cpp obstacle_field.cpp neighbor_list.cpp sph_pcisph.cpp compact_particles.cpp sph_compact.cpp sph_multires.cpp sph_distributed.cpp sph_sleep.cpp
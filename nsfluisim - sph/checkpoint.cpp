@@ -0,0 +1,565 @@
+/*
+Checkpoints binarios del estado de la simulación.
+
+Antes no había forma de guardar el estado: reset() siempre volvía al bloque inicial de
+30x30, así que una corrida larga no se podía retomar ni reutilizar un estado ya asentado.
+
+El archivo tiene una cabecera con versión, cantidad de partículas, pasos y parámetros
+físicos, una tabla de secciones y después un arreglo contiguo por campo, igual que el
+almacenamiento SoA de ParticleData. Al cargar se mapea el archivo en memoria y cada
+sección se copia de una vez a su arreglo, sin leer a un búfer intermedio ni interpretar
+partícula por partícula.
+
+El guardado se reparte en dos: la copia del estado (rápida) en el hilo de simulación y
+la escritura a disco en un hilo de CheckpointWriter, para no frenar la simulación.
+*/
+
+//... checkpoint.cpp
+#include "checkpoint.h"
+#include "mapped_file.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static const char CHECKPOINT_MAGIC[8] = {'N', 'S', 'F', 'S', 'P', 'H', 'C', 'K'};
+static const uint32_t CHECKPOINT_ENDIAN_TAG = 0x01020304u;
+static const uint64_t SECTION_ALIGNMENT = 64;
+
+static bool syncToDisk(FILE* file) {
+    if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+//... reemplaza 'path' por 'tempPath' de una vez: en POSIX rename ya pisa el destino en
+//... forma atómica; en Windows rename falla si el destino existe, y borrarlo antes dejaría
+//... un momento sin checkpoint
+static bool replaceFile(const std::string& tempPath, const std::string& path) {
+#ifdef _WIN32
+    return MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+}
+
+//... registro de obstáculo en disco (independiente del layout de Obstacle en memoria)
+struct ObstacleRecord {
+    uint32_t shape;
+    float centerX, centerY;
+    float halfExtentX, halfExtentY;
+    float angle;
+    float ax, ay, bx, by;
+    float radius;
+};
+
+struct EmitterRecord {
+    float positionX, positionY;
+    float velocityX, velocityY;
+    float width;
+    float travelled;
+};
+
+struct SinkRecord {
+    float minX, minY;
+    float maxX, maxY;
+};
+
+static_assert(std::is_trivially_copyable<CheckpointHeader>::value, "cabecera POD");
+static_assert(std::is_trivially_copyable<CheckpointSection>::value, "sección POD");
+static_assert(std::is_trivially_copyable<ObstacleRecord>::value, "obstáculo POD");
+static_assert(std::is_trivially_copyable<EmitterRecord>::value, "emisor POD");
+static_assert(std::is_trivially_copyable<SinkRecord>::value, "sumidero POD");
+
+static uint64_t alignUp(uint64_t value) {
+    return (value + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+CheckpointState captureCheckpoint(const ParticleSystem& particleSystem, const SPHSolver& solver) {
+    CheckpointState state;
+    state.particles = particleSystem.getData();
+    state.obstacles = particleSystem.getObstacles().getObstacles();
+    state.emitters = particleSystem.getEmitters();
+    state.sinks = particleSystem.getSinks();
+    state.stepCount = particleSystem.getStepCount();
+    state.simulatedTime = particleSystem.getSimulatedTime();
+
+    CheckpointParameters& p = state.parameters;
+    p.smoothingLength = particleSystem.getSmoothingLength();
+    p.particleMass = particleSystem.getParticleMass();
+    p.particleSpacing = particleSystem.getParticleSpacing();
+    p.deltaTime = particleSystem.getDeltaTime();
+    p.viscosity = solver.getViscosity();
+    p.stiffness = solver.getStiffness();
+    p.restDensity = solver.getRestDensity();
+    p.pcisphTolerance = solver.getPCISPHSettings().tolerance;
+    p.pcisphRestDensity = solver.getPCISPHSettings().restDensity;
+    p.pressureSolver = static_cast<int32_t>(solver.getPressureSolver());
+    p.adaptiveTimestep = solver.getTimestepSettings().adaptive ? 1 : 0;
+    p.pcisphMaxIterations = solver.getPCISPHSettings().maxIterations;
+    return state;
+}
+
+namespace {
+
+//... secciones a escribir: puntero a los datos, tamaño de elemento y cantidad
+struct SectionSource {
+    CheckpointSectionId id;
+    uint32_t elementSize;
+    const void* data;
+    uint64_t count;
+};
+
+}
+
+bool writeCheckpoint(const std::string& path, const CheckpointState& state, std::string& error) {
+    const ParticleData& particles = state.particles;
+    const uint64_t count = particles.size();
+
+    std::vector<ObstacleRecord> obstacleRecords;
+    obstacleRecords.reserve(state.obstacles.size());
+    for (const auto& obstacle : state.obstacles) {
+        ObstacleRecord record;
+        record.shape = static_cast<uint32_t>(obstacle.shape);
+        record.centerX = obstacle.center.x;
+        record.centerY = obstacle.center.y;
+        record.halfExtentX = obstacle.halfExtents.x;
+        record.halfExtentY = obstacle.halfExtents.y;
+        record.angle = obstacle.angle;
+        record.ax = obstacle.a.x;
+        record.ay = obstacle.a.y;
+        record.bx = obstacle.b.x;
+        record.by = obstacle.b.y;
+        record.radius = obstacle.radius;
+        obstacleRecords.push_back(record);
+    }
+    std::vector<EmitterRecord> emitterRecords;
+    for (const auto& emitter : state.emitters) {
+        emitterRecords.push_back(EmitterRecord{emitter.position.x, emitter.position.y,
+                                               emitter.velocity.x, emitter.velocity.y,
+                                               emitter.width, emitter.travelled});
+    }
+    std::vector<SinkRecord> sinkRecords;
+    for (const auto& sink : state.sinks) {
+        sinkRecords.push_back(SinkRecord{sink.minCorner.x, sink.minCorner.y,
+                                         sink.maxCorner.x, sink.maxCorner.y});
+    }
+
+    const SectionSource sources[] = {
+        {CheckpointSectionId::PositionX, sizeof(float), particles.x.data(), count},
+        {CheckpointSectionId::PositionY, sizeof(float), particles.y.data(), count},
+        {CheckpointSectionId::VelocityX, sizeof(float), particles.vx.data(), count},
+        {CheckpointSectionId::VelocityY, sizeof(float), particles.vy.data(), count},
+        {CheckpointSectionId::ForceX, sizeof(float), particles.fx.data(), count},
+        {CheckpointSectionId::ForceY, sizeof(float), particles.fy.data(), count},
+        {CheckpointSectionId::Density, sizeof(float), particles.density.data(), count},
+        {CheckpointSectionId::Pressure, sizeof(float), particles.pressure.data(), count},
+        {CheckpointSectionId::ParticleId, sizeof(int32_t), particles.id.data(), count},
+        {CheckpointSectionId::Obstacles, sizeof(ObstacleRecord), obstacleRecords.data(),
+         obstacleRecords.size()},
+        {CheckpointSectionId::FreeIds, sizeof(int32_t), particles.freeIds.data(),
+         particles.freeIds.size()},
+        {CheckpointSectionId::Emitters, sizeof(EmitterRecord), emitterRecords.data(),
+         emitterRecords.size()},
+        {CheckpointSectionId::Sinks, sizeof(SinkRecord), sinkRecords.data(), sinkRecords.size()},
+        {CheckpointSectionId::ResolutionLevel, sizeof(unsigned char), particles.level.data(),
+         particles.level.size()}
+    };
+    const uint32_t sectionCount = sizeof(sources) / sizeof(sources[0]);
+
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.endianTag = CHECKPOINT_ENDIAN_TAG;
+    header.headerSize = sizeof(CheckpointHeader);
+    header.sectionCount = sectionCount;
+    header.particleCount = count;
+    header.stepCount = state.stepCount;
+    header.simulatedTime = state.simulatedTime;
+    header.parameters = state.parameters;
+
+    //... tabla de secciones con offsets alineados
+    std::vector<CheckpointSection> table(sectionCount);
+    uint64_t offset = alignUp(sizeof(CheckpointHeader) + sectionCount * sizeof(CheckpointSection));
+    for (uint32_t s = 0; s < sectionCount; s++) {
+        table[s].id = static_cast<uint32_t>(sources[s].id);
+        table[s].elementSize = sources[s].elementSize;
+        table[s].offset = offset;
+        table[s].count = sources[s].count;
+        offset = alignUp(offset + sources[s].count * sources[s].elementSize);
+    }
+
+    std::string tempPath = path + ".tmp";
+    FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        error = "no se pudo crear " + tempPath;
+        return false;
+    }
+
+    static const unsigned char padding[SECTION_ALIGNMENT] = {};
+    uint64_t written = 0;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(table.data(), sizeof(CheckpointSection), sectionCount, file) == sectionCount;
+    written = sizeof(header) + sectionCount * sizeof(CheckpointSection);
+    for (uint32_t s = 0; ok && s < sectionCount; s++) {
+        uint64_t gap = table[s].offset - written;
+        ok = gap == 0 || std::fwrite(padding, 1, gap, file) == gap;
+        uint64_t bytes = table[s].count * table[s].elementSize;
+        ok = ok && (bytes == 0 || std::fwrite(sources[s].data, 1, bytes, file) == bytes);
+        written = table[s].offset + bytes;
+    }
+    //... el contenido tiene que estar en disco antes del rename: si no, un corte de luz
+    //... puede dejar el nombre definitivo apuntando a un archivo vacío o a medias
+    ok = ok && syncToDisk(file);
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        std::remove(tempPath.c_str());
+        error = "falló la escritura de " + tempPath;
+        return false;
+    }
+
+    if (!replaceFile(tempPath, path)) {
+        error = "no se pudo renombrar " + tempPath + " a " + path;
+        return false;
+    }
+    return true;
+}
+
+//... devuelve la sección pedida validando tamaño de elemento, cantidad y límites
+static const unsigned char* findSection(const MappedFile& file, const CheckpointSection* table,
+                                        uint32_t sectionCount, CheckpointSectionId id,
+                                        uint32_t elementSize, uint64_t expectedCount,
+                                        uint64_t& count, std::string& error) {
+    for (uint32_t s = 0; s < sectionCount; s++) {
+        if (table[s].id != static_cast<uint32_t>(id)) continue;
+        if (table[s].elementSize != elementSize) {
+            error = "tamaño de elemento inesperado en la sección " + std::to_string(table[s].id);
+            return nullptr;
+        }
+        if (expectedCount != UINT64_MAX && table[s].count != expectedCount) {
+            error = "cantidad inesperada en la sección " + std::to_string(table[s].id);
+            return nullptr;
+        }
+        //... se compara la cantidad y no count * elementSize, que con un count corrupto desborda
+        if (table[s].offset > file.size() || table[s].count > (file.size() - table[s].offset) / elementSize) {
+            error = "la sección " + std::to_string(table[s].id) + " sale del archivo";
+            return nullptr;
+        }
+        count = table[s].count;
+        return file.data() + table[s].offset;
+    }
+    error = "falta la sección " + std::to_string(static_cast<uint32_t>(id));
+    return nullptr;
+}
+
+static bool hasSection(const CheckpointSection* table, uint32_t sectionCount, CheckpointSectionId id) {
+    for (uint32_t s = 0; s < sectionCount; s++) {
+        if (table[s].id == static_cast<uint32_t>(id)) return true;
+    }
+    return false;
+}
+
+//... sección opcional: sin ella, count = 0 y se devuelve un puntero no nulo
+static const unsigned char* findOptionalSection(const MappedFile& file, const CheckpointSection* table,
+                                                uint32_t sectionCount, CheckpointSectionId id,
+                                                uint32_t elementSize, uint64_t& count,
+                                                std::string& error) {
+    static const unsigned char none = 0;
+    count = 0;
+    if (!hasSection(table, sectionCount, id)) return &none;
+    return findSection(file, table, sectionCount, id, elementSize, UINT64_MAX, count, error);
+}
+
+bool loadCheckpoint(const std::string& path, ParticleSystem& particleSystem, SPHSolver& solver,
+                    std::string& error) {
+    MappedFile file;
+    if (!file.open(path, error)) return false;
+
+    if (file.size() < sizeof(CheckpointHeader)) {
+        error = path + " es demasiado corto para ser un checkpoint";
+        return false;
+    }
+    CheckpointHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0) {
+        error = path + " no es un checkpoint";
+        return false;
+    }
+    if (header.endianTag != CHECKPOINT_ENDIAN_TAG) {
+        error = path + " se guardó con otro orden de bytes";
+        return false;
+    }
+    if (header.version > CHECKPOINT_VERSION) {
+        error = path + " es de una versión más nueva (" + std::to_string(header.version) + ")";
+        return false;
+    }
+    uint64_t tableBytes = static_cast<uint64_t>(header.sectionCount) * sizeof(CheckpointSection);
+    if (header.headerSize < sizeof(CheckpointHeader) || header.headerSize > file.size() ||
+        tableBytes > file.size() - header.headerSize) {
+        error = path + " tiene la tabla de secciones dañada";
+        return false;
+    }
+    //... h, masa, separación y paso van directo al grid y a la integración del paso
+    //... siguiente: uno nulo, negativo o NaN deja celdas de lado 0 o posiciones NaN
+    const CheckpointParameters& parameters = header.parameters;
+    const float scales[] = {parameters.smoothingLength, parameters.particleMass,
+                            parameters.particleSpacing, parameters.deltaTime};
+    for (float value : scales) {
+        if (!std::isfinite(value) || value <= 0.0f) {
+            error = path + " tiene h, masa, separación o paso no positivos";
+            return false;
+        }
+    }
+    //... la tabla empieza justo después de la cabecera (que puede crecer en otra versión)
+    std::vector<CheckpointSection> table(header.sectionCount);
+    std::memcpy(table.data(), file.data() + header.headerSize, tableBytes);
+
+    const uint64_t count = header.particleCount;
+    ParticleData particles;
+    struct FloatField {
+        CheckpointSectionId id;
+        std::vector<float>* field;
+    };
+    const FloatField floatFields[] = {
+        {CheckpointSectionId::PositionX, &particles.x},
+        {CheckpointSectionId::PositionY, &particles.y},
+        {CheckpointSectionId::VelocityX, &particles.vx},
+        {CheckpointSectionId::VelocityY, &particles.vy},
+        {CheckpointSectionId::ForceX, &particles.fx},
+        {CheckpointSectionId::ForceY, &particles.fy},
+        {CheckpointSectionId::Density, &particles.density},
+        {CheckpointSectionId::Pressure, &particles.pressure}
+    };
+    for (const auto& field : floatFields) {
+        uint64_t found = 0;
+        const unsigned char* source = findSection(file, table.data(), header.sectionCount, field.id,
+                                                  sizeof(float), count, found, error);
+        if (!source) return false;
+        field.field->resize(count);
+        if (count > 0) std::memcpy(field.field->data(), source, count * sizeof(float));
+    }
+
+    uint64_t found = 0;
+    const unsigned char* ids = findSection(file, table.data(), header.sectionCount,
+                                           CheckpointSectionId::ParticleId, sizeof(int32_t),
+                                           count, found, error);
+    if (!ids) return false;
+    particles.id.resize(count);
+    if (count > 0) std::memcpy(particles.id.data(), ids, count * sizeof(int32_t));
+    uint64_t freeCount = 0;
+    const unsigned char* freeIds = findOptionalSection(file, table.data(), header.sectionCount,
+                                                       CheckpointSectionId::FreeIds, sizeof(int32_t),
+                                                       freeCount, error);
+    if (!freeIds) return false;
+    particles.freeIds.resize(freeCount);
+    if (freeCount > 0) std::memcpy(particles.freeIds.data(), freeIds, freeCount * sizeof(int32_t));
+    //... slot es el inverso de id; los id y los libres tienen que ser una permutación de
+    //... 0..n-1, con n = partículas + libres
+    const uint64_t idRange = count + freeCount;
+    particles.slot.assign(idRange, -2);
+    for (uint64_t i = 0; i < idRange; i++) {
+        const bool live = i < count;
+        int32_t particleId = live ? particles.id[i] : particles.freeIds[i - count];
+        if (particleId < 0 || static_cast<uint64_t>(particleId) >= idRange ||
+            particles.slot[particleId] != -2) {
+            error = path + " tiene identificadores de partícula repetidos o fuera de rango";
+            return false;
+        }
+        particles.slot[particleId] = live ? static_cast<int>(i) : -1;
+    }
+
+    uint64_t levelCount = 0;
+    const unsigned char* levels = findOptionalSection(file, table.data(), header.sectionCount,
+                                                      CheckpointSectionId::ResolutionLevel,
+                                                      sizeof(unsigned char), levelCount, error);
+    if (!levels) return false;
+    if (levelCount != 0 && levelCount != count) {
+        error = "cantidad inesperada en la sección " +
+                std::to_string(static_cast<uint32_t>(CheckpointSectionId::ResolutionLevel));
+        return false;
+    }
+    particles.level.assign(levels, levels + levelCount);
+    for (unsigned char level : particles.level) {
+        if (level > MAX_RESOLUTION_LEVEL) {
+            error = path + " tiene un nivel de resolución fuera de rango";
+            return false;
+        }
+    }
+
+    uint64_t obstacleCount = 0;
+    const unsigned char* obstacleBytes = findSection(file, table.data(), header.sectionCount,
+                                                     CheckpointSectionId::Obstacles,
+                                                     sizeof(ObstacleRecord), UINT64_MAX,
+                                                     obstacleCount, error);
+    if (!obstacleBytes) return false;
+    std::vector<Obstacle> obstacles;
+    obstacles.reserve(obstacleCount);
+    for (uint64_t o = 0; o < obstacleCount; o++) {
+        ObstacleRecord record;
+        std::memcpy(&record, obstacleBytes + o * sizeof(ObstacleRecord), sizeof(record));
+        if (record.shape > static_cast<uint32_t>(ObstacleShape::Segment)) {
+            error = path + " tiene un obstáculo de forma desconocida";
+            return false;
+        }
+        Obstacle obstacle = Obstacle();
+        obstacle.shape = static_cast<ObstacleShape>(record.shape);
+        obstacle.center = Vec2(record.centerX, record.centerY);
+        obstacle.halfExtents = Vec2(record.halfExtentX, record.halfExtentY);
+        obstacle.angle = record.angle;
+        obstacle.a = Vec2(record.ax, record.ay);
+        obstacle.b = Vec2(record.bx, record.by);
+        obstacle.radius = record.radius;
+        obstacles.push_back(obstacle);
+    }
+
+    uint64_t emitterCount = 0;
+    const unsigned char* emitterBytes = findOptionalSection(file, table.data(), header.sectionCount,
+                                                            CheckpointSectionId::Emitters,
+                                                            sizeof(EmitterRecord), emitterCount, error);
+    if (!emitterBytes) return false;
+    uint64_t sinkCount = 0;
+    const unsigned char* sinkBytes = findOptionalSection(file, table.data(), header.sectionCount,
+                                                         CheckpointSectionId::Sinks,
+                                                         sizeof(SinkRecord), sinkCount, error);
+    if (!sinkBytes) return false;
+
+    //... todo validado: recién ahora se toca el estado del sistema y del solver
+    const CheckpointParameters& p = header.parameters;
+    particleSystem.setSmoothingLength(p.smoothingLength);
+    particleSystem.setParticleMass(p.particleMass);
+    particleSystem.setParticleSpacing(p.particleSpacing);
+    particleSystem.setDeltaTime(p.deltaTime);
+    particleSystem.restore(std::move(particles), obstacles, header.stepCount, header.simulatedTime);
+    particleSystem.clearSources();
+    for (uint64_t e = 0; e < emitterCount; e++) {
+        EmitterRecord record;
+        std::memcpy(&record, emitterBytes + e * sizeof(EmitterRecord), sizeof(record));
+        particleSystem.addEmitter(Vec2(record.positionX, record.positionY),
+                                  Vec2(record.velocityX, record.velocityY), record.width,
+                                  record.travelled);
+    }
+    for (uint64_t k = 0; k < sinkCount; k++) {
+        SinkRecord record;
+        std::memcpy(&record, sinkBytes + k * sizeof(SinkRecord), sizeof(record));
+        particleSystem.addSink(Vec2(record.minX, record.minY), Vec2(record.maxX, record.maxY));
+    }
+
+    solver.setViscosity(p.viscosity);
+    solver.setStiffness(p.stiffness);
+    solver.setRestDensity(p.restDensity);
+    solver.setPressureSolver(p.pressureSolver == static_cast<int32_t>(PressureSolver::PCISPH)
+                                 ? PressureSolver::PCISPH
+                                 : PressureSolver::EquationOfState);
+    solver.setAdaptiveTimestep(p.adaptiveTimestep != 0);
+    PCISPHSettings pcisph = solver.getPCISPHSettings();
+    pcisph.tolerance = p.pcisphTolerance;
+    pcisph.restDensity = p.pcisphRestDensity;
+    pcisph.maxIterations = p.pcisphMaxIterations;
+    solver.setPCISPHSettings(pcisph);
+    return true;
+}
+
+CheckpointWriter::CheckpointWriter()
+    : writing(false), stopping(false), completed(0), failed(0), superseded(0) {
+    worker = std::thread(&CheckpointWriter::workerLoop, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    worker.join();
+}
+
+void CheckpointWriter::save(const std::string& path, const ParticleSystem& particleSystem,
+                            const SPHSolver& solver) {
+    Job job;
+    job.path = path;
+    job.state = captureCheckpoint(particleSystem, solver);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool replaced = false;
+        for (auto& waiting : pending) {
+            if (waiting.path == path) {
+                waiting.state = std::move(job.state);
+                superseded++;
+                replaced = true;
+                break;
+            }
+        }
+        if (!replaced) pending.push_back(std::move(job));
+    }
+    wakeCondition.notify_one();
+}
+
+void CheckpointWriter::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeCondition.wait(lock, [&] { return stopping || !pending.empty(); });
+        //... al cerrar se terminan de escribir los pendientes
+        if (pending.empty()) break;
+
+        Job job = std::move(pending.front());
+        pending.pop_front();
+        writing = true;
+        lock.unlock();
+
+        std::string error;
+        bool ok = writeCheckpoint(job.path, job.state, error);
+
+        lock.lock();
+        writing = false;
+        if (ok) {
+            completed++;
+        } else {
+            failed++;
+            lastError = error;
+        }
+        if (pending.empty()) idleCondition.notify_all();
+    }
+}
+
+void CheckpointWriter::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idleCondition.wait(lock, [&] { return pending.empty() && !writing; });
+}
+
+bool CheckpointWriter::isBusy() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return writing || !pending.empty();
+}
+
+unsigned CheckpointWriter::getCompletedCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return completed;
+}
+
+unsigned CheckpointWriter::getFailedCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failed;
+}
+
+unsigned CheckpointWriter::getSupersededCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return superseded;
+}
+
+std::string CheckpointWriter::getLastError() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastError;
+}
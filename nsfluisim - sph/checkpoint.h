@@ -0,0 +1,138 @@
+// checkpoint.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "particle_system.h"
+#include "sph_solver.h"
+
+//... formato binario de checkpoint (versión 1, little-endian):
+//...   CheckpointHeader
+//...   CheckpointSection[sectionCount]
+//...   secciones alineadas a 64 bytes: un arreglo por campo SoA (x, y, vx, ...),
+//...   los id estables, los obstáculos y, si hay, los id libres, emisores, sumideros y
+//...   niveles de resolución
+//... Un lector ignora las secciones que no conoce, así se pueden agregar campos
+//... sin cambiar de versión; los cambios incompatibles suben CHECKPOINT_VERSION
+const uint32_t CHECKPOINT_VERSION = 1;
+
+enum class CheckpointSectionId : uint32_t {
+    PositionX = 1,
+    PositionY,
+    VelocityX,
+    VelocityY,
+    ForceX,
+    ForceY,
+    Density,
+    Pressure,
+    ParticleId,
+    Obstacles,
+    //... opcionales: un archivo sin ellas no tiene id libres, emisores ni sumideros
+    FreeIds,
+    Emitters,
+    Sinks,
+    //... opcional, un byte por partícula: sin ella todas son del nivel de la escena
+    ResolutionLevel
+};
+
+//... parámetros físicos del sistema y del solver en el momento de guardar
+struct CheckpointParameters {
+    float smoothingLength;
+    float particleMass;
+    float particleSpacing;
+    float deltaTime;
+    float viscosity;
+    float stiffness;
+    float restDensity;
+    float pcisphTolerance;
+    float pcisphRestDensity;
+    int32_t pressureSolver;         //... PressureSolver como entero
+    int32_t adaptiveTimestep;
+    int32_t pcisphMaxIterations;
+};
+
+struct CheckpointHeader {
+    char magic[8];                  //... "NSFSPHCK"
+    uint32_t version;
+    uint32_t endianTag;             //... 0x01020304 escrito con el orden de la máquina
+    uint32_t headerSize;
+    uint32_t sectionCount;
+    uint64_t particleCount;
+    uint64_t stepCount;
+    double simulatedTime;
+    CheckpointParameters parameters;
+};
+
+struct CheckpointSection {
+    uint32_t id;                    //... CheckpointSectionId
+    uint32_t elementSize;           //... bytes por elemento
+    uint64_t offset;                //... desde el inicio del archivo
+    uint64_t count;                 //... elementos
+};
+
+//... copia del estado a guardar; se arma en el hilo de simulación y se escribe aparte
+struct CheckpointState {
+    ParticleData particles;
+    std::vector<Obstacle> obstacles;
+    std::vector<Emitter> emitters;
+    std::vector<Sink> sinks;
+    CheckpointParameters parameters;
+    unsigned long long stepCount;
+    double simulatedTime;
+};
+
+CheckpointState captureCheckpoint(const ParticleSystem& particleSystem, const SPHSolver& solver);
+
+//... escribe en path + ".tmp" y renombra al final, así un corte a mitad de camino no
+//... deja un checkpoint roto en lugar del anterior
+bool writeCheckpoint(const std::string& path, const CheckpointState& state, std::string& error);
+
+//... mapea el archivo, valida cabecera y secciones y copia cada sección directo a los
+//... arreglos del sistema; también restaura los parámetros del solver
+bool loadCheckpoint(const std::string& path, ParticleSystem& particleSystem, SPHSolver& solver,
+                    std::string& error);
+
+//... guardado en segundo plano: save() toma la copia del estado en el hilo que llama
+//... (un memcpy por campo) y un hilo propio la escribe a disco. Si llega un guardado al
+//... mismo archivo que otro que todavía espera, reemplaza al que espera
+class CheckpointWriter {
+private:
+    struct Job {
+        std::string path;
+        CheckpointState state;
+    };
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable idleCondition;
+    std::deque<Job> pending;
+    bool writing;
+    bool stopping;
+    unsigned completed;
+    unsigned failed;
+    unsigned superseded;
+    std::string lastError;
+
+    void workerLoop();
+
+public:
+    CheckpointWriter();
+    ~CheckpointWriter();
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void save(const std::string& path, const ParticleSystem& particleSystem, const SPHSolver& solver);
+    //... bloquea hasta que no quede nada por escribir
+    void wait();
+    bool isBusy();
+    unsigned getCompletedCount();
+    unsigned getFailedCount();
+    //... guardados descartados porque llegó otro al mismo archivo antes de escribirlos
+    unsigned getSupersededCount();
+    std::string getLastError();
+};
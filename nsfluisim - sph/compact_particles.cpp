@@ -0,0 +1,103 @@
+/*
+Almacenamiento compacto de las partículas para las pasadas de SPHSolver.
+
+Con muchas partículas el cálculo de fuerzas queda limitado por la memoria: por cada
+vecino se leen posición, velocidad, densidad y presión en float, más el índice del grid
+para saltar a ellos, y el conjunto de trabajo no entra en la caché. Aquí se arma, una
+vez por paso y en el orden del grid, una copia de 12 bytes por partícula de lo que se lee
+de los vecinos; densidad y fuerzas recorren esa copia en secuencia y solo escriben sus
+resultados en los arreglos float de siempre (ver sph_compact.cpp).
+
+La posición se guarda relativa a su celda, así 16 bits alcanzan para una resolución de
+lado / 65536 sin importar el tamaño del dominio. Velocidad, densidad y presión van en
+float16; densidad y presión se dividen antes por una potencia de dos elegida con el
+máximo del paso, así quedan en el rango del float16 cualquiera sea la masa o la
+rigidez, y escalar por potencias de dos no agrega error.
+*/
+
+//... compact_particles.cpp
+#include "compact_particles.h"
+#include <algorithm>
+#include <cmath>
+
+//... hasta el mayor finito del float16; también lleva NaN a un finito (std::min con NaN
+//... devuelve el límite), así la decodificación sin ramas nunca ve infinito ni NaN
+static uint16_t encodeHalf(float value) {
+    return floatToHalf(std::max(-65504.0f, std::min(65504.0f, value)));
+}
+
+static uint16_t encodeOffset(float offset, float inverseStep) {
+    float scaled = std::floor(offset * inverseStep + 0.5f);
+    return static_cast<uint16_t>(std::max(0.0f, std::min(65535.0f, scaled)));
+}
+
+//... potencia de dos con la que |valor| / escala queda por debajo de 2^14
+static float powerOfTwoScale(float maxAbs) {
+    if (!(maxAbs > 0.0f) || !std::isfinite(maxAbs)) return 1.0f;
+    int exponent = 0;
+    std::frexp(maxAbs, &exponent);
+    return std::ldexp(1.0f, exponent - 14);
+}
+
+CompactParticles::CompactParticles()
+    : cellSize(1.0f), offsetStep(1.0f / 65536.0f), densityScale(1.0f), pressureScale(1.0f) {}
+
+void CompactParticles::build(const ParticleData& particles, const SpatialGrid& grid,
+                             ThreadPool* pool) {
+    const int count = static_cast<int>(particles.size());
+    positions.resize(count);
+    states.resize(count);
+    cellSize = grid.getCellSize();
+    offsetStep = cellSize / 65536.0f;
+    const float inverseStep = 65536.0f / cellSize;
+    const int gridWidth = grid.getGridWidth();
+    const int* indices = grid.getParticleIndices().data();
+    const int* cells = grid.getParticleCells().data();
+
+    //... cada entrada solo escribe la suya; con el reordenamiento en Z la lectura de los
+    //... arreglos float también es casi secuencial
+    parallelChunks(pool, count, chunkGrain(pool, count), [&](int begin, int end) {
+        for (int k = begin; k < end; k++) {
+            const int i = indices[k];
+            const int cellX = cells[i] % gridWidth;
+            const int cellY = cells[i] / gridWidth;
+            //... lo que cae fuera del dominio queda en la celda del borde: el
+            //... desplazamiento se satura en su lado
+            positions[k].x = encodeOffset(particles.x[i] - cellX * cellSize, inverseStep);
+            positions[k].y = encodeOffset(particles.y[i] - cellY * cellSize, inverseStep);
+            states[k].vx = encodeHalf(particles.vx[i]);
+            states[k].vy = encodeHalf(particles.vy[i]);
+        }
+    });
+}
+
+void CompactParticles::storeDensity(const ParticleData& particles, const SpatialGrid& grid,
+                                    float maxDensity, float maxPressure, ThreadPool* pool) {
+    const int count = static_cast<int>(states.size());
+    densityScale = powerOfTwoScale(maxDensity);
+    pressureScale = powerOfTwoScale(maxPressure);
+    const float inverseDensity = 1.0f / densityScale;
+    const float inversePressure = 1.0f / pressureScale;
+    const int* indices = grid.getParticleIndices().data();
+    parallelChunks(pool, count, chunkGrain(pool, count), [&](int begin, int end) {
+        for (int k = begin; k < end; k++) {
+            const int i = indices[k];
+            states[k].density = encodeHalf(particles.density[i] * inverseDensity);
+            states[k].pressure = encodeHalf(particles.pressure[i] * inversePressure);
+        }
+    });
+}
+
+void CompactParticles::clear() {
+    std::vector<CompactPosition>().swap(positions);
+    std::vector<CompactState>().swap(states);
+}
+
+size_t CompactParticles::getMemoryBytes() const {
+    return positions.capacity() * sizeof(CompactPosition) + states.capacity() * sizeof(CompactState);
+}
+
+size_t CompactParticles::fullPrecisionBytes(size_t count) {
+    //... x, y, vx, vy, densidad y presión, más el índice del grid para llegar a ellos
+    return count * (6 * sizeof(float) + sizeof(int));
+}
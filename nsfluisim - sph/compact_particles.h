@@ -0,0 +1,65 @@
+// compact_particles.h
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "particle_system.h"
+#include "spatial_grid.h"
+#include "half_float.h"
+
+//... desplazamiento dentro de la celda en punto fijo: 0..65535 = [0, lado)
+struct CompactPosition {
+    uint16_t x, y;
+};
+
+//... float16; densidad y presión divididas por su escala del paso
+struct CompactState {
+    uint16_t vx, vy;
+    uint16_t density, pressure;
+};
+
+//... copia reducida de lo que leen de los vecinos las pasadas de densidad y fuerzas,
+//... en el orden del grid: la entrada k es la partícula getParticleIndices()[k], así
+//... los vecinos de una celda son contiguos. 12 bytes por partícula contra 28 en float
+//... (x, y, vx, vy, densidad, presión y el índice del grid):
+//...   posición   desplazamiento dentro de su celda en 16 bits (error de lado / 131072)
+//...   velocidad  float16, acotada a +-65504
+//...   densidad   float16 por una escala potencia de dos fijada en cada paso con el
+//...   presión    máximo, así el rango no depende de la masa ni de la rigidez
+//... Solo con el grid Dense, que da la celda (y con ella el origen) de cada entrada
+class CompactParticles {
+private:
+    std::vector<CompactPosition> positions;
+    std::vector<CompactState> states;
+    float cellSize;
+    float offsetStep;           //... cellSize / 65536
+    float densityScale;
+    float pressureScale;
+
+public:
+    CompactParticles();
+
+    //... posiciones y velocidades con el grid recién armado sobre las mismas partículas
+    void build(const ParticleData& particles, const SpatialGrid& grid, ThreadPool* pool);
+    //... densidad y presión tras la pasada de densidad; los máximos (en valor absoluto)
+    //... fijan las escalas
+    void storeDensity(const ParticleData& particles, const SpatialGrid& grid, float maxDensity,
+                      float maxPressure, ThreadPool* pool);
+    void clear();
+
+    size_t size() const { return positions.size(); }
+    //... bytes reservados por la copia, y los de los arreglos en float que reemplaza
+    size_t getMemoryBytes() const;
+    static size_t fullPrecisionBytes(size_t count);
+
+    const CompactPosition* positionData() const { return positions.data(); }
+    const CompactState* stateData() const { return states.data(); }
+
+    //... unidades de desplazamiento por lado de celda: la diferencia entre dos partículas
+    //... de celdas vecinas es entera, (desplazamiento + salto de celda * CELL_UNITS), y
+    //... pasa a distancia multiplicada por getOffsetStep()
+    static const int CELL_UNITS = 65536;
+    float getOffsetStep() const { return offsetStep; }
+    static float velocity(uint16_t value) { return halfToFloatFinite(value); }
+    float density(const CompactState& state) const { return halfToFloatFinite(state.density) * densityScale; }
+    float pressure(const CompactState& state) const { return halfToFloatFinite(state.pressure) * pressureScale; }
+};
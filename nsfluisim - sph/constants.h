@@ -1,12 +1,21 @@
 //... constants.h
 #pragma once
 
+//... solo constantes del núcleo físico, sin SFML (ver ui_constants.h para la interfaz)
 const int WINDOW_WIDTH = 1024;
 const int WINDOW_HEIGHT = 768;
-const float deltaTime = 1.0f/60.0f;
-const float M_PI = 3.14159265358979323846f;
-
-//... colores para la interfaz
-const sf::Color BUTTON_COLOR(100, 100, 200);
-const sf::Color BUTTON_HOVER_COLOR(150, 150, 255);
-const sf::Color TEXT_COLOR(255, 255, 255);
\ No newline at end of file
+//... paso por defecto (un frame a 60 Hz); el paso real lo fija el planificador o el
+//... control adaptativo de SPHSolver, ver SPHSolver::advance
+const float DEFAULT_TIMESTEP = 1.0f/60.0f;
+//... lado de celda de la fase amplia de obstáculos (ver obstacle_field.h)
+const float OBSTACLE_CELL_SIZE = 32.0f;
+//... escena por defecto, la de siempre: un bloque de 30 x 30 partículas separadas por 8
+//... con h = 15 (se cambia sin recompilar con un archivo de escena, ver simulation_config.h)
+const float DEFAULT_SMOOTHING_LENGTH = 15.0f;
+const float DEFAULT_PARTICLE_SPACING = 8.0f;
+const int DEFAULT_BLOCK_COLUMNS = 30;
+const int DEFAULT_BLOCK_PARTICLES = 900;
+//... muestras del historial de estadísticas (la gráfica de velocidad usa 200 px)
+const int DEFAULT_HISTORY_LENGTH = 200;
+//... no se llama M_PI porque <cmath> ya lo define como macro en glibc
+constexpr float PI = 3.14159265358979323846f;
\ No newline at end of file
@@ -0,0 +1,516 @@
+/*
+Reparto del dominio entre procesos MPI para corridas más grandes que una máquina.
+
+El dominio se corta en franjas verticales, una por proceso: con franjas cada proceso
+tiene a lo sumo dos vecinos y el intercambio de fantasmas son dos mensajes por paso
+(con teselas serían ocho, con las esquinas). Los bordes se eligen con un histograma de
+las posiciones en x sumado entre todos los procesos, así cada franja queda con la misma
+cantidad de partículas, y nunca más angostas que 2h: la banda de fantasmas tiene que
+caber en el vecino.
+
+Un paso (step):
+    updateDistributed   el solver pide las fantasmas (beginHalo: cambia con cada vecino
+                        la cantidad y deja pedidos envíos y recepciones no bloqueantes),
+                        calcula lo interior y recién después las espera (finishHalo);
+                        ver sph_distributed.cpp
+    update()            integración, colisiones y sumideros de ParticleSystem, igual que
+                        en un solo proceso, sobre las partículas propias
+    reequilibrio        cada rebalanceInterval pasos se cuentan las partículas por
+                        proceso (MPI_Allgather) y, si el máximo pasa a la media por más
+                        de REBALANCE_THRESHOLD, se recalculan los bordes
+    migración           cada partícula que quedó fuera de la franja va a su dueño con
+                        todo su estado (MPI_Alltoallv: tras un reequilibrio puede saltar
+                        varias franjas)
+
+Las fantasmas viajan con posición y velocidad (4 float) y las que se mudan con posición,
+velocidad, fuerza, densidad y presión (8 float). Los id de ParticleData son de cada
+proceso; gather() junta todo en el proceso 0 en orden de proceso y los renumera.
+
+Sin -DSPH_MPI se compila solo el esqueleto: initialize() falla con un mensaje.
+*/
+
+//... domain_decomposition.cpp
+#include "domain_decomposition.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//... resolución del histograma de posiciones con que se eligen los bordes
+static const int HISTOGRAM_BINS = 4096;
+
+int DomainDecomposition::ownerOf(float x) const {
+    //... los bordes interiores que quedan a la izquierda de x
+    return static_cast<int>(std::upper_bound(bounds.begin() + 1, bounds.end() - 1, x) -
+                            (bounds.begin() + 1));
+}
+
+float DomainDecomposition::edgeDistance(float x) const {
+    float distance = std::numeric_limits<float>::max();
+    if (rank > 0) distance = std::min(distance, std::fabs(x - bounds[rank]));
+    if (rank < rankCount - 1) distance = std::min(distance, std::fabs(x - bounds[rank + 1]));
+    return distance;
+}
+
+void DomainDecomposition::computeBounds(const ParticleSystem& particleSystem, bool replicated) {
+    const float width = static_cast<float>(particleSystem.getDomainWidth());
+    const float binWidth = width / HISTOGRAM_BINS;
+    const ParticleData& particles = particleSystem.getData();
+    std::vector<unsigned long long> histogram(HISTOGRAM_BINS, 0);
+    for (size_t i = 0; i < particles.size(); i++) {
+        int bin = static_cast<int>(particles.x[i] / binWidth);
+        histogram[std::max(0, std::min(HISTOGRAM_BINS - 1, bin))]++;
+    }
+    if (!replicated) sumAcrossRanks(histogram);
+    unsigned long long total = 0;
+    for (unsigned long long count : histogram) total += count;
+
+    bounds.assign(rankCount + 1, width);
+    bounds[0] = 0.0f;
+    if (total == 0) {
+        for (int r = 1; r < rankCount; r++) bounds[r] = width * r / rankCount;
+    } else {
+        //... el borde r cae donde el acumulado llega a r / rankCount del total, repartido
+        //... dentro del bin en proporción
+        unsigned long long running = 0;
+        int next = 1;
+        for (int bin = 0; bin < HISTOGRAM_BINS && next < rankCount; bin++) {
+            while (next < rankCount &&
+                   static_cast<double>(running + histogram[bin]) >= double(total) * next / rankCount) {
+                double target = double(total) * next / rankCount;
+                double fraction = histogram[bin] > 0 ? (target - running) / histogram[bin] : 0.0;
+                bounds[next] = static_cast<float>((bin + fraction) * binWidth);
+                next++;
+            }
+            running += histogram[bin];
+        }
+    }
+
+    //... ninguna franja más angosta que la banda de fantasmas
+    const float minWidth = 2.0f * particleSystem.getSmoothingLength();
+    for (int r = 1; r < rankCount; r++) {
+        bounds[r] = std::max(bounds[r], bounds[r - 1] + minWidth);
+    }
+    for (int r = rankCount - 1; r >= 1; r--) {
+        bounds[r] = std::min(bounds[r], bounds[r + 1] - minWidth);
+    }
+}
+
+void DomainDecomposition::distribute(ParticleSystem& particleSystem) {
+    computeBounds(particleSystem, true);
+    ParticleData& particles = particleSystem.getData();
+    bool removed = false;
+    for (size_t i = particles.size(); i-- > 0;) {
+        if (ownerOf(particles.x[i]) != rank) {
+            particles.swapRemove(i);
+            removed = true;
+        }
+    }
+    if (removed) particleSystem.touchIndices();
+    if (rank != 0 && !particleSystem.getEmitters().empty()) {
+        std::vector<Sink> sinks = particleSystem.getSinks();
+        particleSystem.clearSources();
+        for (const auto& sink : sinks) particleSystem.addSink(sink.minCorner, sink.maxCorner);
+    }
+    stepsSinceRebalance = 0;
+    countParticles(particleSystem);
+}
+
+void DomainDecomposition::step(ParticleSystem& particleSystem, SPHSolver& solver, float dt) {
+    solver.updateDistributed(particleSystem, *this);
+    particleSystem.setDeltaTime(dt);
+    particleSystem.update();
+    if (rankCount <= 1) return;
+
+    ScopedTimer timer(profiler, ProfilePhase::Exchange);
+    if (rebalanceInterval > 0 && ++stepsSinceRebalance >= rebalanceInterval) {
+        stepsSinceRebalance = 0;
+        if (countParticles(particleSystem)) {
+            computeBounds(particleSystem, false);
+            stats.rebalances++;
+        }
+    }
+    migrate(particleSystem);
+}
+
+#if defined(SPH_MPI)
+
+#include <chrono>
+//... solo se usa la API de C: sin los bindings de C++ de OpenMPI/MPICH, que no
+//... compilan limpios con -Wextra
+#define OMPI_SKIP_MPICXX 1
+#define MPICH_SKIP_MPICXX 1
+#include <mpi.h>
+
+namespace {
+
+const int TAG_HALO = 1;
+const int TAG_HALO_COUNT = 2;
+//... x, y, vx, vy
+const int GHOST_FLOATS = 4;
+//... x, y, vx, vy, fx, fy, densidad, presión
+const int MIGRANT_FLOATS = 8;
+
+void packGhost(const ParticleData& particles, size_t i, std::vector<float>& out) {
+    out.push_back(particles.x[i]);
+    out.push_back(particles.y[i]);
+    out.push_back(particles.vx[i]);
+    out.push_back(particles.vy[i]);
+}
+
+void packMigrant(const ParticleData& particles, size_t i, float* out) {
+    out[0] = particles.x[i];
+    out[1] = particles.y[i];
+    out[2] = particles.vx[i];
+    out[3] = particles.vy[i];
+    out[4] = particles.fx[i];
+    out[5] = particles.fy[i];
+    out[6] = particles.density[i];
+    out[7] = particles.pressure[i];
+}
+
+Particle unpackMigrant(const float* in) {
+    Particle p;
+    p.position = Vec2(in[0], in[1]);
+    p.velocity = Vec2(in[2], in[3]);
+    p.force = Vec2(in[4], in[5]);
+    p.density = in[6];
+    p.pressure = in[7];
+    return p;
+}
+
+//... desplazamientos de un MPI_*v a partir de las cantidades
+void prefixOffsets(const std::vector<int>& counts, std::vector<int>& offsets) {
+    offsets.resize(counts.size());
+    int offset = 0;
+    for (size_t r = 0; r < counts.size(); r++) {
+        offsets[r] = offset;
+        offset += counts[r];
+    }
+}
+
+}
+
+struct DomainDecomposition::MpiState {
+    //... fantasmas para el vecino de la izquierda y el de la derecha y las que llegan de
+    //... cada uno; viven hasta el MPI_Waitall de finishHalo
+    std::vector<float> sendLow, sendHigh;
+    std::vector<float> receivedLow, receivedHigh;
+    //... dos envíos y dos recepciones
+    MPI_Request requests[4];
+    int requestCount = 0;
+
+    std::vector<int> leaving;
+    std::vector<int> destinations;
+    std::vector<int> sendCounts, sendOffsets, recvCounts, recvOffsets;
+    std::vector<float> outgoing, incoming;
+};
+
+DomainDecomposition::DomainDecomposition()
+    : mpi(nullptr), initialized(false), ownsMpi(false), rank(0), rankCount(1),
+      rebalanceInterval(25), stepsSinceRebalance(0), profiler(nullptr),
+      stats{0, 0, 0, 0.0, 0, 0, 1.0f} {}
+
+DomainDecomposition::~DomainDecomposition() {
+    if (ownsMpi) {
+        int finalized = 0;
+        MPI_Finalized(&finalized);
+        if (!finalized) MPI_Finalize();
+    }
+}
+
+bool DomainDecomposition::initialize(int* argc, char*** argv, std::string& error) {
+    int alreadyInitialized = 0;
+    MPI_Initialized(&alreadyInitialized);
+    if (!alreadyInitialized) {
+        if (MPI_Init(argc, argv) != MPI_SUCCESS) {
+            error = "MPI_Init falló";
+            return false;
+        }
+        ownsMpi = true;
+    }
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &rankCount);
+    mpi.reset(new MpiState());
+    initialized = true;
+    return true;
+}
+
+void DomainDecomposition::sumAcrossRanks(std::vector<unsigned long long>& values) const {
+    if (rankCount <= 1) return;
+    MPI_Allreduce(MPI_IN_PLACE, values.data(), static_cast<int>(values.size()),
+                  MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+}
+
+bool DomainDecomposition::countParticles(const ParticleSystem& particleSystem) {
+    unsigned long long local = particleSystem.getParticleCount();
+    std::vector<unsigned long long> counts(rankCount, 0);
+    MPI_Allgather(&local, 1, MPI_UNSIGNED_LONG_LONG, counts.data(), 1, MPI_UNSIGNED_LONG_LONG,
+                  MPI_COMM_WORLD);
+    unsigned long long total = 0;
+    stats.minParticles = static_cast<size_t>(counts[0]);
+    stats.maxParticles = static_cast<size_t>(counts[0]);
+    for (unsigned long long count : counts) {
+        total += count;
+        stats.minParticles = std::min(stats.minParticles, static_cast<size_t>(count));
+        stats.maxParticles = std::max(stats.maxParticles, static_cast<size_t>(count));
+    }
+    double mean = double(total) / rankCount;
+    stats.imbalance = mean > 0.0 ? static_cast<float>(stats.maxParticles / mean) : 1.0f;
+    return stats.imbalance > REBALANCE_THRESHOLD;
+}
+
+void DomainDecomposition::beginHalo(const ParticleSystem& particleSystem, float width) {
+    MpiState& st = *mpi;
+    st.sendLow.clear();
+    st.sendHigh.clear();
+    st.receivedLow.clear();
+    st.receivedHigh.clear();
+    st.requestCount = 0;
+    if (rankCount <= 1) return;
+
+    const ParticleData& particles = particleSystem.getData();
+    const float low = bounds[rank];
+    const float high = bounds[rank + 1];
+    for (size_t i = 0; i < particles.size(); i++) {
+        if (rank > 0 && particles.x[i] < low + width) packGhost(particles, i, st.sendLow);
+        if (rank < rankCount - 1 && particles.x[i] >= high - width) packGhost(particles, i, st.sendHigh);
+    }
+
+    //... primero las cantidades (un int por vecino, lo único que espera acá) para poder
+    //... dimensionar los búferes y dejar pedidas las recepciones antes de volver
+    int sendCount[2] = {static_cast<int>(st.sendLow.size()), static_cast<int>(st.sendHigh.size())};
+    int recvCount[2] = {0, 0};
+    MPI_Request countRequests[4];
+    int countRequestCount = 0;
+    if (rank > 0) {
+        MPI_Irecv(&recvCount[0], 1, MPI_INT, rank - 1, TAG_HALO_COUNT, MPI_COMM_WORLD,
+                  &countRequests[countRequestCount++]);
+        MPI_Isend(&sendCount[0], 1, MPI_INT, rank - 1, TAG_HALO_COUNT, MPI_COMM_WORLD,
+                  &countRequests[countRequestCount++]);
+    }
+    if (rank < rankCount - 1) {
+        MPI_Irecv(&recvCount[1], 1, MPI_INT, rank + 1, TAG_HALO_COUNT, MPI_COMM_WORLD,
+                  &countRequests[countRequestCount++]);
+        MPI_Isend(&sendCount[1], 1, MPI_INT, rank + 1, TAG_HALO_COUNT, MPI_COMM_WORLD,
+                  &countRequests[countRequestCount++]);
+    }
+    MPI_Waitall(countRequestCount, countRequests, MPI_STATUSES_IGNORE);
+
+    if (rank > 0) {
+        st.receivedLow.resize(recvCount[0]);
+        MPI_Irecv(st.receivedLow.data(), recvCount[0], MPI_FLOAT, rank - 1, TAG_HALO, MPI_COMM_WORLD,
+                  &st.requests[st.requestCount++]);
+        MPI_Isend(st.sendLow.data(), sendCount[0], MPI_FLOAT, rank - 1, TAG_HALO, MPI_COMM_WORLD,
+                  &st.requests[st.requestCount++]);
+    }
+    if (rank < rankCount - 1) {
+        st.receivedHigh.resize(recvCount[1]);
+        MPI_Irecv(st.receivedHigh.data(), recvCount[1], MPI_FLOAT, rank + 1, TAG_HALO, MPI_COMM_WORLD,
+                  &st.requests[st.requestCount++]);
+        MPI_Isend(st.sendHigh.data(), sendCount[1], MPI_FLOAT, rank + 1, TAG_HALO, MPI_COMM_WORLD,
+                  &st.requests[st.requestCount++]);
+    }
+    stats.ghostsSent += (st.sendLow.size() + st.sendHigh.size()) / GHOST_FLOATS;
+}
+
+void DomainDecomposition::finishHalo(ParticleSystem& particleSystem) {
+    if (rankCount <= 1) return;
+    MpiState& st = *mpi;
+    ParticleData& particles = particleSystem.getData();
+    auto start = std::chrono::steady_clock::now();
+
+    //... las recepciones ya están pedidas desde beginHalo: acá solo se espera
+    MPI_Waitall(st.requestCount, st.requests, MPI_STATUSES_IGNORE);
+    stats.haloWaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    //... primero las del vecino de la izquierda, así el orden de las fantasmas no depende
+    //... de cuál llegó antes
+    auto append = [&](const std::vector<float>& received) {
+        for (size_t k = 0; k + GHOST_FLOATS <= received.size(); k += GHOST_FLOATS) {
+            Particle ghost;
+            ghost.position = Vec2(received[k], received[k + 1]);
+            ghost.velocity = Vec2(received[k + 2], received[k + 3]);
+            ghost.force = Vec2(0.0f, 0.0f);
+            ghost.density = 0.0f;
+            ghost.pressure = 0.0f;
+            particles.push_back(ghost);
+        }
+    };
+    append(st.receivedLow);
+    append(st.receivedHigh);
+}
+
+void DomainDecomposition::migrate(ParticleSystem& particleSystem) {
+    MpiState& st = *mpi;
+    ParticleData& particles = particleSystem.getData();
+    st.leaving.clear();
+    st.destinations.clear();
+    st.sendCounts.assign(rankCount, 0);
+    for (size_t i = 0; i < particles.size(); i++) {
+        int owner = ownerOf(particles.x[i]);
+        if (owner != rank) {
+            st.leaving.push_back(static_cast<int>(i));
+            st.destinations.push_back(owner);
+            st.sendCounts[owner] += MIGRANT_FLOATS;
+        }
+    }
+    prefixOffsets(st.sendCounts, st.sendOffsets);
+    st.outgoing.resize(st.leaving.size() * MIGRANT_FLOATS);
+    std::vector<int> cursor(st.sendOffsets);
+    for (size_t k = 0; k < st.leaving.size(); k++) {
+        int& offset = cursor[st.destinations[k]];
+        packMigrant(particles, st.leaving[k], st.outgoing.data() + offset);
+        offset += MIGRANT_FLOATS;
+    }
+
+    st.recvCounts.assign(rankCount, 0);
+    MPI_Alltoall(st.sendCounts.data(), 1, MPI_INT, st.recvCounts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    prefixOffsets(st.recvCounts, st.recvOffsets);
+    st.incoming.resize(st.recvOffsets.back() + st.recvCounts.back());
+    MPI_Alltoallv(st.outgoing.data(), st.sendCounts.data(), st.sendOffsets.data(), MPI_FLOAT,
+                  st.incoming.data(), st.recvCounts.data(), st.recvOffsets.data(), MPI_FLOAT,
+                  MPI_COMM_WORLD);
+
+    //... de atrás para adelante: swapRemove solo mueve partículas que se quedan
+    for (size_t k = st.leaving.size(); k-- > 0;) {
+        particles.swapRemove(st.leaving[k]);
+    }
+    for (size_t k = 0; k + MIGRANT_FLOATS <= st.incoming.size(); k += MIGRANT_FLOATS) {
+        particles.push_back(unpackMigrant(st.incoming.data() + k));
+    }
+    stats.migrated += st.leaving.size();
+    if (!st.leaving.empty() || !st.incoming.empty()) particleSystem.touchIndices();
+}
+
+void DomainDecomposition::gather(ParticleSystem& particleSystem) {
+    if (rankCount <= 1) return;
+    MpiState& st = *mpi;
+    const ParticleData& particles = particleSystem.getData();
+    st.outgoing.resize(particles.size() * MIGRANT_FLOATS);
+    for (size_t i = 0; i < particles.size(); i++) {
+        packMigrant(particles, i, st.outgoing.data() + i * MIGRANT_FLOATS);
+    }
+    int sendCount = static_cast<int>(st.outgoing.size());
+    st.recvCounts.assign(rankCount, 0);
+    MPI_Gather(&sendCount, 1, MPI_INT, st.recvCounts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    prefixOffsets(st.recvCounts, st.recvOffsets);
+    st.incoming.resize(rank == 0 ? st.recvOffsets.back() + st.recvCounts.back() : 0);
+    MPI_Gatherv(st.outgoing.data(), sendCount, MPI_FLOAT, st.incoming.data(), st.recvCounts.data(),
+                st.recvOffsets.data(), MPI_FLOAT, 0, MPI_COMM_WORLD);
+
+    ParticleData all;
+    if (rank == 0) {
+        all.reserve(st.incoming.size() / MIGRANT_FLOATS);
+        for (size_t k = 0; k + MIGRANT_FLOATS <= st.incoming.size(); k += MIGRANT_FLOATS) {
+            all.push_back(unpackMigrant(st.incoming.data() + k));
+        }
+    }
+    //... restore() borra los obstáculos antes de copiar la lista: va una copia
+    std::vector<Obstacle> obstacles = particleSystem.getObstacles().getObstacles();
+    particleSystem.restore(std::move(all), obstacles, particleSystem.getStepCount(),
+                           particleSystem.getSimulatedTime());
+}
+
+void DomainDecomposition::barrier() const {
+    if (rankCount <= 1) return;
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+DensityStats DomainDecomposition::reduceDensityStats(const DensityStats& local, size_t count) const {
+    if (rankCount <= 1) return local;
+    //... un proceso sin partículas no aporta extremos
+    const bool empty = count == 0;
+    double sums[3] = {double(local.averageDensity) * count, double(local.averageError) * count,
+                      double(count)};
+    float maxima[4] = {empty ? 0.0f : local.maxDensity, empty ? 0.0f : local.maxError,
+                       empty ? std::numeric_limits<float>::lowest() : local.maxPressure,
+                       empty ? std::numeric_limits<float>::lowest() : -local.minPressure};
+    MPI_Allreduce(MPI_IN_PLACE, sums, 3, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, maxima, 4, MPI_FLOAT, MPI_MAX, MPI_COMM_WORLD);
+    DensityStats total = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    if (sums[2] > 0.0) {
+        total.averageDensity = static_cast<float>(sums[0] / sums[2]);
+        total.averageError = static_cast<float>(sums[1] / sums[2]);
+        total.maxDensity = maxima[0];
+        total.maxError = maxima[1];
+        total.maxPressure = maxima[2];
+        total.minPressure = -maxima[3];
+    }
+    return total;
+}
+
+DecompositionStats DomainDecomposition::reduceStats(const ParticleSystem& particleSystem) const {
+    DecompositionStats total = stats;
+    if (rankCount <= 1) {
+        total.minParticles = total.maxParticles = particleSystem.getParticleCount();
+        return total;
+    }
+    unsigned long long sums[2] = {stats.ghostsSent, stats.migrated};
+    MPI_Allreduce(MPI_IN_PLACE, sums, 2, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&stats.haloWaitSeconds, &total.haloWaitSeconds, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    total.ghostsSent = sums[0];
+    total.migrated = sums[1];
+
+    unsigned long long local = particleSystem.getParticleCount();
+    std::vector<unsigned long long> counts(rankCount, 0);
+    MPI_Allgather(&local, 1, MPI_UNSIGNED_LONG_LONG, counts.data(), 1, MPI_UNSIGNED_LONG_LONG,
+                  MPI_COMM_WORLD);
+    unsigned long long sum = 0;
+    total.minParticles = static_cast<size_t>(counts[0]);
+    total.maxParticles = static_cast<size_t>(counts[0]);
+    for (unsigned long long count : counts) {
+        sum += count;
+        total.minParticles = std::min(total.minParticles, static_cast<size_t>(count));
+        total.maxParticles = std::max(total.maxParticles, static_cast<size_t>(count));
+    }
+    double mean = double(sum) / rankCount;
+    total.imbalance = mean > 0.0 ? static_cast<float>(total.maxParticles / mean) : 1.0f;
+    return total;
+}
+
+#else
+
+//... sin -DSPH_MPI: la interfaz existe, con un solo proceso y sin comunicación
+struct DomainDecomposition::MpiState {};
+
+DomainDecomposition::DomainDecomposition()
+    : mpi(nullptr), initialized(false), ownsMpi(false), rank(0), rankCount(1),
+      rebalanceInterval(25), stepsSinceRebalance(0), profiler(nullptr),
+      stats{0, 0, 0, 0.0, 0, 0, 1.0f} {}
+
+DomainDecomposition::~DomainDecomposition() {}
+
+bool DomainDecomposition::initialize(int*, char***, std::string& error) {
+    error = "reparto entre procesos no compilado (falta -DSPH_MPI)";
+    return false;
+}
+
+void DomainDecomposition::sumAcrossRanks(std::vector<unsigned long long>&) const {}
+
+bool DomainDecomposition::countParticles(const ParticleSystem& particleSystem) {
+    stats.minParticles = stats.maxParticles = particleSystem.getParticleCount();
+    stats.imbalance = 1.0f;
+    return false;
+}
+
+void DomainDecomposition::beginHalo(const ParticleSystem&, float) {}
+
+void DomainDecomposition::finishHalo(ParticleSystem&) {}
+
+void DomainDecomposition::migrate(ParticleSystem&) {}
+
+void DomainDecomposition::gather(ParticleSystem&) {}
+
+void DomainDecomposition::barrier() const {}
+
+DensityStats DomainDecomposition::reduceDensityStats(const DensityStats& local, size_t) const {
+    return local;
+}
+
+DecompositionStats DomainDecomposition::reduceStats(const ParticleSystem& particleSystem) const {
+    DecompositionStats total = stats;
+    total.minParticles = total.maxParticles = particleSystem.getParticleCount();
+    return total;
+}
+
+#endif
@@ -0,0 +1,104 @@
+// domain_decomposition.h
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "halo_exchange.h"
+#include "particle_system.h"
+#include "sph_solver.h"
+
+//... lo que midió el reparto; getStats() es la del proceso y reduceStats() la de todos
+struct DecompositionStats {
+    unsigned long long ghostsSent;      //... fantasmas mandadas, sumadas en todos los pasos
+    unsigned long long migrated;        //... partículas que cambiaron de proceso
+    unsigned rebalances;
+    double haloWaitSeconds;             //... esperando fantasmas después de la primera mitad
+    size_t minParticles;                //... partículas por proceso, al último recuento
+    size_t maxParticles;
+    float imbalance;                    //... máximo / media del último recuento
+};
+
+//... reparto del dominio entre procesos MPI para el ejecutable sin ventana: cada proceso
+//... simula una franja vertical [x0, x1) del dominio con su propio ParticleSystem y
+//... SPHSolver, ve las partículas del vecino a menos de 2h del borde como fantasmas (ver
+//... sph_distributed.cpp) y, después de integrar, manda al dueño nuevo las que cruzaron.
+//... Cada tantos pasos compara las partículas por proceso y, si el desbalance pasa de
+//... REBALANCE_THRESHOLD, mueve los bordes para que cada franja tenga la misma cantidad.
+//... Solo se compila de verdad con -DSPH_MPI (y mpicxx); sin eso initialize() devuelve
+//... false. Cubre la ecuación de estado con paso fijo y los arreglos float
+class DomainDecomposition : public HaloExchange {
+public:
+    //... desbalance (máximo / media) a partir del cual se mueven los bordes
+    static constexpr float REBALANCE_THRESHOLD = 1.1f;
+
+    DomainDecomposition();
+    //... MPI_Finalize si initialize() hizo el MPI_Init
+    ~DomainDecomposition();
+    DomainDecomposition(const DomainDecomposition&) = delete;
+    DomainDecomposition& operator=(const DomainDecomposition&) = delete;
+
+    //... MPI_Init (si nadie lo hizo antes); false con 'error' si no hay MPI
+    bool initialize(int* argc, char*** argv, std::string& error);
+    bool isInitialized() const { return initialized; }
+    int getRank() const { return rank; }
+    int getRankCount() const { return rankCount; }
+    //... pasos entre recuentos para reequilibrar; 0 = bordes fijos
+    void setRebalanceInterval(int steps) { rebalanceInterval = steps > 0 ? steps : 0; }
+    int getRebalanceInterval() const { return rebalanceInterval; }
+    //... mide el intercambio y la migración (fase Exchange); nullptr = sin instrumentación
+    void setProfiler(Profiler* p) { profiler = p; }
+
+    //... todos los procesos arrancan con el mismo estado (la misma escena o el mismo
+    //... checkpoint): fija los bordes con la distribución de esas partículas y cada uno
+    //... se queda con las de su franja. Los emisores quedan solo en el proceso 0 (si no,
+    //... cada proceso largaría las mismas filas); lo que larguen se migra al dueño en el
+    //... paso siguiente. Los sumideros siguen en todos
+    void distribute(ParticleSystem& particleSystem);
+    //... un paso de dt en todos los procesos (colectiva): updateDistributed, integración,
+    //... reequilibrio si toca y migración
+    void step(ParticleSystem& particleSystem, SPHSolver& solver, float dt);
+    //... junta todas las partículas en el proceso 0 con restore() (los demás quedan
+    //... vacíos), para las estadísticas y el checkpoint finales (colectiva)
+    void gather(ParticleSystem& particleSystem);
+    //... espera a que todos lleguen (colectiva)
+    void barrier() const;
+
+    //... DensityStats del último paso de todos los procesos; 'local' es la del solver del
+    //... proceso, con sus 'count' partículas (colectiva)
+    DensityStats reduceDensityStats(const DensityStats& local, size_t count) const;
+    const DecompositionStats& getStats() const { return stats; }
+    //... sumas, máximos y recuento actual de todos los procesos (colectiva)
+    DecompositionStats reduceStats(const ParticleSystem& particleSystem) const;
+    //... rankCount + 1 bordes en x: el proceso r tiene [bounds[r], bounds[r + 1])
+    const std::vector<float>& getBounds() const { return bounds; }
+
+    void beginHalo(const ParticleSystem& particleSystem, float width) override;
+    void finishHalo(ParticleSystem& particleSystem) override;
+    float edgeDistance(float x) const override;
+
+private:
+    //... búferes y pedidos de MPI (solo existen en domain_decomposition.cpp)
+    struct MpiState;
+    std::unique_ptr<MpiState> mpi;
+    bool initialized;
+    bool ownsMpi;
+    int rank;
+    int rankCount;
+    std::vector<float> bounds;
+    int rebalanceInterval;
+    int stepsSinceRebalance;
+    Profiler* profiler;
+    DecompositionStats stats;
+
+    //... proceso dueño de la franja que contiene x (lo de fuera del dominio, al del borde)
+    int ownerOf(float x) const;
+    //... bordes con la misma cantidad de partículas por franja, cada una de al menos 2h;
+    //... 'replicated' = todos tienen las mismas partículas (no se suman los histogramas)
+    void computeBounds(const ParticleSystem& particleSystem, bool replicated);
+    //... recuento por proceso; true si hay que reequilibrar
+    bool countParticles(const ParticleSystem& particleSystem);
+    //... suma elemento a elemento entre todos los procesos (colectiva)
+    void sumAcrossRanks(std::vector<unsigned long long>& values) const;
+    //... manda cada partícula propia que quedó fuera de la franja a su dueño
+    void migrate(ParticleSystem& particleSystem);
+};
@@ -0,0 +1,582 @@
+/*
+Exportación de frames para análisis y render offline.
+
+Hasta ahora lo único que salía de la simulación era la gráfica de velocidad en pantalla.
+FrameExporter escribe cada N pasos las posiciones, velocidades y densidades (y si se pide
+los id y la presión) a un archivo de frames en bloques, uno por frame, que se puede leer
+de forma secuencial con FrameReader.
+
+Para que exportar no frene la simulación el trabajo se reparte en dos hilos con doble
+búfer: en el hilo de simulación capture() solo copia los arreglos SoA al búfer libre, y
+el hilo escritor se encarga de cuantizar a float16 (opcional), reordenar por planos de
+bytes y comprimir con LZ4 o zstd (opcional) antes de escribir.
+*/
+
+//... frame_exporter.cpp
+#include "frame_exporter.h"
+#include "half_float.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(SPH_EXPORT_LZ4)
+#include <lz4.h>
+#endif
+#if defined(SPH_EXPORT_ZSTD)
+#include <zstd.h>
+#endif
+
+static const char FRAME_STREAM_MAGIC[8] = {'N', 'S', 'F', 'S', 'P', 'H', 'F', 'S'};
+static const uint32_t FRAME_ENDIAN_TAG = 0x01020304u;
+//... tope de un frame sin comprimir al leer (y lo que LZ4 acepta en un int): un tamaño
+//... dañado no llega a pedir gigas de memoria antes de fallar
+static const uint64_t MAX_FRAME_RAW_BYTES = 1ull << 30;
+
+//... los campos float en el orden del payload; x/y y vx/vy comparten un bit
+static const int FLOAT_FIELD_COUNT = 6;
+static const uint32_t FLOAT_FIELD_MASKS[FLOAT_FIELD_COUNT] = {
+    FrameFieldPosition, FrameFieldPosition,
+    FrameFieldVelocity, FrameFieldVelocity,
+    FrameFieldDensity, FrameFieldPressure
+};
+
+//... sirve para FrameExporter::Snapshot y ExportedFrame, que tienen los mismos campos
+template <typename Frame, typename Field>
+static void floatFields(Frame& frame, Field* fields[FLOAT_FIELD_COUNT]) {
+    fields[0] = &frame.x;
+    fields[1] = &frame.y;
+    fields[2] = &frame.vx;
+    fields[3] = &frame.vy;
+    fields[4] = &frame.density;
+    fields[5] = &frame.pressure;
+}
+
+static size_t floatElementSize(uint32_t encoding) {
+    return encoding == static_cast<uint32_t>(FrameEncoding::Float16) ? sizeof(uint16_t) : sizeof(float);
+}
+
+//... tamaño de cada arreglo del payload, en orden (id primero); devuelve cuántos hay
+static int payloadLayout(uint32_t fieldMask, uint32_t encoding,
+                         size_t elementSizes[FLOAT_FIELD_COUNT + 1]) {
+    int arrays = 0;
+    if (fieldMask & FrameFieldId) elementSizes[arrays++] = sizeof(int32_t);
+    for (int f = 0; f < FLOAT_FIELD_COUNT; f++) {
+        if (fieldMask & FLOAT_FIELD_MASKS[f]) elementSizes[arrays++] = floatElementSize(encoding);
+    }
+    return arrays;
+}
+
+//... planos de bytes: el byte b del elemento i pasa a b * count + i (y al revés)
+static void shuffleBytes(const unsigned char* source, unsigned char* target, uint64_t count,
+                         size_t elementSize) {
+    for (size_t b = 0; b < elementSize; b++) {
+        unsigned char* plane = target + b * count;
+        for (uint64_t i = 0; i < count; i++) {
+            plane[i] = source[i * elementSize + b];
+        }
+    }
+}
+
+static void unshuffleBytes(const unsigned char* source, unsigned char* target, uint64_t count,
+                           size_t elementSize) {
+    for (size_t b = 0; b < elementSize; b++) {
+        const unsigned char* plane = source + b * count;
+        for (uint64_t i = 0; i < count; i++) {
+            target[i * elementSize + b] = plane[i];
+        }
+    }
+}
+
+bool frameCompressionAvailable(FrameCompression compression) {
+    switch (compression) {
+        case FrameCompression::None: return true;
+#if defined(SPH_EXPORT_LZ4)
+        case FrameCompression::LZ4: return true;
+#endif
+#if defined(SPH_EXPORT_ZSTD)
+        case FrameCompression::Zstd: return true;
+#endif
+        default: return false;
+    }
+}
+
+const char* frameCompressionName(FrameCompression compression) {
+    switch (compression) {
+        case FrameCompression::None: return "none";
+        case FrameCompression::LZ4: return "lz4";
+        case FrameCompression::Zstd: return "zstd";
+        default: return "?";
+    }
+}
+
+FrameExporter::FrameExporter()
+    : file(nullptr), stopping(false), captureCalls(0), nextFrameIndex(0),
+      stats(), profiler(nullptr) {
+    for (auto& buffer : buffers) {
+        buffer.state = BufferState::Free;
+    }
+}
+
+FrameExporter::~FrameExporter() {
+    close();
+}
+
+bool FrameExporter::open(const std::string& path, const FrameExportSettings& exportSettings,
+                         std::string& error) {
+    close();
+    if (!frameCompressionAvailable(exportSettings.compression)) {
+        error = std::string("compresión ") + frameCompressionName(exportSettings.compression) +
+                " no compilada (falta -DSPH_EXPORT_LZ4 / -DSPH_EXPORT_ZSTD)";
+        return false;
+    }
+    std::FILE* output = std::fopen(path.c_str(), "wb");
+    if (!output) {
+        error = "no se pudo crear " + path;
+        return false;
+    }
+
+    FrameStreamHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, FRAME_STREAM_MAGIC, sizeof(header.magic));
+    header.version = FRAME_STREAM_VERSION;
+    header.endianTag = FRAME_ENDIAN_TAG;
+    header.headerSize = sizeof(FrameStreamHeader);
+    if (std::fwrite(&header, sizeof(header), 1, output) != 1) {
+        std::fclose(output);
+        error = "falló la escritura de " + path;
+        return false;
+    }
+
+    settings = exportSettings;
+    if (settings.interval < 1) settings.interval = 1;
+    file = output;
+    stopping = false;
+    captureCalls = 0;
+    nextFrameIndex = 0;
+    stats = FrameExportStats();
+    stats.storedBytes = sizeof(header);
+    lastError.clear();
+    for (auto& buffer : buffers) {
+        buffer.state = BufferState::Free;
+    }
+    worker = std::thread(&FrameExporter::workerLoop, this);
+    return true;
+}
+
+void FrameExporter::close() {
+    if (!file) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    readyCondition.notify_all();
+    worker.join();
+    if (std::fclose(file) != 0 && !stats.failed) {
+        stats.failed = true;
+        lastError = "falló el cierre del archivo de frames";
+    }
+    file = nullptr;
+}
+
+bool FrameExporter::capture(const ParticleSystem& particleSystem) {
+    if (!file) return false;
+    captureCalls++;
+    if (captureCalls % static_cast<unsigned long long>(settings.interval) != 0) return false;
+
+    ScopedTimer timer(profiler, ProfilePhase::Export);
+    Snapshot* buffer = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto findFree = [&] {
+            for (auto& candidate : buffers) {
+                if (candidate.state == BufferState::Free) {
+                    buffer = &candidate;
+                    return true;
+                }
+            }
+            return false;
+        };
+        if (!findFree()) {
+            if (settings.dropWhenBusy) {
+                stats.framesDropped++;
+                return false;
+            }
+            auto waitStart = std::chrono::steady_clock::now();
+            freeCondition.wait(lock, findFree);
+            stats.stallSeconds += std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - waitStart).count();
+        }
+        buffer->state = BufferState::Filling;
+        buffer->frameIndex = nextFrameIndex++;
+    }
+
+    //... el búfer está reservado: se llena sin el candado
+    const ParticleData& particles = particleSystem.getData();
+    buffer->particleCount = particles.size();
+    buffer->stepCount = particleSystem.getStepCount();
+    buffer->simulatedTime = particleSystem.getSimulatedTime();
+    if (settings.fields & FrameFieldId) buffer->id.assign(particles.id.begin(), particles.id.end());
+    else buffer->id.clear();
+    const std::vector<float>* sources[FLOAT_FIELD_COUNT] = {
+        &particles.x, &particles.y, &particles.vx, &particles.vy,
+        &particles.density, &particles.pressure
+    };
+    std::vector<float>* targets[FLOAT_FIELD_COUNT];
+    floatFields(*buffer, targets);
+    for (int f = 0; f < FLOAT_FIELD_COUNT; f++) {
+        if (settings.fields & FLOAT_FIELD_MASKS[f]) targets[f]->assign(sources[f]->begin(), sources[f]->end());
+        else targets[f]->clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer->state = BufferState::Ready;
+    }
+    readyCondition.notify_one();
+    return true;
+}
+
+void FrameExporter::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        //... el más viejo de los listos, así los frames salen en orden
+        Snapshot* next = nullptr;
+        readyCondition.wait(lock, [&] {
+            next = nullptr;
+            for (auto& candidate : buffers) {
+                if (candidate.state == BufferState::Ready &&
+                    (!next || candidate.frameIndex < next->frameIndex)) {
+                    next = &candidate;
+                }
+            }
+            return next != nullptr || stopping;
+        });
+        if (!next) break;
+
+        next->state = BufferState::Writing;
+        bool skip = stats.failed;
+        lock.unlock();
+
+        bool ok = skip || writeFrame(*next);
+
+        lock.lock();
+        next->state = BufferState::Free;
+        if (skip) {
+            stats.framesDropped++;
+        } else if (!ok) {
+            stats.failed = true;
+            stats.framesDropped++;
+        }
+        freeCondition.notify_all();
+    }
+}
+
+void FrameExporter::encodePayload(const Snapshot& snapshot) {
+    const uint64_t count = snapshot.particleCount;
+    const size_t elementSize = floatElementSize(static_cast<uint32_t>(settings.encoding));
+    const bool half = settings.encoding == FrameEncoding::Float16;
+
+    size_t rawSize = 0;
+    if (settings.fields & FrameFieldId) rawSize += count * sizeof(int32_t);
+    for (int f = 0; f < FLOAT_FIELD_COUNT; f++) {
+        if (settings.fields & FLOAT_FIELD_MASKS[f]) rawSize += count * elementSize;
+    }
+    payload.resize(rawSize);
+
+    unsigned char* out = payload.data();
+    if (settings.fields & FrameFieldId) {
+        if (count > 0) std::memcpy(out, snapshot.id.data(), count * sizeof(int32_t));
+        out += count * sizeof(int32_t);
+    }
+    const std::vector<float>* fields[FLOAT_FIELD_COUNT];
+    floatFields(snapshot, fields);
+    for (int f = 0; f < FLOAT_FIELD_COUNT; f++) {
+        if (!(settings.fields & FLOAT_FIELD_MASKS[f])) continue;
+        const float* source = fields[f]->data();
+        if (half) {
+            for (uint64_t i = 0; i < count; i++) {
+                uint16_t value = floatToHalf(source[i]);
+                std::memcpy(out + i * sizeof(uint16_t), &value, sizeof(value));
+            }
+        } else if (count > 0) {
+            std::memcpy(out, source, count * sizeof(float));
+        }
+        out += count * elementSize;
+    }
+}
+
+bool FrameExporter::compressPayload(uint64_t count, std::string& error) {
+    //... arreglo por arreglo a planos de bytes, después un solo bloque comprimido
+    const uint64_t rawSize = payload.size();
+    size_t elementSizes[FLOAT_FIELD_COUNT + 1];
+    int arrays = payloadLayout(settings.fields, static_cast<uint32_t>(settings.encoding), elementSizes);
+
+    shuffled.resize(rawSize);
+    uint64_t offset = 0;
+    for (int a = 0; a < arrays; a++) {
+        shuffleBytes(payload.data() + offset, shuffled.data() + offset, count, elementSizes[a]);
+        offset += count * elementSizes[a];
+    }
+
+    switch (settings.compression) {
+#if defined(SPH_EXPORT_LZ4)
+        case FrameCompression::LZ4: {
+            int bound = LZ4_compressBound(static_cast<int>(rawSize));
+            compressed.resize(static_cast<size_t>(bound));
+            //... en LZ4 el "nivel" es la aceleración: más alto, más rápido y menos compresión
+            int written = LZ4_compress_fast(reinterpret_cast<const char*>(shuffled.data()),
+                                            reinterpret_cast<char*>(compressed.data()),
+                                            static_cast<int>(rawSize), bound,
+                                            settings.compressionLevel > 1 ? settings.compressionLevel : 1);
+            if (written <= 0) {
+                error = "falló la compresión LZ4";
+                return false;
+            }
+            compressed.resize(static_cast<size_t>(written));
+            return true;
+        }
+#endif
+#if defined(SPH_EXPORT_ZSTD)
+        case FrameCompression::Zstd: {
+            size_t bound = ZSTD_compressBound(rawSize);
+            compressed.resize(bound);
+            //... 3 es el nivel por defecto de zstd
+            size_t written = ZSTD_compress(compressed.data(), bound, shuffled.data(), rawSize,
+                                           settings.compressionLevel > 0 ? settings.compressionLevel : 3);
+            if (ZSTD_isError(written)) {
+                error = std::string("falló la compresión zstd: ") + ZSTD_getErrorName(written);
+                return false;
+            }
+            compressed.resize(written);
+            return true;
+        }
+#endif
+        default:
+            error = "compresión no disponible";
+            return false;
+    }
+}
+
+bool FrameExporter::writeFrame(const Snapshot& snapshot) {
+    encodePayload(snapshot);
+
+    std::string error;
+    const bool compress = settings.compression != FrameCompression::None;
+    if (compress && !compressPayload(snapshot.particleCount, error)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        lastError = error;
+        return false;
+    }
+    const std::vector<unsigned char>& stored = compress ? compressed : payload;
+
+    FrameChunkHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.tag = FRAME_CHUNK_TAG;
+    header.fieldMask = settings.fields;
+    header.encoding = static_cast<uint32_t>(settings.encoding);
+    header.compression = static_cast<uint32_t>(settings.compression);
+    header.frameIndex = snapshot.frameIndex;
+    header.stepCount = snapshot.stepCount;
+    header.simulatedTime = snapshot.simulatedTime;
+    header.particleCount = snapshot.particleCount;
+    header.rawSize = payload.size();
+    header.storedSize = stored.size();
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              (stored.empty() || std::fwrite(stored.data(), 1, stored.size(), file) == stored.size());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!ok) {
+        lastError = "falló la escritura de un frame";
+        return false;
+    }
+    stats.framesWritten++;
+    stats.rawBytes += header.rawSize;
+    stats.storedBytes += sizeof(header) + header.storedSize;
+    return true;
+}
+
+FrameExportStats FrameExporter::getStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+std::string FrameExporter::getLastError() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastError;
+}
+
+//... tamaño del archivo en 64 bits (ftell es de 32 en Windows); deja el cursor al final
+static bool streamSize(std::FILE* file, uint64_t& size) {
+#ifdef _WIN32
+    if (_fseeki64(file, 0, SEEK_END) != 0) return false;
+    const long long end = _ftelli64(file);
+#else
+    if (fseeko(file, 0, SEEK_END) != 0) return false;
+    const long long end = ftello(file);
+#endif
+    if (end < 0) return false;
+    size = static_cast<uint64_t>(end);
+    return true;
+}
+
+FrameReader::FrameReader() : file(nullptr), remaining(0) {}
+
+FrameReader::~FrameReader() {
+    close();
+}
+
+bool FrameReader::open(const std::string& path, std::string& error) {
+    close();
+    file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        error = "no se pudo abrir " + path;
+        return false;
+    }
+    FrameStreamHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        std::memcmp(header.magic, FRAME_STREAM_MAGIC, sizeof(header.magic)) != 0) {
+        error = path + " no es un archivo de frames";
+        close();
+        return false;
+    }
+    if (header.endianTag != FRAME_ENDIAN_TAG || header.version > FRAME_STREAM_VERSION ||
+        header.headerSize < sizeof(FrameStreamHeader)) {
+        error = path + " es de otra versión u orden de bytes";
+        close();
+        return false;
+    }
+    uint64_t size = 0;
+    if (!streamSize(file, size) || size < header.headerSize) {
+        error = path + " está truncado";
+        close();
+        return false;
+    }
+    remaining = size - header.headerSize;
+    //... una cabecera más larga (versión futura compatible) se saltea
+    std::fseek(file, static_cast<long>(header.headerSize), SEEK_SET);
+    return true;
+}
+
+void FrameReader::close() {
+    if (file) std::fclose(file);
+    file = nullptr;
+    remaining = 0;
+}
+
+bool FrameReader::next(ExportedFrame& frame, std::string& error) {
+    error.clear();
+    if (!file) {
+        error = "el lector no está abierto";
+        return false;
+    }
+    FrameChunkHeader& header = frame.header;
+    size_t got = std::fread(&header, 1, sizeof(header), file);
+    if (got == 0 && std::feof(file)) return false;
+    if (got != sizeof(header) || header.tag != FRAME_CHUNK_TAG) {
+        error = "cabecera de frame dañada";
+        return false;
+    }
+    remaining -= std::min<uint64_t>(remaining, got);
+
+    //... antes de multiplicar o reservar nada: con un tamaño dañado stored.resize podría
+    //... pedir toda la memoria, y particleCount * elementSize desbordar
+    if (header.rawSize > MAX_FRAME_RAW_BYTES || header.particleCount > MAX_FRAME_RAW_BYTES) {
+        error = "frame demasiado grande";
+        return false;
+    }
+    if (header.storedSize > remaining) {
+        error = "frame truncado";
+        return false;
+    }
+    if (header.compression == static_cast<uint32_t>(FrameCompression::None) &&
+        header.storedSize != header.rawSize) {
+        error = "tamaño de frame inconsistente";
+        return false;
+    }
+
+    size_t elementSizes[FLOAT_FIELD_COUNT + 1];
+    int arrays = payloadLayout(header.fieldMask, header.encoding, elementSizes);
+    uint64_t expected = 0;
+    for (int a = 0; a < arrays; a++) expected += header.particleCount * elementSizes[a];
+    if (expected != header.rawSize) {
+        error = "tamaño de frame inconsistente";
+        return false;
+    }
+
+    stored.resize(header.storedSize);
+    if (header.storedSize > 0 && std::fread(stored.data(), 1, stored.size(), file) != stored.size()) {
+        error = "frame truncado";
+        return false;
+    }
+    remaining -= header.storedSize;
+
+    const unsigned char* raw = stored.data();
+    FrameCompression compression = static_cast<FrameCompression>(header.compression);
+    if (compression != FrameCompression::None) {
+        if (!frameCompressionAvailable(compression)) {
+            error = std::string("compresión ") + frameCompressionName(compression) + " no compilada";
+            return false;
+        }
+        std::vector<unsigned char> planes(header.rawSize);
+        bool ok = false;
+#if defined(SPH_EXPORT_LZ4)
+        if (compression == FrameCompression::LZ4) {
+            int decoded = LZ4_decompress_safe(reinterpret_cast<const char*>(stored.data()),
+                                              reinterpret_cast<char*>(planes.data()),
+                                              static_cast<int>(header.storedSize),
+                                              static_cast<int>(header.rawSize));
+            ok = decoded >= 0 && static_cast<uint64_t>(decoded) == header.rawSize;
+        }
+#endif
+#if defined(SPH_EXPORT_ZSTD)
+        if (compression == FrameCompression::Zstd) {
+            size_t decoded = ZSTD_decompress(planes.data(), planes.size(), stored.data(), stored.size());
+            ok = !ZSTD_isError(decoded) && decoded == header.rawSize;
+        }
+#endif
+        if (!ok) {
+            error = "no se pudo descomprimir el frame";
+            return false;
+        }
+        payload.resize(header.rawSize);
+        uint64_t offset = 0;
+        for (int a = 0; a < arrays; a++) {
+            unshuffleBytes(planes.data() + offset, payload.data() + offset, header.particleCount,
+                           elementSizes[a]);
+            offset += header.particleCount * elementSizes[a];
+        }
+        raw = payload.data();
+    }
+
+    const uint64_t count = header.particleCount;
+    const bool half = header.encoding == static_cast<uint32_t>(FrameEncoding::Float16);
+    if (header.fieldMask & FrameFieldId) {
+        frame.id.resize(count);
+        if (count > 0) std::memcpy(frame.id.data(), raw, count * sizeof(int32_t));
+        raw += count * sizeof(int32_t);
+    } else {
+        frame.id.clear();
+    }
+    std::vector<float>* fields[FLOAT_FIELD_COUNT];
+    floatFields(frame, fields);
+    for (int f = 0; f < FLOAT_FIELD_COUNT; f++) {
+        if (!(header.fieldMask & FLOAT_FIELD_MASKS[f])) {
+            fields[f]->clear();
+            continue;
+        }
+        fields[f]->resize(count);
+        if (half) {
+            for (uint64_t i = 0; i < count; i++) {
+                uint16_t value;
+                std::memcpy(&value, raw + i * sizeof(uint16_t), sizeof(value));
+                (*fields[f])[i] = halfToFloat(value);
+            }
+            raw += count * sizeof(uint16_t);
+        } else {
+            if (count > 0) std::memcpy(fields[f]->data(), raw, count * sizeof(float));
+            raw += count * sizeof(float);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,198 @@
+// frame_exporter.h
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "particle_system.h"
+#include "profiler.h"
+
+//... flujo de frames para análisis o render offline (versión 1, little-endian):
+//...   FrameStreamHeader
+//...   por cada frame exportado: FrameChunkHeader + payload de storedSize bytes
+//... El payload sin comprimir tiene un arreglo por campo, en el orden de FrameField
+//... (id siempre int32; los demás float32 o float16 según 'encoding'). Comprimido,
+//... cada campo se guarda por planos de bytes (todos los bytes 0, después los 1, ...),
+//... que LZ4/zstd comprimen mucho mejor que los floats intercalados.
+const uint32_t FRAME_STREAM_VERSION = 1;
+const uint32_t FRAME_CHUNK_TAG = 0x314d5246u;   //... "FRM1"
+
+enum FrameField : uint32_t {
+    FrameFieldId = 1u << 0,
+    FrameFieldPosition = 1u << 1,       //... x, y
+    FrameFieldVelocity = 1u << 2,       //... vx, vy
+    FrameFieldDensity = 1u << 3,
+    FrameFieldPressure = 1u << 4
+};
+
+enum class FrameEncoding : uint32_t {
+    Float32 = 0,
+    Float16 = 1
+};
+
+//... LZ4 y zstd solo están si se compila con -DSPH_EXPORT_LZ4 (-llz4) o
+//... -DSPH_EXPORT_ZSTD (-lzstd)
+enum class FrameCompression : uint32_t {
+    None = 0,
+    LZ4 = 1,
+    Zstd = 2
+};
+
+bool frameCompressionAvailable(FrameCompression compression);
+const char* frameCompressionName(FrameCompression compression);
+
+struct FrameStreamHeader {
+    char magic[8];                      //... "NSFSPHFS"
+    uint32_t version;
+    uint32_t endianTag;                 //... 0x01020304
+    uint32_t headerSize;
+    uint32_t reserved;
+};
+
+struct FrameChunkHeader {
+    uint32_t tag;                       //... FRAME_CHUNK_TAG
+    uint32_t fieldMask;                 //... FrameField
+    uint32_t encoding;                  //... FrameEncoding
+    uint32_t compression;               //... FrameCompression
+    uint64_t frameIndex;                //... número de frame exportado, desde 0
+    uint64_t stepCount;                 //... ParticleSystem::getStepCount() al capturar
+    double simulatedTime;
+    uint64_t particleCount;
+    uint64_t rawSize;                   //... bytes del payload sin comprimir
+    uint64_t storedSize;                //... bytes que siguen a la cabecera
+};
+
+struct FrameExportSettings {
+    int interval;                       //... exporta una de cada 'interval' capturas
+    uint32_t fields;
+    FrameEncoding encoding;
+    FrameCompression compression;
+    int compressionLevel;               //... 0 = nivel por defecto de cada compresor
+    //... si el escritor va atrasado: false espera a que libere un búfer (no se pierden
+    //... frames), true descarta el frame (la simulación nunca espera)
+    bool dropWhenBusy;
+
+    FrameExportSettings()
+        : interval(1),
+          fields(FrameFieldId | FrameFieldPosition | FrameFieldVelocity | FrameFieldDensity),
+          encoding(FrameEncoding::Float32),
+          compression(FrameCompression::None),
+          compressionLevel(0),
+          dropWhenBusy(false) {}
+};
+
+struct FrameExportStats {
+    unsigned long long framesWritten;
+    unsigned long long framesDropped;
+    unsigned long long rawBytes;        //... payload sin comprimir (float32 o float16)
+    unsigned long long storedBytes;     //... bytes escritos al archivo, con cabeceras
+    double stallSeconds;                //... tiempo que la simulación esperó al escritor
+    bool failed;
+};
+
+//... exportador en segundo plano con doble búfer: capture() copia los campos pedidos a
+//... un búfer libre (un memcpy por campo, en el hilo de simulación) y el hilo escritor
+//... cuantiza, comprime y escribe el otro. La simulación solo espera si el escritor va
+//... más de un frame atrasado, y con dropWhenBusy ni siquiera entonces.
+class FrameExporter {
+private:
+    enum class BufferState {
+        Free,
+        Filling,                        //... lo está llenando capture()
+        Ready,
+        Writing
+    };
+
+    struct Snapshot {
+        BufferState state;
+        uint64_t frameIndex;
+        uint64_t particleCount;
+        uint64_t stepCount;
+        double simulatedTime;
+        std::vector<int> id;
+        std::vector<float> x, y;
+        std::vector<float> vx, vy;
+        std::vector<float> density;
+        std::vector<float> pressure;
+    };
+
+    FrameExportSettings settings;
+    std::FILE* file;
+    Snapshot buffers[2];
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable readyCondition;
+    std::condition_variable freeCondition;
+    bool stopping;
+    unsigned long long captureCalls;
+    uint64_t nextFrameIndex;
+    FrameExportStats stats;
+    std::string lastError;
+    Profiler* profiler;
+
+    //... búferes del escritor (solo los usa el hilo escritor)
+    std::vector<unsigned char> payload;
+    std::vector<unsigned char> shuffled;
+    std::vector<unsigned char> compressed;
+
+    void workerLoop();
+    bool writeFrame(const Snapshot& snapshot);
+    void encodePayload(const Snapshot& snapshot);
+    bool compressPayload(uint64_t count, std::string& error);
+
+public:
+    FrameExporter();
+    ~FrameExporter();
+    FrameExporter(const FrameExporter&) = delete;
+    FrameExporter& operator=(const FrameExporter&) = delete;
+
+    //... crea el archivo y arranca el hilo escritor; false si no se pudo abrir o la
+    //... compresión pedida no está compilada
+    bool open(const std::string& path, const FrameExportSettings& exportSettings, std::string& error);
+    //... escribe lo que quede pendiente y cierra el archivo
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    //... llamar una vez por paso; cada 'interval' llamadas captura un frame.
+    //... Devuelve true si capturó
+    bool capture(const ParticleSystem& particleSystem);
+
+    void setProfiler(Profiler* p) { profiler = p; }
+    const FrameExportSettings& getSettings() const { return settings; }
+    FrameExportStats getStats();
+    std::string getLastError();
+};
+
+//... lector secuencial del flujo, para herramientas de análisis: cada frame vuelve con
+//... los campos en float32 (los id como int), cualquiera sea la codificación
+struct ExportedFrame {
+    FrameChunkHeader header;
+    std::vector<int> id;
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;
+    std::vector<float> density;
+    std::vector<float> pressure;
+};
+
+class FrameReader {
+private:
+    std::FILE* file;
+    //... bytes que quedan por leer; ningún frame puede pedir más que esto
+    uint64_t remaining;
+    std::vector<unsigned char> stored;
+    std::vector<unsigned char> payload;
+
+public:
+    FrameReader();
+    ~FrameReader();
+    FrameReader(const FrameReader&) = delete;
+    FrameReader& operator=(const FrameReader&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+    void close();
+    //... false al final del archivo (error queda vacío) o si el frame está dañado
+    bool next(ExportedFrame& frame, std::string& error);
+};
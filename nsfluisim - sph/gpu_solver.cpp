@@ -0,0 +1,852 @@
+/*
+Backend de GPU del solver SPH con compute shaders de OpenGL 4.3.
+
+Aun con todos los núcleos, la CPU se queda corta para las cantidades de partículas que
+piden las visualizaciones. Aquí el paso completo corre en la GPU y las partículas viven
+allá: el render dibuja el mismo búfer (drawParticles), así las posiciones no cruzan el
+bus en cada frame. OpenGL compute y no CUDA para no atarse a un fabricante; las
+funciones se cargan con el GpuProcLoader que da el llamador (SFML o EGL), sin GLEW.
+
+Un paso son unas pocas dispatches sobre búferes SSBO:
+    keys        celda de cada partícula (como SpatialGrid en Dense: acotada al borde)
+    radix sort  de a 4 bits, estable: histograma por grupo de 256, prefijo global en un
+                solo grupo y reparto, con el rango dentro del grupo sacado de un prefijo
+                en memoria compartida (16 contadores de 16 bits en 8 palabras)
+    cells       inicio y fin de cada celda en el arreglo ordenado
+    gather      copia las partículas (y sus id) en orden de celda, así las vecinas
+                quedan contiguas también en memoria
+    density     densidad y presión con la ecuación de estado, 3x3 celdas
+    forces      presión, viscosidad y gravedad, integración y bordes, escritas de vuelta
+                al búfer principal
+Las fórmulas son las de SPHSolver con los kernels de Müller; el resultado no es igual bit
+a bit al de la CPU (otro orden de suma y FMA en la GPU) pero sí igual a sí mismo entre
+corridas, porque el orden es estable y no hay atómicos en las sumas.
+
+Sin -DSPH_GPU_OPENGL se compila solo el esqueleto: initialize() falla con un mensaje.
+*/
+
+//... gpu_solver.cpp
+#include "gpu_solver.h"
+
+#if defined(SPH_GPU_OPENGL)
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "sph_kernels.h"
+
+#if defined(_WIN32)
+#define SPH_GLAPI __stdcall
+#else
+#define SPH_GLAPI
+#endif
+
+namespace {
+
+typedef unsigned int GLenum;
+typedef unsigned int GLuint;
+typedef unsigned int GLbitfield;
+typedef int GLint;
+typedef int GLsizei;
+typedef float GLfloat;
+typedef char GLchar;
+typedef std::ptrdiff_t GLsizeiptr;
+typedef std::ptrdiff_t GLintptr;
+
+//... solo las constantes que se usan (valores de glcorearb.h)
+const GLenum COMPUTE_SHADER = 0x91B9;
+const GLenum VERTEX_SHADER = 0x8B31;
+const GLenum FRAGMENT_SHADER = 0x8B30;
+const GLenum COMPILE_STATUS = 0x8B81;
+const GLenum LINK_STATUS = 0x8B82;
+const GLenum INFO_LOG_LENGTH = 0x8B84;
+const GLenum SHADER_STORAGE_BUFFER = 0x90D2;
+const GLenum DYNAMIC_COPY = 0x88EA;
+const GLenum MAJOR_VERSION = 0x821B;
+const GLenum MINOR_VERSION = 0x821C;
+const GLenum POINTS = 0x0000;
+const GLenum BLEND = 0x0BE2;
+const GLenum SRC_ALPHA = 0x0302;
+const GLenum ONE_MINUS_SRC_ALPHA = 0x0303;
+const GLenum PROGRAM_POINT_SIZE = 0x8642;
+const GLbitfield SHADER_STORAGE_BARRIER_BIT = 0x2000;
+const GLbitfield BUFFER_UPDATE_BARRIER_BIT = 0x0200;
+
+const unsigned GROUP_SIZE = 256;
+const unsigned RADIX_BITS = 4;
+const unsigned RADIX_BUCKETS = 1u << RADIX_BITS;
+
+//... puntos de enlace de los SSBO, compartidos por todos los shaders
+enum Binding {
+    BIND_PARTICLES = 0,         //... vec4 (x, y, vx, vy) de entrada
+    BIND_KEYS_IN = 1,
+    BIND_VALUES_IN = 2,
+    BIND_HISTOGRAM = 3,
+    BIND_KEYS_OUT = 4,
+    BIND_VALUES_OUT = 5,
+    BIND_CELL_START = 6,
+    BIND_CELL_END = 7,
+    BIND_IDS_IN = 8,
+    BIND_PARTICLES_OUT = 9,
+    BIND_IDS_OUT = 10,
+    BIND_FLUID = 11             //... vec2 (densidad, presión)
+};
+
+//... cabecera común de los compute shaders; las ubicaciones de uniforms son fijas
+//... (layout(location)) y se repiten en setUniforms
+const char* COMPUTE_PRELUDE = R"(#version 430
+layout(local_size_x = 256) in;
+layout(location = 0) uniform uint count;
+)";
+
+const char* GRID_PRELUDE = R"(
+layout(location = 1) uniform float cellSize;
+layout(location = 2) uniform ivec2 gridSize;
+layout(std430, binding = 6) buffer CellStart { uint cellStart[]; };
+layout(std430, binding = 7) buffer CellEnd { uint cellEnd[]; };
+ivec2 cellOf(vec2 p) {
+    return ivec2(clamp(floor(p / cellSize), vec2(0.0), vec2(gridSize - 1)));
+}
+)";
+
+//... parámetros físicos de densidad y fuerzas
+const char* PHYSICS_PRELUDE = R"(
+layout(location = 3) uniform float h;
+layout(location = 4) uniform float mass;
+layout(location = 5) uniform float stiffness;
+layout(location = 6) uniform float restDensity;
+layout(location = 7) uniform float poly6Coeff;
+layout(location = 8) uniform float spikyCoeff;
+layout(location = 9) uniform float viscosityCoeff;
+layout(location = 10) uniform float viscosity;
+layout(location = 11) uniform float dt;
+layout(location = 12) uniform vec2 domain;
+layout(std430, binding = 0) readonly buffer Particles { vec4 particles[]; };
+)";
+
+const char* KEYS_SOURCE = R"(
+layout(std430, binding = 0) readonly buffer Particles { vec4 particles[]; };
+layout(std430, binding = 1) writeonly buffer Keys { uint keys[]; };
+layout(std430, binding = 2) writeonly buffer Values { uint values[]; };
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= count) return;
+    ivec2 c = cellOf(particles[i].xy);
+    keys[i] = uint(c.y * gridSize.x + c.x);
+    values[i] = i;
+}
+)";
+
+const char* HISTOGRAM_SOURCE = R"(
+layout(location = 1) uniform uint shift;
+layout(location = 2) uniform uint groups;
+layout(std430, binding = 1) readonly buffer Keys { uint keys[]; };
+layout(std430, binding = 3) writeonly buffer Histogram { uint histogram[]; };
+shared uint localCount[16];
+void main() {
+    uint t = gl_LocalInvocationID.x;
+    if (t < 16u) localCount[t] = 0u;
+    barrier();
+    uint i = gl_GlobalInvocationID.x;
+    if (i < count) atomicAdd(localCount[(keys[i] >> shift) & 15u], 1u);
+    barrier();
+    //... dígito mayor: el prefijo de todo el arreglo da la posición de cada (dígito, grupo)
+    if (t < 16u) histogram[t * groups + gl_WorkGroupID.x] = localCount[t];
+}
+)";
+
+//... prefijo exclusivo de 'count' contadores en un solo grupo de 1024: cada hilo suma
+//... un tramo, se hace el prefijo de las sumas y cada hilo reparte el suyo
+const char* SCAN_SOURCE = R"(#version 430
+layout(local_size_x = 1024) in;
+layout(location = 0) uniform uint count;
+layout(std430, binding = 3) buffer Histogram { uint histogram[]; };
+shared uint sums[1024];
+void main() {
+    uint t = gl_LocalInvocationID.x;
+    uint chunk = (count + 1023u) / 1024u;
+    uint begin = min(t * chunk, count);
+    uint end = min(begin + chunk, count);
+    uint total = 0u;
+    for (uint k = begin; k < end; k++) total += histogram[k];
+    sums[t] = total;
+    barrier();
+    for (uint offset = 1u; offset < 1024u; offset <<= 1) {
+        uint value = sums[t];
+        if (t >= offset) value += sums[t - offset];
+        barrier();
+        sums[t] = value;
+        barrier();
+    }
+    uint running = t > 0u ? sums[t - 1u] : 0u;
+    for (uint k = begin; k < end; k++) {
+        uint value = histogram[k];
+        histogram[k] = running;
+        running += value;
+    }
+}
+)";
+
+const char* SCATTER_SOURCE = R"(
+layout(location = 1) uniform uint shift;
+layout(location = 2) uniform uint groups;
+layout(std430, binding = 1) readonly buffer KeysIn { uint keysIn[]; };
+layout(std430, binding = 2) readonly buffer ValuesIn { uint valuesIn[]; };
+layout(std430, binding = 3) readonly buffer Histogram { uint histogram[]; };
+layout(std430, binding = 4) writeonly buffer KeysOut { uint keysOut[]; };
+layout(std430, binding = 5) writeonly buffer ValuesOut { uint valuesOut[]; };
+//... 16 contadores de 16 bits por hilo: dígitos 0-7 en low, 8-15 en high
+shared uvec4 low[256];
+shared uvec4 high[256];
+void main() {
+    uint t = gl_LocalInvocationID.x;
+    uint i = gl_GlobalInvocationID.x;
+    bool live = i < count;
+    uint key = live ? keysIn[i] : 0u;
+    uint digit = (key >> shift) & 15u;
+    uint word = digit >> 1;
+    uint bit = 1u << ((digit & 1u) * 16u);
+    uvec4 a = uvec4(0u), b = uvec4(0u);
+    if (live) {
+        if (word < 4u) a[word] = bit; else b[word - 4u] = bit;
+    }
+    low[t] = a;
+    high[t] = b;
+    barrier();
+    for (uint offset = 1u; offset < 256u; offset <<= 1) {
+        uvec4 x = low[t], y = high[t];
+        if (t >= offset) {
+            x += low[t - offset];
+            y += high[t - offset];
+        }
+        barrier();
+        low[t] = x;
+        high[t] = y;
+        barrier();
+    }
+    if (!live) return;
+    uint counters = word < 4u ? low[t][word] : high[t][word - 4u];
+    //... prefijo inclusivo: las anteriores del mismo dígito son una menos
+    uint rank = ((counters >> ((digit & 1u) * 16u)) & 0xFFFFu) - 1u;
+    uint position = histogram[digit * groups + gl_WorkGroupID.x] + rank;
+    keysOut[position] = key;
+    valuesOut[position] = valuesIn[i];
+}
+)";
+
+const char* CLEAR_CELLS_SOURCE = R"(
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= count) return;
+    cellStart[i] = 0u;
+    cellEnd[i] = 0u;
+}
+)";
+
+const char* CELLS_SOURCE = R"(
+layout(std430, binding = 1) readonly buffer Keys { uint keys[]; };
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= count) return;
+    uint key = keys[i];
+    if (i == 0u || keys[i - 1u] != key) cellStart[key] = i;
+    if (i + 1u == count || keys[i + 1u] != key) cellEnd[key] = i + 1u;
+}
+)";
+
+const char* GATHER_SOURCE = R"(
+layout(std430, binding = 0) readonly buffer Particles { vec4 particles[]; };
+layout(std430, binding = 2) readonly buffer Values { uint values[]; };
+layout(std430, binding = 8) readonly buffer IdsIn { uint idsIn[]; };
+layout(std430, binding = 9) writeonly buffer ParticlesOut { vec4 particlesOut[]; };
+layout(std430, binding = 10) writeonly buffer IdsOut { uint idsOut[]; };
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= count) return;
+    uint j = values[i];
+    particlesOut[i] = particles[j];
+    idsOut[i] = idsIn[j];
+}
+)";
+
+const char* DENSITY_SOURCE = R"(
+layout(std430, binding = 11) writeonly buffer Fluid { vec2 fluid[]; };
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= count) return;
+    vec2 position = particles[i].xy;
+    ivec2 c = cellOf(position);
+    ivec2 first = max(c - 1, ivec2(0));
+    ivec2 last = min(c + 1, gridSize - 1);
+    float h2 = h * h;
+    float density = 0.0;
+    for (int y = first.y; y <= last.y; y++) {
+        for (int x = first.x; x <= last.x; x++) {
+            uint cell = uint(y * gridSize.x + x);
+            for (uint j = cellStart[cell]; j < cellEnd[cell]; j++) {
+                vec2 d = position - particles[j].xy;
+                float r2 = dot(d, d);
+                if (r2 < h2) {
+                    float term = h2 - r2;
+                    density += mass * (poly6Coeff * term * term * term);
+                }
+            }
+        }
+    }
+    fluid[i] = vec2(density, stiffness * (density - restDensity));
+}
+)";
+
+const char* FORCES_SOURCE = R"(
+layout(std430, binding = 11) readonly buffer Fluid { vec2 fluid[]; };
+layout(std430, binding = 9) writeonly buffer ParticlesOut { vec4 particlesOut[]; };
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= count) return;
+    vec4 self = particles[i];
+    vec2 fluidSelf = fluid[i];
+    ivec2 c = cellOf(self.xy);
+    ivec2 first = max(c - 1, ivec2(0));
+    ivec2 last = min(c + 1, gridSize - 1);
+    float h2 = h * h;
+    vec2 pressureForce = vec2(0.0);
+    vec2 viscosityForce = vec2(0.0);
+    for (int y = first.y; y <= last.y; y++) {
+        for (int x = first.x; x <= last.x; x++) {
+            uint cell = uint(y * gridSize.x + x);
+            for (uint j = cellStart[cell]; j < cellEnd[cell]; j++) {
+                if (j == i) continue;
+                vec4 other = particles[j];
+                vec2 diff = self.xy - other.xy;
+                float r2 = dot(diff, diff);
+                if (r2 >= h2) continue;
+                float r = sqrt(r2);
+                vec2 fluidOther = fluid[j];
+                float term = h - r;
+                if (r > 0.0) {
+                    pressureForce += diff / r * mass * (fluidSelf.y + fluidOther.y) /
+                                     (2.0 * fluidOther.x) * (spikyCoeff * term * term);
+                }
+                viscosityForce += mass * (other.zw - self.zw) / fluidOther.x * (viscosityCoeff * term);
+            }
+        }
+    }
+    vec2 force = -pressureForce + viscosityForce * viscosity + vec2(0.0, 981.0);
+    vec2 velocity = self.zw + force * dt;
+    vec2 position = self.xy + velocity * dt;
+    //... bordes como ParticleSystem::resolveCollisions
+    if (position.x < 0.0) { position.x = 0.0; velocity.x *= -0.5; }
+    if (position.x > domain.x) { position.x = domain.x; velocity.x *= -0.5; }
+    if (position.y < 0.0) { position.y = 0.0; velocity.y *= -0.5; }
+    if (position.y > domain.y) { position.y = domain.y; velocity.y *= -0.5; }
+    particlesOut[i] = vec4(position, velocity);
+}
+)";
+
+const char* DRAW_VERTEX_SOURCE = R"(#version 430
+layout(std430, binding = 0) readonly buffer Particles { vec4 particles[]; };
+layout(location = 0) uniform vec2 viewSize;
+layout(location = 1) uniform float pointSize;
+out float speed;
+void main() {
+    vec4 p = particles[gl_VertexID];
+    gl_Position = vec4(p.x / viewSize.x * 2.0 - 1.0, 1.0 - p.y / viewSize.y * 2.0, 0.0, 1.0);
+    gl_PointSize = pointSize;
+    speed = length(p.zw);
+}
+)";
+
+//... disco con borde suavizado de un píxel y el azul de speedColor (particle_renderer.cpp)
+const char* DRAW_FRAGMENT_SOURCE = R"(#version 430
+layout(location = 1) uniform float pointSize;
+in float speed;
+out vec4 color;
+void main() {
+    float r = length(gl_PointCoord * 2.0 - 1.0);
+    float coverage = clamp((1.0 - r) * pointSize * 0.5, 0.0, 1.0);
+    if (coverage <= 0.0) discard;
+    float blue = clamp(255.0 - speed * 5.0, 0.0, 255.0) / 255.0;
+    color = vec4(0.0, 120.0 / 255.0, blue, coverage);
+}
+)";
+
+} // namespace
+
+struct GpuSPHSolver::GlState {
+    GLuint (SPH_GLAPI *CreateShader)(GLenum type);
+    void (SPH_GLAPI *ShaderSource)(GLuint shader, GLsizei count, const GLchar* const* sources, const GLint* lengths);
+    void (SPH_GLAPI *CompileShader)(GLuint shader);
+    void (SPH_GLAPI *GetShaderiv)(GLuint shader, GLenum name, GLint* value);
+    void (SPH_GLAPI *GetShaderInfoLog)(GLuint shader, GLsizei size, GLsizei* length, GLchar* log);
+    void (SPH_GLAPI *DeleteShader)(GLuint shader);
+    GLuint (SPH_GLAPI *CreateProgram)();
+    void (SPH_GLAPI *AttachShader)(GLuint program, GLuint shader);
+    void (SPH_GLAPI *LinkProgram)(GLuint program);
+    void (SPH_GLAPI *GetProgramiv)(GLuint program, GLenum name, GLint* value);
+    void (SPH_GLAPI *GetProgramInfoLog)(GLuint program, GLsizei size, GLsizei* length, GLchar* log);
+    void (SPH_GLAPI *DeleteProgram)(GLuint program);
+    void (SPH_GLAPI *UseProgram)(GLuint program);
+    void (SPH_GLAPI *Uniform1ui)(GLint location, GLuint value);
+    void (SPH_GLAPI *Uniform1f)(GLint location, GLfloat value);
+    void (SPH_GLAPI *Uniform2f)(GLint location, GLfloat x, GLfloat y);
+    void (SPH_GLAPI *Uniform2i)(GLint location, GLint x, GLint y);
+    void (SPH_GLAPI *GenBuffers)(GLsizei count, GLuint* buffers);
+    void (SPH_GLAPI *DeleteBuffers)(GLsizei count, const GLuint* buffers);
+    void (SPH_GLAPI *BindBuffer)(GLenum target, GLuint buffer);
+    void (SPH_GLAPI *BufferData)(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+    void (SPH_GLAPI *GetBufferSubData)(GLenum target, GLintptr offset, GLsizeiptr size, void* data);
+    void (SPH_GLAPI *BindBufferBase)(GLenum target, GLuint index, GLuint buffer);
+    void (SPH_GLAPI *DispatchCompute)(GLuint x, GLuint y, GLuint z);
+    void (SPH_GLAPI *MemoryBarrier)(GLbitfield barriers);
+    void (SPH_GLAPI *GenVertexArrays)(GLsizei count, GLuint* arrays);
+    void (SPH_GLAPI *DeleteVertexArrays)(GLsizei count, const GLuint* arrays);
+    void (SPH_GLAPI *BindVertexArray)(GLuint array);
+    void (SPH_GLAPI *DrawArrays)(GLenum mode, GLint first, GLsizei count);
+    void (SPH_GLAPI *Enable)(GLenum capability);
+    void (SPH_GLAPI *Disable)(GLenum capability);
+    void (SPH_GLAPI *BlendFunc)(GLenum source, GLenum destination);
+    void (SPH_GLAPI *GetIntegerv)(GLenum name, GLint* value);
+
+    GLuint keysProgram, histogramProgram, scanProgram, scatterProgram;
+    GLuint clearCellsProgram, cellsProgram, gatherProgram, densityProgram, forcesProgram;
+    GLuint drawProgram;
+    GLuint vertexArray;
+
+    //... particles[0] es el estado actual y particles[1] la copia ordenada del paso; los
+    //... id se alternan entre los dos en cada paso (currentIds)
+    GLuint particles[2];
+    GLuint ids[2];
+    GLuint keys[2];
+    GLuint values[2];
+    GLuint histogram;
+    GLuint cellStart, cellEnd;
+    GLuint fluid;
+    int currentIds;
+
+    //... dominio, grid y parámetros del último upload()
+    float domainWidth, domainHeight;
+    float cellSize;
+    int gridWidth, gridHeight;
+    int radixPasses;
+    float h, mass, viscosity, stiffness, restDensity;
+    float poly6Coeff, spikyCoeff, viscosityCoeff;
+    //... para devolver un ParticleData válido en download()
+    size_t slotCount;
+    std::vector<int> freeIds;
+
+    void bind(GLuint binding, GLuint buffer) { BindBufferBase(SHADER_STORAGE_BUFFER, binding, buffer); }
+    void resize(GLuint buffer, size_t bytes, const void* data = nullptr) {
+        BindBuffer(SHADER_STORAGE_BUFFER, buffer);
+        BufferData(SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(bytes), data, DYNAMIC_COPY);
+    }
+    void read(GLuint buffer, size_t bytes, void* data) {
+        BindBuffer(SHADER_STORAGE_BUFFER, buffer);
+        GetBufferSubData(SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(bytes), data);
+    }
+    //... una dispatch de grupos de 256 sobre 'items' y la barrera para la siguiente
+    void run(GLuint program, size_t items) {
+        UseProgram(program);
+        Uniform1ui(0, static_cast<GLuint>(items));
+        DispatchCompute(static_cast<GLuint>((items + GROUP_SIZE - 1) / GROUP_SIZE), 1, 1);
+        MemoryBarrier(SHADER_STORAGE_BARRIER_BIT);
+    }
+    void setGrid(GLuint program) {
+        UseProgram(program);
+        Uniform1f(1, cellSize);
+        Uniform2i(2, gridWidth, gridHeight);
+    }
+    void setPhysics(GLuint program) {
+        setGrid(program);
+        Uniform1f(3, h);
+        Uniform1f(4, mass);
+        Uniform1f(5, stiffness);
+        Uniform1f(6, restDensity);
+        Uniform1f(7, poly6Coeff);
+    }
+
+    GLuint compile(GLenum type, const std::vector<const char*>& sources, std::string& error);
+    GLuint link(const std::vector<GLuint>& shaders, std::string& error);
+    GLuint computeProgram(std::vector<const char*> sources, std::string& error);
+};
+
+GLuint GpuSPHSolver::GlState::compile(GLenum type, const std::vector<const char*>& sources,
+                                      std::string& error) {
+    GLuint shader = CreateShader(type);
+    ShaderSource(shader, static_cast<GLsizei>(sources.size()), sources.data(), nullptr);
+    CompileShader(shader);
+    GLint status = 0;
+    GetShaderiv(shader, COMPILE_STATUS, &status);
+    if (!status) {
+        GLint length = 0;
+        GetShaderiv(shader, INFO_LOG_LENGTH, &length);
+        std::string log(static_cast<size_t>(std::max(length, 1)), '\0');
+        GetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), nullptr, &log[0]);
+        error = "no compiló un shader: " + std::string(log.c_str());
+        DeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint GpuSPHSolver::GlState::link(const std::vector<GLuint>& shaders, std::string& error) {
+    GLuint program = CreateProgram();
+    for (GLuint shader : shaders) AttachShader(program, shader);
+    LinkProgram(program);
+    for (GLuint shader : shaders) DeleteShader(shader);
+    GLint status = 0;
+    GetProgramiv(program, LINK_STATUS, &status);
+    if (!status) {
+        GLint length = 0;
+        GetProgramiv(program, INFO_LOG_LENGTH, &length);
+        std::string log(static_cast<size_t>(std::max(length, 1)), '\0');
+        GetProgramInfoLog(program, static_cast<GLsizei>(log.size()), nullptr, &log[0]);
+        error = "no enlazó un programa: " + std::string(log.c_str());
+        DeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+GLuint GpuSPHSolver::GlState::computeProgram(std::vector<const char*> sources, std::string& error) {
+    GLuint shader = compile(COMPUTE_SHADER, sources, error);
+    return shader ? link({shader}, error) : 0;
+}
+
+//... convierte el puntero genérico del cargador al tipo del miembro
+template <typename Fn>
+static bool loadFunction(GpuProcLoader loader, const char* name, Fn& function, std::string& error) {
+    function = reinterpret_cast<Fn>(loader(name));
+    if (!function && error.empty()) {
+        error = std::string("falta la función ") + name;
+    }
+    return function != nullptr;
+}
+
+GpuSPHSolver::GpuSPHSolver()
+    : gl(new GlState()), initialized(false), count(0), stepCount(0), simulatedTime(0.0) {}
+
+GpuSPHSolver::~GpuSPHSolver() {
+    if (!initialized) return;
+    GLuint programs[] = {gl->keysProgram, gl->histogramProgram, gl->scanProgram, gl->scatterProgram,
+                         gl->clearCellsProgram, gl->cellsProgram, gl->gatherProgram,
+                         gl->densityProgram, gl->forcesProgram, gl->drawProgram};
+    for (GLuint program : programs) gl->DeleteProgram(program);
+    GLuint buffers[] = {gl->particles[0], gl->particles[1], gl->ids[0], gl->ids[1],
+                        gl->keys[0], gl->keys[1], gl->values[0], gl->values[1],
+                        gl->histogram, gl->cellStart, gl->cellEnd, gl->fluid};
+    gl->DeleteBuffers(static_cast<GLsizei>(sizeof(buffers) / sizeof(buffers[0])), buffers);
+    gl->DeleteVertexArrays(1, &gl->vertexArray);
+}
+
+bool GpuSPHSolver::initialize(GpuProcLoader loader, std::string& error) {
+    if (initialized) return true;
+#if !defined(SPH_KERNELS_MULLER)
+    (void)loader;
+    error = "el backend de GPU solo implementa los kernels de Müller";
+    return false;
+#else
+    error.clear();
+    GlState& g = *gl;
+    bool ok = true;
+    ok &= loadFunction(loader, "glCreateShader", g.CreateShader, error);
+    ok &= loadFunction(loader, "glShaderSource", g.ShaderSource, error);
+    ok &= loadFunction(loader, "glCompileShader", g.CompileShader, error);
+    ok &= loadFunction(loader, "glGetShaderiv", g.GetShaderiv, error);
+    ok &= loadFunction(loader, "glGetShaderInfoLog", g.GetShaderInfoLog, error);
+    ok &= loadFunction(loader, "glDeleteShader", g.DeleteShader, error);
+    ok &= loadFunction(loader, "glCreateProgram", g.CreateProgram, error);
+    ok &= loadFunction(loader, "glAttachShader", g.AttachShader, error);
+    ok &= loadFunction(loader, "glLinkProgram", g.LinkProgram, error);
+    ok &= loadFunction(loader, "glGetProgramiv", g.GetProgramiv, error);
+    ok &= loadFunction(loader, "glGetProgramInfoLog", g.GetProgramInfoLog, error);
+    ok &= loadFunction(loader, "glDeleteProgram", g.DeleteProgram, error);
+    ok &= loadFunction(loader, "glUseProgram", g.UseProgram, error);
+    ok &= loadFunction(loader, "glUniform1ui", g.Uniform1ui, error);
+    ok &= loadFunction(loader, "glUniform1f", g.Uniform1f, error);
+    ok &= loadFunction(loader, "glUniform2f", g.Uniform2f, error);
+    ok &= loadFunction(loader, "glUniform2i", g.Uniform2i, error);
+    ok &= loadFunction(loader, "glGenBuffers", g.GenBuffers, error);
+    ok &= loadFunction(loader, "glDeleteBuffers", g.DeleteBuffers, error);
+    ok &= loadFunction(loader, "glBindBuffer", g.BindBuffer, error);
+    ok &= loadFunction(loader, "glBufferData", g.BufferData, error);
+    ok &= loadFunction(loader, "glGetBufferSubData", g.GetBufferSubData, error);
+    ok &= loadFunction(loader, "glBindBufferBase", g.BindBufferBase, error);
+    ok &= loadFunction(loader, "glDispatchCompute", g.DispatchCompute, error);
+    ok &= loadFunction(loader, "glMemoryBarrier", g.MemoryBarrier, error);
+    ok &= loadFunction(loader, "glGenVertexArrays", g.GenVertexArrays, error);
+    ok &= loadFunction(loader, "glDeleteVertexArrays", g.DeleteVertexArrays, error);
+    ok &= loadFunction(loader, "glBindVertexArray", g.BindVertexArray, error);
+    ok &= loadFunction(loader, "glDrawArrays", g.DrawArrays, error);
+    ok &= loadFunction(loader, "glEnable", g.Enable, error);
+    ok &= loadFunction(loader, "glDisable", g.Disable, error);
+    ok &= loadFunction(loader, "glBlendFunc", g.BlendFunc, error);
+    ok &= loadFunction(loader, "glGetIntegerv", g.GetIntegerv, error);
+    if (!ok) return false;
+
+    GLint major = 0, minor = 0;
+    g.GetIntegerv(MAJOR_VERSION, &major);
+    g.GetIntegerv(MINOR_VERSION, &minor);
+    if (major < 4 || (major == 4 && minor < 3)) {
+        error = "hace falta OpenGL 4.3 (el contexto es " + std::to_string(major) + "." +
+                std::to_string(minor) + ")";
+        return false;
+    }
+
+    g.keysProgram = g.computeProgram({COMPUTE_PRELUDE, GRID_PRELUDE, KEYS_SOURCE}, error);
+    g.histogramProgram = g.computeProgram({COMPUTE_PRELUDE, HISTOGRAM_SOURCE}, error);
+    g.scanProgram = g.computeProgram({SCAN_SOURCE}, error);
+    g.scatterProgram = g.computeProgram({COMPUTE_PRELUDE, SCATTER_SOURCE}, error);
+    g.clearCellsProgram = g.computeProgram({COMPUTE_PRELUDE, GRID_PRELUDE, CLEAR_CELLS_SOURCE}, error);
+    g.cellsProgram = g.computeProgram({COMPUTE_PRELUDE, GRID_PRELUDE, CELLS_SOURCE}, error);
+    g.gatherProgram = g.computeProgram({COMPUTE_PRELUDE, GATHER_SOURCE}, error);
+    g.densityProgram = g.computeProgram({COMPUTE_PRELUDE, GRID_PRELUDE, PHYSICS_PRELUDE,
+                                         DENSITY_SOURCE}, error);
+    g.forcesProgram = g.computeProgram({COMPUTE_PRELUDE, GRID_PRELUDE, PHYSICS_PRELUDE,
+                                        FORCES_SOURCE}, error);
+    GLuint vertex = g.compile(VERTEX_SHADER, {DRAW_VERTEX_SOURCE}, error);
+    GLuint fragment = vertex ? g.compile(FRAGMENT_SHADER, {DRAW_FRAGMENT_SOURCE}, error) : 0;
+    g.drawProgram = fragment ? g.link({vertex, fragment}, error) : 0;
+    if (vertex && !fragment) g.DeleteShader(vertex);
+    GLuint programs[] = {g.keysProgram, g.histogramProgram, g.scanProgram, g.scatterProgram,
+                         g.clearCellsProgram, g.cellsProgram, g.gatherProgram,
+                         g.densityProgram, g.forcesProgram, g.drawProgram};
+    bool compiled = true;
+    for (GLuint program : programs) compiled = compiled && program != 0;
+    if (!compiled) {
+        for (GLuint program : programs) {
+            if (program) g.DeleteProgram(program);
+        }
+        return false;
+    }
+
+    GLuint buffers[12];
+    g.GenBuffers(12, buffers);
+    g.particles[0] = buffers[0];
+    g.particles[1] = buffers[1];
+    g.ids[0] = buffers[2];
+    g.ids[1] = buffers[3];
+    g.keys[0] = buffers[4];
+    g.keys[1] = buffers[5];
+    g.values[0] = buffers[6];
+    g.values[1] = buffers[7];
+    g.histogram = buffers[8];
+    g.cellStart = buffers[9];
+    g.cellEnd = buffers[10];
+    g.fluid = buffers[11];
+    g.currentIds = 0;
+    //... el dibujo no usa atributos, pero un contexto core exige un VAO enlazado
+    g.GenVertexArrays(1, &g.vertexArray);
+    initialized = true;
+    return true;
+#endif
+}
+
+void GpuSPHSolver::upload(const ParticleSystem& particleSystem, const SPHSolver& solver) {
+    if (!initialized) return;
+    GlState& g = *gl;
+    const ParticleData& data = particleSystem.getData();
+    count = data.size();
+    stepCount = particleSystem.getStepCount();
+    simulatedTime = particleSystem.getSimulatedTime();
+
+    g.domainWidth = static_cast<float>(particleSystem.getDomainWidth());
+    g.domainHeight = static_cast<float>(particleSystem.getDomainHeight());
+    g.h = particleSystem.getSmoothingLength();
+    g.mass = particleSystem.getParticleMass();
+    g.viscosity = solver.getViscosity();
+    g.stiffness = solver.getStiffness();
+    g.restDensity = solver.getRestDensity();
+    SPHKernels kernels(g.h);
+    g.poly6Coeff = kernels.poly6Coeff;
+    g.spikyCoeff = kernels.spikyCoeff;
+    g.viscosityCoeff = kernels.viscosityCoeff;
+    //... igual que el grid de la CPU, pero sin fuerza bruta: nunca menos que h
+    g.cellSize = std::max(solver.getGridCellSize(), g.h);
+    g.gridWidth = std::max(1, static_cast<int>(std::ceil(g.domainWidth / g.cellSize)));
+    g.gridHeight = std::max(1, static_cast<int>(std::ceil(g.domainHeight / g.cellSize)));
+    const size_t cells = static_cast<size_t>(g.gridWidth) * g.gridHeight;
+    //... pasadas de 4 bits que cubren la clave de celda más alta
+    int bits = 0;
+    while (bits < 32 && (static_cast<size_t>(1) << bits) < cells) bits++;
+    g.radixPasses = std::max(1, (bits + static_cast<int>(RADIX_BITS) - 1) / static_cast<int>(RADIX_BITS));
+    g.slotCount = data.slot.size();
+    g.freeIds = data.freeIds;
+
+    std::vector<float> packed(count * 4);
+    for (size_t i = 0; i < count; i++) {
+        packed[i * 4 + 0] = data.x[i];
+        packed[i * 4 + 1] = data.y[i];
+        packed[i * 4 + 2] = data.vx[i];
+        packed[i * 4 + 3] = data.vy[i];
+    }
+    const size_t groups = (count + GROUP_SIZE - 1) / GROUP_SIZE;
+    g.resize(g.particles[0], count * 4 * sizeof(float), packed.data());
+    g.resize(g.particles[1], count * 4 * sizeof(float));
+    g.resize(g.ids[0], count * sizeof(int), data.id.data());
+    g.resize(g.ids[1], count * sizeof(int));
+    for (int k = 0; k < 2; k++) {
+        g.resize(g.keys[k], count * sizeof(GLuint));
+        g.resize(g.values[k], count * sizeof(GLuint));
+    }
+    g.resize(g.histogram, groups * RADIX_BUCKETS * sizeof(GLuint));
+    g.resize(g.cellStart, cells * sizeof(GLuint));
+    g.resize(g.cellEnd, cells * sizeof(GLuint));
+    g.resize(g.fluid, count * 2 * sizeof(float));
+    g.currentIds = 0;
+}
+
+void GpuSPHSolver::step(float dt) {
+    stepCount++;
+    simulatedTime += dt;
+    if (!initialized || count == 0) return;
+    GlState& g = *gl;
+    const size_t cells = static_cast<size_t>(g.gridWidth) * g.gridHeight;
+    const GLuint groups = static_cast<GLuint>((count + GROUP_SIZE - 1) / GROUP_SIZE);
+
+    //... celda de cada partícula
+    g.bind(BIND_PARTICLES, g.particles[0]);
+    g.bind(BIND_KEYS_IN, g.keys[0]);
+    g.bind(BIND_VALUES_IN, g.values[0]);
+    g.setGrid(g.keysProgram);
+    g.run(g.keysProgram, count);
+
+    //... radix sort estable de (celda, índice), alternando entre los dos pares de búferes
+    int in = 0;
+    g.bind(BIND_HISTOGRAM, g.histogram);
+    for (int pass = 0; pass < g.radixPasses; pass++) {
+        const GLuint shift = static_cast<GLuint>(pass) * RADIX_BITS;
+        g.bind(BIND_KEYS_IN, g.keys[in]);
+        g.bind(BIND_VALUES_IN, g.values[in]);
+        g.bind(BIND_KEYS_OUT, g.keys[1 - in]);
+        g.bind(BIND_VALUES_OUT, g.values[1 - in]);
+        g.UseProgram(g.histogramProgram);
+        g.Uniform1ui(1, shift);
+        g.Uniform1ui(2, groups);
+        g.run(g.histogramProgram, count);
+        g.UseProgram(g.scanProgram);
+        g.Uniform1ui(0, groups * RADIX_BUCKETS);
+        g.DispatchCompute(1, 1, 1);
+        g.MemoryBarrier(SHADER_STORAGE_BARRIER_BIT);
+        g.UseProgram(g.scatterProgram);
+        g.Uniform1ui(1, shift);
+        g.Uniform1ui(2, groups);
+        g.run(g.scatterProgram, count);
+        in = 1 - in;
+    }
+
+    //... rango de cada celda en el arreglo ordenado
+    g.bind(BIND_KEYS_IN, g.keys[in]);
+    g.bind(BIND_VALUES_IN, g.values[in]);
+    g.bind(BIND_CELL_START, g.cellStart);
+    g.bind(BIND_CELL_END, g.cellEnd);
+    g.setGrid(g.clearCellsProgram);
+    g.run(g.clearCellsProgram, cells);
+    g.setGrid(g.cellsProgram);
+    g.run(g.cellsProgram, count);
+
+    //... copia ordenada: particles[1] y el otro búfer de id
+    g.bind(BIND_IDS_IN, g.ids[g.currentIds]);
+    g.bind(BIND_PARTICLES_OUT, g.particles[1]);
+    g.bind(BIND_IDS_OUT, g.ids[1 - g.currentIds]);
+    g.run(g.gatherProgram, count);
+    g.currentIds = 1 - g.currentIds;
+
+    //... densidad y fuerzas sobre la copia ordenada; el resultado vuelve a particles[0]
+    g.bind(BIND_PARTICLES, g.particles[1]);
+    g.bind(BIND_FLUID, g.fluid);
+    g.setPhysics(g.densityProgram);
+    g.run(g.densityProgram, count);
+    g.bind(BIND_PARTICLES_OUT, g.particles[0]);
+    g.setPhysics(g.forcesProgram);
+    g.Uniform1f(8, g.spikyCoeff);
+    g.Uniform1f(9, g.viscosityCoeff);
+    g.Uniform1f(10, g.viscosity);
+    g.Uniform1f(11, dt);
+    g.Uniform2f(12, g.domainWidth, g.domainHeight);
+    g.run(g.forcesProgram, count);
+    g.UseProgram(0);
+}
+
+void GpuSPHSolver::download(ParticleSystem& particleSystem) const {
+    if (!initialized) return;
+    GlState& g = *gl;
+    g.MemoryBarrier(BUFFER_UPDATE_BARRIER_BIT);
+    std::vector<float> packed(count * 4);
+    std::vector<float> fluid(count * 2);
+    ParticleData data;
+    data.id.resize(count);
+    if (count > 0) {
+        g.read(g.particles[0], packed.size() * sizeof(float), packed.data());
+        g.read(g.fluid, fluid.size() * sizeof(float), fluid.data());
+        g.read(g.ids[g.currentIds], count * sizeof(int), data.id.data());
+    }
+    data.x.resize(count);
+    data.y.resize(count);
+    data.vx.resize(count);
+    data.vy.resize(count);
+    data.fx.assign(count, 0.0f);
+    data.fy.assign(count, 0.0f);
+    data.density.resize(count);
+    data.pressure.resize(count);
+    data.level.assign(count, 0);
+    data.slot.assign(g.slotCount, -1);
+    data.freeIds = g.freeIds;
+    for (size_t i = 0; i < count; i++) {
+        data.x[i] = packed[i * 4 + 0];
+        data.y[i] = packed[i * 4 + 1];
+        data.vx[i] = packed[i * 4 + 2];
+        data.vy[i] = packed[i * 4 + 3];
+        data.density[i] = fluid[i * 2 + 0];
+        data.pressure[i] = fluid[i * 2 + 1];
+        data.slot[data.id[i]] = static_cast<int>(i);
+    }
+    //... restore() vacía los obstáculos antes de volver a agregar la lista: va una copia
+    std::vector<Obstacle> obstacles = particleSystem.getObstacles().getObstacles();
+    particleSystem.restore(std::move(data), obstacles, stepCount, simulatedTime);
+}
+
+void GpuSPHSolver::drawParticles(float viewWidth, float viewHeight, float radius) const {
+    if (!initialized || count == 0) return;
+    GlState& g = *gl;
+    g.BindVertexArray(g.vertexArray);
+    g.bind(BIND_PARTICLES, g.particles[0]);
+    g.Enable(PROGRAM_POINT_SIZE);
+    g.Enable(BLEND);
+    g.BlendFunc(SRC_ALPHA, ONE_MINUS_SRC_ALPHA);
+    g.UseProgram(g.drawProgram);
+    g.Uniform2f(0, viewWidth, viewHeight);
+    g.Uniform1f(1, std::max(1.0f, radius * 2.0f));
+    g.DrawArrays(POINTS, 0, static_cast<GLsizei>(count));
+    g.UseProgram(0);
+    g.Disable(PROGRAM_POINT_SIZE);
+    g.BindVertexArray(0);
+}
+
+#else
+
+//... sin -DSPH_GPU_OPENGL: la interfaz existe, pero no hay backend
+struct GpuSPHSolver::GlState {};
+
+GpuSPHSolver::GpuSPHSolver()
+    : gl(nullptr), initialized(false), count(0), stepCount(0), simulatedTime(0.0) {}
+
+GpuSPHSolver::~GpuSPHSolver() {}
+
+bool GpuSPHSolver::initialize(GpuProcLoader, std::string& error) {
+    error = "backend de GPU no compilado (falta -DSPH_GPU_OPENGL)";
+    return false;
+}
+
+void GpuSPHSolver::upload(const ParticleSystem&, const SPHSolver&) {}
+
+void GpuSPHSolver::step(float dt) {
+    stepCount++;
+    simulatedTime += dt;
+}
+
+void GpuSPHSolver::download(ParticleSystem&) const {}
+
+void GpuSPHSolver::drawParticles(float, float, float) const {}
+
+#endif
@@ -0,0 +1,61 @@
+// gpu_solver.h
+#pragma once
+#include <memory>
+#include <string>
+#include "particle_system.h"
+#include "sph_solver.h"
+
+//... resuelve una función de OpenGL en el contexto actual; sirven sf::Context::getFunction
+//... o eglGetProcAddress tal cual (la interfaz no depende de SFML ni de un cargador)
+typedef void (*GpuProc)();
+typedef GpuProc (*GpuProcLoader)(const char* name);
+
+//... backend de GPU con compute shaders de OpenGL 4.3 (cualquier fabricante): el grid se
+//... arma con un radix sort en la GPU y densidad, fuerzas, integración y bordes corren
+//... allá, con las partículas residentes en un búfer que el render dibuja directamente
+//... (drawParticles), sin volver a la CPU en cada frame.
+//... Solo se compila de verdad con -DSPH_GPU_OPENGL; sin eso initialize() devuelve false.
+//... Cubre el modelo de la ecuación de estado con los kernels de Müller y paso fijo:
+//... obstáculos, emisores, PCISPH, el paso adaptativo y la resolución adaptativa siguen
+//... siendo de la CPU.
+//... Todos los métodos van en el hilo con el contexto actual, el mismo del initialize()
+class GpuSPHSolver {
+public:
+    GpuSPHSolver();
+    //... libera los objetos de OpenGL: el contexto tiene que seguir actual
+    ~GpuSPHSolver();
+    GpuSPHSolver(const GpuSPHSolver&) = delete;
+    GpuSPHSolver& operator=(const GpuSPHSolver&) = delete;
+
+    //... carga las funciones y compila los shaders; false con 'error' si el contexto no
+    //... es 4.3 o falta algo
+    bool initialize(GpuProcLoader loader, std::string& error);
+    bool isInitialized() const { return initialized; }
+
+    //... sube partículas, dominio y parámetros (h, masa, viscosidad, rigidez, densidad de
+    //... reposo, lado de celda) y deja el contador de pasos donde estaba el sistema
+    void upload(const ParticleSystem& particleSystem, const SPHSolver& solver);
+    //... un paso de dt entero en la GPU; no espera a que termine
+    void step(float dt);
+    //... trae el estado de vuelta (bloquea hasta que la GPU termine): posiciones,
+    //... velocidades, densidad, presión, id, pasos y tiempo simulado, como un restore()
+    void download(ParticleSystem& particleSystem) const;
+
+    //... dibuja cada partícula como un punto de 'radius' píxeles leído del búfer de la
+    //... GPU, con el mismo color por rapidez que ParticleRenderer. La vista cubre
+    //... [0, viewWidth] x [0, viewHeight] con y hacia abajo, como en SFML
+    void drawParticles(float viewWidth, float viewHeight, float radius) const;
+
+    size_t getParticleCount() const { return count; }
+    unsigned long long getStepCount() const { return stepCount; }
+    double getSimulatedTime() const { return simulatedTime; }
+
+private:
+    //... funciones, programas y búferes de OpenGL (solo existen en gpu_solver.cpp)
+    struct GlState;
+    std::unique_ptr<GlState> gl;
+    bool initialized;
+    size_t count;
+    unsigned long long stepCount;
+    double simulatedTime;
+};
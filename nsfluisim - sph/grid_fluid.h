@@ -0,0 +1,118 @@
+// grid_fluid.h
+#pragma once
+#include <vector>
+#include "thread_pool.h"
+#include "profiler.h"
+
+//... delante de un bucle cuyas iteraciones no se pisan entre sí: GCC no vectoriza los
+//... que leen y escriben muchos arreglos a la vez, porque tendría que comprobar en
+//... tiempo de ejecución que ninguno se solapa con otro
+#if defined(__GNUC__) && !defined(__clang__)
+#define GRID_INDEPENDENT_LOOP _Pragma("GCC ivdep")
+#else
+#define GRID_INDEPENDENT_LOOP
+#endif
+
+//... lo que el overlay muestra de un modelo de malla; velocidades en celdas por unidad
+//... de tiempo del modelo (por paso de la red en Lattice Boltzmann, por segundo en
+//... fluidos estables)
+struct GridFluidStats {
+    float averageSpeed;
+    float maxSpeed;
+    float kineticEnergy;        //... sum 1/2 densidad |u|^2 sobre las celdas de fluido
+    float averageDensity;
+    float maxDivergence;        //... |div u| máximo con diferencias centradas
+    int iterations;             //... ciclos V de la última proyección (0 sin solve)
+    float residual;             //... residuo máximo al terminar esa proyección
+    float tolerance;            //... el residuo que se buscaba en esa proyección
+};
+
+//... qué campo conviene pintar: la rapidez (Lattice Boltzmann, donde la densidad casi
+//... no cambia) o la densidad transportada (el colorante de fluidos estables)
+enum class FieldShading {
+    Speed,
+    Density
+};
+
+//... modelo euleriano sobre una malla regular de width x height celdas, la parte que
+//... comparten Lattice Boltzmann (lbm_solver.h) y fluidos estables (stable_fluids.h)
+//... con el render y el overlay: densidad y velocidad por celda (fila por fila, la celda
+//... (x, y) es y * width + x), una máscara de sólidos y las estadísticas. Como
+//... ParticleSystem, no conoce SFML y reparte las pasadas por filas en el ThreadPool
+class GridFluid {
+public:
+    GridFluid(int width, int height);
+    virtual ~GridFluid() = default;
+
+    //... avanza dt en las unidades del modelo (ver cada uno)
+    virtual void step(float dt) = 0;
+    //... vuelve al estado inicial; los obstáculos se mantienen
+    virtual void reset() = 0;
+    //... empuja el fluido a (vx, vy) en el disco de radio 'radius' alrededor de (x, y),
+    //... en celdas; vale para el próximo step(). 'amount' es densidad que se agrega, y
+    //... solo la usan los modelos con colorante: en fluidos estables crece 'amount' por
+    //... segundo, y Lattice Boltzmann la ignora y solo impone la velocidad, porque su
+    //... densidad es la de la red (la masa del fluido), no algo transportado
+    virtual void addSource(float x, float y, float radius, float amount, float vx, float vy) = 0;
+    virtual const char* getName() const = 0;
+    virtual FieldShading getShading() const = 0;
+
+    //... disco sólido de radio 'radius' centrado en (x, y), en celdas
+    void addCircleObstacle(float x, float y, float radius);
+    void clearObstacles();
+    //... cambia con cada obstáculo agregado o borrado (para cachés de dibujo)
+    unsigned getObstacleRevision() const { return obstacleRevision; }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getCellCount() const { return width * height; }
+    const std::vector<float>& getDensity() const { return density; }
+    const std::vector<float>& getVelocityX() const { return velocityX; }
+    const std::vector<float>& getVelocityY() const { return velocityY; }
+    //... 1 = celda sólida
+    const std::vector<unsigned char>& getSolid() const { return solid; }
+    unsigned long long getStepCount() const { return stepCount; }
+
+    //... recorre los campos y deja las estadísticas en getStats() (O(celdas), pensado
+    //... para llamarlo una vez por frame y no en cada paso)
+    void updateStatistics();
+    const GridFluidStats& getStats() const { return stats; }
+
+    //... nullptr = todo en el hilo actual
+    void setThreadPool(ThreadPool* pool) { threadPool = pool; }
+    //... nullptr = sin instrumentación
+    void setProfiler(Profiler* p) { profiler = p; }
+
+protected:
+    int width;
+    int height;
+    std::vector<float> density;
+    std::vector<float> velocityX, velocityY;
+    std::vector<unsigned char> solid;
+    unsigned obstacleRevision;
+    unsigned long long stepCount;
+    GridFluidStats stats;
+    ThreadPool* threadPool;
+    Profiler* profiler;
+
+    //... los modelos que guardan algo por celda sólida lo rearman aquí
+    virtual void onSolidChanged() {}
+
+    //... fn(y0, y1) por trozos de filas en el pool
+    template <typename RowFn>
+    void forRows(RowFn&& fn) {
+        parallelChunks(threadPool, height, chunkGrain(threadPool, height), fn);
+    }
+
+private:
+    //... parciales por trozo de filas, sumados en orden de trozo
+    struct StatsPartial {
+        double speedSum;
+        float maxSpeed2;
+        double kineticEnergy;
+        double densitySum;
+        float maxDivergence;
+        int fluidCells;
+    };
+    std::vector<StatsPartial> statsPartials;
+};
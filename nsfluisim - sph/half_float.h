@@ -0,0 +1,81 @@
+// half_float.h
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+//... conversión float32 <-> float16 (IEEE 754 binary16) por software, con redondeo al
+//... par más cercano; 10 bits de mantisa = error relativo de ~5e-4, rango hasta 65504
+inline uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t magnitude = bits & 0x7fffffffu;
+
+    //... NaN se conserva como NaN, infinito y desbordes quedan en infinito
+    if (magnitude >= 0x7f800000u) {
+        return static_cast<uint16_t>(sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x200u : 0u));
+    }
+    if (magnitude >= 0x477ff000u) {
+        return static_cast<uint16_t>(sign | 0x7c00u);
+    }
+    //... normales en half
+    if (magnitude >= 0x38800000u) {
+        uint32_t rounded = magnitude + 0xfffu + ((magnitude >> 13) & 1u);
+        return static_cast<uint16_t>(sign | ((rounded - 0x38000000u) >> 13));
+    }
+    //... subnormales en half (o cero)
+    if (magnitude < 0x33000000u) {
+        return static_cast<uint16_t>(sign);
+    }
+    uint32_t exponent = magnitude >> 23;
+    uint32_t mantissa = (magnitude & 0x7fffffu) | 0x800000u;
+    uint32_t shift = 126 - exponent;
+    uint32_t halfMantissa = mantissa >> shift;
+    uint32_t remainder = mantissa & ((1u << shift) - 1u);
+    uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (halfMantissa & 1u))) {
+        halfMantissa++;
+    }
+    return static_cast<uint16_t>(sign | halfMantissa);
+}
+
+//... versión sin ramas para valores finitos (normales, subnormales y cero): exponente y
+//... mantisa se corren a su lugar en float32 y el sesgo se corrige multiplicando por
+//... 2^112. Infinito y NaN no salen bien; sirve en bucles internos sobre datos que se
+//... codificaron ya acotados (ver CompactParticles)
+inline float halfToFloatFinite(uint16_t half) {
+    uint32_t bits = static_cast<uint32_t>(half & 0x7fffu) << 13;
+    float magnitude;
+    std::memcpy(&magnitude, &bits, sizeof(magnitude));
+    magnitude *= 5.192296858534828e33f;
+    std::memcpy(&bits, &magnitude, sizeof(bits));
+    bits |= static_cast<uint32_t>(half & 0x8000u) << 16;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline float halfToFloat(uint16_t half) {
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    uint32_t exponent = (half >> 10) & 0x1fu;
+    uint32_t mantissa = half & 0x3ffu;
+    uint32_t bits;
+    if (exponent == 0x1fu) {
+        bits = sign | 0x7f800000u | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign;
+    } else {
+        //... subnormal: se normaliza corriendo la mantisa
+        exponent = 113;
+        while ((mantissa & 0x400u) == 0) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
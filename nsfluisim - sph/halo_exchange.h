@@ -0,0 +1,22 @@
+// halo_exchange.h
+#pragma once
+
+class ParticleSystem;
+
+//... intercambio de partículas fantasma entre procesos que se reparten el dominio en
+//... franjas (lo implementa DomainDecomposition, ver domain_decomposition.h). El solver
+//... lo usa en dos mitades, SPHSolver::updateDistributed: entre beginHalo y finishHalo
+//... calcula las partículas que no necesitan a las del vecino, así la comunicación se
+//... solapa con ese cálculo
+class HaloExchange {
+public:
+    virtual ~HaloExchange() {}
+    //... cambia con cada vecino cuántas fantasmas se mandan (solo espera eso) y deja
+    //... pedidos sin esperar el envío de las propias a menos de 'width' del borde que
+    //... comparten y la recepción de las suyas
+    virtual void beginHalo(const ParticleSystem& particleSystem, float width) = 0;
+    //... espera las fantasmas y las agrega al final de las partículas
+    virtual void finishHalo(ParticleSystem& particleSystem) = 0;
+    //... distancia de x al borde compartido más cercano; muy grande si no comparte ninguno
+    virtual float edgeDistance(float x) const = 0;
+};
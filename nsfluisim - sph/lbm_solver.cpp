@@ -0,0 +1,212 @@
+/*
+Lattice Boltzmann D2Q9 en C++: la versión de "nsfluisim - lattice boltzmann.py" con
+NumPy hacía colisión, streaming (np.roll por dirección), bordes y macros en pasadas
+separadas sobre los 9 x nx x ny arreglos, varias veces por paso.
+
+Aquí streaming y colisión van fusionados en una sola pasada "pull": cada celda toma de
+sus vecinas en el búfer A las distribuciones que le llegan, calcula densidad y velocidad,
+relaja hacia el equilibrio y escribe el resultado en el búfer B; al terminar se
+intercambian A y B. Así cada paso lee y escribe cada distribución una sola vez y no hace
+falta sincronizar entre celdas.
+
+La pasada va por filas, repartidas en el ThreadPool por bloques de filas contiguas. Para
+cada fila primero se juntan las 9 filas de distribuciones que llegan (copias desplazadas
+de las filas vecinas, con el rebote contra los sólidos como una selección) en un búfer
+de 9 x ancho floats que queda en L1/L2, y después la colisión recorre x sobre ese búfer.
+Los dos bucles internos son contiguos y sin saltos, y el compilador los vectoriza.
+
+Direcciones (y hacia abajo, como la pantalla):
+    6 2 5
+    3 0 1
+    7 4 8
+*/
+
+//... lbm_solver.cpp
+#include "lbm_solver.h"
+#include <cmath>
+#include <algorithm>
+
+static const int LBM_CX[LatticeBoltzmannSolver::Q] = { 0, 1, 0, -1, 0, 1, -1, -1, 1 };
+static const int LBM_CY[LatticeBoltzmannSolver::Q] = { 0, 0, 1, 0, -1, 1, 1, -1, -1 };
+static const int LBM_OPPOSITE[LatticeBoltzmannSolver::Q] = { 0, 3, 4, 1, 2, 7, 8, 5, 6 };
+static const float LBM_WEIGHT[LatticeBoltzmannSolver::Q] = {
+    4.0f / 9.0f,
+    1.0f / 9.0f, 1.0f / 9.0f, 1.0f / 9.0f, 1.0f / 9.0f,
+    1.0f / 36.0f, 1.0f / 36.0f, 1.0f / 36.0f, 1.0f / 36.0f
+};
+
+LatticeBoltzmannSolver::LatticeBoltzmannSolver(int w, int h)
+    : GridFluid(w, h),
+      settings{0.6f, 0.05f, 1.0f} {
+    reset();
+}
+
+void LatticeBoltzmannSolver::setEquilibrium(int cell, float rho, float ux, float uy, float* f) {
+    const int cells = getCellCount();
+    const float usq = 1.5f * (ux * ux + uy * uy);
+    for (int q = 0; q < Q; q++) {
+        const float cu = 3.0f * (LBM_CX[q] * ux + LBM_CY[q] * uy);
+        f[q * cells + cell] = LBM_WEIGHT[q] * rho * (1.0f + cu + 0.5f * cu * cu - usq);
+    }
+}
+
+void LatticeBoltzmannSolver::reset() {
+    const int cells = getCellCount();
+    distributionsA.assign(static_cast<size_t>(cells) * Q, 0.0f);
+    distributionsB.assign(static_cast<size_t>(cells) * Q, 0.0f);
+    for (int c = 0; c < cells; c++) {
+        const float ux = solid[c] ? 0.0f : settings.inletVelocity;
+        setEquilibrium(c, settings.restDensity, ux, 0.0f, distributionsA.data());
+        density[c] = settings.restDensity;
+        velocityX[c] = ux;
+        velocityY[c] = 0.0f;
+    }
+    sources.clear();
+    stepCount = 0;
+}
+
+void LatticeBoltzmannSolver::addSource(float x, float y, float radius, float amount, float vx, float vy) {
+    //... sin colorante: la densidad de la red no se toca (ver GridFluid::addSource)
+    (void)amount;
+    sources.push_back(PendingSource{x, y, radius, vx, vy});
+}
+
+void LatticeBoltzmannSolver::applySources() {
+    for (const PendingSource& source : sources) {
+        const int x0 = std::max(0, static_cast<int>(std::floor(source.x - source.radius)));
+        const int x1 = std::min(width - 1, static_cast<int>(std::ceil(source.x + source.radius)));
+        const int y0 = std::max(0, static_cast<int>(std::floor(source.y - source.radius)));
+        const int y1 = std::min(height - 1, static_cast<int>(std::ceil(source.y + source.radius)));
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                const float dx = cx + 0.5f - source.x, dy = cy + 0.5f - source.y;
+                const int c = cy * width + cx;
+                if (dx * dx + dy * dy > source.radius * source.radius || solid[c]) continue;
+                setEquilibrium(c, density[c], source.vx, source.vy, distributionsA.data());
+            }
+        }
+    }
+    sources.clear();
+}
+
+void LatticeBoltzmannSolver::streamCollideRows(int y0, int y1, float* scratch) {
+    const int cells = getCellCount();
+    const float* A = distributionsA.data();
+    float* B = distributionsB.data();
+    const unsigned char* blocked = solid.data();
+    const float omega = 1.0f / settings.tau;
+
+    //... lo que trae la columna virtual de la entrada: equilibrio a inletVelocity
+    float inlet[Q];
+    {
+        const float ux = settings.inletVelocity;
+        const float usq = 1.5f * ux * ux;
+        for (int q = 0; q < Q; q++) {
+            const float cu = 3.0f * LBM_CX[q] * ux;
+            inlet[q] = LBM_WEIGHT[q] * settings.restDensity * (1.0f + cu + 0.5f * cu * cu - usq);
+        }
+    }
+
+    for (int y = y0; y < y1; y++) {
+        const int row = y * width;
+
+        //... streaming: la dirección q llega desde (x - cx, y - cy); si esa celda es
+        //... sólida, vuelve la distribución opuesta de la propia celda (rebote)
+        for (int q = 0; q < Q; q++) {
+            const int sy = (y - LBM_CY[q] + height) % height;
+            const int dx = LBM_CX[q];
+            const float* src = A + q * cells + sy * width - dx;
+            const unsigned char* srcBlocked = blocked + sy * width - dx;
+            const float* back = A + LBM_OPPOSITE[q] * cells + row;
+            float* in = scratch + q * width;
+            const int xBegin = dx > 0 ? 1 : 0;
+            const int xEnd = dx < 0 ? width - 1 : width;
+            GRID_INDEPENDENT_LOOP
+            for (int x = xBegin; x < xEnd; x++) {
+                const float streamed = src[x];
+                const float bounced = back[x];
+                in[x] = srcBlocked[x] ? bounced : streamed;
+            }
+            //... entrada por la izquierda, salida de gradiente nulo por la derecha
+            if (dx > 0) in[0] = inlet[q];
+            if (dx < 0) in[width - 1] = A[q * cells + sy * width + width - 1];
+        }
+
+        //... colisión BGK sobre las 9 filas que llegaron
+        const float* in0 = scratch;
+        const float* in1 = scratch + width;
+        const float* in2 = scratch + 2 * width;
+        const float* in3 = scratch + 3 * width;
+        const float* in4 = scratch + 4 * width;
+        const float* in5 = scratch + 5 * width;
+        const float* in6 = scratch + 6 * width;
+        const float* in7 = scratch + 7 * width;
+        const float* in8 = scratch + 8 * width;
+        float* out0 = B + row;
+        float* out1 = B + cells + row;
+        float* out2 = B + 2 * cells + row;
+        float* out3 = B + 3 * cells + row;
+        float* out4 = B + 4 * cells + row;
+        float* out5 = B + 5 * cells + row;
+        float* out6 = B + 6 * cells + row;
+        float* out7 = B + 7 * cells + row;
+        float* out8 = B + 8 * cells + row;
+        float* rhoOut = density.data() + row;
+        float* uxOut = velocityX.data() + row;
+        float* uyOut = velocityY.data() + row;
+        const float w0 = LBM_WEIGHT[0], w1 = LBM_WEIGHT[1], w5 = LBM_WEIGHT[5];
+        GRID_INDEPENDENT_LOOP
+        for (int x = 0; x < width; x++) {
+            const float f0 = in0[x], f1 = in1[x], f2 = in2[x], f3 = in3[x], f4 = in4[x];
+            const float f5 = in5[x], f6 = in6[x], f7 = in7[x], f8 = in8[x];
+            const float rho = f0 + f1 + f2 + f3 + f4 + f5 + f6 + f7 + f8;
+            const float inverse = 1.0f / rho;
+            const float ux = (f1 - f3 + f5 - f6 - f7 + f8) * inverse;
+            const float uy = (f2 - f4 + f5 + f6 - f7 - f8) * inverse;
+            const float usq = 1.5f * (ux * ux + uy * uy);
+            const float base = 1.0f - usq;
+            const float r0 = w0 * rho, r1 = w1 * rho, r5 = w5 * rho;
+            //... feq = w rho (1 + cu + cu^2 / 2 - usq) con cu = 3 c.u
+            const float cu1 = 3.0f * ux, cu2 = 3.0f * uy;
+            const float cu5 = 3.0f * (ux + uy), cu6 = 3.0f * (uy - ux);
+            out0[x] = f0 - omega * (f0 - r0 * base);
+            out1[x] = f1 - omega * (f1 - r1 * (base + cu1 + 0.5f * cu1 * cu1));
+            out3[x] = f3 - omega * (f3 - r1 * (base - cu1 + 0.5f * cu1 * cu1));
+            out2[x] = f2 - omega * (f2 - r1 * (base + cu2 + 0.5f * cu2 * cu2));
+            out4[x] = f4 - omega * (f4 - r1 * (base - cu2 + 0.5f * cu2 * cu2));
+            out5[x] = f5 - omega * (f5 - r5 * (base + cu5 + 0.5f * cu5 * cu5));
+            out7[x] = f7 - omega * (f7 - r5 * (base - cu5 + 0.5f * cu5 * cu5));
+            out6[x] = f6 - omega * (f6 - r5 * (base + cu6 + 0.5f * cu6 * cu6));
+            out8[x] = f8 - omega * (f8 - r5 * (base - cu6 + 0.5f * cu6 * cu6));
+            rhoOut[x] = rho;
+            uxOut[x] = ux;
+            uyOut[x] = uy;
+        }
+
+        //... las celdas sólidas quedan en reposo (sus distribuciones solo se leen para el
+        //... rebote de las vecinas, que usa las de la celda de fluido)
+        const unsigned char* rowBlocked = blocked + row;
+        for (int x = 0; x < width; x++) {
+            if (!rowBlocked[x]) continue;
+            for (int q = 0; q < Q; q++) {
+                B[q * cells + row + x] = LBM_WEIGHT[q] * settings.restDensity;
+            }
+            rhoOut[x] = settings.restDensity;
+            uxOut[x] = 0.0f;
+            uyOut[x] = 0.0f;
+        }
+    }
+}
+
+void LatticeBoltzmannSolver::step(float dt) {
+    (void)dt;
+    applySources();
+    ScopedTimer timer(profiler, ProfilePhase::StreamCollide);
+    const int grain = chunkGrain(threadPool, height);
+    rowScratch.resize(static_cast<size_t>(chunkTotal(height, grain)) * Q * width);
+    parallelChunks(threadPool, height, grain, [&](int y0, int y1) {
+        streamCollideRows(y0, y1, rowScratch.data() + static_cast<size_t>(y0 / grain) * Q * width);
+    });
+    distributionsA.swap(distributionsB);
+    stepCount++;
+}
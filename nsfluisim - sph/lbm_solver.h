@@ -0,0 +1,55 @@
+// lbm_solver.h
+#pragma once
+#include "grid_fluid.h"
+
+//... parámetros de la red: tau da la viscosidad nu = (tau - 1/2) / 3 y el fluido entra
+//... por la izquierda a inletVelocity (celdas por paso, < 0.1 para que siga estable)
+struct LBMSettings {
+    float tau;
+    float inletVelocity;
+    float restDensity;
+};
+
+//... Lattice Boltzmann D2Q9 con colisión BGK (el de "nsfluisim - lattice boltzmann.py"):
+//... canal con entrada de equilibrio a inletVelocity por la izquierda, salida de
+//... gradiente nulo por la derecha, periódico en y, y rebote a medio camino contra los
+//... sólidos. Cada step() es un paso de la red (dt no se usa): streaming y colisión en una
+//... sola pasada que lee el búfer A y escribe el B (ver lbm_solver.cpp), y al final se
+//... intercambian. Densidad y velocidad de GridFluid son las del último paso
+class LatticeBoltzmannSolver : public GridFluid {
+public:
+    static const int Q = 9;
+
+    LatticeBoltzmannSolver(int width, int height);
+
+    void step(float dt) override;
+    //... todo en equilibrio con la velocidad de entrada
+    void reset() override;
+    //... impone el equilibrio a (vx, vy) en el disco (amount no se usa: la densidad de la
+    //... red no es un colorante)
+    void addSource(float x, float y, float radius, float amount, float vx, float vy) override;
+    const char* getName() const override { return "Lattice Boltzmann D2Q9"; }
+    FieldShading getShading() const override { return FieldShading::Speed; }
+
+    //... vale desde el próximo paso
+    void setSettings(const LBMSettings& value) { settings = value; }
+    const LBMSettings& getSettings() const { return settings; }
+    float getViscosity() const { return (settings.tau - 0.5f) / 3.0f; }
+
+private:
+    LBMSettings settings;
+    //... distribuciones SoA: la dirección q de la celda c está en f[q * celdas + c]; A es
+    //... el estado actual y B recibe el paso siguiente
+    std::vector<float> distributionsA, distributionsB;
+    //... por trozo de filas, las 9 distribuciones que llegan a la fila en curso (ver
+    //... streamCollideRows): 9 x width floats por trozo
+    std::vector<float> rowScratch;
+    struct PendingSource {
+        float x, y, radius, vx, vy;
+    };
+    std::vector<PendingSource> sources;
+
+    void streamCollideRows(int y0, int y1, float* scratch);
+    void applySources();
+    void setEquilibrium(int cell, float rho, float ux, float uy, float* f);
+};
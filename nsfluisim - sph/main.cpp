@@ -30,7 +30,19 @@ Hecho por Felipe Alexander Correa Rodríguez.
 
 #include "sph_solver.h"
 #include "particle_system.h"
+#include "particle_renderer.h"
 #include "constants.h"
+#include "ui_constants.h"
+#include "thread_pool.h"
+#include "simulation_scheduler.h"
+#include "profiler.h"
+#include "checkpoint.h"
+#include "frame_exporter.h"
+#include "simulation_thread.h"
+#include "simulation_config.h"
+#include "gpu_solver.h"
+#include "lbm_solver.h"
+#include "stable_fluids.h"
 
 class Button {
 public:
@@ -77,8 +89,35 @@ private:
 
 sf::Font Button::font;
 
-int main() {
-    sf::RenderWindow window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), 
+int main(int argc, char** argv) {
+    //.... nsfluidsph [--config archivo] [--set clave=valor]... [--gpu]: la escena, el tamaño
+    //.... de la ventana y los parámetros salen de ahí (ver simulation_config.h), en orden;
+    //.... --gpu arranca con el backend de GPU (lo mismo que la tecla G)
+    SimulationConfig config;
+    bool startOnGpu = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string error;
+        bool ok = false;
+        if (arg == "--config" && i + 1 < argc) {
+            ok = loadSimulationConfig(argv[++i], config, error);
+        } else if (arg == "--set" && i + 1 < argc) {
+            ok = setSimulationConfigValue(argv[++i], config, error);
+        } else if (arg == "--gpu") {
+            startOnGpu = true;
+            ok = true;
+        } else {
+            error = "uso: " + std::string(argv[0]) + " [--config archivo] [--set clave=valor] [--gpu]";
+        }
+        if (!ok) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+    }
+    const int width = config.domainWidth;
+    const int height = config.domainHeight;
+
+    sf::RenderWindow window(sf::VideoMode(width, height), 
                            "NSFLUID - SPH Simulacion", 
                            sf::Style::Close);
     window.setFramerateLimit(60);
@@ -86,11 +125,120 @@ int main() {
     sf::Vector2f mousePosF(static_cast<float>(mousePos.x), 
                              static_cast<float>(mousePos.y));
     
-    ParticleSystem particleSystem(WINDOW_WIDTH, WINDOW_HEIGHT);
-    SPHSolver solver;
+    ParticleSystem particleSystem(width, height);
+    SPHSolver solver(width, height);
+    applySimulationConfig(config, particleSystem, solver);
+    ParticleRenderer renderer;
+
+    //.... pool de hilos compartido por el solver y el sistema de partículas
+    ThreadPool threadPool;
+    particleSystem.setThreadPool(&threadPool);
+    solver.setThreadPool(&threadPool);
+
+    //.... tiempos por fase (min/media/p99 de los últimos 240 frames): uno por hilo, el de
+    //.... simulación mide las fases de la física y el de render el dibujo y el frame
+    Profiler simulationProfiler(240);
+    simulationProfiler.setTracing(true);
+    particleSystem.setProfiler(&simulationProfiler);
+    solver.setProfiler(&simulationProfiler);
+    Profiler profiler(240);
+
+    //.... paso físico fijo, independiente de los FPS de renderizado
+    SimulationScheduler scheduler(config.timestep, 1, 4);
+    particleSystem.setDeltaTime(scheduler.getSubstepDt());
+    //.... T activa el paso adaptativo: cada paso fijo se subdivide en pasos estables
+    bool adaptiveTimestep = config.adaptiveTimestep;
+    //.... C prende/apaga un canal: entrada a la izquierda y salida en el borde derecho,
+    //.... con un pool de 6000 partículas reservado de una vez
+    particleSystem.setParticleCapacity(6000);
+    //.... S cambia entre dibujar las partículas y solo la superficie del fluido
+    bool surfaceRendering = false;
+    //.... F5 guarda un checkpoint en segundo plano, F9 lo vuelve a cargar
+    const std::string checkpointPath = "checkpoint.nsck";
+    CheckpointWriter checkpointWriter;
+    //.... F6 prende/apaga la exportación de frames (un frame por paso fijo)
+    FrameExporter exporter;
+    exporter.setProfiler(&simulationProfiler);
+
+    //.... la física corre en su propio hilo; desde aquí solo se le mandan comandos y se
+    //.... dibuja el último estado que publicó
+    SimulationThread simulation(particleSystem, solver, scheduler);
+    simulation.setProfiler(&simulationProfiler);
+    simulation.setThreadPool(&threadPool);
+    simulation.setStepCallback([&] { exporter.capture(particleSystem); });
+
+    //.... G pasa la física a la GPU (compute shaders, ver gpu_solver.h) y de vuelta. En modo
+    //.... GPU el hilo de simulación está detenido: este hilo avanza el paso fijo, la GPU
+    //.... integra y dibuja desde su propio búfer. Solo el modelo de la ecuación de estado;
+    //.... obstáculos y emisores no existen allá, y las demás teclas esperan al modo CPU
+    GpuSPHSolver gpu;
+    bool gpuMode = false;
+    sf::Clock gpuClock;
+    auto enterGpu = [&] {
+        simulation.stop();
+        std::string error;
+        if (!gpu.isInitialized() && !gpu.initialize(&sf::Context::getFunction, error)) {
+            std::cout << "GPU no disponible: " << error << "\n";
+            simulation.start();
+            return;
+        }
+        //.... la GPU tiene una sola masa y un solo h: las partículas divididas valdrían doble
+        if (solver.isMultiresolution(particleSystem)) {
+            std::cout << "La GPU no cubre la resolución adaptativa\n";
+            simulation.start();
+            return;
+        }
+        if (solver.getPressureSolver() == PressureSolver::PCISPH ||
+            particleSystem.getObstacles().size() > 0 || !particleSystem.getEmitters().empty()) {
+            std::cout << "La GPU usa la ecuación de estado, sin obstáculos ni emisores\n";
+        }
+        gpu.upload(particleSystem, solver);
+        scheduler.reset();
+        gpuClock.restart();
+        gpuMode = true;
+    };
+    auto leaveGpu = [&] {
+        gpu.download(particleSystem);
+        //.... start() recalcula las estadísticas antes del primer snapshot
+        scheduler.reset();
+        gpuMode = false;
+        simulation.start();
+    };
+
+    //.... E pasa a los modelos de malla (grid_fluid.h): SPH -> Lattice Boltzmann ->
+    //.... fluidos estables -> SPH. Igual que en modo GPU el hilo de simulación se detiene
+    //.... y este hilo avanza el paso fijo; cada paso son varios pasos de la red en
+    //.... Lattice Boltzmann, y en fluidos estables una fuente de colorante sube desde abajo.
+    //.... Clic izquierdo pone un obstáculo, C los borra, espacio pausa y R reinicia
+    LatticeBoltzmannSolver lbm(400, 200);
+    StableFluidsSolver stableFluids(256, 192);
+    const int latticeStepsPerStep = 8;
+    Profiler gridProfiler(240);
+    for (GridFluid* fluid : {static_cast<GridFluid*>(&lbm), static_cast<GridFluid*>(&stableFluids)}) {
+        fluid->setThreadPool(&threadPool);
+        fluid->setProfiler(&gridProfiler);
+    }
+    GridFluid* gridFluid = nullptr;
+    bool gridPaused = false;
+    sf::Clock gridClock;
+    auto switchGrid = [&] {
+        if (!gridFluid) {
+            simulation.stop();
+            gridFluid = &lbm;
+        } else if (gridFluid == &lbm) {
+            gridFluid = &stableFluids;
+        } else {
+            gridFluid = nullptr;
+            scheduler.reset();
+            simulation.start();
+            return;
+        }
+        std::cout << "Modelo de malla: " << gridFluid->getName() << "\n";
+        scheduler.reset();
+        gridClock.restart();
+    };
 
     //.... variables para fps
-    sf::Clock clock;
     sf::Text fpsText;
     sf::Font font;
     if (!font.loadFromFile("Arial.ttf")) {
@@ -102,8 +250,8 @@ int main() {
     fpsText.setPosition(10, 10);
 
     //.... creamos botones
-    Button startButton("Start/Pause", sf::Vector2f(10, WINDOW_HEIGHT - 40), sf::Vector2f(100, 30));
-    Button resetButton("Reset", sf::Vector2f(120, WINDOW_HEIGHT - 40), sf::Vector2f(100, 30));
+    Button startButton("Start/Pause", sf::Vector2f(10, height - 40), sf::Vector2f(100, 30));
+    Button resetButton("Reset", sf::Vector2f(120, height - 40), sf::Vector2f(100, 30));
     
     //.... texto para estadísticas
     sf::Text statsText;
@@ -115,67 +263,309 @@ int main() {
     //.... gráfica de velocidad
     sf::VertexArray velocityGraph(sf::LineStrip);
 
+    simulation.start();
+    if (startOnGpu) enterGpu();
     while (window.isOpen()) {
+        profiler.beginFrame();
         sf::Event event;
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed)
                 window.close();
             
-            if (event.type == sf::Event::MouseButtonPressed) {
+            if (event.type == sf::Event::MouseButtonPressed && gpuMode) {
+                std::cout << "Los clics solo funcionan en modo CPU (G)\n";
+            } else if (event.type == sf::Event::MouseButtonPressed && gridFluid) {
+                if (event.mouseButton.button == sf::Mouse::Left) {
+                    const float cellsX = static_cast<float>(gridFluid->getWidth()) / width;
+                    const float cellsY = static_cast<float>(gridFluid->getHeight()) / height;
+                    gridFluid->addCircleObstacle(event.mouseButton.x * cellsX, event.mouseButton.y * cellsY,
+                                                 gridFluid->getHeight() * 0.06f);
+                }
+            } else if (event.type == sf::Event::MouseButtonPressed) {
+                int x = event.mouseButton.x;
+                int y = event.mouseButton.y;
                 if (event.mouseButton.button == sf::Mouse::Left) {
-                    particleSystem.handleMouseInput(event.mouseButton.x, 
-                                                  event.mouseButton.y);
+                    simulation.post([&, x, y] { particleSystem.handleMouseInput(x, y); });
+                } else if (event.mouseButton.button == sf::Mouse::Right) {
+                    //.... clic derecho: caja de 60x30
+                    simulation.post([&, x, y] {
+                        particleSystem.addBoxObstacle(Vec2(static_cast<float>(x), static_cast<float>(y)),
+                                                      Vec2(30.0f, 15.0f));
+                    });
                 }
             }
-        }
 
-        //.... actualización física
-        solver.update(particleSystem);
-        particleSystem.update();
+            //.... espacio pausa/reanuda, R reinicia; todo lo que toca la física se encola
+            //.... y lo ejecuta el hilo de simulación entre dos pasos
+            if (event.type == sf::Event::KeyPressed) {
+                if (event.key.code == sf::Keyboard::G && !gridFluid) {
+                    if (gpuMode) {
+                        leaveGpu();
+                    } else {
+                        enterGpu();
+                    }
+                } else if (gpuMode) {
+                    //.... sin hilo de simulación: el estado se toca directo
+                    if (event.key.code == sf::Keyboard::Space) {
+                        particleSystem.togglePause();
+                    } else if (event.key.code == sf::Keyboard::R) {
+                        particleSystem.reset();
+                        gpu.upload(particleSystem, solver);
+                        scheduler.reset();
+                    } else {
+                        std::cout << "Tecla solo disponible en modo CPU (G)\n";
+                    }
+                } else if (event.key.code == sf::Keyboard::E) {
+                    switchGrid();
+                } else if (gridFluid) {
+                    if (event.key.code == sf::Keyboard::Space) {
+                        gridPaused = !gridPaused;
+                    } else if (event.key.code == sf::Keyboard::R) {
+                        gridFluid->reset();
+                        scheduler.reset();
+                    } else if (event.key.code == sf::Keyboard::C) {
+                        gridFluid->clearObstacles();
+                    } else {
+                        std::cout << "Tecla solo disponible en modo SPH (E)\n";
+                    }
+                } else if (event.key.code == sf::Keyboard::Space) {
+                    simulation.post([&] { particleSystem.togglePause(); });
+                } else if (event.key.code == sf::Keyboard::R) {
+                    simulation.post([&] {
+                        particleSystem.reset();
+                        scheduler.reset();
+                    });
+                } else if (event.key.code == sf::Keyboard::T) {
+                    simulation.post([&] {
+                        adaptiveTimestep = !adaptiveTimestep;
+                        solver.setAdaptiveTimestep(adaptiveTimestep);
+                        solver.resetTimestepStats();
+                    });
+                } else if (event.key.code == sf::Keyboard::C) {
+                    simulation.post([&] {
+                        if (particleSystem.getEmitters().empty()) {
+                            particleSystem.addEmitter(Vec2(20.0f, height * 0.5f),
+                                                      Vec2(250.0f, 0.0f), 80.0f);
+                            particleSystem.addSink(Vec2(width - 30.0f, 0.0f),
+                                                   Vec2(static_cast<float>(width),
+                                                        static_cast<float>(height)));
+                        } else {
+                            particleSystem.clearSources();
+                        }
+                    });
+                } else if (event.key.code == sf::Keyboard::S) {
+                    surfaceRendering = !surfaceRendering;
+                    const bool enabled = surfaceRendering;
+                    simulation.post([&, enabled] { simulation.setSurfaceRendering(enabled); });
+                } else if (event.key.code == sf::Keyboard::F1) {
+                    //.... F1 exporta la ventana de tiempos, F2 la traza de eventos
+                    simulation.post([&] {
+                        if (simulationProfiler.writeCsv("profile.csv")) {
+                            std::cout << "Perfil guardado en profile.csv\n";
+                        }
+                    });
+                } else if (event.key.code == sf::Keyboard::F2) {
+                    simulation.post([&] {
+                        if (simulationProfiler.writeChromeTrace("profile_trace.json")) {
+                            std::cout << "Traza guardada en profile_trace.json\n";
+                        }
+                    });
+                } else if (event.key.code == sf::Keyboard::F5) {
+                    simulation.post([&] {
+                        checkpointWriter.save(checkpointPath, particleSystem, solver);
+                        std::cout << "Guardando checkpoint en " << checkpointPath << "\n";
+                    });
+                } else if (event.key.code == sf::Keyboard::F6) {
+                    simulation.post([&] {
+                        if (exporter.isOpen()) {
+                            exporter.close();
+                            std::cout << "Exportación detenida: " << exporter.getStats().framesWritten
+                                      << " frames en frames.nsfr\n";
+                        } else {
+                            std::string error;
+                            if (exporter.open("frames.nsfr", FrameExportSettings(), error)) {
+                                std::cout << "Exportando frames a frames.nsfr\n";
+                            } else {
+                                std::cout << "No se pudo exportar: " << error << "\n";
+                            }
+                        }
+                    });
+                } else if (event.key.code == sf::Keyboard::F9) {
+                    simulation.post([&] {
+                        //.... primero se termina cualquier guardado pendiente del mismo archivo
+                        checkpointWriter.wait();
+                        std::string error;
+                        if (loadCheckpoint(checkpointPath, particleSystem, solver, error)) {
+                            adaptiveTimestep = solver.getTimestepSettings().adaptive;
+                            solver.resetTimestepStats();
+                            scheduler.reset();
+                            std::cout << "Checkpoint cargado (paso " << particleSystem.getStepCount() << ")\n";
+                        } else {
+                            std::cout << "No se pudo cargar el checkpoint: " << error << "\n";
+                        }
+                    });
+                }
+            }
+        }
 
-        //.... cálculo de fps
-        float fps = 1.0f / clock.restart().asSeconds();
+        //.... los FPS de render salen de la media de la ventana del profiler, no de un
+        //.... frame suelto
+        PhaseStats frameStats = profiler.getStats(ProfilePhase::Frame);
+        float fps = frameStats.meanMs > 0.0 ? static_cast<float>(1000.0 / frameStats.meanMs) : 0.0f;
         fpsText.setString("FPS: " + std::to_string((int)fps));
 
         //.... actualiza hover de botones
         startButton.setHovered(startButton.isMouseOver(mousePosF));
         resetButton.setHovered(resetButton.isMouseOver(mousePosF));
 
-        //.... actualiza simulación si no está pausada
-        if (!particleSystem.getIsPaused()) {
-            solver.update(particleSystem);
-            particleSystem.update();
+        if (gpuMode) {
+            //.... paso fijo en este hilo; la GPU encola los pasos y los dibuja sin bajarlos
+            float frameSeconds = gpuClock.restart().asSeconds();
+            const int steps = particleSystem.getIsPaused() ? 0 : scheduler.advance(frameSeconds);
+            for (int i = 0; i < steps * scheduler.getSubsteps(); i++) {
+                gpu.step(scheduler.getSubstepDt());
+            }
+
+            std::stringstream ss;
+            ss << "FPS: " << static_cast<int>(fps) << "\n"
+               << "GPU: " << gpu.getParticleCount() << " partículas, paso " << gpu.getStepCount()
+               << (particleSystem.getIsPaused() ? " (pausa)" : "") << "\n"
+               << "G vuelve a la CPU\n\n"
+               << profiler.summary();
+            statsText.setString(ss.str());
+
+            window.clear(sf::Color(20, 20, 50));
+            {
+                ScopedTimer timer(&profiler, ProfilePhase::Render);
+                gpu.drawParticles(static_cast<float>(width), static_cast<float>(height),
+                                  particleSystem.getSmoothingLength() * 0.5f);
+            }
+            //.... drawParticles deja su propio estado de OpenGL; SFML vuelve a fijar el suyo
+            window.resetGLStates();
+            window.draw(fpsText);
+            window.draw(statsText);
+            window.display();
+            profiler.endFrame();
+            continue;
         }
-        
-        //.... actualizamos estadísticas
-        particleSystem.updateStatistics();
-        
+
+        if (gridFluid) {
+            float frameSeconds = gridClock.restart().asSeconds();
+            const int steps = gridPaused ? 0 : scheduler.advance(frameSeconds);
+            const int substeps = steps * scheduler.getSubsteps();
+            gridProfiler.beginFrame();
+            for (int i = 0; i < substeps; i++) {
+                if (gridFluid == &lbm) {
+                    for (int k = 0; k < latticeStepsPerStep; k++) lbm.step(1.0f);
+                } else {
+                    stableFluids.addSource(stableFluids.getWidth() * 0.5f, stableFluids.getHeight() - 12.0f,
+                                           5.0f, 8.0f, 0.0f, -60.0f);
+                    stableFluids.step(scheduler.getSubstepDt());
+                }
+            }
+            {
+                ScopedTimer timer(&gridProfiler, ProfilePhase::Statistics);
+                gridFluid->updateStatistics();
+            }
+            gridProfiler.endFrame();
+
+            const GridFluidStats& gridStats = gridFluid->getStats();
+            std::stringstream ss;
+            ss << "FPS: " << static_cast<int>(fps) << "\n"
+               << gridFluid->getName() << ": " << gridFluid->getWidth() << "x" << gridFluid->getHeight()
+               << " celdas, paso " << gridFluid->getStepCount() << (gridPaused ? " (pausa)" : "") << "\n"
+               << std::fixed << std::setprecision(4)
+               << "Velocidad promedio: " << gridStats.averageSpeed << ", máxima: " << gridStats.maxSpeed << "\n"
+               << "Energía cinética: " << gridStats.kineticEnergy << "\n"
+               << "Densidad media: " << gridStats.averageDensity << "\n"
+               << "Divergencia máxima: " << gridStats.maxDivergence;
+            if (gridStats.iterations > 0) {
+                ss << ", proyección en " << gridStats.iterations << " ciclos multigrid (residuo "
+                   << gridStats.residual << ", tolerancia " << gridStats.tolerance << ")";
+            }
+            ss << "\nClic: obstáculo, C los borra, E cambia de modelo\n\n"
+               << gridProfiler.summary()
+               << profiler.summary();
+            statsText.setString(ss.str());
+
+            window.clear(sf::Color(20, 20, 50));
+            {
+                ScopedTimer timer(&profiler, ProfilePhase::Render);
+                renderer.renderField(window, *gridFluid);
+            }
+            window.draw(fpsText);
+            window.draw(statsText);
+            window.display();
+            profiler.endFrame();
+            continue;
+        }
+
+        //.... último estado publicado por el hilo de simulación; si no hay uno nuevo se
+        //.... vuelve a dibujar el anterior
+        simulation.acquireSnapshot();
+        const RenderSnapshot& snapshot = simulation.getSnapshot();
+
         //.... actualiza texto de estadísticas
         std::stringstream ss;
-        ss << "FPS: " << static_cast<int>(1.0f / clock.restart().asSeconds()) << "\n"
+        ss << "FPS: " << static_cast<int>(fps) << "\n"
            << "Velocidad promedio: " << std::fixed << std::setprecision(2) 
-           << particleSystem.getAverageVelocity() << "\n"
-           << "Velocidad máxima: " << particleSystem.getMaxVelocity() << "\n"
-           << "Energía cinética total: " << particleSystem.getTotalKineticEnergy() << "\n"
-           << "Partículas: " << particleSystem.getParticles().size();
+           << snapshot.averageVelocity << "\n"
+           << "Velocidad máxima: " << snapshot.maxVelocity << "\n"
+           << "Energía cinética total: " << snapshot.totalKineticEnergy << "\n"
+           << "Compresión: " << snapshot.maxDensityError * 100.0f << "% máx, "
+           << snapshot.averageDensityError * 100.0f << "% media\n"
+           << "Presión: " << snapshot.minPressure << " a " << snapshot.maxPressure << "\n"
+           << "Partículas: " << snapshot.size();
+        if (!snapshot.levelCounts.empty()) {
+            ss << " (por nivel:";
+            for (size_t level = 0; level < snapshot.levelCounts.size(); level++) {
+                ss << (level == 0 ? " " : "/") << snapshot.levelCounts[level];
+            }
+            ss << ")";
+        }
+        if (snapshot.sleeping) {
+            ss << ", " << snapshot.sleepingParticles << " dormidas en "
+               << snapshot.sleepingCells << " celdas";
+        }
+        if (snapshot.surface) {
+            ss << ", superficie de " << snapshot.surfaceTriangles.size() / 6 << " triángulos";
+        }
+        ss << "\n"
+           << "Paso: " << (snapshot.adaptiveTimestep ? "adaptativo" : "fijo") << ", "
+           << snapshot.lastSubsteps << " subpasos, dt "
+           << std::setprecision(5) << snapshot.lastTimestep 
+           << std::setprecision(2) << " s\n\n"
+           << snapshot.profileSummary
+           << profiler.summary();
         statsText.setString(ss.str());
         
         //.... actualiza gráfica de velocidad
         velocityGraph.clear();
-        const auto& history = particleSystem.getVelocityHistory();
+        const auto& history = snapshot.velocityHistory;
+        //.... la gráfica mide 200 px; un historial más largo se comprime
+        float graphStep = history.size() > 200 ? 200.0f / history.size() : 1.0f;
         for (size_t i = 0; i < history.size(); ++i) {
-            float x = static_cast<float>(WINDOW_WIDTH - 220 + i);
-            float y = static_cast<float>(WINDOW_HEIGHT - 100) - history[i] * 2.0f;
+            float x = width - 220 + i * graphStep;
+            float y = static_cast<float>(height - 100) - history[i] * 2.0f;
             velocityGraph.append(sf::Vertex(sf::Vector2f(x, y), sf::Color::Green));
         }
 
         //.... renderizado
         window.clear(sf::Color(20, 20, 50));
-        particleSystem.render(window);
+        {
+            ScopedTimer timer(&profiler, ProfilePhase::Render);
+            renderer.render(window, snapshot);
+        }
         window.draw(fpsText);
+        window.draw(statsText);
         window.display();
+        profiler.endFrame();
     }
 
+    if (gpuMode) gpu.download(particleSystem);
+    simulation.stop();
+    checkpointWriter.wait();
+    exporter.close();
     return 0;
 }
 
@@ -183,4 +573,6 @@ int main() {
 // Todos los derechos reservados. @FECORO, 2023.
 
 // Compilo como:
-// g++ -std=c++17 -I"C:\msys64\mingw64\include\SFML" -L"C:\msys64\mingw64\lib" -o nsfluidsph main.cpp particle_system.cpp sph_solver.cpp spatial_grid.cpp -lsfml-graphics -lsfml-window -lsfml-system
\ No newline at end of file
+// g++ -std=c++17 -I"C:\msys64\mingw64\include\SFML" -L"C:\msys64\mingw64\lib" -o nsfluidsph main.cpp particle_system.cpp sph_solver.cpp spatial_grid.cpp thread_pool.cpp particle_renderer.cpp simulation_scheduler.cpp sph_simd.cpp sph_simd_x86.cpp profiler.cpp obstacle_field.cpp neighbor_list.cpp sph_pcisph.cpp mapped_file.cpp checkpoint.cpp frame_exporter.cpp simulation_thread.cpp simulation_config.cpp gpu_solver.cpp compact_particles.cpp sph_compact.cpp sph_multires.cpp sph_distributed.cpp sph_sleep.cpp grid_fluid.cpp lbm_solver.cpp stable_fluids.cpp surface_field.cpp -lsfml-graphics -lsfml-window -lsfml-system
+// Con -O3 se vectorizan los bucles de los modelos de malla (tecla E)
+// Con -DSPH_GPU_OPENGL se compila el backend de GPU (tecla G); hace falta OpenGL 4.3
\ No newline at end of file
@@ -0,0 +1,32 @@
+// mapped_file.h
+#pragma once
+#include <string>
+#include <cstddef>
+
+//... archivo de solo lectura mapeado en memoria (mmap en POSIX, CreateFileMapping en
+//... Windows); las páginas se cargan a demanda al leerlas, sin copiar a un búfer propio
+class MappedFile {
+private:
+    const unsigned char* bytes;
+    std::size_t length;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    //... false si no se pudo abrir o mapear; 'error' dice por qué
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    bool isOpen() const { return bytes != nullptr; }
+    const unsigned char* data() const { return bytes; }
+    std::size_t size() const { return length; }
+};
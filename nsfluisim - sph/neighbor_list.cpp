@@ -0,0 +1,78 @@
+/*
+Lista de vecinos en caché (lista de Verlet).
+
+Sin la lista, las pasadas de densidad y fuerzas recorren las 3x3 celdas del grid cada una
+por su cuenta, repitiendo la misma búsqueda dos veces por paso. Aquí la búsqueda se hace
+una vez y se guardan los índices de los vecinos de cada partícula en un arreglo contiguo.
+
+Con una piel (skin) el radio de búsqueda es h + skin, y la lista sirve para varios pasos:
+dos partículas a distancia < h ahora estaban a menos de h + skin al armarla si ninguna se
+movió más de skin/2, así que solo hace falta rearmarla cuando alguna lo supera.
+
+El armado va en paralelo: cada trozo llena su propio búfer (que se conserva entre
+armados para no reservar memoria) y al final se copian en orden al arreglo común.
+*/
+
+//... neighbor_list.cpp
+#include "neighbor_list.h"
+#include <algorithm>
+
+void NeighborList::build(const ParticleData& particles, const SpatialGrid& grid,
+                         float searchRadius, unsigned reorderRevision, ThreadPool* pool) {
+    const int count = static_cast<int>(particles.size());
+    const float* px = particles.x.data();
+    const float* py = particles.y.data();
+    const float r2Max = searchRadius * searchRadius;
+    offsets.assign(count + 1, 0);
+
+    //... una sola búsqueda: cada trozo escribe sus vecinos en su propio búfer y
+    //... offsets[i+1] guarda la cuenta de i; después se juntan en orden de trozo
+    const int grain = chunkGrain(pool, count);
+    chunkIndices.resize(chunkTotal(count, grain));
+    parallelChunks(pool, count, grain, [&](int begin, int end) {
+        std::vector<int>& out = chunkIndices[begin / grain];
+        out.clear();
+        for (int i = begin; i < end; i++) {
+            size_t before = out.size();
+            grid.forEachNeighbor(px[i], py[i], [&](int j) {
+                float dx = px[i] - px[j];
+                float dy = py[i] - py[j];
+                if (dx * dx + dy * dy < r2Max) out.push_back(j);
+            });
+            offsets[i + 1] = static_cast<int>(out.size() - before);
+        }
+    });
+
+    for (int i = 0; i < count; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+    indices.resize(offsets[count]);
+    for (size_t c = 0; c < chunkIndices.size(); c++) {
+        int first = offsets[c * grain];
+        std::copy(chunkIndices[c].begin(), chunkIndices[c].end(), indices.begin() + first);
+    }
+
+    refX.assign(particles.x.begin(), particles.x.end());
+    refY.assign(particles.y.begin(), particles.y.end());
+    radius = searchRadius;
+    builtReorder = reorderRevision;
+    valid = true;
+}
+
+bool NeighborList::needsRebuild(const ParticleData& particles, float h,
+                                unsigned reorderRevision) const {
+    if (!valid || refX.size() != particles.size() || builtReorder != reorderRevision) {
+        return true;
+    }
+    float skin = radius - h;
+    if (skin <= 0.0f) return true;
+
+    const float limit2 = 0.25f * skin * skin;
+    const size_t count = particles.size();
+    for (size_t i = 0; i < count; i++) {
+        float dx = particles.x[i] - refX[i];
+        float dy = particles.y[i] - refY[i];
+        if (dx * dx + dy * dy > limit2) return true;
+    }
+    return false;
+}
@@ -0,0 +1,45 @@
+// neighbor_list.h
+#pragma once
+#include <vector>
+#include "particle_system.h"
+#include "spatial_grid.h"
+#include "thread_pool.h"
+
+//... lista de vecinos por partícula en formato CSR: los vecinos de i son
+//... indices[offsets[i]..offsets[i+1]), todos a distancia < radio al momento de armarla
+//... (la partícula misma incluida). Se arma una vez y la comparten densidad y fuerzas.
+//... Con piel (radio = h + skin) sigue siendo válida mientras ninguna partícula se haya
+//... movido más de skin/2 desde que se armó: ver needsRebuild()
+class NeighborList {
+private:
+    std::vector<int> offsets;
+    std::vector<int> indices;
+    //... un búfer por trozo del pool durante el armado
+    std::vector<std::vector<int>> chunkIndices;
+    //... posiciones al armar, para medir el desplazamiento
+    std::vector<float> refX, refY;
+    float radius;
+    unsigned builtReorder;
+    bool valid;
+
+public:
+    NeighborList() : radius(0.0f), builtReorder(0), valid(false) {}
+
+    //... busca con el grid (ya actualizado) y guarda los pares a distancia < searchRadius;
+    //... el grid debe tener celdas de al menos searchRadius
+    void build(const ParticleData& particles, const SpatialGrid& grid, float searchRadius,
+               unsigned reorderRevision, ThreadPool* pool);
+
+    //... true si la lista ya no garantiza contener todos los pares a distancia < h:
+    //... cambió la cantidad de partículas o su orden, o alguna se movió más de skin/2
+    bool needsRebuild(const ParticleData& particles, float h, unsigned reorderRevision) const;
+
+    void invalidate() { valid = false; }
+    bool isValid() const { return valid; }
+    float getRadius() const { return radius; }
+    size_t getPairCount() const { return indices.size(); }
+    size_t getParticleCount() const { return refX.size(); }
+
+    const int* begin(int i) const { return indices.data() + offsets[i]; }
+    const int* end(int i) const { return indices.data() + offsets[i + 1]; }
+};
@@ -0,0 +1,255 @@
+/*
+Aquí están los obstáculos estáticos de la simulación: círculos, cajas (con giro) y
+polilíneas, que se parten en segmentos con grosor.
+
+Antes cada partícula se comparaba con todos los obstáculos en cada paso, así que cada clic
+agregaba n comparaciones más. Ahora los obstáculos se reparten en un grid uniforme según su
+caja envolvente y cada partícula solo mira los de su celda; con cientos de obstáculos
+repartidos por la ventana, cada partícula prueba unos pocos.
+
+La respuesta de contacto usa la distancia con signo de cada forma: si la partícula quedó
+dentro se empuja hasta la superficie por la normal y se refleja la velocidad normal.
+*/
+
+//... obstacle_field.cpp
+#include "obstacle_field.h"
+#include <algorithm>
+#include <cmath>
+
+ObstacleField::ObstacleField(int width, int height, float cellSize)
+    : gridWidth(static_cast<int>(std::ceil(width / cellSize))),
+      gridHeight(static_cast<int>(std::ceil(height / cellSize))),
+      cellSize(cellSize),
+      revision(0),
+      dirty(false) {
+    cellStart.assign(gridWidth * gridHeight + 1, 0);
+}
+
+int ObstacleField::cellCoordX(float x) const {
+    int cellX = static_cast<int>(std::floor(x / cellSize));
+    return std::max(0, std::min(gridWidth - 1, cellX));
+}
+
+int ObstacleField::cellCoordY(float y) const {
+    int cellY = static_cast<int>(std::floor(y / cellSize));
+    return std::max(0, std::min(gridHeight - 1, cellY));
+}
+
+void ObstacleField::add(const Obstacle& obstacle) {
+    obstacles.push_back(obstacle);
+    revision++;
+    dirty = true;
+}
+
+void ObstacleField::addCircle(const Vec2& center, float radius) {
+    Obstacle obstacle = Obstacle();
+    obstacle.shape = ObstacleShape::Circle;
+    obstacle.center = center;
+    obstacle.radius = radius;
+    add(obstacle);
+}
+
+void ObstacleField::addBox(const Vec2& center, const Vec2& halfExtents, float angle) {
+    Obstacle obstacle = Obstacle();
+    obstacle.shape = ObstacleShape::Box;
+    obstacle.center = center;
+    obstacle.halfExtents = halfExtents;
+    obstacle.angle = angle;
+    obstacle.cosAngle = std::cos(angle);
+    obstacle.sinAngle = std::sin(angle);
+    add(obstacle);
+}
+
+void ObstacleField::addPolyline(const std::vector<Vec2>& points, float thickness, bool closed) {
+    if (points.size() < 2) return;
+    size_t segments = closed ? points.size() : points.size() - 1;
+    for (size_t s = 0; s < segments; s++) {
+        Obstacle obstacle = Obstacle();
+        obstacle.shape = ObstacleShape::Segment;
+        obstacle.a = points[s];
+        obstacle.b = points[(s + 1) % points.size()];
+        obstacle.center = (obstacle.a + obstacle.b) * 0.5f;
+        obstacle.radius = thickness * 0.5f;
+        add(obstacle);
+    }
+}
+
+void ObstacleField::addObstacle(const Obstacle& obstacle) {
+    Obstacle copy = obstacle;
+    if (copy.shape == ObstacleShape::Box) {
+        copy.cosAngle = std::cos(copy.angle);
+        copy.sinAngle = std::sin(copy.angle);
+    }
+    add(copy);
+}
+
+void ObstacleField::clear() {
+    obstacles.clear();
+    revision++;
+    dirty = true;
+}
+
+void ObstacleField::bounds(const Obstacle& obstacle, Vec2& minCorner, Vec2& maxCorner) const {
+    switch (obstacle.shape) {
+        case ObstacleShape::Circle:
+            minCorner = obstacle.center - Vec2(obstacle.radius, obstacle.radius);
+            maxCorner = obstacle.center + Vec2(obstacle.radius, obstacle.radius);
+            break;
+        case ObstacleShape::Box: {
+            //... extensión de la caja girada sobre cada eje
+            float c = std::fabs(obstacle.cosAngle);
+            float s = std::fabs(obstacle.sinAngle);
+            Vec2 extent(c * obstacle.halfExtents.x + s * obstacle.halfExtents.y,
+                        s * obstacle.halfExtents.x + c * obstacle.halfExtents.y);
+            minCorner = obstacle.center - extent;
+            maxCorner = obstacle.center + extent;
+            break;
+        }
+        case ObstacleShape::Segment:
+            minCorner = Vec2(std::min(obstacle.a.x, obstacle.b.x) - obstacle.radius,
+                             std::min(obstacle.a.y, obstacle.b.y) - obstacle.radius);
+            maxCorner = Vec2(std::max(obstacle.a.x, obstacle.b.x) + obstacle.radius,
+                             std::max(obstacle.a.y, obstacle.b.y) + obstacle.radius);
+            break;
+    }
+}
+
+void ObstacleField::rebuild() {
+    if (!dirty) return;
+    dirty = false;
+
+    int numCells = gridWidth * gridHeight;
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+
+    //... dos recorridos (contar y repartir) igual que el counting sort de SpatialGrid,
+    //... pero un obstáculo grande puede entrar en varias celdas
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            for (int c = 0; c < numCells; c++) {
+                cellStart[c + 1] += cellStart[c];
+            }
+            cellObstacles.resize(cellStart[numCells]);
+        }
+        for (size_t o = 0; o < obstacles.size(); o++) {
+            Vec2 minCorner, maxCorner;
+            bounds(obstacles[o], minCorner, maxCorner);
+            int x0 = cellCoordX(minCorner.x), x1 = cellCoordX(maxCorner.x);
+            int y0 = cellCoordY(minCorner.y), y1 = cellCoordY(maxCorner.y);
+            for (int cy = y0; cy <= y1; cy++) {
+                for (int cx = x0; cx <= x1; cx++) {
+                    int cell = cy * gridWidth + cx;
+                    if (pass == 0) {
+                        cellStart[cell + 1]++;
+                    } else {
+                        cellObstacles[cellStart[cell]++] = static_cast<int>(o);
+                    }
+                }
+            }
+        }
+    }
+
+    //... cellStart[c] quedó apuntando al inicio de c+1, se desplaza una posición
+    for (int c = numCells; c > 0; c--) {
+        cellStart[c] = cellStart[c - 1];
+    }
+    cellStart[0] = 0;
+}
+
+float ObstacleField::signedDistance(const Obstacle& obstacle, const Vec2& p, Vec2& normal) {
+    switch (obstacle.shape) {
+        case ObstacleShape::Circle: {
+            Vec2 diff = p - obstacle.center;
+            float dist = std::sqrt(dot(diff, diff));
+            //... en el centro exacto no hay dirección, se empuja hacia arriba
+            normal = dist > 0.0f ? diff / dist : Vec2(0.0f, -1.0f);
+            return dist - obstacle.radius;
+        }
+        case ObstacleShape::Box: {
+            //... a coordenadas locales de la caja
+            Vec2 diff = p - obstacle.center;
+            float c = obstacle.cosAngle, s = obstacle.sinAngle;
+            Vec2 local(c * diff.x + s * diff.y, -s * diff.x + c * diff.y);
+            float qx = std::fabs(local.x) - obstacle.halfExtents.x;
+            float qy = std::fabs(local.y) - obstacle.halfExtents.y;
+
+            Vec2 localNormal;
+            float dist;
+            if (qx > 0.0f || qy > 0.0f) {
+                //... afuera: distancia a la esquina o a la cara más cercana
+                Vec2 outside(std::max(qx, 0.0f), std::max(qy, 0.0f));
+                dist = std::sqrt(dot(outside, outside));
+                localNormal = Vec2(local.x < 0.0f ? -outside.x : outside.x,
+                                   local.y < 0.0f ? -outside.y : outside.y) / dist;
+            } else if (qx > qy) {
+                //... adentro: sale por la cara más cercana
+                dist = qx;
+                localNormal = Vec2(local.x < 0.0f ? -1.0f : 1.0f, 0.0f);
+            } else {
+                dist = qy;
+                localNormal = Vec2(0.0f, local.y < 0.0f ? -1.0f : 1.0f);
+            }
+            normal = Vec2(c * localNormal.x - s * localNormal.y,
+                          s * localNormal.x + c * localNormal.y);
+            return dist;
+        }
+        case ObstacleShape::Segment: {
+            Vec2 ab = obstacle.b - obstacle.a;
+            float len2 = dot(ab, ab);
+            float t = len2 > 0.0f ? dot(p - obstacle.a, ab) / len2 : 0.0f;
+            t = std::max(0.0f, std::min(1.0f, t));
+            Vec2 diff = p - (obstacle.a + ab * t);
+            float dist = std::sqrt(dot(diff, diff));
+            if (dist > 0.0f) {
+                normal = diff / dist;
+            } else {
+                //... sobre el eje del segmento: se usa la perpendicular
+                float len = std::sqrt(len2);
+                normal = len > 0.0f ? Vec2(-ab.y / len, ab.x / len) : Vec2(0.0f, -1.0f);
+            }
+            return dist - obstacle.radius;
+        }
+    }
+    normal = Vec2(0.0f, -1.0f);
+    return 0.0f;
+}
+
+bool ObstacleField::resolve(float& x, float& y, float& vx, float& vy) const {
+    if (obstacles.empty()) return false;
+    bool contact = false;
+    forEachNear(x, y, [&](const Obstacle& obstacle) {
+        Vec2 normal;
+        float dist = signedDistance(obstacle, Vec2(x, y), normal);
+        if (dist < 0.0f) {
+            x -= normal.x * dist;
+            y -= normal.y * dist;
+
+            //... reflexión de velocidad, solo si todavía entra al obstáculo
+            float velDotNormal = vx * normal.x + vy * normal.y;
+            if (velDotNormal < 0.0f) {
+                vx -= 1.8f * velDotNormal * normal.x;
+                vy -= 1.8f * velDotNormal * normal.y;
+            }
+            contact = true;
+        }
+    });
+    return contact;
+}
+
+float ObstacleField::nearestDistance(float x, float y, float maxDistance) const {
+    float nearest = maxDistance;
+    if (obstacles.empty()) return nearest;
+    //... un obstáculo a menos de maxDistance toca alguna celda del cuadrado que lo rodea
+    //... (repetido en varias celdas da la misma distancia, no importa)
+    const int x0 = cellCoordX(x - maxDistance), x1 = cellCoordX(x + maxDistance);
+    const int y0 = cellCoordY(y - maxDistance), y1 = cellCoordY(y + maxDistance);
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            const int cell = cy * gridWidth + cx;
+            for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+                Vec2 normal;
+                nearest = std::min(nearest, signedDistance(obstacles[cellObstacles[k]], Vec2(x, y), normal));
+            }
+        }
+    }
+    return nearest;
+}
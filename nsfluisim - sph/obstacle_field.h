@@ -0,0 +1,92 @@
+// obstacle_field.h
+#pragma once
+#include <vector>
+#include <cstddef>
+#include "vec2.h"
+
+//... formas de obstáculo estático; las polilíneas se guardan como segmentos con grosor
+//... (cápsulas), así cada tramo entra solo en las celdas que toca
+enum class ObstacleShape {
+    Circle,
+    Box,
+    Segment
+};
+
+//... obstáculo primitivo:
+//...   Circle:  center + radius
+//...   Box:     center + halfExtents, girada 'angle' radianes
+//...   Segment: a..b con radio 'radius' (media anchura del trazo)
+struct Obstacle {
+    ObstacleShape shape;
+    Vec2 center;
+    Vec2 halfExtents;
+    float angle;
+    Vec2 a, b;
+    float radius;
+    //... cos/sin del ángulo, precalculados al agregar la caja
+    float cosAngle, sinAngle;
+};
+
+//... conjunto de obstáculos con fase amplia: un grid uniforme (mismo esquema CSR que
+//... SpatialGrid) guarda por celda la lista de obstáculos cuya caja envolvente la toca.
+//... Una partícula solo prueba los obstáculos de su propia celda, así el costo de las
+//... colisiones no crece con el número total de obstáculos sino con los cercanos.
+class ObstacleField {
+private:
+    std::vector<Obstacle> obstacles;
+
+    std::vector<int> cellStart;
+    std::vector<int> cellObstacles;
+    int gridWidth, gridHeight;
+    float cellSize;
+    unsigned revision;
+    bool dirty;
+
+    int cellCoordX(float x) const;
+    int cellCoordY(float y) const;
+    void bounds(const Obstacle& obstacle, Vec2& minCorner, Vec2& maxCorner) const;
+    void add(const Obstacle& obstacle);
+
+public:
+    ObstacleField(int width, int height, float cellSize);
+
+    void addCircle(const Vec2& center, float radius);
+    void addBox(const Vec2& center, const Vec2& halfExtents, float angle = 0.0f);
+    //... polilínea abierta; 'closed' une el último punto con el primero
+    void addPolyline(const std::vector<Vec2>& points, float thickness, bool closed = false);
+    //... copia un obstáculo ya armado (por ejemplo leído de un checkpoint); recalcula
+    //... cos/sin del ángulo de las cajas
+    void addObstacle(const Obstacle& obstacle);
+    void clear();
+
+    //... reconstruye la fase amplia si hubo cambios; llamar antes de las pasadas en paralelo
+    void rebuild();
+
+    //... distancia con signo al obstáculo (negativa dentro) y normal hacia afuera
+    static float signedDistance(const Obstacle& obstacle, const Vec2& p, Vec2& normal);
+
+    //... empuja la partícula fuera de los obstáculos de su celda y refleja la velocidad;
+    //... devuelve true si hubo contacto. Solo lectura sobre el campo, seguro entre hilos
+    bool resolve(float& x, float& y, float& vx, float& vy) const;
+
+    //... distancia con signo a la superficie del obstáculo más cercano, mirando solo las
+    //... celdas a menos de maxDistance de (x, y): si no hay ninguno tan cerca devuelve
+    //... maxDistance. Solo lectura, como resolve()
+    float nearestDistance(float x, float y, float maxDistance) const;
+
+    //... llama visit(obstacle) por cada obstáculo candidato de la celda de (x, y)
+    template <typename Visitor>
+    void forEachNear(float x, float y, Visitor&& visit) const {
+        int cell = cellCoordY(y) * gridWidth + cellCoordX(x);
+        for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+            visit(obstacles[cellObstacles[k]]);
+        }
+    }
+
+    const std::vector<Obstacle>& getObstacles() const { return obstacles; }
+    std::size_t size() const { return obstacles.size(); }
+    bool empty() const { return obstacles.empty(); }
+    //... cambia cada vez que se agregan o borran obstáculos (para cachés de dibujo)
+    unsigned getRevision() const { return revision; }
+    float getCellSize() const { return cellSize; }
+};
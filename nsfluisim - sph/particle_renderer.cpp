@@ -0,0 +1,241 @@
+/*
+Renderizado de la simulación con SFML.
+
+Se separó de ParticleSystem para que la física pueda compilarse y correr sin SFML
+(ver headless_main.cpp). El color de cada partícula se calcula aquí a partir de su
+rapidez, la física no guarda colores.
+
+Antes se llamaba window.draw una vez por partícula con un sf::CircleShape de 30 lados;
+ahora cada partícula es un quad de 4 vértices texturizado con un círculo, todos dentro
+de un mismo VertexArray que se rellena en su lugar cada frame y se dibuja de una vez.
+Los obstáculos forman un segundo lote que solo se reconstruye cuando cambian. En el modo
+de superficie las partículas no se dibujan: la malla del contorno ya viene armada en el
+snapshot y se copia a un tercer lote, así el costo no depende de cuántas hay adentro.
+
+Lo que se dibuja es un RenderSnapshot publicado por el hilo de simulación
+(simulation_thread.h), no el ParticleSystem, que mientras tanto ya avanza el paso siguiente.
+
+Los modelos de malla se dibujan como una textura con un téxel por celda, que se rellena
+cada frame y se estira a la ventana en un solo quad con filtrado bilineal.
+*/
+
+//... particle_renderer.cpp
+#include "particle_renderer.h"
+#include "constants.h"
+#include "particle_system.h"
+#include <cmath>
+#include <algorithm>
+
+static const unsigned CIRCLE_TEXTURE_SIZE = 64;
+static const int OBSTACLE_SEGMENTS = 30;
+
+//... azul más oscuro cuanto más rápida va la partícula
+static sf::Color speedColor(float speed) {
+    int blue = static_cast<int>(255 - speed * 5);
+    blue = std::max(0, std::min(255, blue));
+    return sf::Color(0, 120, blue, 255);
+}
+
+ParticleRenderer::ParticleRenderer()
+    : particleVertices(sf::Quads),
+      obstacleVertices(sf::Triangles),
+      surfaceVertices(sf::Triangles),
+      cachedObstacleRevision(static_cast<unsigned>(-1)) {
+    buildCircleTexture();
+}
+
+//... disco blanco con borde suavizado; el color del vértice lo tiñe
+void ParticleRenderer::buildCircleTexture() {
+    sf::Image image;
+    image.create(CIRCLE_TEXTURE_SIZE, CIRCLE_TEXTURE_SIZE, sf::Color(255, 255, 255, 0));
+    float center = CIRCLE_TEXTURE_SIZE * 0.5f;
+    for (unsigned y = 0; y < CIRCLE_TEXTURE_SIZE; y++) {
+        for (unsigned x = 0; x < CIRCLE_TEXTURE_SIZE; x++) {
+            float dx = x + 0.5f - center;
+            float dy = y + 0.5f - center;
+            float coverage = center - std::sqrt(dx * dx + dy * dy);
+            coverage = std::max(0.0f, std::min(1.0f, coverage));
+            image.setPixel(x, y, sf::Color(255, 255, 255, static_cast<sf::Uint8>(coverage * 255)));
+        }
+    }
+    circleTexture.loadFromImage(image);
+    circleTexture.setSmooth(true);
+}
+
+void ParticleRenderer::updateParticleBatch(const RenderSnapshot& particles) {
+    //... una partícula dividida se dibuja con el radio de su nivel (h / sqrt(2) por nivel)
+    float levelRadius[MAX_RESOLUTION_LEVEL + 1];
+    for (int level = 0; level <= MAX_RESOLUTION_LEVEL; level++) {
+        levelRadius[level] = particles.particleRadius * levelLengthScale(level);
+    }
+    const bool levels = particles.level.size() == particles.size();
+    const float texSize = static_cast<float>(CIRCLE_TEXTURE_SIZE);
+
+    //... resize solo cambia el tamaño si cambió la cantidad de partículas
+    particleVertices.resize(particles.size() * 4);
+    for (size_t i = 0; i < particles.size(); i++) {
+        float x = particles.x[i];
+        float y = particles.y[i];
+        float radius = levelRadius[levels ? particles.level[i] : 0];
+        float speed = std::sqrt(particles.vx[i] * particles.vx[i] + 
+                              particles.vy[i] * particles.vy[i]);
+        sf::Color color = speedColor(speed);
+
+        sf::Vertex* quad = &particleVertices[i * 4];
+        quad[0].position = sf::Vector2f(x - radius, y - radius);
+        quad[1].position = sf::Vector2f(x + radius, y - radius);
+        quad[2].position = sf::Vector2f(x + radius, y + radius);
+        quad[3].position = sf::Vector2f(x - radius, y + radius);
+        quad[0].texCoords = sf::Vector2f(0.0f, 0.0f);
+        quad[1].texCoords = sf::Vector2f(texSize, 0.0f);
+        quad[2].texCoords = sf::Vector2f(texSize, texSize);
+        quad[3].texCoords = sf::Vector2f(0.0f, texSize);
+        quad[0].color = color;
+        quad[1].color = color;
+        quad[2].color = color;
+        quad[3].color = color;
+    }
+}
+
+void ParticleRenderer::updateObstacleBatch(const RenderSnapshot& snapshot) {
+    if (snapshot.obstacleRevision == cachedObstacleRevision) return;
+    cachedObstacleRevision = snapshot.obstacleRevision;
+
+    const sf::Color color(200, 100, 100);
+    obstacleVertices.clear();
+    for (const auto& obstacle : snapshot.obstacles) {
+        switch (obstacle.shape) {
+            case ObstacleShape::Circle:
+                appendDisc(obstacle.center, obstacle.radius, color);
+                break;
+            case ObstacleShape::Box: {
+                float c = obstacle.cosAngle, s = obstacle.sinAngle;
+                float hx = obstacle.halfExtents.x, hy = obstacle.halfExtents.y;
+                sf::Vector2f corners[4];
+                const float signs[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+                for (int k = 0; k < 4; k++) {
+                    float lx = signs[k][0] * hx, ly = signs[k][1] * hy;
+                    corners[k] = sf::Vector2f(obstacle.center.x + c * lx - s * ly,
+                                              obstacle.center.y + s * lx + c * ly);
+                }
+                appendQuad(corners, color);
+                break;
+            }
+            case ObstacleShape::Segment: {
+                //... trazo con grosor + discos en los extremos (forma de cápsula)
+                Vec2 ab = obstacle.b - obstacle.a;
+                float len = std::sqrt(dot(ab, ab));
+                if (len > 0.0f) {
+                    Vec2 n(-ab.y / len * obstacle.radius, ab.x / len * obstacle.radius);
+                    sf::Vector2f corners[4] = {
+                        sf::Vector2f(obstacle.a.x + n.x, obstacle.a.y + n.y),
+                        sf::Vector2f(obstacle.b.x + n.x, obstacle.b.y + n.y),
+                        sf::Vector2f(obstacle.b.x - n.x, obstacle.b.y - n.y),
+                        sf::Vector2f(obstacle.a.x - n.x, obstacle.a.y - n.y)
+                    };
+                    appendQuad(corners, color);
+                }
+                appendDisc(obstacle.a, obstacle.radius, color);
+                appendDisc(obstacle.b, obstacle.radius, color);
+                break;
+            }
+        }
+    }
+}
+
+void ParticleRenderer::updateSurfaceBatch(const RenderSnapshot& snapshot) {
+    const sf::Color color(0, 120, 220);
+    const std::vector<float>& triangles = snapshot.surfaceTriangles;
+    surfaceVertices.resize(triangles.size() / 2);
+    for (size_t v = 0; v < triangles.size() / 2; v++) {
+        surfaceVertices[v].position = sf::Vector2f(triangles[2 * v], triangles[2 * v + 1]);
+        surfaceVertices[v].color = color;
+    }
+}
+
+void ParticleRenderer::appendDisc(const Vec2& position, float radius, const sf::Color& color) {
+    sf::Vector2f center(position.x, position.y);
+    for (int s = 0; s < OBSTACLE_SEGMENTS; s++) {
+        float a0 = 2.0f * PI * s / OBSTACLE_SEGMENTS;
+        float a1 = 2.0f * PI * (s + 1) / OBSTACLE_SEGMENTS;
+        sf::Vector2f p0(center.x + radius * std::cos(a0), center.y + radius * std::sin(a0));
+        sf::Vector2f p1(center.x + radius * std::cos(a1), center.y + radius * std::sin(a1));
+        obstacleVertices.append(sf::Vertex(center, color));
+        obstacleVertices.append(sf::Vertex(p0, color));
+        obstacleVertices.append(sf::Vertex(p1, color));
+    }
+}
+
+void ParticleRenderer::appendQuad(const sf::Vector2f corners[4], const sf::Color& color) {
+    obstacleVertices.append(sf::Vertex(corners[0], color));
+    obstacleVertices.append(sf::Vertex(corners[1], color));
+    obstacleVertices.append(sf::Vertex(corners[2], color));
+    obstacleVertices.append(sf::Vertex(corners[0], color));
+    obstacleVertices.append(sf::Vertex(corners[2], color));
+    obstacleVertices.append(sf::Vertex(corners[3], color));
+}
+
+void ParticleRenderer::render(sf::RenderWindow& window, const RenderSnapshot& snapshot) {
+    updateObstacleBatch(snapshot);
+    if (snapshot.surface) {
+        updateSurfaceBatch(snapshot);
+        window.draw(surfaceVertices);
+    } else {
+        updateParticleBatch(snapshot);
+        window.draw(particleVertices, sf::RenderStates(&circleTexture));
+    }
+    window.draw(obstacleVertices);
+}
+
+void ParticleRenderer::renderField(sf::RenderWindow& window, const GridFluid& fluid) {
+    const unsigned w = static_cast<unsigned>(fluid.getWidth());
+    const unsigned h = static_cast<unsigned>(fluid.getHeight());
+    if (fieldTexture.getSize().x != w || fieldTexture.getSize().y != h) {
+        fieldTexture.create(w, h);
+        fieldTexture.setSmooth(true);
+    }
+    fieldPixels.resize(static_cast<size_t>(w) * h * 4);
+
+    const std::vector<float>& u = fluid.getVelocityX();
+    const std::vector<float>& v = fluid.getVelocityY();
+    const std::vector<float>& rho = fluid.getDensity();
+    const std::vector<unsigned char>& solid = fluid.getSolid();
+    const bool speedShading = fluid.getShading() == FieldShading::Speed;
+    const float maxSpeed = fluid.getStats().maxSpeed;
+    const float inverseSpeed = maxSpeed > 0.0f ? 1.0f / maxSpeed : 0.0f;
+    for (size_t c = 0; c < solid.size(); c++) {
+        sf::Uint8* pixel = &fieldPixels[c * 4];
+        pixel[3] = 255;
+        if (solid[c]) {
+            pixel[0] = 200;
+            pixel[1] = 100;
+            pixel[2] = 100;
+        } else if (speedShading) {
+            //... de azul oscuro (quieto) a celeste (la rapidez máxima del frame)
+            float t = std::sqrt(u[c] * u[c] + v[c] * v[c]) * inverseSpeed;
+            t = std::min(1.0f, t);
+            pixel[0] = static_cast<sf::Uint8>(200 * t * t);
+            pixel[1] = static_cast<sf::Uint8>(40 + 180 * t);
+            pixel[2] = static_cast<sf::Uint8>(80 + 175 * t);
+        } else {
+            //... colorante blanco sobre el fondo; densidad 1 ya es opaco
+            float t = std::max(0.0f, std::min(1.0f, rho[c]));
+            pixel[0] = static_cast<sf::Uint8>(20 + 235 * t);
+            pixel[1] = static_cast<sf::Uint8>(20 + 235 * t);
+            pixel[2] = static_cast<sf::Uint8>(50 + 205 * t);
+        }
+    }
+    fieldTexture.update(fieldPixels.data());
+
+    const sf::Vector2u size = window.getSize();
+    const float sx = static_cast<float>(size.x), sy = static_cast<float>(size.y);
+    const float tx = static_cast<float>(w), ty = static_cast<float>(h);
+    const sf::Color white(255, 255, 255);
+    sf::Vertex quad[4] = {
+        sf::Vertex(sf::Vector2f(0.0f, 0.0f), white, sf::Vector2f(0.0f, 0.0f)),
+        sf::Vertex(sf::Vector2f(sx, 0.0f), white, sf::Vector2f(tx, 0.0f)),
+        sf::Vertex(sf::Vector2f(sx, sy), white, sf::Vector2f(tx, ty)),
+        sf::Vertex(sf::Vector2f(0.0f, sy), white, sf::Vector2f(0.0f, ty))
+    };
+    window.draw(quad, 4, sf::Quads, sf::RenderStates(&fieldTexture));
+}
@@ -0,0 +1,40 @@
+// particle_renderer.h
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "render_snapshot.h"
+#include "grid_fluid.h"
+
+//... dibujo de partículas y obstáculos con SFML; el núcleo físico no conoce esta clase.
+//... Todas las partículas van en un solo VertexArray de quads texturizados con un
+//... círculo (una llamada de dibujo), y los obstáculos en un segundo lote de triángulos.
+//... Dibuja un RenderSnapshot, no el ParticleSystem: puede correr en otro hilo que la física.
+//... Si el snapshot trae la superficie (surface), en vez de las partículas va su malla,
+//... un tercer lote de triángulos.
+//... Los modelos de malla (grid_fluid.h) se dibujan aparte con renderField
+class ParticleRenderer {
+private:
+    sf::Texture circleTexture;
+    sf::VertexArray particleVertices;
+    sf::VertexArray obstacleVertices;
+    sf::VertexArray surfaceVertices;
+    unsigned cachedObstacleRevision;
+    //... una textura de width x height texeles para el campo de los modelos de malla
+    sf::Texture fieldTexture;
+    std::vector<sf::Uint8> fieldPixels;
+
+    void buildCircleTexture();
+    void updateParticleBatch(const RenderSnapshot& snapshot);
+    void updateObstacleBatch(const RenderSnapshot& snapshot);
+    void updateSurfaceBatch(const RenderSnapshot& snapshot);
+    void appendDisc(const Vec2& position, float radius, const sf::Color& color);
+    //... dos triángulos, esquinas en orden
+    void appendQuad(const sf::Vector2f corners[4], const sf::Color& color);
+
+public:
+    ParticleRenderer();
+    void render(sf::RenderWindow& window, const RenderSnapshot& snapshot);
+    //... el campo del modelo estirado a toda la ventana, un téxel por celda: rapidez
+    //... relativa a la máxima o densidad del colorante según getShading(), sólidos como
+    //... los obstáculos. Lee el modelo directo: llamarlo entre dos step()
+    void renderField(sf::RenderWindow& window, const GridFluid& fluid);
+};
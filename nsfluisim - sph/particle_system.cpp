@@ -5,140 +5,722 @@ Aquí se implementa la lógica de la simulación de partículas y obstáculos.
 
 Esta funciona tal que se inicializan las partículas en una cuadrícula y se actualizan
 sus posiciones y velocidades en cada frame. Se manejan colisiones con los bordes de la ventana
-y con obstáculos estáticos.
+y con obstáculos estáticos (ver obstacle_field.h).
 
 Además, se calcula la velocidad promedio de las partículas y se guarda un historial de
-velocidades para su visualización en una gráfica.
+velocidades para su visualización en una gráfica. La reducción va dentro de la pasada
+de colisiones (la última que toca las velocidades del paso), así no hay una segunda
+pasada por todas las partículas, y el historial es un búfer circular de largo fijo.
+
+Para escenas de flujo continuo (un canal con entrada y salida) hay emisores y
+sumideros. Retirar una partícula es un swap-and-pop: la última ocupa su lugar, así los
+arreglos SoA quedan contiguos sin mover nada más, y su id vuelve a una lista libre para
+la próxima que se agregue. Con setParticleCapacity los arreglos se reservan una vez y
+agregar nunca reserva memoria.
+
+Con la resolución adaptativa (ResolutionSettings) la escena arranca con partículas
+gruesas y solo se afina donde hace falta: cada tantos pasos las que están cerca de un
+obstáculo o en la superficie libre se dividen en dos, y lejos de ahí dos vecinas del
+mismo nivel (no necesariamente hijas de la misma madre) se fusionan en una. Dividir
+conserva masa, centro de masa y momento; fusionar también, porque solo se juntan dos
+partículas del mismo nivel (misma masa). Para que una partícula no oscile entre dos
+niveles, la banda para fusionar es más angosta que la de dividir y después de cambiar
+de nivel se queda en él holdSteps pasos.
 */
 #include "particle_system.h"
 #include <random>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+void ParticleData::clear() {
+    x.clear(); y.clear();
+    vx.clear(); vy.clear();
+    fx.clear(); fy.clear();
+    density.clear();
+    pressure.clear();
+    level.clear();
+    id.clear();
+    slot.clear();
+    freeIds.clear();
+}
+
+void ParticleData::reserve(size_t count) {
+    x.reserve(count); y.reserve(count);
+    vx.reserve(count); vy.reserve(count);
+    fx.reserve(count); fy.reserve(count);
+    density.reserve(count);
+    pressure.reserve(count);
+    level.reserve(count);
+    id.reserve(count);
+    slot.reserve(count);
+}
+
+void ParticleData::push_back(const Particle& particle) {
+    x.push_back(particle.position.x);
+    y.push_back(particle.position.y);
+    vx.push_back(particle.velocity.x);
+    vy.push_back(particle.velocity.y);
+    fx.push_back(particle.force.x);
+    fy.push_back(particle.force.y);
+    density.push_back(particle.density);
+    pressure.push_back(particle.pressure);
+    level.push_back(particle.level);
+    //... primero los id de partículas retiradas; si no hay, el siguiente al último
+    int newId;
+    if (freeIds.empty()) {
+        newId = static_cast<int>(slot.size());
+        slot.push_back(0);
+    } else {
+        newId = freeIds.back();
+        freeIds.pop_back();
+    }
+    slot[newId] = static_cast<int>(id.size());
+    id.push_back(newId);
+}
+
+void ParticleData::swapRemove(size_t i) {
+    const size_t last = size() - 1;
+    const int removedId = id[i];
+    if (i != last) {
+        x[i] = x[last]; y[i] = y[last];
+        vx[i] = vx[last]; vy[i] = vy[last];
+        fx[i] = fx[last]; fy[i] = fy[last];
+        density[i] = density[last];
+        pressure[i] = pressure[last];
+        level[i] = level[last];
+        id[i] = id[last];
+        slot[id[i]] = static_cast<int>(i);
+    }
+    x.pop_back(); y.pop_back();
+    vx.pop_back(); vy.pop_back();
+    fx.pop_back(); fy.pop_back();
+    density.pop_back();
+    pressure.pop_back();
+    level.pop_back();
+    id.pop_back();
+    slot[removedId] = -1;
+    freeIds.push_back(removedId);
+}
 
-void ParticleSystem::initializeParticles(int startX, int startY) {
-    const int particlesPerRow = 30;
-    const int particlesPerCol = 30;
-    const float spacing = 8.0f;
+void ParticleData::truncate(size_t count) {
+    while (size() > count) {
+        swapRemove(size() - 1);
+    }
+}
+
+Particle ParticleData::get(size_t i) const {
+    Particle p;
+    p.position = Vec2(x[i], y[i]);
+    p.velocity = Vec2(vx[i], vy[i]);
+    p.force = Vec2(fx[i], fy[i]);
+    p.density = density[i];
+    p.pressure = pressure[i];
+    p.level = level[i];
+    return p;
+}
+
+void ParticleData::set(size_t i, const Particle& particle) {
+    x[i] = particle.position.x;
+    y[i] = particle.position.y;
+    vx[i] = particle.velocity.x;
+    vy[i] = particle.velocity.y;
+    fx[i] = particle.force.x;
+    fy[i] = particle.force.y;
+    density[i] = particle.density;
+    pressure[i] = particle.pressure;
+    level[i] = particle.level;
+}
+
+//... gather por campo usando un solo arreglo temporal que se reutiliza
+static void permuteField(std::vector<float>& field, const std::vector<int>& newToOld,
+                         std::vector<float>& scratch) {
+    scratch.resize(field.size());
+    for (size_t i = 0; i < newToOld.size(); i++) {
+        scratch[i] = field[newToOld[i]];
+    }
+    field.swap(scratch);
+}
+
+void ParticleData::permute(const std::vector<int>& newToOld, std::vector<float>& scratch) {
+    permuteField(x, newToOld, scratch);
+    permuteField(y, newToOld, scratch);
+    permuteField(vx, newToOld, scratch);
+    permuteField(vy, newToOld, scratch);
+    permuteField(fx, newToOld, scratch);
+    permuteField(fy, newToOld, scratch);
+    permuteField(density, newToOld, scratch);
+    permuteField(pressure, newToOld, scratch);
+
+    std::vector<unsigned char> oldLevels(level);
+    std::vector<int> oldIds(id);
+    for (size_t i = 0; i < newToOld.size(); i++) {
+        level[i] = oldLevels[newToOld[i]];
+        id[i] = oldIds[newToOld[i]];
+        slot[id[i]] = static_cast<int>(i);
+    }
+}
+
+void ParticleSystem::initializeParticles(float startX, float startY) {
+    const int particlesPerRow = blockColumns;
+    const float spacing = particleSpacing;
     
-    for (int y = 0; y < particlesPerCol; y++) {
-        for (int x = 0; x < particlesPerRow; x++) {
-            Particle p;
-            p.position = sf::Vector2f(startX + x * spacing, startY + y * spacing);
-            p.velocity = sf::Vector2f(0.0f, 0.0f);
-            p.force = sf::Vector2f(0.0f, 0.0f);
-            p.density = 0.0f;
-            p.pressure = 0.0f;
-            p.color = sf::Color(0, 120, 255, 255);
-            particles.push_back(p);
-        }
+    //... filas completas de particlesPerRow; la última puede quedar a medias
+    particles.reserve(particles.size() + blockParticles);
+    for (int i = 0; i < blockParticles; i++) {
+        int x = i % particlesPerRow;
+        int y = i / particlesPerRow;
+        Particle p;
+        p.position = Vec2(startX + x * spacing, startY + y * spacing);
+        p.velocity = Vec2(0.0f, 0.0f);
+        p.force = Vec2(0.0f, 0.0f);
+        p.density = 0.0f;
+        p.pressure = 0.0f;
+        particles.push_back(p);
     }
 }
 
 void ParticleSystem::update() {
-    for (auto& particle : particles) {
-        particle.velocity += particle.force * deltaTime;
-        particle.position += particle.velocity * deltaTime;
-        
-        //... colisiones con bordes
-        if (particle.position.x < 0.0f) {
-            particle.position.x = 0.0f;
-            particle.velocity.x *= -0.5f;
+    stepCount++;
+    simulatedTime += deltaTime;
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Integration);
+        integrate();
+    }
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Collisions);
+        resolveCollisions();
+    }
+    //... desde aquí los índices pueden cambiar
+    sleepMask.clear();
+    adaptResolution();
+    updateSources();
+}
+
+void ParticleSystem::setParticleCapacity(size_t count) {
+    particleCapacity = count;
+    particles.reserve(count);
+}
+
+void ParticleSystem::updateSources() {
+    if (emitters.empty() && sinks.empty()) return;
+    ScopedTimer timer(profiler, ProfilePhase::Emission);
+    const size_t before = particles.size();
+    const unsigned long long retiredBefore = retiredCount;
+
+    if (!sinks.empty()) {
+        retireList.clear();
+        const int count = static_cast<int>(particles.size());
+        for (int i = 0; i < count; i++) {
+            const float x = particles.x[i];
+            const float y = particles.y[i];
+            for (const Sink& sink : sinks) {
+                if (x >= sink.minCorner.x && x <= sink.maxCorner.x &&
+                    y >= sink.minCorner.y && y <= sink.maxCorner.y) {
+                    retireList.push_back(i);
+                    break;
+                }
+            }
         }
-        if (particle.position.x > WINDOW_WIDTH) {
-            particle.position.x = WINDOW_WIDTH;
-            particle.velocity.x *= -0.5f;
+        //... de atrás hacia adelante: la última partícula nunca es una ya marcada
+        for (size_t k = retireList.size(); k-- > 0;) {
+            //... el id queda libre: la que lo tome no hereda la espera de esta
+            const size_t id = static_cast<size_t>(particles.id[retireList[k]]);
+            if (id < levelChangeStep.size()) levelChangeStep[id] = 0;
+            particles.swapRemove(retireList[k]);
         }
-        if (particle.position.y < 0.0f) {
-            particle.position.y = 0.0f;
-            particle.velocity.y *= -0.5f;
+        retiredCount += retireList.size();
+    }
+
+    for (Emitter& emitter : emitters) {
+        float speed = std::sqrt(dot(emitter.velocity, emitter.velocity));
+        if (speed <= 0.0f) continue;
+        Vec2 direction = emitter.velocity / speed;
+        Vec2 across(-direction.y, direction.x);
+        int perRow = std::max(1, static_cast<int>(emitter.width / particleSpacing) + 1);
+
+        //... cada fila sale al recorrer una separación; la más vieja ya avanzó lo que
+        //... sobra del paso, así el espaciado no depende de dt
+        emitter.travelled += speed * deltaTime;
+        while (emitter.travelled >= particleSpacing) {
+            emitter.travelled -= particleSpacing;
+            Vec2 rowCenter = emitter.position + direction * emitter.travelled;
+            for (int k = 0; k < perRow; k++) {
+                if (particleCapacity > 0 && particles.size() >= particleCapacity) {
+                    rejectedCount++;
+                    continue;
+                }
+                Particle p;
+                p.position = rowCenter + across * ((k - (perRow - 1) * 0.5f) * particleSpacing);
+                p.velocity = emitter.velocity;
+                p.force = Vec2(0.0f, 0.0f);
+                p.density = 0.0f;
+                p.pressure = 0.0f;
+                particles.push_back(p);
+                spawnedCount++;
+            }
         }
-        if (particle.position.y > WINDOW_HEIGHT) {
-            particle.position.y = WINDOW_HEIGHT;
-            particle.velocity.y *= -0.5f;
+    }
+
+    if (particles.size() != before || retiredCount != retiredBefore) {
+        indexRevision++;
+    }
+}
+
+void ParticleSystem::setResolutionSettings(const ResolutionSettings& settings) {
+    resolution = settings;
+    resolution.maxLevel = std::max(0, std::min(MAX_RESOLUTION_LEVEL, settings.maxLevel));
+    resolution.obstacleBand = std::max(settings.obstacleBand, 1.0e-3f);
+    resolution.surfaceDensity = std::max(settings.surfaceDensity, 0.0f);
+    resolution.interval = std::max(settings.interval, 1);
+    resolution.holdSteps = std::max(settings.holdSteps, 0);
+}
+
+bool ParticleSystem::hasRefinedParticles() const {
+    for (int level = 1; level <= MAX_RESOLUTION_LEVEL; level++) {
+        if (resolutionStats.levelCounts[level] > 0) return true;
+    }
+    return false;
+}
+
+int ParticleSystem::getFinestLevel() const {
+    int finest = resolution.maxLevel;
+    for (int level = finest + 1; level <= MAX_RESOLUTION_LEVEL; level++) {
+        if (resolutionStats.levelCounts[level] > 0) finest = level;
+    }
+    return finest;
+}
+
+void ParticleSystem::countLevels() {
+    std::fill(std::begin(resolutionStats.levelCounts), std::end(resolutionStats.levelCounts), 0);
+    for (unsigned char level : particles.level) {
+        resolutionStats.levelCounts[level]++;
+    }
+}
+
+int ParticleSystem::obstacleLevel(float distance) const {
+    if (distance <= 0.0f) return resolution.maxLevel;
+    int bands = static_cast<int>(distance / resolution.obstacleBand);
+    return std::max(0, resolution.maxLevel - bands);
+}
+
+//... con la fracción de la densidad media que marca la superficie, la que la marca para
+//... no fusionar (un margen, así una partícula en el borde no se divide y se fusiona una
+//... revisión sí y otra no) y lo mismo con una banda de distancia a los obstáculos
+static const float KEEP_DENSITY_MARGIN = 1.5f;
+static const float KEEP_BAND_MARGIN = 1.0f;
+//... dos candidatas del mismo nivel que quedan seguidas al ordenar por (nivel, celda) se
+//... fusionan si están a menos de este múltiplo de la separación de su nivel
+static const float MERGE_DISTANCE = 1.25f;
+
+void ParticleSystem::adaptResolution() {
+    if (resolution.maxLevel == 0 && !hasRefinedParticles()) return;
+    if (particles.empty() || stepCount % static_cast<unsigned long long>(resolution.interval) != 0) return;
+    ScopedTimer timer(profiler, ProfilePhase::Resolution);
+    const int count = static_cast<int>(particles.size());
+    const int grain = chunkGrain(threadPool, count);
+
+    //... densidad media del paso; las recién emitidas todavía no tienen densidad
+    densitySums.assign(chunkTotal(count, grain), DensitySumPartial{0.0, 0});
+    parallelChunks(threadPool, count, grain, [&](int begin, int end) {
+        DensitySumPartial partial{0.0, 0};
+        for (int i = begin; i < end; i++) {
+            if (particles.density[i] > 0.0f) {
+                partial.sum += particles.density[i];
+                partial.count++;
+            }
         }
+        densitySums[begin / grain] = partial;
+    });
+    DensitySumPartial total{0.0, 0};
+    for (const auto& partial : densitySums) {
+        total.sum += partial.sum;
+        total.count += partial.count;
+    }
+    const float averageDensity = total.count > 0 ? static_cast<float>(total.sum / total.count) : 0.0f;
+    const float surfaceLimit = resolution.surfaceDensity * averageDensity;
+    const float keepLimit = surfaceLimit * KEEP_DENSITY_MARGIN;
 
-        //... colisiones con obstáculos
-        for (const auto& obstacle : obstacles) {
-            sf::Vector2f obsPos = obstacle.getPosition() + sf::Vector2f(25.0f, 25.0f);
-            sf::Vector2f diff = particle.position - obsPos;
-            float dist = std::sqrt(diff.x * diff.x + diff.y * diff.y);
-            if (dist < 25.0f) {
-                sf::Vector2f normal = diff / dist;
-                particle.position = obsPos + normal * 25.0f;
-                
-                //... reflexión de velocidad
-                float velDotNormal = particle.velocity.x * normal.x + 
-                                   particle.velocity.y * normal.y;
-                particle.velocity -= 1.8f * velDotNormal * normal;
+    //... nivel pedido por cada partícula: para dividirse y, con los márgenes, para seguir
+    //... dividida; solo leen el campo de obstáculos (ya reconstruido en las colisiones)
+    const float band = resolution.obstacleBand;
+    const float reach = band * (resolution.maxLevel + 1);
+    splitLevels.resize(count);
+    keepLevels.resize(count);
+    parallelChunks(threadPool, count, grain, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            float distance = obstacles.nearestDistance(particles.x[i], particles.y[i], reach);
+            float density = particles.density[i];
+            bool surface = density > 0.0f && density < surfaceLimit;
+            bool nearSurface = density > 0.0f && density < keepLimit;
+            int split = surface ? resolution.maxLevel : obstacleLevel(distance);
+            int keep = nearSurface ? resolution.maxLevel : obstacleLevel(distance - KEEP_BAND_MARGIN * band);
+            splitLevels[i] = static_cast<unsigned char>(split);
+            keepLevels[i] = static_cast<unsigned char>(std::max(split, keep));
+        }
+    });
+
+    //... una partícula que cambió de nivel hace menos de holdSteps pasos se queda en él:
+    //... el paso anterior dice poco de lo que va a medir con el h nuevo
+    if (levelChangeStep.size() < particles.slot.size()) levelChangeStep.resize(particles.slot.size(), 0);
+    auto held = [&](int i) {
+        const unsigned long long changed = levelChangeStep[particles.id[i]];
+        return changed != 0 && stepCount + 1 - changed < static_cast<unsigned long long>(resolution.holdSteps);
+    };
+
+    //... fusiones: candidatas ordenadas por nivel y celda (de lado la distancia de fusión
+    //... del nivel), y de a dos, en ese orden, dentro de la misma celda si están cerca. keepLevels >=
+    //... splitLevels, así ninguna candidata se divide en esta misma revisión
+    mergeCandidates.clear();
+    for (int i = 0; i < count; i++) {
+        const int level = particles.level[i];
+        if (level == 0 || keepLevels[i] >= level || held(i)) continue;
+        const float cell = MERGE_DISTANCE * getLevelSpacing(level);
+        unsigned long long cellX = static_cast<unsigned long long>(std::max(0.0f, std::floor(particles.x[i] / cell)));
+        unsigned long long cellY = static_cast<unsigned long long>(std::max(0.0f, std::floor(particles.y[i] / cell)));
+        unsigned long long key = (static_cast<unsigned long long>(level) << 56) |
+                                 (std::min(cellY, 0xFFFFFFFull) << 28) | std::min(cellX, 0xFFFFFFFull);
+        mergeCandidates.push_back(std::make_pair(key, i));
+    }
+    std::sort(mergeCandidates.begin(), mergeCandidates.end());
+    mergedAway.clear();
+    for (size_t k = 0; k + 1 < mergeCandidates.size();) {
+        const int a = mergeCandidates[k].second;
+        const int b = mergeCandidates[k + 1].second;
+        const float limit = MERGE_DISTANCE * getLevelSpacing(particles.level[a]);
+        const float dx = particles.x[b] - particles.x[a];
+        const float dy = particles.y[b] - particles.y[a];
+        if (mergeCandidates[k].first != mergeCandidates[k + 1].first || dx * dx + dy * dy > limit * limit) {
+            k++;
+            continue;
+        }
+        //... misma masa: centro de masa y velocidad media, así se conserva el momento
+        particles.x[a] += 0.5f * dx;
+        particles.y[a] += 0.5f * dy;
+        particles.vx[a] = 0.5f * (particles.vx[a] + particles.vx[b]);
+        particles.vy[a] = 0.5f * (particles.vy[a] + particles.vy[b]);
+        particles.fx[a] = 0.5f * (particles.fx[a] + particles.fx[b]);
+        particles.fy[a] = 0.5f * (particles.fy[a] + particles.fy[b]);
+        particles.density[a] = 0.5f * (particles.density[a] + particles.density[b]);
+        particles.pressure[a] = 0.5f * (particles.pressure[a] + particles.pressure[b]);
+        particles.level[a]--;
+        levelChangeStep[particles.id[a]] = stepCount + 1;
+        //... el id de b queda libre y lo va a tomar otra partícula
+        levelChangeStep[particles.id[b]] = 0;
+        mergedAway.push_back(b);
+        resolutionStats.merges++;
+        k += 2;
+    }
+
+    //... divisiones: las hijas quedan a +-1/4 de la separación de la celda que ocupaba la
+    //... madre, alternando el eje por nivel (x en los pares), así dos niveles seguidos
+    //... parten un cuadrado de la cuadrícula en cuatro
+    const float width = static_cast<float>(domainWidth);
+    const float height = static_cast<float>(domainHeight);
+    for (int i = 0; i < count; i++) {
+        const int level = particles.level[i];
+        if (splitLevels[i] <= level || held(i)) continue;
+        if (particleCapacity > 0 && particles.size() >= particleCapacity) break;
+        const float offset = 0.25f * particleSpacing * std::ldexp(1.0f, -(level / 2));
+        Particle child = particles.get(i);
+        child.level = static_cast<unsigned char>(level + 1);
+        if (level % 2 == 0) {
+            child.position.x = std::min(width, child.position.x + offset);
+            particles.x[i] = std::max(0.0f, particles.x[i] - offset);
+        } else {
+            child.position.y = std::min(height, child.position.y + offset);
+            particles.y[i] = std::max(0.0f, particles.y[i] - offset);
+        }
+        particles.level[i] = child.level;
+        particles.push_back(child);
+        levelChangeStep[particles.id[i]] = stepCount + 1;
+        if (levelChangeStep.size() < particles.slot.size()) levelChangeStep.resize(particles.slot.size(), 0);
+        levelChangeStep[particles.id.back()] = stepCount + 1;
+        resolutionStats.splits++;
+    }
+
+    //... de atrás hacia adelante, como los sumideros
+    std::sort(mergedAway.begin(), mergedAway.end());
+    for (size_t k = mergedAway.size(); k-- > 0;) {
+        particles.swapRemove(mergedAway[k]);
+    }
+    if (particles.size() != static_cast<size_t>(count) || !mergedAway.empty()) {
+        indexRevision++;
+    }
+    countLevels();
+}
+
+void ParticleSystem::integrate() {
+    const int count = static_cast<int>(particles.size());
+    float* px = particles.x.data();
+    float* py = particles.y.data();
+    float* pvx = particles.vx.data();
+    float* pvy = particles.vy.data();
+    const float* pfx = particles.fx.data();
+    const float* pfy = particles.fy.data();
+    //... las dormidas quedan donde están, con velocidad 0
+    const unsigned char* asleep = sleepMask.size() == particles.size() ? sleepMask.data() : nullptr;
+
+    //... cada partícula solo toca su propio estado, los trozos son independientes
+    parallelChunks(threadPool, count, chunkGrain(threadPool, count), [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            if (asleep && asleep[i]) continue;
+            pvx[i] += pfx[i] * deltaTime;
+            pvy[i] += pfy[i] * deltaTime;
+            px[i] += pvx[i] * deltaTime;
+            py[i] += pvy[i] * deltaTime;
+        }
+    });
+}
+
+void ParticleSystem::resolveCollisions() {
+    //... la fase amplia se reconstruye aquí, antes de repartir, y los hilos solo la leen
+    obstacles.rebuild();
+
+    const int count = static_cast<int>(particles.size());
+    const float width = static_cast<float>(domainWidth);
+    const float height = static_cast<float>(domainHeight);
+    float* px = particles.x.data();
+    float* py = particles.y.data();
+    float* pvx = particles.vx.data();
+    float* pvy = particles.vy.data();
+
+    //... en los pasos muestreados cada trozo deja además su parcial de estadísticas
+    const bool sample = stepCount % static_cast<unsigned long long>(statisticsInterval) == 0;
+    const int grain = chunkGrain(threadPool, count);
+    if (sample) {
+        statsPartials.assign(chunkTotal(count, grain), StatsPartial{0.0f, 0.0f, 0.0f});
+        statsParticleCount = particles.size();
+        statsSampled = true;
+    }
+    //... energía cinética con la masa del nivel de cada partícula
+    float halfMass[MAX_RESOLUTION_LEVEL + 1];
+    for (int level = 0; level <= MAX_RESOLUTION_LEVEL; level++) {
+        halfMass[level] = 0.5f * getLevelMass(level);
+    }
+    const unsigned char* plevel = particles.level.data();
+
+    parallelChunks(threadPool, count, grain, [&](int begin, int end) {
+        StatsPartial partial{0.0f, 0.0f, 0.0f};
+        for (int i = begin; i < end; i++) {
+            //... colisiones con bordes
+            if (px[i] < 0.0f) {
+                px[i] = 0.0f;
+                pvx[i] *= -0.5f;
+            }
+            if (px[i] > width) {
+                px[i] = width;
+                pvx[i] *= -0.5f;
+            }
+            if (py[i] < 0.0f) {
+                py[i] = 0.0f;
+                pvy[i] *= -0.5f;
+            }
+            if (py[i] > height) {
+                py[i] = height;
+                pvy[i] *= -0.5f;
+            }
+
+            //... colisiones con obstáculos: solo los de la celda de la partícula
+            obstacles.resolve(px[i], py[i], pvx[i], pvy[i]);
+
+            if (sample) {
+                float speed2 = pvx[i] * pvx[i] + pvy[i] * pvy[i];
+                partial.speedSum += std::sqrt(speed2);
+                partial.maxSpeed2 = std::max(partial.maxSpeed2, speed2);
+                partial.kineticEnergy += halfMass[plevel[i]] * speed2;
             }
         }
-        
-        //... actualización de color basada en velocidad
-        float speed = std::sqrt(particle.velocity.x * particle.velocity.x + 
-                              particle.velocity.y * particle.velocity.y);
-        int blue = static_cast<int>(255 - speed * 5);
-        blue = std::max(0, std::min(255, blue));
-        particle.color = sf::Color(0, 120, blue, 255);
+        if (sample) statsPartials[begin / grain] = partial;
+    });
+}
+
+//... intercala los bits de x e y (x en los pares): celdas cercanas dan claves cercanas
+static unsigned mortonKey(unsigned cellX, unsigned cellY) {
+    auto spread = [](unsigned v) {
+        v &= 0xFFFF;
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return spread(cellX) | (spread(cellY) << 1);
+}
+
+//... con REORDER_ADAPTIVE se mide el desorden cada tantos pasos, y se reordena si
+//... más de la fracción indicada de partículas quedó fuera de orden
+static const int ADAPTIVE_CHECK_STEPS = 25;
+static const float ADAPTIVE_DISORDER_THRESHOLD = 0.2f;
+
+void ParticleSystem::computeMortonKeys(float cellSize) {
+    const int count = static_cast<int>(particles.size());
+    mortonKeys.resize(count);
+    const float inverseCell = 1.0f / cellSize;
+    const float* px = particles.x.data();
+    const float* py = particles.y.data();
+    parallelChunks(threadPool, count, chunkGrain(threadPool, count), [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            //... igual que SpatialGrid, las partículas fuera de la ventana van a la celda 0
+            int cellX = std::max(0, static_cast<int>(std::floor(px[i] * inverseCell)));
+            int cellY = std::max(0, static_cast<int>(std::floor(py[i] * inverseCell)));
+            mortonKeys[i] = mortonKey(static_cast<unsigned>(cellX), static_cast<unsigned>(cellY));
+        }
+    });
+}
+
+float ParticleSystem::mortonDisorder() const {
+    if (mortonKeys.size() < 2) return 0.0f;
+    int outOfOrder = 0;
+    for (size_t i = 1; i < mortonKeys.size(); i++) {
+        if (mortonKeys[i] < mortonKeys[i - 1]) outOfOrder++;
     }
+    return static_cast<float>(outOfOrder) / static_cast<float>(mortonKeys.size() - 1);
 }
 
-void ParticleSystem::render(sf::RenderWindow& window) {
-    sf::CircleShape shape(smoothingLength * 0.5f);
-    shape.setOrigin(smoothingLength * 0.5f, smoothingLength * 0.5f);
-    
-    for (const auto& particle : particles) {
-        shape.setPosition(particle.position);
-        shape.setFillColor(particle.color);
-        window.draw(shape);
+void ParticleSystem::reorderSpatially(float cellSize) {
+    ScopedTimer timer(profiler, ProfilePhase::Reorder);
+    computeMortonKeys(cellSize);
+
+    //... orden estable por clave: dentro de una celda se conserva el orden anterior,
+    //... así el resultado no depende de la cantidad de hilos
+    const int count = static_cast<int>(particles.size());
+    reorderOrder.resize(count);
+    for (int i = 0; i < count; i++) reorderOrder[i] = i;
+    std::stable_sort(reorderOrder.begin(), reorderOrder.end(), [&](int a, int b) {
+        return mortonKeys[a] < mortonKeys[b];
+    });
+
+    particles.permute(reorderOrder, reorderScratch);
+    oldToNew.resize(count);
+    for (int i = 0; i < count; i++) {
+        oldToNew[reorderOrder[i]] = i;
     }
-    
-    for (const auto& obstacle : obstacles) {
-        window.draw(obstacle);
+    stepsSinceReorder = 0;
+    reorderCount++;
+    indexRevision++;
+}
+
+void ParticleSystem::maybeReorder(float cellSize) {
+    if (reorderInterval == REORDER_OFF || particles.empty()) return;
+    stepsSinceReorder++;
+    if (reorderInterval > 0) {
+        if (stepsSinceReorder >= reorderInterval) {
+            reorderSpatially(cellSize);
+        }
+        return;
+    }
+
+    //... adaptativo: medir sale mucho más barato que reordenar
+    if (stepsSinceReorder % ADAPTIVE_CHECK_STEPS != 0) return;
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Reorder);
+        computeMortonKeys(cellSize);
+    }
+    if (mortonDisorder() > ADAPTIVE_DISORDER_THRESHOLD) {
+        reorderSpatially(cellSize);
     }
 }
 
 void ParticleSystem::reset() {
     particles.clear();
     obstacles.clear();
-    initializeParticles(WINDOW_WIDTH/4, WINDOW_HEIGHT/4);
+    clearSources();
+    spawnedCount = 0;
+    retiredCount = 0;
+    rejectedCount = 0;
+    resolutionStats = ResolutionStats{0, 0, {}};
+    levelChangeStep.clear();
+    indexRevision++;
+    sleepMask.clear();
+    initializeParticles(blockX, blockY);
+    countLevels();
     velocityHistory.clear();
+    statsSampled = false;
+    oldToNew.clear();
+    stepsSinceReorder = 0;
+    stepCount = 0;
+    simulatedTime = 0.0;
     isPaused = false;
 }
 
+void ParticleSystem::restore(ParticleData data, const std::vector<Obstacle>& obstacleList,
+                             unsigned long long steps, double time) {
+    particles = std::move(data);
+    //... un estado sin niveles (un checkpoint viejo) es todo de la resolución de la escena
+    if (particles.level.size() != particles.size()) particles.level.assign(particles.size(), 0);
+    countLevels();
+    levelChangeStep.clear();
+    if (particleCapacity > 0) particles.reserve(particleCapacity);
+    indexRevision++;
+    sleepMask.clear();
+    statsSampled = false;
+    obstacles.clear();
+    for (const auto& obstacle : obstacleList) {
+        obstacles.addObstacle(obstacle);
+    }
+    velocityHistory.clear();
+    oldToNew.clear();
+    stepsSinceReorder = 0;
+    stepCount = steps;
+    simulatedTime = time;
+}
+
 void ParticleSystem::togglePause() {
     isPaused = !isPaused;
 }
 
 void ParticleSystem::handleMouseInput(int x, int y) {
-    sf::CircleShape obstacle(25.0f);
-    obstacle.setPosition(x - 25.0f, y - 25.0f);
-    obstacle.setFillColor(sf::Color(200, 100, 100));
-    obstacles.push_back(obstacle);
+    obstacles.addCircle(Vec2(static_cast<float>(x), static_cast<float>(y)), 25.0f);
+}
+
+void ParticleSystem::reduceStatistics() {
+    const int n = static_cast<int>(particles.size());
+    const int grain = chunkGrain(threadPool, n);
+    statsPartials.assign(chunkTotal(n, grain), StatsPartial{0.0f, 0.0f, 0.0f});
+    parallelChunks(threadPool, n, grain, [&](int begin, int end) {
+        StatsPartial partial{0.0f, 0.0f, 0.0f};
+        for (int i = begin; i < end; i++) {
+            float speed2 = particles.vx[i] * particles.vx[i] + particles.vy[i] * particles.vy[i];
+            partial.speedSum += std::sqrt(speed2);
+            partial.maxSpeed2 = std::max(partial.maxSpeed2, speed2);
+            partial.kineticEnergy += 0.5f * getLevelMass(particles.level[i]) * speed2;
+        }
+        statsPartials[begin / grain] = partial;
+    });
+    statsParticleCount = particles.size();
+    statsSampled = true;
 }
 
 void ParticleSystem::updateStatistics() {
-    averageVelocity = 0;
-    maxVelocity = 0;
-    totalKineticEnergy = 0;
-    
-    for (const auto& particle : particles) {
-        float speed = std::sqrt(particle.velocity.x * particle.velocity.x + 
-                              particle.velocity.y * particle.velocity.y);
-        averageVelocity += speed;
-        maxVelocity = std::max(maxVelocity, speed);
-        totalKineticEnergy += 0.5f * particleMass * speed * speed;
+    ScopedTimer timer(profiler, ProfilePhase::Statistics);
+    if (!statsSampled) {
+        reduceStatistics();
     }
-    
-    if (!particles.empty()) {
-        averageVelocity /= particles.size();
+
+    //... parciales sumados en orden de trozo: el resultado no depende de los hilos
+    float speedSum = 0.0f;
+    float maxSpeed2 = 0.0f;
+    totalKineticEnergy = 0.0f;
+    for (const auto& partial : statsPartials) {
+        speedSum += partial.speedSum;
+        maxSpeed2 = std::max(maxSpeed2, partial.maxSpeed2);
+        totalKineticEnergy += partial.kineticEnergy;
     }
-    
-    //... guardamos historial de velocidades para gráfica
-    velocityHistory.push_back(averageVelocity);
-    if (velocityHistory.size() > 200) { //... mantener solo últimos 200 frames
-        velocityHistory.erase(velocityHistory.begin());
+    averageVelocity = statsParticleCount > 0 ? speedSum / statsParticleCount : 0.0f;
+    maxVelocity = std::sqrt(maxSpeed2);
+
+    velocityHistory.push(averageVelocity);
+}
+
+std::vector<Particle> ParticleSystem::getParticles() const {
+    std::vector<Particle> view;
+    view.reserve(particles.size());
+    for (size_t i = 0; i < particles.size(); i++) {
+        view.push_back(particles.get(i));
     }
+    return view;
 }
 
-const std::vector<Particle>& ParticleSystem::getParticles() const { return particles; }
-std::vector<Particle>& ParticleSystem::getParticles() { return particles; }
 float ParticleSystem::getSmoothingLength() const { return smoothingLength; }
 float ParticleSystem::getParticleMass() const { return particleMass; }
@@ -1,57 +1,382 @@
 // particle_system.h
 #pragma once
 #include <vector>
-#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <utility>
 #include "constants.h"
+#include "vec2.h"
+#include "thread_pool.h"
+#include "profiler.h"
+#include "obstacle_field.h"
+#include "ring_buffer.h"
 
+//... vista AoS de una partícula, solo para código que necesita una partícula completa;
+//... el almacenamiento real es ParticleData
 struct Particle {
-    sf::Vector2f position;
-    sf::Vector2f velocity;
-    sf::Vector2f force;
+    Vec2 position;
+    Vec2 velocity;
+    Vec2 force;
     float density;
     float pressure;
-    sf::Color color;
+    //... nivel de resolución (ver ParticleData::level)
+    unsigned char level = 0;
 };
 
+//... almacenamiento SoA: un arreglo contiguo por campo, así la pasada de densidad
+//... solo lee x/y y no arrastra velocidad, fuerza y color en cada línea de caché
+struct ParticleData {
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;
+    std::vector<float> fx, fy;
+    std::vector<float> density;
+    std::vector<float> pressure;
+    //... nivel de resolución: 0 es la partícula de la escena (masa y h del sistema) y cada
+    //... nivel más divide la masa por 2 y h por sqrt(2) (ver ResolutionSettings)
+    std::vector<unsigned char> level;
+    //... identificador estable de cada partícula (no cambia al reordenar) y su inverso:
+    //... slot[id] es la posición actual de la partícula 'id'. Los id de las partículas
+    //... retiradas quedan en freeIds (slot = -1) y se reutilizan al agregar; id y freeIds
+    //... juntos son siempre una permutación de 0..slot.size()-1
+    std::vector<int> id;
+    std::vector<int> slot;
+    std::vector<int> freeIds;
+
+    size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+    void clear();
+    void reserve(size_t count);
+    void push_back(const Particle& particle);
+    Particle get(size_t i) const;
+    void set(size_t i, const Particle& particle);
+    //... retira la partícula i moviendo la última a su lugar (O(1), sin reservar); cambia
+    //... el índice de la última, su id no
+    void swapRemove(size_t i);
+    //... reordena todos los campos: la nueva partícula i es la antigua newToOld[i]
+    void permute(const std::vector<int>& newToOld, std::vector<float>& scratch);
+    //... retira las partículas desde 'count' hasta el final (sus id quedan libres)
+    void truncate(size_t count);
+};
+
+//... intervalo de reordenamiento: fijo en K pasos, apagado, o adaptativo (se mide el
+//... desorden cada pocos pasos y se reordena cuando pasa un umbral)
+const int REORDER_OFF = 0;
+const int REORDER_ADAPTIVE = -1;
+
+//... emisor: una boca de ancho 'width' centrada en 'position' que larga partículas a
+//... 'velocity' (la boca queda perpendicular a la velocidad). Salen filas separadas por
+//... la separación del bloque inicial, así el chorro entra con la densidad de reposo
+struct Emitter {
+    Vec2 position;
+    Vec2 velocity;
+    float width;
+    //... distancia recorrida desde la última fila (estado interno, arranca en 0)
+    float travelled;
+};
+
+//... sumidero: caja alineada a los ejes; las partículas que entran se retiran
+struct Sink {
+    Vec2 minCorner;
+    Vec2 maxCorner;
+};
+
+//... resolución adaptativa: cerca de los obstáculos y en la superficie libre una partícula
+//... se divide en dos hijas con la mitad de la masa y h / sqrt(2) (la misma área por
+//... partícula repartida en dos, así la densidad no cambia), y lejos de ahí dos vecinas
+//... del mismo nivel, sean o no hijas de la misma madre, se fusionan en una. Con maxLevel = 0 está apagada y
+//... todas las partículas tienen la masa y el h del sistema
+const int MAX_RESOLUTION_LEVEL = 6;
+
+struct ResolutionSettings {
+    int maxLevel;
+    //... ancho de cada banda alrededor de los obstáculos: a menos de una banda se pide
+    //... maxLevel, a menos de dos maxLevel - 1, y así hasta el nivel 0
+    float obstacleBand;
+    //... superficie libre: densidad por debajo de esta fracción de la media del paso
+    float surfaceDensity;
+    //... pasos entre revisiones; cada revisión sube o baja a lo sumo un nivel
+    int interval;
+    //... pasos que una partícula se queda en un nivel antes de poder cambiarlo otra vez
+    int holdSteps;
+};
+
+struct ResolutionStats {
+    unsigned long long splits;
+    unsigned long long merges;
+    //... partículas por nivel tras la última revisión
+    size_t levelCounts[MAX_RESOLUTION_LEVEL + 1];
+};
+
+//... escalas de un nivel respecto de la partícula de la escena
+inline float levelMassScale(int level) { return std::ldexp(1.0f, -level); }
+inline float levelLengthScale(int level) { return std::sqrt(levelMassScale(level)); }
+
 class ParticleSystem {
 private:
-    std::vector<Particle> particles;
-    std::vector<sf::CircleShape> obstacles;
+    ParticleData particles;
+    ObstacleField obstacles;
+    //... dominio [0, domainWidth] x [0, domainHeight]: fuera rebotan en los bordes
+    int domainWidth;
+    int domainHeight;
     float smoothingLength;
     float particleMass;
+    float particleSpacing;
+    //... bloque inicial (lo rearma reset()): blockParticles partículas en filas de
+    //... blockColumns desde la esquina (blockX, blockY)
+    int blockColumns;
+    int blockParticles;
+    float blockX, blockY;
     float deltaTime;
     bool isPaused;
     float averageVelocity;
     float maxVelocity;
     float totalKineticEnergy;
     int particleCount;
-    std::vector<float> velocityHistory;
+    //... pasos integrados y tiempo simulado desde el inicio (o desde el checkpoint)
+    unsigned long long stepCount;
+    double simulatedTime;
+    RingBuffer<float> velocityHistory;
+    ThreadPool* threadPool;
+    Profiler* profiler;
+
+    //... parciales por trozo para la reducción de estadísticas; los llena la pasada de
+    //... colisiones de un paso muestreado (ver setStatisticsInterval)
+    struct StatsPartial {
+        float speedSum;
+        float maxSpeed2;
+        float kineticEnergy;
+    };
+    std::vector<StatsPartial> statsPartials;
+    int statisticsInterval;
+    //... partículas de la última muestra; statsSampled queda en false hasta el primer
+    //... paso muestreado después de reset/restore
+    size_t statsParticleCount;
+    bool statsSampled;
+
+    //... reordenamiento en Z (Morton) por celda, ver reorderSpatially()
+    int reorderInterval;
+    int stepsSinceReorder;
+    unsigned reorderCount;
+    std::vector<unsigned> mortonKeys;
+    std::vector<int> reorderOrder;
+    std::vector<int> oldToNew;
+    std::vector<float> reorderScratch;
+
+    //... flujo continuo: emisores y sumideros, con un tope opcional de partículas
+    //... reservado de antemano (ver setParticleCapacity)
+    std::vector<Emitter> emitters;
+    std::vector<Sink> sinks;
+    std::vector<int> retireList;
+    size_t particleCapacity;
+    unsigned long long spawnedCount;
+    unsigned long long retiredCount;
+    unsigned long long rejectedCount;
+    //... sube con cada reordenamiento y con cada paso que agrega o retira partículas
+    unsigned indexRevision;
+
+    //... resolución adaptativa (ver adaptResolution): nivel pedido por partícula para
+    //... dividirse y para no fusionarse, candidatas a fusión con su clave de celda
+    ResolutionSettings resolution;
+    ResolutionStats resolutionStats;
+    std::vector<unsigned char> splitLevels;
+    std::vector<unsigned char> keepLevels;
+    std::vector<std::pair<unsigned long long, int>> mergeCandidates;
+    std::vector<int> mergedAway;
+    //... paso + 1 del último cambio de nivel de cada partícula, por id; 0 si nunca cambió
+    //... (ver holdSteps)
+    std::vector<unsigned long long> levelChangeStep;
+    struct DensitySumPartial {
+        double sum;
+        int count;
+    };
+    std::vector<DensitySumPartial> densitySums;
+    //... partículas dormidas del paso (ver getSleepMask); vacío = todas despiertas
+    std::vector<unsigned char> sleepMask;
+
+    void computeMortonKeys(float cellSize);
+    //... fracción de partículas cuya clave es menor que la de la anterior en memoria
+    float mortonDisorder() const;
+
+    //... update() = integrate() + resolveCollisions(), separadas para medirlas por fase
+    void integrate();
+    void resolveCollisions();
+    //... pasada completa solo para estadísticas, cuando todavía no hay una muestra
+    void reduceStatistics();
+    //... retira lo que cayó en los sumideros y larga las filas que tocan a los emisores
+    void updateSources();
+    //... divide y fusiona según ResolutionSettings, cada resolution.interval pasos
+    void adaptResolution();
+    //... nivel que piden los obstáculos a la distancia d de su superficie
+    int obstacleLevel(float distance) const;
+    //... recuenta resolutionStats.levelCounts
+    void countLevels();
     
 
 public:
     ParticleSystem(int width, int height) 
-        : smoothingLength(15.0f), 
+        : obstacles(width, height, OBSTACLE_CELL_SIZE),
+          domainWidth(width),
+          domainHeight(height),
+          smoothingLength(DEFAULT_SMOOTHING_LENGTH), 
           particleMass(1.0f), 
-          deltaTime(1.0f/60.0f) {
-        initializeParticles(width/4, height/4);
+          particleSpacing(DEFAULT_PARTICLE_SPACING),
+          blockColumns(DEFAULT_BLOCK_COLUMNS),
+          blockParticles(DEFAULT_BLOCK_PARTICLES),
+          blockX(width/4.0f),
+          blockY(height/4.0f),
+          deltaTime(DEFAULT_TIMESTEP),
+          isPaused(false),
+          averageVelocity(0.0f),
+          maxVelocity(0.0f),
+          totalKineticEnergy(0.0f),
+          stepCount(0),
+          simulatedTime(0.0),
+          velocityHistory(DEFAULT_HISTORY_LENGTH),
+          threadPool(nullptr),
+          profiler(nullptr),
+          statisticsInterval(1),
+          statsParticleCount(0),
+          statsSampled(false),
+          reorderInterval(REORDER_ADAPTIVE),
+          stepsSinceReorder(0),
+          reorderCount(0),
+          particleCapacity(0),
+          spawnedCount(0),
+          retiredCount(0),
+          rejectedCount(0),
+          indexRevision(0),
+          resolution{0, 2.0f * DEFAULT_SMOOTHING_LENGTH, 0.6f, 10, 200},
+          resolutionStats{0, 0, {}} {
+        initializeParticles(blockX, blockY);
+        countLevels();
     }
 
-    void initializeParticles(int startX, int startY);
+    //... agrega el bloque inicial con la esquina en (startX, startY)
+    void initializeParticles(float startX, float startY);
+    //... cambia el bloque que arman reset() y el constructor; vale desde el próximo reset()
+    void setSpawnBlock(int columns, int count, float x, float y) {
+        blockColumns = columns > 0 ? columns : 1;
+        blockParticles = count > 0 ? count : 0;
+        blockX = x;
+        blockY = y;
+    }
+    int getSpawnBlockColumns() const { return blockColumns; }
+    int getSpawnBlockParticles() const { return blockParticles; }
     void update();
-    void render(sf::RenderWindow& window);
+    //... clic: agrega un círculo de radio 25 centrado en el cursor
     void handleMouseInput(int x, int y);
-    const std::vector<Particle>& getParticles() const;
-    std::vector<Particle>& getParticles();
+    void addCircleObstacle(const Vec2& center, float radius) { obstacles.addCircle(center, radius); }
+    void addBoxObstacle(const Vec2& center, const Vec2& halfExtents, float angle = 0.0f) {
+        obstacles.addBox(center, halfExtents, angle);
+    }
+    void addPolylineObstacle(const std::vector<Vec2>& points, float thickness, bool closed = false) {
+        obstacles.addPolyline(points, thickness, closed);
+    }
+    ParticleData& getData() { return particles; }
+    const ParticleData& getData() const { return particles; }
+    size_t getParticleCount() const { return particles.size(); }
+    //... adaptadores AoS para llamadores existentes (copian, no usar en bucles calientes)
+    std::vector<Particle> getParticles() const;
+    Particle getParticle(size_t i) const { return particles.get(i); }
+    void setParticle(size_t i, const Particle& particle) { particles.set(i, particle); }
     float getSmoothingLength() const;
     float getParticleMass() const;
-    const std::vector<float>& getVelocityHistory() const { return velocityHistory; }
-    const std::vector<sf::CircleShape>& getObstacles() const { return obstacles; }
+    void setSmoothingLength(float h) { smoothingLength = h; }
+    void setParticleMass(float mass) { particleMass = mass; }
+    void setParticleSpacing(float spacing) { particleSpacing = spacing; }
+    //... separación del bloque inicial; el solver incompresible la usa para calibrarse
+    float getParticleSpacing() const { return particleSpacing; }
+    //... velocidad promedio de las últimas llamadas a updateStatistics(), la más vieja primero
+    const RingBuffer<float>& getVelocityHistory() const { return velocityHistory; }
+    void setHistoryLength(size_t samples) { velocityHistory.setCapacity(samples); }
+    const ObstacleField& getObstacles() const { return obstacles; }
+    int getDomainWidth() const { return domainWidth; }
+    int getDomainHeight() const { return domainHeight; }
+    //... cambia cada vez que se agregan o borran obstáculos (para cachés de dibujo)
+    unsigned getObstacleRevision() const { return obstacles.getRevision(); }
     void reset();
     void togglePause();
+    //... cierra la última muestra (suma los parciales por trozo, O(trozos)) y la agrega al
+    //... historial; la pasada sobre las partículas ya la hizo update()
     void updateStatistics();
+    //... muestrear cada N pasos (1 = todos); entre muestras las colisiones no calculan nada
+    void setStatisticsInterval(int steps) { statisticsInterval = steps > 1 ? steps : 1; }
+    int getStatisticsInterval() const { return statisticsInterval; }
     float getAverageVelocity() const { return averageVelocity; }
     float getMaxVelocity() const { return maxVelocity; }
     float getTotalKineticEnergy() const { return totalKineticEnergy; }
     bool getIsPaused() const { return isPaused; }
+    //... paso de integración (lo fijan el planificador y SPHSolver::advance)
+    void setDeltaTime(float dt) { deltaTime = dt; }
+    float getDeltaTime() const { return deltaTime; }
+    unsigned long long getStepCount() const { return stepCount; }
+    double getSimulatedTime() const { return simulatedTime; }
+    //... reemplaza partículas, obstáculos y contadores (al cargar un checkpoint); borra el
+    //... historial y cualquier índice anterior, como reset()
+    void restore(ParticleData data, const std::vector<Obstacle>& obstacleList,
+                 unsigned long long steps, double time);
+    //... nullptr = todo en el hilo actual
+    void setThreadPool(ThreadPool* pool) { threadPool = pool; }
+    //... nullptr = sin instrumentación
+    void setProfiler(Profiler* p) { profiler = p; }
+
+    //... ordena las partículas en memoria por la clave Morton de su celda, así las
+    //... vecinas en el espacio quedan cerca en memoria. Invalida cualquier índice de
+    //... partícula guardado afuera: usar remapIndex() o los id estables (getData().slot)
+    void reorderSpatially(float cellSize);
+    //... llamar una vez por paso antes de armar el grid; reordena según el intervalo
+    void maybeReorder(float cellSize);
+    //... K > 0 pasos, REORDER_OFF o REORDER_ADAPTIVE
+    void setReorderInterval(int steps) { reorderInterval = steps; stepsSinceReorder = 0; }
+    int getReorderInterval() const { return reorderInterval; }
+    unsigned getReorderCount() const { return reorderCount; }
+    //... revisión para cachés de índices: cambia al reordenar y al agregar o retirar
+    unsigned getIndexRevision() const { return indexRevision; }
+    //... para quien agrega o retira partículas directamente en getData() (el reparto
+    //... entre procesos): sube la revisión como lo hacen los emisores y los sumideros
+    void touchIndices() { indexRevision++; }
+
+    //... los emisores y sumideros actúan al final de update(), después de las
+    //... colisiones: el grid y la lista de vecinos de ese paso ya no se usan, y el paso
+    //... siguiente los arma con las partículas nuevas
+    void addEmitter(const Vec2& position, const Vec2& velocity, float width, float travelled = 0.0f) {
+        emitters.push_back(Emitter{position, velocity, width, travelled});
+    }
+    void addSink(const Vec2& minCorner, const Vec2& maxCorner) {
+        sinks.push_back(Sink{minCorner, maxCorner});
+    }
+    void clearSources() { emitters.clear(); sinks.clear(); }
+    const std::vector<Emitter>& getEmitters() const { return emitters; }
+    const std::vector<Sink>& getSinks() const { return sinks; }
+    //... reserva los arreglos para 'count' partículas y hace de tope: con el pool lleno
+    //... los emisores no agregan más (se cuentan como rechazadas). 0 = sin tope
+    void setParticleCapacity(size_t count);
+    size_t getParticleCapacity() const { return particleCapacity; }
+    unsigned long long getSpawnedCount() const { return spawnedCount; }
+    unsigned long long getRetiredCount() const { return retiredCount; }
+    unsigned long long getRejectedCount() const { return rejectedCount; }
+
+    //... la revisión va al final de update(), antes de los emisores, con la densidad del
+    //... paso; divide y fusiona con swap-and-pop como los sumideros, así sube
+    //... getIndexRevision(). Con un tope de partículas no se divide más allá del tope
+    void setResolutionSettings(const ResolutionSettings& settings);
+    const ResolutionSettings& getResolutionSettings() const { return resolution; }
+    int getMaxResolutionLevel() const { return resolution.maxLevel; }
+    const ResolutionStats& getResolutionStats() const { return resolutionStats; }
+    //... hay partículas divididas (según el último recuento): mientras las haya, las
+    //... revisiones siguen aunque maxLevel sea 0, para volver a fusionarlas
+    bool hasRefinedParticles() const;
+    //... el nivel más fino que puede haber: maxLevel o el más fino que quede dividido
+    int getFinestLevel() const;
+    float getLevelMass(int level) const { return particleMass * levelMassScale(level); }
+    float getLevelSmoothingLength(int level) const { return smoothingLength * levelLengthScale(level); }
+    float getLevelSpacing(int level) const { return particleSpacing * levelLengthScale(level); }
+    //... 1 = la partícula está dormida en este paso (SPHSolver, celdas dormidas): el
+    //... próximo update() no la integra. Lo llena el solver después de armar el grid,
+    //... con una entrada por partícula, y vale solo para ese update(), que lo vacía
+    std::vector<unsigned char>& getSleepMask() { return sleepMask; }
+    //... posición nueva de un índice anterior al último reordenamiento
+    int remapIndex(int oldIndex) const {
+        return oldToNew.empty() ? oldIndex : oldToNew[oldIndex];
+    }
 };
 
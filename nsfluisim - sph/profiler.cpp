@@ -0,0 +1,178 @@
+/*
+Instrumentación por fase del paso de simulación y del renderizado.
+
+Cada ScopedTimer suma su duración a la fase correspondiente del frame en curso; al
+cerrar el frame (endFrame) los totales pasan a un historial circular de tamaño fijo,
+de donde salen el mínimo, la media y el percentil 99 que se muestran en el overlay.
+Si la traza está activa además se guarda cada evento individual con su marca de
+tiempo, para verlo en chrome://tracing.
+*/
+
+//... profiler.cpp
+#include "profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+const char* profilePhaseName(ProfilePhase phase) {
+    switch (phase) {
+        case ProfilePhase::Reorder: return "reorder";
+        case ProfilePhase::GridRebuild: return "grid";
+        case ProfilePhase::NeighborList: return "neighbors";
+        case ProfilePhase::Density: return "density";
+        case ProfilePhase::Activity: return "activity";
+        case ProfilePhase::Forces: return "forces";
+        case ProfilePhase::PressureSolve: return "pressure";
+        case ProfilePhase::Integration: return "integration";
+        case ProfilePhase::Collisions: return "collisions";
+        case ProfilePhase::Emission: return "emission";
+        case ProfilePhase::Resolution: return "resolution";
+        case ProfilePhase::Exchange: return "exchange";
+        case ProfilePhase::StreamCollide: return "stream_collide";
+        case ProfilePhase::Advection: return "advection";
+        case ProfilePhase::Diffusion: return "diffusion";
+        case ProfilePhase::Projection: return "projection";
+        case ProfilePhase::Statistics: return "statistics";
+        case ProfilePhase::Surface: return "surface";
+        case ProfilePhase::Export: return "export";
+        case ProfilePhase::Render: return "render";
+        case ProfilePhase::Frame: return "frame";
+        default: return "?";
+    }
+}
+
+Profiler::Profiler(size_t windowSize)
+    : windowSize(std::max<size_t>(1, windowSize)),
+      frameCount(0),
+      history(this->windowSize * PHASE_COUNT, 0.0),
+      origin(Clock::now()),
+      frameStart(origin),
+      tracing(false),
+      traceCapacity(0),
+      traceNext(0) {
+    std::fill(currentFrame, currentFrame + PHASE_COUNT, 0.0);
+}
+
+void Profiler::beginFrame() {
+    std::fill(currentFrame, currentFrame + PHASE_COUNT, 0.0);
+    frameStart = Clock::now();
+}
+
+void Profiler::endFrame() {
+    record(ProfilePhase::Frame, frameStart, Clock::now());
+    double* row = &history[(frameCount % windowSize) * PHASE_COUNT];
+    std::copy(currentFrame, currentFrame + PHASE_COUNT, row);
+    frameCount++;
+}
+
+void Profiler::record(ProfilePhase phase, Clock::time_point start, Clock::time_point end) {
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    currentFrame[static_cast<int>(phase)] += ms;
+
+    if (tracing && traceCapacity > 0) {
+        TraceEvent event;
+        event.phase = phase;
+        event.startUs = std::chrono::duration<double, std::micro>(start - origin).count();
+        event.durationUs = ms * 1000.0;
+        if (traceEvents.size() < traceCapacity) {
+            traceEvents.push_back(event);
+        } else {
+            traceEvents[traceNext] = event;
+        }
+        traceNext = (traceNext + 1) % traceCapacity;
+    }
+}
+
+PhaseStats Profiler::getStats(ProfilePhase phase) const {
+    PhaseStats stats = { 0.0, 0.0, 0.0, 0.0 };
+    size_t frames = std::min(frameCount, windowSize);
+    if (frames == 0) return stats;
+
+    std::vector<double> samples(frames);
+    int column = static_cast<int>(phase);
+    for (size_t f = 0; f < frames; f++) {
+        samples[f] = history[f * PHASE_COUNT + column];
+    }
+    stats.lastMs = history[((frameCount - 1) % windowSize) * PHASE_COUNT + column];
+
+    double sum = 0.0;
+    for (double s : samples) sum += s;
+    stats.meanMs = sum / frames;
+
+    std::sort(samples.begin(), samples.end());
+    stats.minMs = samples.front();
+    size_t p99Index = static_cast<size_t>(0.99 * (frames - 1) + 0.5);
+    stats.p99Ms = samples[p99Index];
+    return stats;
+}
+
+void Profiler::setTracing(bool enabled, size_t capacity) {
+    tracing = enabled;
+    if (enabled) {
+        traceCapacity = capacity;
+        traceEvents.clear();
+        traceEvents.reserve(std::min<size_t>(capacity, 4096));
+        traceNext = 0;
+    }
+}
+
+bool Profiler::writeCsv(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    out << "frame";
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        out << "," << profilePhaseName(static_cast<ProfilePhase>(p)) << "_ms";
+    }
+    out << "\n";
+
+    //... de la más vieja a la más nueva dentro de la ventana
+    size_t frames = std::min(frameCount, windowSize);
+    size_t first = frameCount - frames;
+    out << std::fixed << std::setprecision(4);
+    for (size_t f = first; f < frameCount; f++) {
+        const double* row = &history[(f % windowSize) * PHASE_COUNT];
+        out << f;
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            out << "," << row[p];
+        }
+        out << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    out << "{\"traceEvents\":[\n";
+    //... si el buffer dio la vuelta, el evento más viejo está en traceNext
+    size_t count = traceEvents.size();
+    size_t first = count < traceCapacity ? 0 : traceNext;
+    out << std::fixed << std::setprecision(3);
+    for (size_t k = 0; k < count; k++) {
+        const TraceEvent& event = traceEvents[(first + k) % count];
+        out << (k ? ",\n" : "")
+            << "{\"name\":\"" << profilePhaseName(event.phase) << "\","
+            << "\"cat\":\"sph\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+            << (event.phase == ProfilePhase::Frame ? 0 : 1) << ","
+            << "\"ts\":" << event.startUs << ",\"dur\":" << event.durationUs << "}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return static_cast<bool>(out);
+}
+
+std::string Profiler::summary() const {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(2)
+       << "fase         min   media   p99 (ms)\n";
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        PhaseStats stats = getStats(static_cast<ProfilePhase>(p));
+        ss << std::left << std::setw(11) << profilePhaseName(static_cast<ProfilePhase>(p))
+           << std::right << std::setw(6) << stats.minMs
+           << std::setw(8) << stats.meanMs
+           << std::setw(7) << stats.p99Ms << "\n";
+    }
+    return ss.str();
+}
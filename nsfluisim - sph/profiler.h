@@ -0,0 +1,112 @@
+// profiler.h
+#pragma once
+#include <vector>
+#include <string>
+#include <chrono>
+
+//... fases instrumentadas del frame; Frame es el frame completo (beginFrame..endFrame)
+enum class ProfilePhase {
+    Reorder,
+    GridRebuild,
+    NeighborList,
+    Density,
+    Activity,
+    Forces,
+    PressureSolve,
+    Integration,
+    Collisions,
+    Emission,
+    Resolution,
+    Exchange,
+    StreamCollide,
+    Advection,
+    Diffusion,
+    Projection,
+    Statistics,
+    Surface,
+    Export,
+    Render,
+    Frame,
+    Count
+};
+
+const char* profilePhaseName(ProfilePhase phase);
+
+struct PhaseStats {
+    double minMs;
+    double meanMs;
+    double p99Ms;
+    double lastMs;
+};
+
+//... tiempos por fase acumulados por frame, con ventana deslizante de los últimos
+//... 'windowSize' frames para min/media/p99, y un registro opcional de eventos para
+//... exportar como traza de Chrome (chrome://tracing o Perfetto).
+//... Se mide desde el hilo que llama a cada pasada, no dentro de los trozos del pool.
+class Profiler {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+private:
+    static const int PHASE_COUNT = static_cast<int>(ProfilePhase::Count);
+
+    struct TraceEvent {
+        ProfilePhase phase;
+        double startUs;
+        double durationUs;
+    };
+
+    size_t windowSize;
+    size_t frameCount;
+    //... historial circular: history[frame % windowSize][fase] en ms
+    std::vector<double> history;
+    double currentFrame[PHASE_COUNT];
+    Clock::time_point origin;
+    Clock::time_point frameStart;
+
+    bool tracing;
+    std::vector<TraceEvent> traceEvents;
+    size_t traceCapacity;
+    size_t traceNext;
+
+public:
+    explicit Profiler(size_t windowSize = 240);
+
+    void beginFrame();
+    void endFrame();
+    //... suma una medición a la fase en el frame actual (varios subpasos se acumulan)
+    void record(ProfilePhase phase, Clock::time_point start, Clock::time_point end);
+
+    PhaseStats getStats(ProfilePhase phase) const;
+    size_t getFrameCount() const { return frameCount; }
+
+    //... eventos para la traza; al llenarse se pisan los más viejos
+    void setTracing(bool enabled, size_t capacity = 100000);
+    bool isTracing() const { return tracing; }
+
+    //... CSV con una fila por frame de la ventana y una columna por fase (ms)
+    bool writeCsv(const std::string& path) const;
+    //... formato de eventos de Chrome ("ph": "X")
+    bool writeChromeTrace(const std::string& path) const;
+    //... resumen legible para el overlay o la consola
+    std::string summary() const;
+};
+
+//... mide el bloque en que vive; con profiler == nullptr no hace nada
+class ScopedTimer {
+private:
+    Profiler* profiler;
+    ProfilePhase phase;
+    Profiler::Clock::time_point start;
+
+public:
+    ScopedTimer(Profiler* profiler, ProfilePhase phase)
+        : profiler(profiler), phase(phase) {
+        if (profiler) start = Profiler::Clock::now();
+    }
+    ~ScopedTimer() {
+        if (profiler) profiler->record(phase, start, Profiler::Clock::now());
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
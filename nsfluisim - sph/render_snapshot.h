@@ -0,0 +1,94 @@
+// render_snapshot.h
+#pragma once
+#include <atomic>
+#include <string>
+#include <vector>
+#include "obstacle_field.h"
+
+//... lo que el renderizado necesita de un paso terminado: posiciones y velocidades (para
+//... el color), obstáculos y las estadísticas del overlay. Lo llena el hilo de simulación
+//... (SimulationThread) y lo lee el de render sin tocar ParticleSystem
+struct RenderSnapshot {
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;
+    //... radio del nivel de la escena; con resolución adaptativa 'level' trae el nivel de
+    //... cada partícula (si no, queda vacío) y levelCounts cuántas hay por nivel
+    float particleRadius;
+    std::vector<unsigned char> level;
+    std::vector<size_t> levelCounts;
+    //... modo de dibujo por superficie (ver surface_field.h): triángulos del contorno como
+    //... x, y por vértice; con surface = false queda vacío y se dibujan las partículas
+    bool surface;
+    std::vector<float> surfaceTriangles;
+    //... los obstáculos solo se copian cuando cambia la revisión
+    std::vector<Obstacle> obstacles;
+    unsigned obstacleRevision;
+
+    unsigned long long stepCount;
+    double simulatedTime;
+    bool paused;
+    float averageVelocity;
+    float maxVelocity;
+    float totalKineticEnergy;
+    std::vector<float> velocityHistory;
+    //... error de densidad (compresión relativa) y extremos de presión del último paso
+    float maxDensityError;
+    float averageDensityError;
+    float minPressure;
+    float maxPressure;
+    //... celdas dormidas (ver SleepSettings); sleeping = false si están apagadas
+    bool sleeping;
+    size_t sleepingCells;
+    size_t sleepingParticles;
+    bool adaptiveTimestep;
+    int lastSubsteps;
+    float lastTimestep;
+    //... resumen del profiler del hilo de simulación
+    std::string profileSummary;
+
+    RenderSnapshot()
+        : particleRadius(0.0f), surface(false), obstacleRevision(static_cast<unsigned>(-1)),
+          stepCount(0), simulatedTime(0.0), paused(false), averageVelocity(0.0f),
+          maxVelocity(0.0f), totalKineticEnergy(0.0f), maxDensityError(0.0f),
+          averageDensityError(0.0f), minPressure(0.0f), maxPressure(0.0f), sleeping(false),
+          sleepingCells(0), sleepingParticles(0), adaptiveTimestep(false),
+          lastSubsteps(0), lastTimestep(0.0f) {}
+
+    size_t size() const { return x.size(); }
+};
+
+//... triple búfer sin candados entre un productor y un consumidor: el productor escribe
+//... siempre en su búfer trasero y lo publica intercambiándolo con el del medio; el
+//... consumidor toma el del medio solo si hay uno nuevo. Ninguno espera al otro y el
+//... consumidor siempre ve el último estado completo (los intermedios se pisan)
+template <typename T>
+class TripleBuffer {
+private:
+    static const unsigned INDEX_MASK = 3u;
+    static const unsigned FRESH_BIT = 4u;
+
+    T slots[3];
+    //... índice del búfer del medio, con FRESH_BIT si se publicó y nadie lo tomó
+    std::atomic<unsigned> middle;
+    unsigned back;      //... solo lo toca el productor
+    unsigned front;     //... solo lo toca el consumidor
+
+public:
+    TripleBuffer() : middle(1), back(0), front(2) {}
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    //... productor: búfer a llenar y publicación (release: lo escrito se ve al tomarlo)
+    T& writeBuffer() { return slots[back]; }
+    void publish() {
+        back = middle.exchange(back | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    //... consumidor: true si cambió el búfer de lectura
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH_BIT)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+    const T& readBuffer() const { return slots[front]; }
+};
@@ -0,0 +1,55 @@
+// ring_buffer.h
+#pragma once
+#include <cstddef>
+#include <vector>
+
+//... búfer circular de capacidad fija: push() es O(1) y, lleno, pisa el más viejo en
+//... lugar de correr todo el arreglo como un erase(begin()). El índice 0 es el más viejo
+template <typename T>
+class RingBuffer {
+private:
+    std::vector<T> items;
+    size_t head;        //... posición del más viejo
+    size_t count;
+
+public:
+    explicit RingBuffer(size_t capacity = 0) : items(capacity), head(0), count(0) {}
+
+    void push(const T& value) {
+        if (items.empty()) return;
+        if (count < items.size()) {
+            items[(head + count) % items.size()] = value;
+            count++;
+        } else {
+            items[head] = value;
+            head = (head + 1) % items.size();
+        }
+    }
+
+    const T& operator[](size_t i) const { return items[(head + i) % items.size()]; }
+    const T& back() const { return (*this)[count - 1]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return items.size(); }
+    void clear() { head = 0; count = 0; }
+
+    //... cambia la capacidad conservando los más nuevos que entren
+    void setCapacity(size_t capacity) {
+        std::vector<T> resized(capacity);
+        size_t keep = count < capacity ? count : capacity;
+        for (size_t i = 0; i < keep; i++) {
+            resized[i] = (*this)[count - keep + i];
+        }
+        items.swap(resized);
+        head = 0;
+        count = keep;
+    }
+
+    //... copia en orden (del más viejo al más nuevo) reutilizando la capacidad de 'out'
+    void copyTo(std::vector<T>& out) const {
+        out.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            out[i] = (*this)[i];
+        }
+    }
+};
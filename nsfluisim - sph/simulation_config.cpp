@@ -0,0 +1,329 @@
+/*
+Configuración de la escena y de los parámetros sin recompilar.
+
+Antes el tamaño del dominio (WINDOW_WIDTH x WINDOW_HEIGHT), el bloque inicial de 30x30,
+h = 15, la separación, el lado de celda del grid (30, sin relación con h) y los
+coeficientes del solver estaban escritos en el código: probar otra escena era editar y
+volver a compilar. Ahora todo eso es un SimulationConfig que arranca con los valores de
+siempre, se lee de un archivo clave = valor y se puede pisar con --set desde la línea de
+comandos; applySimulationConfig() lo pasa al ParticleSystem y al SPHSolver.
+
+El formato es deliberadamente simple (sin secciones ni comillas): una asignación por
+línea, espacios alrededor ignorados y '#' como comentario. Las claves desconocidas son un
+error, así un error de tipeo no pasa como un valor por defecto silencioso.
+*/
+
+//... simulation_config.cpp
+#include "simulation_config.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+SimulationConfig::SimulationConfig()
+    : domainWidth(WINDOW_WIDTH),
+      domainHeight(WINDOW_HEIGHT),
+      particles(DEFAULT_BLOCK_PARTICLES),
+      blockColumns(DEFAULT_BLOCK_COLUMNS),
+      blockX(-1.0f),
+      blockY(-1.0f),
+      spacing(DEFAULT_PARTICLE_SPACING),
+      smoothingLength(DEFAULT_SMOOTHING_LENGTH),
+      particleMass(1.0f),
+      cellSize(0.0f),
+      gridLayout(GridLayout::Dense),
+      reorderInterval(REORDER_ADAPTIVE),
+      pressureSolver(PressureSolver::EquationOfState),
+      neighborCache(NeighborCache::Off),
+      compactStorage(false),
+      timestep(DEFAULT_TIMESTEP),
+      adaptiveTimestep(false) {
+    //... los del solver salen de un SPHSolver recién construido, así no se repiten aquí
+    SPHSolver defaults(1, 1);
+    viscosity = defaults.getViscosity();
+    stiffness = defaults.getStiffness();
+    restDensity = defaults.getRestDensity();
+    pcisph = defaults.getPCISPHSettings();
+    verletSkin = defaults.getVerletSkin();
+    maxSubsteps = defaults.getTimestepSettings().maxSubsteps;
+    sleep = defaults.getSleepSettings();
+    ParticleSystem systemDefaults(1, 1);
+    resolution = systemDefaults.getResolutionSettings();
+}
+
+static std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return std::string();
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+//... el texto entero tiene que ser el número
+static bool parseFloat(const std::string& text, float& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    errno = 0;
+    float parsed = std::strtof(text.c_str(), &end);
+    if (*end != '\0' || errno == ERANGE || !std::isfinite(parsed)) return false;
+    value = parsed;
+    return true;
+}
+
+static bool parseInt(const std::string& text, int& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    if (*end != '\0' || errno == ERANGE || parsed < -2147483647L || parsed > 2147483647L) return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+static bool parseBool(const std::string& text, bool& value) {
+    if (text == "true" || text == "on" || text == "1") {
+        value = true;
+    } else if (text == "false" || text == "off" || text == "0") {
+        value = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+//... el más corto de 6 a 9 dígitos que se vuelve a leer igual (9 siempre alcanza)
+static std::string formatFloat(float value) {
+    std::ostringstream out;
+    for (int digits = 6; digits <= 9; digits++) {
+        out.str(std::string());
+        out.precision(digits);
+        out << value;
+        if (std::strtof(out.str().c_str(), nullptr) == value) break;
+    }
+    return out.str();
+}
+
+//... asigna 'value' a 'key'; 'error' solo dice qué se esperaba
+static bool setValue(SimulationConfig& config, const std::string& key, const std::string& value,
+                     std::string& error) {
+    float f = 0.0f;
+    int n = 0;
+    if (key == "domain") {
+        size_t separator = value.find('x');
+        int width = 0, height = 0;
+        if (separator == std::string::npos || !parseInt(value.substr(0, separator), width) ||
+            !parseInt(value.substr(separator + 1), height) || width <= 0 || height <= 0) {
+            error = "se esperaba ANCHOxALTO";
+            return false;
+        }
+        config.domainWidth = width;
+        config.domainHeight = height;
+    } else if (key == "particles") {
+        if (!parseInt(value, n) || n < 0) { error = "se esperaba un entero >= 0"; return false; }
+        config.particles = n;
+    } else if (key == "block_columns") {
+        if (!parseInt(value, n) || n < 0) { error = "se esperaba un entero >= 0"; return false; }
+        config.blockColumns = n;
+    } else if (key == "block_x" || key == "block_y") {
+        if (!parseFloat(value, f)) { error = "se esperaba un número"; return false; }
+        (key == "block_x" ? config.blockX : config.blockY) = f;
+    } else if (key == "spacing" || key == "smoothing_length" || key == "particle_mass" ||
+               key == "rest_density" || key == "timestep" || key == "pcisph_tolerance") {
+        if (!parseFloat(value, f) || f <= 0.0f) { error = "se esperaba un número > 0"; return false; }
+        if (key == "spacing") config.spacing = f;
+        else if (key == "smoothing_length") config.smoothingLength = f;
+        else if (key == "particle_mass") config.particleMass = f;
+        else if (key == "rest_density") config.restDensity = f;
+        else if (key == "timestep") config.timestep = f;
+        else config.pcisph.tolerance = f;
+    } else if (key == "cell_size" || key == "viscosity" || key == "stiffness" || key == "skin" ||
+               key == "pcisph_rest_density") {
+        if (!parseFloat(value, f) || f < 0.0f) { error = "se esperaba un número >= 0"; return false; }
+        if (key == "cell_size") config.cellSize = f;
+        else if (key == "viscosity") config.viscosity = f;
+        else if (key == "stiffness") config.stiffness = f;
+        else if (key == "skin") config.verletSkin = f;
+        else config.pcisph.restDensity = f;
+    } else if (key == "pcisph_min_iterations" || key == "pcisph_max_iterations" ||
+               key == "max_substeps" || key == "refine_interval") {
+        if (!parseInt(value, n) || n < 1) { error = "se esperaba un entero >= 1"; return false; }
+        if (key == "pcisph_min_iterations") config.pcisph.minIterations = n;
+        else if (key == "pcisph_max_iterations") config.pcisph.maxIterations = n;
+        else if (key == "max_substeps") config.maxSubsteps = n;
+        else config.resolution.interval = n;
+    } else if (key == "resolution_levels") {
+        if (!parseInt(value, n) || n < 0 || n > MAX_RESOLUTION_LEVEL) {
+            error = "se esperaba un entero de 0 a " + std::to_string(MAX_RESOLUTION_LEVEL);
+            return false;
+        }
+        config.resolution.maxLevel = n;
+    } else if (key == "refine_hold") {
+        if (!parseInt(value, n) || n < 0) { error = "se esperaba un entero >= 0"; return false; }
+        config.resolution.holdSteps = n;
+    } else if (key == "refine_band") {
+        if (!parseFloat(value, f) || f <= 0.0f) { error = "se esperaba un número > 0"; return false; }
+        config.resolution.obstacleBand = f;
+    } else if (key == "surface_density") {
+        if (!parseFloat(value, f) || f < 0.0f || f > 1.0f) { error = "se esperaba un número de 0 a 1"; return false; }
+        config.resolution.surfaceDensity = f;
+    } else if (key == "sleep") {
+        if (!parseBool(value, config.sleep.enabled)) { error = "se esperaba true o false"; return false; }
+    } else if (key == "sleep_speed" || key == "sleep_force") {
+        if (!parseFloat(value, f) || f <= 0.0f) { error = "se esperaba un número > 0"; return false; }
+        (key == "sleep_speed" ? config.sleep.speedThreshold : config.sleep.forceThreshold) = f;
+    } else if (key == "sleep_steps") {
+        if (!parseInt(value, n) || n < 1) { error = "se esperaba un entero >= 1"; return false; }
+        config.sleep.steps = n;
+    } else if (key == "adaptive_dt") {
+        if (!parseBool(value, config.adaptiveTimestep)) { error = "se esperaba true o false"; return false; }
+    } else if (key == "grid") {
+        if (value == "dense") config.gridLayout = GridLayout::Dense;
+        else if (value == "hashed") config.gridLayout = GridLayout::Hashed;
+        else { error = "se esperaba dense o hashed"; return false; }
+    } else if (key == "pressure") {
+        if (value == "eos") config.pressureSolver = PressureSolver::EquationOfState;
+        else if (value == "pcisph") config.pressureSolver = PressureSolver::PCISPH;
+        else { error = "se esperaba eos o pcisph"; return false; }
+    } else if (key == "neighbor_list") {
+        if (value == "off") config.neighborCache = NeighborCache::Off;
+        else if (value == "step") config.neighborCache = NeighborCache::PerStep;
+        else if (value == "verlet") config.neighborCache = NeighborCache::Verlet;
+        else { error = "se esperaba off, step o verlet"; return false; }
+    } else if (key == "compact") {
+        if (!parseBool(value, config.compactStorage)) { error = "se esperaba true o false"; return false; }
+    } else if (key == "reorder") {
+        if (value == "adaptive") config.reorderInterval = REORDER_ADAPTIVE;
+        else if (value == "off") config.reorderInterval = REORDER_OFF;
+        else if (parseInt(value, n) && n >= 1) config.reorderInterval = n;
+        else { error = "se esperaba un entero >= 1, adaptive u off"; return false; }
+    } else {
+        error = "clave desconocida";
+        return false;
+    }
+    return true;
+}
+
+bool setSimulationConfigValue(const std::string& assignment, SimulationConfig& config,
+                              std::string& error) {
+    size_t equals = assignment.find('=');
+    if (equals == std::string::npos) {
+        error = "'" + assignment + "' no es clave=valor";
+        return false;
+    }
+    std::string key = trim(assignment.substr(0, equals));
+    std::string value = trim(assignment.substr(equals + 1));
+    std::string reason;
+    if (!setValue(config, key, value, reason)) {
+        error = key + " = " + value + ": " + reason;
+        return false;
+    }
+    return true;
+}
+
+bool loadSimulationConfig(const std::string& path, SimulationConfig& config, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "no se pudo abrir " + path;
+        return false;
+    }
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+        line = trim(line);
+        if (line.empty()) continue;
+        std::string reason;
+        if (!setSimulationConfigValue(line, config, reason)) {
+            error = path + ":" + std::to_string(lineNumber) + ": " + reason;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string describeSimulationConfig(const SimulationConfig& config) {
+    std::ostringstream out;
+    out << "domain = " << config.domainWidth << "x" << config.domainHeight << "\n"
+        << "particles = " << config.particles << "\n"
+        << "block_columns = " << config.blockColumns << "\n"
+        << "block_x = " << formatFloat(config.blockX) << "\n"
+        << "block_y = " << formatFloat(config.blockY) << "\n"
+        << "spacing = " << formatFloat(config.spacing) << "\n"
+        << "smoothing_length = " << formatFloat(config.smoothingLength) << "\n"
+        << "particle_mass = " << formatFloat(config.particleMass) << "\n"
+        << "cell_size = " << formatFloat(config.cellSize) << "\n"
+        << "grid = " << (config.gridLayout == GridLayout::Hashed ? "hashed" : "dense") << "\n"
+        << "reorder = ";
+    if (config.reorderInterval == REORDER_ADAPTIVE) out << "adaptive";
+    else if (config.reorderInterval == REORDER_OFF) out << "off";
+    else out << config.reorderInterval;
+    out << "\n"
+        << "viscosity = " << formatFloat(config.viscosity) << "\n"
+        << "stiffness = " << formatFloat(config.stiffness) << "\n"
+        << "rest_density = " << formatFloat(config.restDensity) << "\n"
+        << "pressure = " << (config.pressureSolver == PressureSolver::PCISPH ? "pcisph" : "eos") << "\n"
+        << "pcisph_tolerance = " << formatFloat(config.pcisph.tolerance) << "\n"
+        << "pcisph_min_iterations = " << config.pcisph.minIterations << "\n"
+        << "pcisph_max_iterations = " << config.pcisph.maxIterations << "\n"
+        << "pcisph_rest_density = " << formatFloat(config.pcisph.restDensity) << "\n"
+        << "neighbor_list = "
+        << (config.neighborCache == NeighborCache::Verlet ? "verlet" :
+            config.neighborCache == NeighborCache::PerStep ? "step" : "off") << "\n"
+        << "skin = " << formatFloat(config.verletSkin) << "\n"
+        << "compact = " << (config.compactStorage ? "true" : "false") << "\n"
+        << "resolution_levels = " << config.resolution.maxLevel << "\n"
+        << "refine_band = " << formatFloat(config.resolution.obstacleBand) << "\n"
+        << "surface_density = " << formatFloat(config.resolution.surfaceDensity) << "\n"
+        << "refine_interval = " << config.resolution.interval << "\n"
+        << "refine_hold = " << config.resolution.holdSteps << "\n"
+        << "sleep = " << (config.sleep.enabled ? "true" : "false") << "\n"
+        << "sleep_speed = " << formatFloat(config.sleep.speedThreshold) << "\n"
+        << "sleep_force = " << formatFloat(config.sleep.forceThreshold) << "\n"
+        << "sleep_steps = " << config.sleep.steps << "\n"
+        << "timestep = " << formatFloat(config.timestep) << "\n"
+        << "adaptive_dt = " << (config.adaptiveTimestep ? "true" : "false") << "\n"
+        << "max_substeps = " << config.maxSubsteps << "\n";
+    return out.str();
+}
+
+void applySimulationConfig(const SimulationConfig& config, ParticleSystem& particleSystem,
+                           SPHSolver& solver) {
+    int columns = config.blockColumns;
+    if (columns <= 0) {
+        columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(config.particles))));
+    }
+    particleSystem.setSmoothingLength(config.smoothingLength);
+    particleSystem.setParticleMass(config.particleMass);
+    particleSystem.setParticleSpacing(config.spacing);
+    particleSystem.setSpawnBlock(columns, config.particles,
+                                 config.blockX >= 0.0f ? config.blockX : config.domainWidth / 4.0f,
+                                 config.blockY >= 0.0f ? config.blockY : config.domainHeight / 4.0f);
+    particleSystem.setReorderInterval(config.reorderInterval);
+    particleSystem.setDeltaTime(config.timestep);
+    particleSystem.setResolutionSettings(config.resolution);
+    particleSystem.reset();
+
+    solver.setViscosity(config.viscosity);
+    solver.setStiffness(config.stiffness);
+    solver.setRestDensity(config.restDensity);
+    solver.setGridLayout(config.gridLayout);
+    solver.setGridCellSize(config.cellSize);
+    solver.setPressureSolver(config.pressureSolver);
+    PCISPHSettings pcisph = config.pcisph;
+    pcisph.maxIterations = std::max(pcisph.maxIterations, pcisph.minIterations);
+    solver.setPCISPHSettings(pcisph);
+    solver.setNeighborCache(config.neighborCache);
+    solver.setVerletSkin(config.verletSkin);
+    solver.setCompactStorage(config.compactStorage);
+    solver.setSleepSettings(config.sleep);
+    TimestepSettings timestep = solver.getTimestepSettings();
+    timestep.adaptive = config.adaptiveTimestep;
+    timestep.maxSubsteps = config.maxSubsteps;
+    //... un subpaso nunca es más largo que el paso fijo
+    timestep.maxTimestep = config.timestep;
+    timestep.minTimestep = std::min(timestep.minTimestep, config.timestep);
+    solver.setTimestepSettings(timestep);
+}
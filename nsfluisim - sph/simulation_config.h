@@ -0,0 +1,70 @@
+// simulation_config.h
+#pragma once
+#include <string>
+#include "constants.h"
+#include "particle_system.h"
+#include "sph_solver.h"
+
+//... escena y parámetros de una corrida, para cambiarlos sin recompilar. Se leen de un
+//... archivo de texto con una asignación clave = valor por línea ('#' comenta hasta el
+//... fin de la línea) y se pueden pisar desde la línea de comandos con --set clave=valor:
+//...     domain = 2048x768
+//...     particles = 4000
+//...     block_columns = 80
+//...     smoothing_length = 12
+//...     pressure = pcisph
+//... describeSimulationConfig() escribe todas las claves con su valor. Lo que no se
+//... asigna queda con el valor por defecto, que es la escena de siempre
+struct SimulationConfig {
+    //... dominio (y ventana) [0, domainWidth] x [0, domainHeight]
+    int domainWidth;
+    int domainHeight;
+    //... bloque inicial: 'particles' partículas en filas de blockColumns (0 = lo más
+    //... cuadrado posible) con la esquina en (blockX, blockY); negativo = primer cuarto
+    int particles;
+    int blockColumns;
+    float blockX, blockY;
+    float spacing;
+    float smoothingLength;
+    float particleMass;
+    //... lado de celda del grid de vecinos; 0 = derivado de h (ver SPHSolver::setGridCellSize)
+    float cellSize;
+    GridLayout gridLayout;
+    //... K pasos, REORDER_OFF o REORDER_ADAPTIVE
+    int reorderInterval;
+    float viscosity;
+    float stiffness;
+    float restDensity;
+    PressureSolver pressureSolver;
+    PCISPHSettings pcisph;
+    NeighborCache neighborCache;
+    float verletSkin;
+    //... densidad y fuerzas sobre la copia compacta (ver SPHSolver::setCompactStorage)
+    bool compactStorage;
+    //... resolución adaptativa (ver ResolutionSettings); resolution_levels = 0 la apaga
+    ResolutionSettings resolution;
+    //... celdas dormidas del fluido asentado (ver SleepSettings); sleep = false las apaga
+    SleepSettings sleep;
+    //... paso fijo de la simulación; con adaptiveTimestep se subdivide en pasos estables
+    float timestep;
+    bool adaptiveTimestep;
+    int maxSubsteps;
+
+    SimulationConfig();
+};
+
+//... lee 'path' encima de lo que ya tiene 'config'; si falla deja 'error' con la línea
+//... y la clave, y 'config' puede quedar a medio aplicar
+bool loadSimulationConfig(const std::string& path, SimulationConfig& config, std::string& error);
+//... una asignación "clave=valor" (la de --set); false si la clave no existe o el valor
+//... no vale para ella
+bool setSimulationConfigValue(const std::string& assignment, SimulationConfig& config,
+                              std::string& error);
+//... todas las claves con su valor actual, en el mismo formato que lee loadSimulationConfig
+std::string describeSimulationConfig(const SimulationConfig& config);
+
+//... fija los parámetros y rearma el bloque inicial (llama a reset(), así que va antes
+//... de agregar obstáculos, emisores o cargar un checkpoint). El sistema y el solver se
+//... construyen antes con config.domainWidth x config.domainHeight
+void applySimulationConfig(const SimulationConfig& config, ParticleSystem& particleSystem,
+                           SPHSolver& solver);
@@ -0,0 +1,36 @@
+/*
+Planificador de paso fijo para la simulación.
+
+El bucle principal le pasa el tiempo real de cada frame. Ese tiempo se acumula y se
+gasta en pasos de duración fija (fixedTimestep), cada uno dividido en 'substeps'
+subpasos. Si un frame pesado deja mucho tiempo acumulado, se ejecutan como mucho
+maxCatchUpSteps pasos y el resto se descarta: la simulación va más lenta que el
+tiempo real por un momento, pero no entra en la espiral de frames cada vez más largos.
+*/
+
+//... simulation_scheduler.cpp
+#include "simulation_scheduler.h"
+
+SimulationScheduler::SimulationScheduler(float fixedTimestep, int substeps, int maxCatchUpSteps)
+    : fixedTimestep(fixedTimestep),
+      substeps(substeps > 0 ? substeps : 1),
+      maxCatchUpSteps(maxCatchUpSteps > 0 ? maxCatchUpSteps : 1),
+      accumulator(0.0f),
+      droppedSteps(0) {}
+
+int SimulationScheduler::advance(float frameSeconds) {
+    if (frameSeconds > 0.0f) {
+        accumulator += frameSeconds;
+    }
+
+    int steps = static_cast<int>(accumulator / fixedTimestep);
+    if (steps > maxCatchUpSteps) {
+        droppedSteps += steps - maxCatchUpSteps;
+        steps = maxCatchUpSteps;
+        //... se conserva solo la fracción pendiente, el resto se pierde
+        accumulator -= static_cast<int>(accumulator / fixedTimestep) * fixedTimestep;
+    } else {
+        accumulator -= steps * fixedTimestep;
+    }
+    return steps;
+}
@@ -0,0 +1,38 @@
+// simulation_scheduler.h
+#pragma once
+
+//... planificador de paso fijo con acumulador: el tiempo real de cada frame se
+//... acumula y se consume en pasos físicos de duración fija, así la física avanza
+//... igual sin importar a cuántos FPS se renderice
+class SimulationScheduler {
+private:
+    float fixedTimestep;
+    int substeps;
+    int maxCatchUpSteps;
+    float accumulator;
+    int droppedSteps;
+
+public:
+    //... fixedTimestep: tiempo simulado por paso; substeps: subpasos por paso;
+    //... maxCatchUpSteps: tope de pasos por frame para no caer en espiral
+    explicit SimulationScheduler(float fixedTimestep = 1.0f/60.0f,
+                                 int substeps = 1,
+                                 int maxCatchUpSteps = 4);
+
+    //... acumula frameSeconds y devuelve cuántos pasos fijos tocan en este frame
+    int advance(float frameSeconds);
+
+    //... descarta el tiempo acumulado (al pausar o reiniciar)
+    void reset() { accumulator = 0.0f; }
+
+    void setFixedTimestep(float dt) { fixedTimestep = dt; }
+    void setSubsteps(int count) { substeps = count > 0 ? count : 1; }
+    void setMaxCatchUpSteps(int count) { maxCatchUpSteps = count > 0 ? count : 1; }
+    float getFixedTimestep() const { return fixedTimestep; }
+    float getSubstepDt() const { return fixedTimestep / substeps; }
+    int getSubsteps() const { return substeps; }
+    //... fracción del siguiente paso ya acumulada, para interpolar al renderizar
+    float getInterpolationAlpha() const { return accumulator / fixedTimestep; }
+    //... pasos descartados por el tope desde el inicio (indica que la física no da abasto)
+    int getDroppedSteps() const { return droppedSteps; }
+};
@@ -0,0 +1,172 @@
+/*
+Hilo de simulación separado del de render.
+
+Antes main.cpp hacía en cada frame la física y después el dibujo, en el mismo hilo: el
+tiempo por frame era la suma de los dos, y el render leía los arreglos que update() acababa
+de cambiar. Ahora la física corre aquí, con su propio reloj y el mismo planificador de
+paso fijo, y al terminar cada tanda de pasos escribe un RenderSnapshot en el búfer trasero
+de un triple búfer y lo publica. El render toma siempre el último publicado sin candados
+ni copias de su lado, así en una máquina con varios núcleos el frame cuesta el máximo de
+los dos y no la suma.
+
+La copia al snapshot (cuatro arreglos de floats) la paga el hilo de simulación; es muy
+chica al lado de un paso. Los obstáculos se copian solo cuando cambian. En el modo de
+dibujo por superficie también se arma aquí la malla del contorno (surface_field.h), con
+el pool de la física, y el render solo la dibuja.
+*/
+
+//... simulation_thread.cpp
+#include "simulation_thread.h"
+#include <algorithm>
+#include <chrono>
+
+SimulationThread::SimulationThread(ParticleSystem& particleSystem, SPHSolver& solver,
+                                   SimulationScheduler& scheduler)
+    : particleSystem(particleSystem),
+      solver(solver),
+      scheduler(scheduler),
+      profiler(nullptr),
+      surfaceField(particleSystem.getDomainWidth(), particleSystem.getDomainHeight()),
+      surfaceRendering(false),
+      surfaceCurrent(false),
+      running(false) {}
+
+SimulationThread::~SimulationThread() {
+    stop();
+}
+
+void SimulationThread::start() {
+    if (running.load()) return;
+    //... primer snapshot antes de arrancar, así el render tiene algo desde el frame 0
+    particleSystem.updateStatistics();
+    publish();
+    running.store(true);
+    worker = std::thread(&SimulationThread::loop, this);
+}
+
+void SimulationThread::stop() {
+    if (!running.exchange(false)) return;
+    worker.join();
+    runCommands();
+}
+
+void SimulationThread::post(std::function<void()> command) {
+    std::lock_guard<std::mutex> lock(commandMutex);
+    commands.push_back(std::move(command));
+}
+
+bool SimulationThread::runCommands() {
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        runningCommands.swap(commands);
+    }
+    if (runningCommands.empty()) return false;
+    for (auto& command : runningCommands) {
+        command();
+    }
+    runningCommands.clear();
+    return true;
+}
+
+void SimulationThread::loop() {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point last = Clock::now();
+
+    while (running.load()) {
+        bool changed = runCommands();
+
+        Clock::time_point now = Clock::now();
+        float frameSeconds = std::chrono::duration<float>(now - last).count();
+        last = now;
+
+        int steps = 0;
+        if (particleSystem.getIsPaused()) {
+            scheduler.reset();
+        } else {
+            steps = scheduler.advance(frameSeconds);
+        }
+
+        if (steps > 0) {
+            if (profiler) profiler->beginFrame();
+            const float dt = scheduler.getSubstepDt();
+            for (int i = 0; i < steps * scheduler.getSubsteps(); i++) {
+                solver.advance(particleSystem, dt);
+                if (stepCallback) stepCallback();
+            }
+            particleSystem.updateStatistics();
+            if (surfaceRendering) {
+                ScopedTimer timer(profiler, ProfilePhase::Surface);
+                surfaceField.build(particleSystem);
+                surfaceCurrent = true;
+            }
+            if (profiler) profiler->endFrame();
+        }
+
+        if (steps > 0 || changed) {
+            publish();
+        } else {
+            //... hasta que toque el próximo paso (o un rato si está en pausa)
+            float remaining = (1.0f - scheduler.getInterpolationAlpha()) * scheduler.getFixedTimestep();
+            if (particleSystem.getIsPaused()) remaining = 0.005f;
+            std::this_thread::sleep_for(std::chrono::duration<float>(std::max(remaining, 0.0005f)));
+        }
+    }
+}
+
+void SimulationThread::publish() {
+    RenderSnapshot& snapshot = snapshots.writeBuffer();
+    const ParticleData& particles = particleSystem.getData();
+
+    //... assign reutiliza la capacidad del búfer, no reserva memoria en régimen
+    snapshot.x.assign(particles.x.begin(), particles.x.end());
+    snapshot.y.assign(particles.y.begin(), particles.y.end());
+    snapshot.vx.assign(particles.vx.begin(), particles.vx.end());
+    snapshot.vy.assign(particles.vy.begin(), particles.vy.end());
+    snapshot.particleRadius = particleSystem.getSmoothingLength() * 0.5f;
+    if (solver.isMultiresolution(particleSystem)) {
+        snapshot.level.assign(particles.level.begin(), particles.level.end());
+        const ResolutionStats& resolution = particleSystem.getResolutionStats();
+        snapshot.levelCounts.assign(resolution.levelCounts,
+                                    resolution.levelCounts + particleSystem.getFinestLevel() + 1);
+    } else {
+        snapshot.level.clear();
+        snapshot.levelCounts.clear();
+    }
+
+    const ObstacleField& obstacles = particleSystem.getObstacles();
+    if (snapshot.obstacleRevision != obstacles.getRevision()) {
+        snapshot.obstacles = obstacles.getObstacles();
+        snapshot.obstacleRevision = obstacles.getRevision();
+    }
+
+    snapshot.stepCount = particleSystem.getStepCount();
+    snapshot.simulatedTime = particleSystem.getSimulatedTime();
+    snapshot.paused = particleSystem.getIsPaused();
+    snapshot.averageVelocity = particleSystem.getAverageVelocity();
+    snapshot.maxVelocity = particleSystem.getMaxVelocity();
+    snapshot.totalKineticEnergy = particleSystem.getTotalKineticEnergy();
+    particleSystem.getVelocityHistory().copyTo(snapshot.velocityHistory);
+    const DensityStats& densityStats = solver.getDensityStats();
+    snapshot.maxDensityError = densityStats.maxError;
+    snapshot.averageDensityError = densityStats.averageError;
+    snapshot.minPressure = densityStats.minPressure;
+    snapshot.maxPressure = densityStats.maxPressure;
+    snapshot.sleeping = solver.getSleepSettings().enabled;
+    snapshot.sleepingCells = solver.getSleepStats().sleepingCells;
+    snapshot.sleepingParticles = solver.getSleepStats().sleepingParticles;
+    snapshot.adaptiveTimestep = solver.getTimestepSettings().adaptive;
+    snapshot.lastSubsteps = solver.getTimestepStats().lastSubsteps;
+    snapshot.lastTimestep = solver.getTimestepStats().lastTimestep;
+    snapshot.surface = surfaceRendering;
+    if (surfaceRendering) {
+        //... sin pasos nuevos (un comando en pausa) se arma aquí, fuera del profiler
+        if (!surfaceCurrent) surfaceField.build(particleSystem);
+        snapshot.surfaceTriangles.assign(surfaceField.getTriangles().begin(), surfaceField.getTriangles().end());
+    } else {
+        snapshot.surfaceTriangles.clear();
+    }
+    surfaceCurrent = false;
+    snapshot.profileSummary = profiler ? profiler->summary() : std::string();
+
+    snapshots.publish();
+}
@@ -0,0 +1,72 @@
+// simulation_thread.h
+#pragma once
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "particle_system.h"
+#include "sph_solver.h"
+#include "simulation_scheduler.h"
+#include "profiler.h"
+#include "render_snapshot.h"
+#include "surface_field.h"
+
+//... corre la física en un hilo propio, a paso fijo con el planificador, y publica cada
+//... paso terminado en un TripleBuffer<RenderSnapshot> que el hilo de render lee sin
+//... esperar. Mientras el hilo corre, ParticleSystem y SPHSolver son suyos: cualquier
+//... cambio desde otro hilo (teclado, mouse, cargar checkpoint...) pasa por post()
+class SimulationThread {
+private:
+    ParticleSystem& particleSystem;
+    SPHSolver& solver;
+    SimulationScheduler& scheduler;
+    Profiler* profiler;
+    std::function<void()> stepCallback;
+    //... con surfaceRendering cada snapshot lleva la superficie en vez de solo partículas;
+    //... surfaceCurrent = ya se armó para el estado actual (dentro del frame del profiler)
+    SurfaceField surfaceField;
+    bool surfaceRendering;
+    bool surfaceCurrent;
+    TripleBuffer<RenderSnapshot> snapshots;
+
+    std::thread worker;
+    std::atomic<bool> running;
+    std::mutex commandMutex;
+    std::vector<std::function<void()>> commands;
+    std::vector<std::function<void()>> runningCommands;
+
+    void loop();
+    bool runCommands();
+    void publish();
+
+public:
+    SimulationThread(ParticleSystem& particleSystem, SPHSolver& solver, SimulationScheduler& scheduler);
+    ~SimulationThread();
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    //... el profiler, el pool y el callback se fijan antes de start()
+    void setProfiler(Profiler* p) { profiler = p; }
+    //... el de la física: la superficie se arma en el hilo de simulación, entre dos pasos
+    void setThreadPool(ThreadPool* pool) { surfaceField.setThreadPool(pool); }
+    //... se llama en el hilo de simulación después de cada subpaso (p. ej. exportar)
+    void setStepCallback(std::function<void()> callback) { stepCallback = std::move(callback); }
+
+    void start();
+    //... ejecuta los comandos pendientes y espera a que el hilo termine
+    void stop();
+    bool isRunning() const { return running.load(); }
+
+    //... encola 'command' para el hilo de simulación, entre dos pasos
+    void post(std::function<void()> command);
+
+    //... antes de start() o desde un comando (post): vale desde el próximo snapshot
+    void setSurfaceRendering(bool enabled) { surfaceRendering = enabled; }
+    bool getSurfaceRendering() const { return surfaceRendering; }
+
+    //... lado del render: acquireSnapshot() pasa al último estado publicado (si hay uno
+    //... nuevo) y getSnapshot() lo devuelve; sigue siendo válido hasta el próximo acquire
+    bool acquireSnapshot() { return snapshots.acquire(); }
+    const RenderSnapshot& getSnapshot() const { return snapshots.readBuffer(); }
+};
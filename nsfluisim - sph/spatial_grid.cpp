@@ -8,51 +8,260 @@ Este enfoque reduce la complejidad de tiempo de O(n^2) a O(n) en el cálculo de
 
 El código muestra la implementación de la cuadrícula y cómo se actualiza y se buscan los vecinos de una partícula. 
 Este código es parte de una simulación de fluidos utilizando el método Smoothed Particle Hydrodynamics (SPH) en C++.
+
+Con GridLayout::Hashed el arreglo denso se cambia por uno compacto de celdas ocupadas.
+Al armar, cada partícula busca su celda en una tabla hash (direccionamiento abierto,
+sondeo lineal, a lo sumo medio llena) y la inserta si es nueva; después se ordenan solo
+las celdas ocupadas por (fila, columna), que son muchas menos que las partículas, y el
+counting sort de siempre reparte las partículas por celda. El costo sigue siendo lineal
+en partículas más m log m en celdas ocupadas, y la memoria es proporcional a m: un
+dominio de 100000 x 100000 con el fluido en un rincón cuesta lo mismo que la ventana.
+Para que las consultas no paguen nueve búsquedas en la tabla, al armar se guardan por
+cada celda ocupada los tres tramos de su vecindad: una consulta desde una partícula hace
+una sola búsqueda (la de su celda). El orden de las partículas dentro de cada celda y el
+de los tramos es el mismo que en Dense, así que con todas las partículas dentro del dominio las dos dan igual bit a bit.
 */
 
 //... spatial_grid.cpp
 #include "spatial_grid.h"
+#include <algorithm>
+#include <cmath>
 
 SpatialGrid::SpatialGrid(int width, int height, float cellSize) 
-    : gridWidth(width/cellSize), gridHeight(height/cellSize), cellSize(cellSize) {
-    grid.resize(gridWidth * gridHeight);
+    : domainWidth(width),
+      domainHeight(height),
+      gridWidth(static_cast<int>(std::ceil(width/cellSize))),
+      gridHeight(static_cast<int>(std::ceil(height/cellSize))),
+      cellSize(cellSize),
+      layout(GridLayout::Dense),
+      tableMask(0) {
+    cellStart.assign(gridWidth * gridHeight + 1, 0);
 }
 
-void SpatialGrid::updateGrid(const std::vector<Particle>& particles) {
-    //... limpiar grid
-    for (auto& cell : grid) {
-        cell.particleIndices.clear();
-    }
-    
-    //... insertar partículas en el grid
-    for (int i = 0; i < particles.size(); i++) {
-        int cellX = particles[i].position.x / cellSize;
-        int cellY = particles[i].position.y / cellSize;
-        
-        if (cellX >= 0 && cellX < gridWidth && cellY >= 0 && cellY < gridHeight) {
-            grid[cellY * gridWidth + cellX].particleIndices.push_back(i);
+void SpatialGrid::setLayout(GridLayout mode) {
+    if (mode == layout) return;
+    layout = mode;
+    //... swap con vacíos para devolver de verdad la memoria de la otra organización
+    if (layout == GridLayout::Hashed) {
+        std::vector<int>(1, 0).swap(cellStart);
+        resizeTable(64);
+    } else {
+        std::vector<uint64_t>().swap(cellKeys);
+        std::vector<TableEntry>().swap(table);
+        std::vector<int>().swap(cellOrder);
+        std::vector<int>().swap(cellRank);
+        std::vector<uint64_t>().swap(sortedKeys);
+        std::vector<int>().swap(cellSpans);
+        tableMask = 0;
+        cellStart.assign(gridWidth * gridHeight + 1, 0);
+    }
+    //... hasta el próximo updateGrid no hay partículas repartidas
+    particleIndices.clear();
+    particleCells.clear();
+}
+
+void SpatialGrid::setCellSize(float size) {
+    if (size == cellSize) return;
+    cellSize = size;
+    gridWidth = static_cast<int>(std::ceil(domainWidth/cellSize));
+    gridHeight = static_cast<int>(std::ceil(domainHeight/cellSize));
+    if (layout == GridLayout::Dense) {
+        cellStart.assign(gridWidth * gridHeight + 1, 0);
+    } else {
+        //... la tabla queda vacía: hasta el próximo armado ninguna consulta encuentra celdas
+        cellStart.assign(1, 0);
+        cellKeys.clear();
+        for (TableEntry& entry : table) entry.cell = -1;
+    }
+    particleIndices.clear();
+    particleCells.clear();
+}
+
+size_t SpatialGrid::getMemoryBytes() const {
+    return (cellStart.capacity() + particleIndices.capacity() + particleCells.capacity() +
+            cellOrder.capacity() + cellRank.capacity() + cellSpans.capacity()) * sizeof(int) +
+           (cellKeys.capacity() + sortedKeys.capacity()) * sizeof(uint64_t) +
+           table.capacity() * sizeof(TableEntry);
+}
+
+//... las partículas pegadas al borde (x == ancho del dominio) o fuera de él caen en la
+//... celda extrema en vez de perderse; como el acotado es monótono, dos partículas
+//... a distancia < cellSize siguen quedando en celdas adyacentes
+int SpatialGrid::cellCoordX(float x) const {
+    int cellX = static_cast<int>(std::floor(x / cellSize));
+    return std::max(0, std::min(gridWidth - 1, cellX));
+}
+
+int SpatialGrid::cellCoordY(float y) const {
+    int cellY = static_cast<int>(std::floor(y / cellSize));
+    return std::max(0, std::min(gridHeight - 1, cellY));
+}
+
+//... se acota en float: std::min(límite, NaN) da el límite, así un NaN no llega al cast
+int SpatialGrid::hashedCoord(float v) const {
+    const float limit = 1073741824.0f;
+    float cell = std::floor(v / cellSize);
+    return static_cast<int>(std::max(-limit, std::min(limit, cell)));
+}
+
+void SpatialGrid::resizeTable(size_t capacity) {
+    table.assign(capacity, TableEntry{0, -1});
+    tableMask = capacity - 1;
+}
+
+int SpatialGrid::insertCell(uint64_t key) {
+    size_t slot = tableSlot(key);
+    for (; table[slot].cell >= 0; slot = (slot + 1) & tableMask) {
+        if (table[slot].key == key) return table[slot].cell;
+    }
+    int cell = static_cast<int>(cellKeys.size());
+    cellKeys.push_back(key);
+    table[slot] = TableEntry{key, cell};
+
+    //... a más de media carga los sondeos se alargan: se duplica y se reinserta
+    if (cellKeys.size() * 2 > table.size()) {
+        resizeTable(table.size() * 2);
+        for (size_t c = 0; c < cellKeys.size(); c++) {
+            size_t s = tableSlot(cellKeys[c]);
+            while (table[s].cell >= 0) s = (s + 1) & tableMask;
+            table[s] = TableEntry{cellKeys[c], static_cast<int>(c)};
         }
     }
+    return cell;
 }
 
-std::vector<int> SpatialGrid::getNeighbors(const sf::Vector2f& position) {
-    std::vector<int> neighbors;
-    int cellX = position.x / cellSize;
-    int cellY = position.y / cellSize;
-    
-    //... buscar en celdas adyacentes
-    for (int dy = -1; dy <= 1; dy++) {
-        for (int dx = -1; dx <= 1; dx++) {
-            int nx = cellX + dx;
-            int ny = cellY + dy;
-            
-            if (nx >= 0 && nx < gridWidth && ny >= 0 && ny < gridHeight) {
-                const auto& cell = grid[ny * gridWidth + nx];
-                neighbors.insert(neighbors.end(), 
-                               cell.particleIndices.begin(), 
-                               cell.particleIndices.end());
-            }
+template <typename PositionAt>
+void SpatialGrid::updateHashed(int count, PositionAt&& positionAt, const int* ids) {
+    //... tabla de al menos el doble de las celdas del armado anterior; se achica si
+    //... quedó muy grande, así no guarda memoria de un pico viejo
+    size_t capacity = 64;
+    while (capacity < cellKeys.size() * 2) capacity *= 2;
+    if (table.size() < capacity || table.size() > capacity * 4) {
+        resizeTable(capacity);
+    } else {
+        for (TableEntry& entry : table) entry.cell = -1;
+    }
+    cellKeys.clear();
+
+    //... celda provisoria de cada partícula, en orden de aparición
+    particleCells.resize(count);
+    for (int i = 0; i < count; i++) {
+        Vec2 position = positionAt(i);
+        particleCells[i] = insertCell(cellKey(hashedCoord(position.x), hashedCoord(position.y)));
+    }
+
+    //... orden (fila, columna) de las celdas ocupadas y renumeración de la tabla
+    const int numCells = static_cast<int>(cellKeys.size());
+    cellOrder.resize(numCells);
+    for (int c = 0; c < numCells; c++) cellOrder[c] = c;
+    std::sort(cellOrder.begin(), cellOrder.end(), [&](int a, int b) {
+        return cellKeys[a] < cellKeys[b];
+    });
+    cellRank.resize(numCells);
+    for (int r = 0; r < numCells; r++) cellRank[cellOrder[r]] = r;
+    for (TableEntry& entry : table) {
+        if (entry.cell >= 0) entry.cell = cellRank[entry.cell];
+    }
+    for (int i = 0; i < count; i++) {
+        particleCells[i] = cellRank[particleCells[i]];
+    }
+    //... las claves quedan en orden; sortedKeys conserva su capacidad entre armados
+    sortedKeys.resize(numCells);
+    for (int r = 0; r < numCells; r++) sortedKeys[r] = cellKeys[cellOrder[r]];
+    cellKeys.swap(sortedKeys);
+
+    sortByCell(numCells, ids);
+
+    //... tramos de la vecindad de cada celda ocupada (ver forEachHashedSpan)
+    cellSpans.resize(static_cast<size_t>(numCells) * 6);
+    for (int c = 0; c < numCells; c++) {
+        const int cellX = static_cast<int>(static_cast<uint32_t>(cellKeys[c]) ^ 0x80000000u);
+        const int cellY = static_cast<int>(static_cast<uint32_t>(cellKeys[c] >> 32) ^ 0x80000000u);
+        int* spans = cellSpans.data() + static_cast<size_t>(c) * 6;
+        for (int r = 0; r < 3; r++) {
+            rowSpan(cellX - 1, cellX + 1, cellY - 1 + r, spans[2 * r], spans[2 * r + 1]);
         }
     }
+}
+
+void SpatialGrid::updateGrid(const ParticleData& particles) {
+    int count = static_cast<int>(particles.size());
+    if (layout == GridLayout::Hashed) {
+        updateHashed(count, [&](int i) { return Vec2(particles.x[i], particles.y[i]); });
+        return;
+    }
+    particleCells.resize(count);
+    for (int i = 0; i < count; i++) {
+        particleCells[i] = cellCoordY(particles.y[i]) * gridWidth + cellCoordX(particles.x[i]);
+    }
+    sortByCell(gridWidth * gridHeight);
+}
+
+void SpatialGrid::updateGrid(const std::vector<Particle>& particles) {
+    int count = static_cast<int>(particles.size());
+    if (layout == GridLayout::Hashed) {
+        updateHashed(count, [&](int i) { return particles[i].position; });
+        return;
+    }
+    particleCells.resize(count);
+    for (int i = 0; i < count; i++) {
+        particleCells[i] = cellCoordY(particles[i].position.y) * gridWidth +
+                           cellCoordX(particles[i].position.x);
+    }
+    sortByCell(gridWidth * gridHeight);
+}
+
+void SpatialGrid::updateGrid(const ParticleData& particles, const std::vector<int>& subset) {
+    int count = static_cast<int>(subset.size());
+    if (layout == GridLayout::Hashed) {
+        updateHashed(count, [&](int k) { return Vec2(particles.x[subset[k]], particles.y[subset[k]]); },
+                     subset.data());
+        return;
+    }
+    particleCells.resize(count);
+    for (int k = 0; k < count; k++) {
+        const int i = subset[k];
+        particleCells[k] = cellCoordY(particles.y[i]) * gridWidth + cellCoordX(particles.x[i]);
+    }
+    sortByCell(gridWidth * gridHeight, subset.data());
+}
+
+void SpatialGrid::sortByCell(int numCells, const int* ids) {
+    int count = static_cast<int>(particleCells.size());
+    particleIndices.resize(count);
+
+    //... contar partículas por celda
+    cellStart.assign(numCells + 1, 0);
+    for (int i = 0; i < count; i++) {
+        cellStart[particleCells[i] + 1]++;
+    }
+
+    //... suma prefija -> inicio de cada celda
+    for (int c = 0; c < numCells; c++) {
+        cellStart[c + 1] += cellStart[c];
+    }
+
+    //... repartir índices; cellStart[c] avanza como cursor de la celda c y
+    //... al terminar apunta al inicio de c+1, así que se desplaza una posición
+    for (int i = 0; i < count; i++) {
+        particleIndices[cellStart[particleCells[i]]++] = ids ? ids[i] : i;
+    }
+    for (int c = numCells; c > 0; c--) {
+        cellStart[c] = cellStart[c - 1];
+    }
+    cellStart[0] = 0;
+}
+
+std::vector<int> SpatialGrid::getNeighbors(const Vec2& position) const {
+    std::vector<int> neighbors;
+    getNeighbors(position, neighbors);
     return neighbors;
 }
+
+//... versión sin reservas: escribe en un vector del llamador que se reutiliza entre consultas
+void SpatialGrid::getNeighbors(const Vec2& position, std::vector<int>& neighbors) const {
+    neighbors.clear();
+    forEachNeighborSpan(position, [&](const int* begin, const int* end) {
+        neighbors.insert(neighbors.end(), begin, end);
+    });
+}
@@ -1,20 +1,231 @@
 // spatial_grid.h
 #pragma once
+#include <cstdint>
 #include <vector>
 #include "particle_system.h"
 
+//... organización de las celdas: Dense es un arreglo de gridWidth x gridHeight que
+//... cubre el dominio (lo de afuera cae en la celda del borde); Hashed guarda solo las
+//... celdas ocupadas, así la memoria depende de las partículas y no del área, y no hay
+//... bordes: sirve para dominios grandes o abiertos donde el fluido ocupa poco
+enum class GridLayout {
+    Dense,
+    Hashed
+};
+
+//... grid plano tipo counting sort: particleIndices guarda los índices ordenados
+//... por celda y cellStart[c]..cellStart[c+1] es el rango de la celda c. En Hashed,
+//... c es el número de la celda ocupada en orden (fila, columna) y una tabla hash de
+//... direccionamiento abierto lleva de las coordenadas de la celda a c
 class SpatialGrid {
 private:
-    struct Cell {
-        std::vector<int> particleIndices;
-    };
-    
-    std::vector<Cell> grid;
+    std::vector<int> cellStart;
+    std::vector<int> particleIndices;
+    std::vector<int> particleCells;
+    int domainWidth, domainHeight;
     int gridWidth, gridHeight;
     float cellSize;
+    GridLayout layout;
+
+    //... solo Hashed: clave de cada celda ocupada (ordenadas) y la tabla clave -> celda;
+    //... clave y celda juntas, así un sondeo toca una sola línea de caché
+    struct TableEntry {
+        uint64_t key;
+        int cell;           //... -1 = vacía
+    };
+    std::vector<uint64_t> cellKeys;
+    std::vector<TableEntry> table;
+    size_t tableMask;
+    std::vector<int> cellOrder;
+    std::vector<int> cellRank;
+    std::vector<uint64_t> sortedKeys;
+    //... por celda ocupada, los tramos [begin, end) de sus filas vecinas (y-1, y, y+1)
+    std::vector<int> cellSpans;
 
 public:
     SpatialGrid(int width, int height, float cellSize);
+    void updateGrid(const ParticleData& particles);
     void updateGrid(const std::vector<Particle>& particles);
-    std::vector<int> getNeighbors(const sf::Vector2f& position);
+    //... solo las partículas de 'subset' (índices en ParticleData, por ejemplo las de un
+    //... nivel de resolución): las consultas devuelven esos mismos índices, y
+    //... getParticleCells() queda indexado por la posición dentro de 'subset'
+    void updateGrid(const ParticleData& particles, const std::vector<int>& subset);
+    std::vector<int> getNeighbors(const Vec2& position) const;
+    void getNeighbors(const Vec2& position, std::vector<int>& neighbors) const;
+    float getCellSize() const { return cellSize; }
+    int getDomainWidth() const { return domainWidth; }
+    int getDomainHeight() const { return domainHeight; }
+    //... cambia el lado de celda sobre el mismo dominio; vale desde el próximo updateGrid
+    void setCellSize(float size);
+
+    //... cambiar la organización libera la memoria de la otra; vale desde el próximo updateGrid
+    void setLayout(GridLayout mode);
+    GridLayout getLayout() const { return layout; }
+    //... celdas con partículas (Dense: todas las del arreglo)
+    int getCellCount() const { return static_cast<int>(cellStart.size()) - 1; }
+    //... bytes reservados por el grid, para comparar organizaciones
+    size_t getMemoryBytes() const;
+
+    //... solo Dense, para recorrer las celdas a mano (ver CompactParticles): la celda c =
+    //... y * gridWidth + x tiene las entradas [cellStart[c], cellStart[c+1]) de
+    //... getParticleIndices(), y getParticleCells()[i] es la celda de la partícula i
+    int getGridWidth() const { return gridWidth; }
+    int getGridHeight() const { return gridHeight; }
+    const std::vector<int>& getCellStart() const { return cellStart; }
+    const std::vector<int>& getParticleIndices() const { return particleIndices; }
+    const std::vector<int>& getParticleCells() const { return particleCells; }
+
+    //... recorre los vecinos como tramos contiguos [begin, end) del arreglo de índices,
+    //... sin reservar memoria; las celdas de una misma fila son consecutivas
+    template <typename SpanVisitor>
+    void forEachNeighborSpan(float x, float y, SpanVisitor&& visit) const {
+        if (layout == GridLayout::Hashed) {
+            forEachHashedSpan(x, y, visit);
+            return;
+        }
+        int cellX = cellCoordX(x);
+        int cellY = cellCoordY(y);
+        int x0 = cellX > 0 ? cellX - 1 : 0;
+        int x1 = cellX < gridWidth - 1 ? cellX + 1 : gridWidth - 1;
+        int y0 = cellY > 0 ? cellY - 1 : 0;
+        int y1 = cellY < gridHeight - 1 ? cellY + 1 : gridHeight - 1;
+
+        for (int ny = y0; ny <= y1; ny++) {
+            int row = ny * gridWidth;
+            const int* begin = particleIndices.data() + cellStart[row + x0];
+            const int* end = particleIndices.data() + cellStart[row + x1 + 1];
+            if (begin != end) {
+                visit(begin, end);
+            }
+        }
+    }
+
+    //... llama visit(j) por cada índice de partícula en las celdas vecinas
+    template <typename Visitor>
+    void forEachNeighbor(float x, float y, Visitor&& visit) const {
+        forEachNeighborSpan(x, y, [&](const int* begin, const int* end) {
+            for (const int* it = begin; it != end; ++it) {
+                visit(*it);
+            }
+        });
+    }
+
+    //... como forEachNeighborSpan pero con las celdas que toca el cuadrado de lado 2 *
+    //... radius centrado en (x, y): sirve para un radio distinto del lado de celda (mayor
+    //... o menor), y un vecino a menos de 'radius' siempre está en uno de los tramos
+    template <typename SpanVisitor>
+    void forEachSpanWithin(float x, float y, float radius, SpanVisitor&& visit) const {
+        const int* indices = particleIndices.data();
+        if (layout == GridLayout::Hashed) {
+            const int x0 = hashedCoord(x - radius), x1 = hashedCoord(x + radius);
+            for (int ny = hashedCoord(y - radius); ny <= hashedCoord(y + radius); ny++) {
+                int begin, end;
+                rowSpan(x0, x1, ny, begin, end);
+                if (begin != end) {
+                    visit(indices + begin, indices + end);
+                }
+            }
+            return;
+        }
+        const int x0 = cellCoordX(x - radius), x1 = cellCoordX(x + radius);
+        const int y1 = cellCoordY(y + radius);
+        for (int ny = cellCoordY(y - radius); ny <= y1; ny++) {
+            int row = ny * gridWidth;
+            const int* begin = indices + cellStart[row + x0];
+            const int* end = indices + cellStart[row + x1 + 1];
+            if (begin != end) {
+                visit(begin, end);
+            }
+        }
+    }
+
+    template <typename SpanVisitor>
+    void forEachNeighborSpan(const Vec2& position, SpanVisitor&& visit) const {
+        forEachNeighborSpan(position.x, position.y, visit);
+    }
+
+    template <typename Visitor>
+    void forEachNeighbor(const Vec2& position, Visitor&& visit) const {
+        forEachNeighbor(position.x, position.y, visit);
+    }
+
+private:
+    //... ordena por celda a partir de particleCells (counting sort); con 'ids' guarda
+    //... ids[i] en vez de i
+    void sortByCell(int numCells, const int* ids = nullptr);
+
+    //... índice de celda acotado al grid, así ninguna partícula queda fuera de la búsqueda
+    int cellCoordX(float x) const;
+    int cellCoordY(float y) const;
+
+    //... Hashed: coordenada de celda sin acotar (solo se limita a +-2^30 para no desbordar)
+    int hashedCoord(float v) const;
+    //... clave ordenable por (fila, columna): el bit de signo invertido deja los negativos
+    //... antes de los positivos, así las celdas vecinas de una fila quedan seguidas
+    static uint64_t cellKey(int cellX, int cellY) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cellY) ^ 0x80000000u) << 32) |
+               (static_cast<uint32_t>(cellX) ^ 0x80000000u);
+    }
+    size_t tableSlot(uint64_t key) const {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & tableMask;
+    }
+    //... celda ocupada con esa clave, o -1
+    int findCell(uint64_t key) const {
+        for (size_t slot = tableSlot(key); table[slot].cell >= 0; slot = (slot + 1) & tableMask) {
+            if (table[slot].key == key) return table[slot].cell;
+        }
+        return -1;
+    }
+    //... inserta si no estaba; devuelve la celda (provisoria, en orden de aparición)
+    int insertCell(uint64_t key);
+    void resizeTable(size_t capacity);
+    template <typename PositionAt>
+    void updateHashed(int count, PositionAt&& positionAt, const int* ids = nullptr);
+
+    //... como en Dense, un tramo por fila: como las celdas ocupadas están ordenadas por
+    //... (fila, columna), las de la fila ny entre las columnas firstX y lastX son
+    //... consecutivas, y sus partículas también. Deja [begin, end) en particleIndices
+    void rowSpan(int firstX, int lastX, int ny, int& begin, int& end) const {
+        begin = end = 0;
+        int first = -1;
+        for (int nx = firstX; nx <= lastX && first < 0; nx++) {
+            first = findCell(cellKey(nx, ny));
+        }
+        if (first < 0) return;
+        const uint64_t lastKey = cellKey(lastX, ny);
+        const int numCells = getCellCount();
+        int last = first;
+        while (last + 1 < numCells && cellKeys[last + 1] <= lastKey) {
+            last++;
+        }
+        begin = cellStart[first];
+        end = cellStart[last + 1];
+    }
+
+    //... la celda propia casi siempre está ocupada (la consulta es de una partícula): sus
+    //... tres tramos quedan precalculados en cellSpans y basta una búsqueda en la tabla.
+    //... Si no (una posición cualquiera), se arma fila por fila
+    template <typename SpanVisitor>
+    void forEachHashedSpan(float x, float y, SpanVisitor&& visit) const {
+        const int cellX = hashedCoord(x);
+        const int cellY = hashedCoord(y);
+        const int* indices = particleIndices.data();
+        const int cell = findCell(cellKey(cellX, cellY));
+        if (cell >= 0) {
+            const int* spans = cellSpans.data() + cell * 6;
+            for (int r = 0; r < 6; r += 2) {
+                if (spans[r] != spans[r + 1]) {
+                    visit(indices + spans[r], indices + spans[r + 1]);
+                }
+            }
+            return;
+        }
+        for (int ny = cellY - 1; ny <= cellY + 1; ny++) {
+            int begin, end;
+            rowSpan(cellX - 1, cellX + 1, ny, begin, end);
+            if (begin != end) {
+                visit(indices + begin, indices + end);
+            }
+        }
+    }
 };
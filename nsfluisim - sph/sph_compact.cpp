@@ -0,0 +1,159 @@
+/*
+Pasadas de densidad y fuerzas de SPHSolver sobre el almacenamiento compacto.
+
+Son las mismas fórmulas que calculateDensityPressure y calculateForces con los kernels
+de SPHKernels, pero todo lo que se lee de una partícula (propia o vecina) sale de
+CompactParticles: se recorre en el orden del grid, y los vecinos de cada una de las
+3x3 celdas son un tramo contiguo de la copia de 12 bytes por partícula. La diferencia de
+posición se saca en enteros, con los desplazamientos dentro de la celda más el salto
+entre la celda propia y la vecina, y recién entonces pasa a float: es exacta y no
+depende de dónde esté la celda en el dominio. Por el salto el recorrido va celda por
+celda y no por filas como forEachNeighborSpan.
+
+Los resultados (densidad, presión y fuerza) se escriben en float en ParticleData, en el
+lugar de cada partícula, y las estadísticas salen de la misma pasada que en la ruta
+float. El error frente a ella es del orden de la precisión del float16 (~5e-4
+relativo); headless_main --check-compact lo mide sobre el estado final de una corrida.
+*/
+
+//... sph_compact.cpp
+#include "sph_solver.h"
+#include <cmath>
+#include <algorithm>
+
+//... las 3x3 celdas alrededor de (cellX, cellY), una por una, con su tramo de entradas y
+//... el salto (cellX - nx, cellY - ny) en unidades de desplazamiento
+template <typename CellVisitor>
+static void forEachCompactCell(const SpatialGrid& grid, int cellX, int cellY, CellVisitor&& visit) {
+    const int gridWidth = grid.getGridWidth();
+    const int gridHeight = grid.getGridHeight();
+    const int* cellStart = grid.getCellStart().data();
+    int x0 = cellX > 0 ? cellX - 1 : 0;
+    int x1 = cellX < gridWidth - 1 ? cellX + 1 : gridWidth - 1;
+    int y0 = cellY > 0 ? cellY - 1 : 0;
+    int y1 = cellY < gridHeight - 1 ? cellY + 1 : gridHeight - 1;
+    for (int ny = y0; ny <= y1; ny++) {
+        const int shiftY = (cellY - ny) * CompactParticles::CELL_UNITS;
+        for (int nx = x0; nx <= x1; nx++) {
+            const int cell = ny * gridWidth + nx;
+            if (cellStart[cell] != cellStart[cell + 1]) {
+                visit(cellStart[cell], cellStart[cell + 1],
+                      (cellX - nx) * CompactParticles::CELL_UNITS, shiftY);
+            }
+        }
+    }
+}
+
+void SPHSolver::calculateDensityCompact(ParticleSystem& particleSystem) {
+    ParticleData& particles = particleSystem.getData();
+    const int count = static_cast<int>(particles.size());
+    const float h = particleSystem.getSmoothingLength();
+    const float mass = particleSystem.getParticleMass();
+    refreshKernels(h);
+    const SPHKernels& kernel = kernels;
+    const int gridWidth = grid.getGridWidth();
+    const int* indices = grid.getParticleIndices().data();
+    const int* cells = grid.getParticleCells().data();
+    const CompactPosition* positions = compact.positionData();
+    const float step = compact.getOffsetStep();
+    const int grain = chunkGrain(threadPool, count);
+    densityPartials.assign(chunkTotal(count, grain), emptyDensityPartial());
+
+    //... los trozos van por entrada del grid, no por partícula
+    parallelChunks(threadPool, count, grain, [&](int begin, int end) {
+        DensityPartial partial = emptyDensityPartial();
+        for (int k = begin; k < end; k++) {
+            const int i = indices[k];
+            const int cellX = cells[i] % gridWidth;
+            const int cellY = cells[i] / gridWidth;
+            const int ownX = positions[k].x;
+            const int ownY = positions[k].y;
+
+            float kernelSum = 0.0f;
+            forEachCompactCell(grid, cellX, cellY, [&](int first, int last, int shiftX, int shiftY) {
+                const int baseX = ownX + shiftX;
+                const int baseY = ownY + shiftY;
+                for (int m = first; m < last; m++) {
+                    float dx = static_cast<float>(baseX - positions[m].x) * step;
+                    float dy = static_cast<float>(baseY - positions[m].y) * step;
+                    kernelSum += kernel.density(dx * dx + dy * dy);
+                }
+            });
+            float density = mass * kernelSum;
+            float pressure = stiffness * (density - restDensity);
+            particles.density[i] = density;
+            particles.pressure[i] = pressure;
+            accumulateDensity(partial, density, pressure, restDensity);
+        }
+        densityPartials[begin / grain] = partial;
+    });
+    reduceDensityStats(count);
+
+    //... la pasada de fuerzas lee la densidad y la presión de los vecinos de la copia
+    compact.storeDensity(particles, grid, densityStats.maxDensity,
+                         std::max(std::fabs(densityStats.minPressure), std::fabs(densityStats.maxPressure)),
+                         threadPool);
+}
+
+void SPHSolver::calculateForcesCompact(ParticleSystem& particleSystem) {
+    ParticleData& particles = particleSystem.getData();
+    const int count = static_cast<int>(particles.size());
+    const float h = particleSystem.getSmoothingLength();
+    const float mass = particleSystem.getParticleMass();
+    refreshKernels(h);
+    const SPHKernels& kernel = kernels;
+    const float h2 = h * h;
+    const int gridWidth = grid.getGridWidth();
+    const int* indices = grid.getParticleIndices().data();
+    const int* cells = grid.getParticleCells().data();
+    const CompactPosition* positions = compact.positionData();
+    const CompactState* states = compact.stateData();
+    const float step = compact.getOffsetStep();
+
+    parallelChunks(threadPool, count, chunkGrain(threadPool, count), [&](int begin, int end) {
+        for (int k = begin; k < end; k++) {
+            const int i = indices[k];
+            const int cellX = cells[i] % gridWidth;
+            const int cellY = cells[i] / gridWidth;
+            const int ownX = positions[k].x;
+            const int ownY = positions[k].y;
+            const Vec2 velocity(CompactParticles::velocity(states[k].vx),
+                                CompactParticles::velocity(states[k].vy));
+            const float ownPressure = compact.pressure(states[k]);
+            Vec2 pressureForce(0.0f, 0.0f);
+            Vec2 viscosityForce(0.0f, 0.0f);
+
+            forEachCompactCell(grid, cellX, cellY, [&](int first, int last, int shiftX, int shiftY) {
+                const int baseX = ownX + shiftX;
+                const int baseY = ownY + shiftY;
+                for (int m = first; m < last; m++) {
+                    if (m == k) continue;
+                    Vec2 diff(static_cast<float>(baseX - positions[m].x) * step,
+                              static_cast<float>(baseY - positions[m].y) * step);
+                    float r2 = diff.x * diff.x + diff.y * diff.y;
+                    if (r2 >= h2) continue;
+                    float r = std::sqrt(r2);
+                    const CompactState& neighbor = states[m];
+                    const float density = compact.density(neighbor);
+
+                    //... como en calculateForces: con r == 0 la presión no tiene dirección
+                    if (r > 0.0f) {
+                        pressureForce += diff/r * mass *
+                            (ownPressure + compact.pressure(neighbor))/(2.0f * density) *
+                            kernel.pressureGradient(r);
+                    }
+                    Vec2 velocityDiff(CompactParticles::velocity(neighbor.vx) - velocity.x,
+                                      CompactParticles::velocity(neighbor.vy) - velocity.y);
+                    viscosityForce += mass * velocityDiff / density * kernel.viscosityLaplacian(r);
+                }
+            });
+
+            Vec2 gravity(0.0f, 981.0f); //... gravedad en cm/s^2
+            Vec2 force = pressureForce * -1.0f +
+                            viscosityForce * viscosity +
+                            gravity;
+            particles.fx[i] = force.x;
+            particles.fy[i] = force.y;
+        }
+    });
+}
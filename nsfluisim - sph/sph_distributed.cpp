@@ -0,0 +1,107 @@
+/*
+Paso de SPHSolver con el dominio repartido entre procesos (ver domain_decomposition.h).
+
+Cada proceso tiene solo las partículas de su franja. Para que densidad y fuerzas sean las
+de una corrida en un solo proceso, el vecino manda como fantasmas las suyas a menos de 2h
+del borde compartido, con posición y velocidad: con esa banda doble la densidad de cada
+fantasma a menos de h del borde se calcula aquí mismo (todos sus vecinos están en la
+banda o son propios) y no hace falta una segunda ronda para intercambiar densidades.
+
+Con e la distancia al borde compartido más cercano:
+    e >= h   la densidad propia no ve fantasmas
+    e >= 2h  la fuerza tampoco: sus vecinos están a e >= h y su densidad ya es la final
+Así el paso va en dos mitades. Primero se piden las fantasmas y, mientras viajan, se arma
+el grid con las propias y se calculan la densidad de las de e >= h y la fuerza de las de
+e >= 2h, que son casi todas con franjas anchas. Después se agregan las fantasmas al final
+de las partículas, se rearma el grid con todas y se completan la densidad de las propias
+y las fantasmas a menos de h y la fuerza de las propias a menos de 2h. Al terminar las
+fantasmas se sacan y la integración de ParticleSystem::update() ve solo las propias.
+
+Las pasadas son las de la ecuación de estado sobre los arreglos float (densityPass y
+forcesPass con un subconjunto). Las estadísticas de densidad salen de una pasada corta
+sobre las propias al final, porque cada mitad ve solo una parte.
+*/
+
+//... sph_distributed.cpp
+#include "sph_solver.h"
+#include <cmath>
+#include <algorithm>
+
+void SPHSolver::collectDensityStats(const ParticleData& particles, int count) {
+    const int grain = chunkGrain(threadPool, count);
+    densityPartials.assign(chunkTotal(count, grain), emptyDensityPartial());
+    parallelChunks(threadPool, count, grain, [&](int begin, int end) {
+        DensityPartial partial = emptyDensityPartial();
+        for (int i = begin; i < end; i++) {
+            accumulateDensity(partial, particles.density[i], particles.pressure[i], restDensity);
+        }
+        densityPartials[begin / grain] = partial;
+    });
+    reduceDensityStats(count);
+}
+
+void SPHSolver::updateDistributed(ParticleSystem& particleSystem, HaloExchange& halo) {
+    compactReady = false;
+    neighborList.invalidate();
+    const float h = particleSystem.getSmoothingLength();
+    fitGrid(h);
+    particleSystem.maybeReorder(grid.getCellSize());
+
+    ParticleData& particles = particleSystem.getData();
+    const int owned = static_cast<int>(particles.size());
+    halo.beginHalo(particleSystem, 2.0f * h);
+
+    haloSets.innerDensity.clear();
+    haloSets.edgeDensity.clear();
+    haloSets.innerForces.clear();
+    haloSets.edgeForces.clear();
+    for (int i = 0; i < owned; i++) {
+        const float edge = halo.edgeDistance(particles.x[i]);
+        (edge >= h ? haloSets.innerDensity : haloSets.edgeDensity).push_back(i);
+        (edge >= 2.0f * h ? haloSets.innerForces : haloSets.edgeForces).push_back(i);
+    }
+
+    //... primera mitad: solo las propias, mientras llegan las fantasmas
+    if (useGrid(h)) {
+        ScopedTimer timer(profiler, ProfilePhase::GridRebuild);
+        grid.updateGrid(particles);
+    }
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Density);
+        densityPass(particleSystem, haloSets.innerDensity.data(),
+                    static_cast<int>(haloSets.innerDensity.size()));
+    }
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Forces);
+        forcesPass(particleSystem, haloSets.innerForces.data(),
+                   static_cast<int>(haloSets.innerForces.size()));
+    }
+
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Exchange);
+        halo.finishHalo(particleSystem);
+    }
+    const int total = static_cast<int>(particles.size());
+    for (int i = owned; i < total; i++) {
+        if (halo.edgeDistance(particles.x[i]) < h) haloSets.edgeDensity.push_back(i);
+    }
+
+    //... segunda mitad: con las fantasmas, lo que quedaba cerca de los bordes
+    if (total > owned || !haloSets.edgeForces.empty()) {
+        if (useGrid(h)) {
+            ScopedTimer timer(profiler, ProfilePhase::GridRebuild);
+            grid.updateGrid(particles);
+        }
+        {
+            ScopedTimer timer(profiler, ProfilePhase::Density);
+            densityPass(particleSystem, haloSets.edgeDensity.data(),
+                        static_cast<int>(haloSets.edgeDensity.size()));
+        }
+        ScopedTimer timer(profiler, ProfilePhase::Forces);
+        forcesPass(particleSystem, haloSets.edgeForces.data(),
+                   static_cast<int>(haloSets.edgeForces.size()));
+    }
+
+    particles.truncate(static_cast<size_t>(owned));
+    collectDensityStats(particles, owned);
+}
@@ -0,0 +1,192 @@
+/*
+Pasadas de densidad y fuerzas de SPHSolver con resolución adaptativa.
+
+Cada partícula tiene un nivel (ParticleData::level): masa m / 2^nivel y h / sqrt(2)^nivel
+respecto de la escena. Entre dos partículas de niveles distintos se usa el soporte
+medio h_ij = (h_i + h_j) / 2, que es simétrico, así la fuerza entre las dos ve el mismo
+kernel de los dos lados, y cada término lleva la masa del vecino. Los niveles son pocos,
+por eso los kernels de cada par se arman una vez en una tabla de niveles x niveles y el
+bucle interno solo la indexa con los dos niveles.
+
+Los kernels de Müller conservan la normalización 3D del código original: en el plano su
+integral escala como 1/h, y un nivel más fino sumaría una densidad sqrt(2) veces mayor
+con la misma distribución de masa. Cada par se corrige por (h_ij / h)^(dimensión - 2)
+para que todos los niveles vean la normalización del nivel de la escena (con Wendland y
+el spline cúbico, que ya son 2D, la corrección es 1).
+
+Con un solo grid las celdas tendrían que cubrir el soporte más grande y una partícula
+fina recorrería las 3x3 celdas gruesas, con varias veces los candidatos que necesita.
+En cambio cada nivel tiene su grid, con celdas de su h y solo sus partículas, y la
+partícula i busca en el grid del nivel L las celdas que toca el cuadrado de radio
+(h_i + h_L) / 2, el soporte del par: entre partículas finas la búsqueda es la de un
+grid fino, y donde no hay partículas gruesas su grid no aporta candidatos.
+*/
+
+//... sph_multires.cpp
+#include "sph_solver.h"
+#include <cmath>
+#include <algorithm>
+
+//... candidatos de todos los niveles para la partícula en (x, y) de la fila 'row' de la
+//... tabla: visit(j, par) con el índice del par en la tabla; sin grid, todas las partículas
+template <typename Visitor>
+static void forEachLevelCandidate(const std::vector<SpatialGrid>& grids,
+                                  const std::vector<std::vector<int>>& members, int levelCount,
+                                  const float* support, const unsigned char* plevel, int count,
+                                  bool gridSearch, int row, float x, float y, Visitor&& visit) {
+    if (!gridSearch) {
+        for (int j = 0; j < count; j++) {
+            visit(j, row + plevel[j]);
+        }
+        return;
+    }
+    for (int level = 0; level < levelCount; level++) {
+        if (members[level].empty()) continue;
+        const int pair = row + level;
+        grids[level].forEachSpanWithin(x, y, support[pair], [&](const int* first, const int* last) {
+            for (const int* it = first; it != last; ++it) {
+                visit(*it, pair);
+            }
+        });
+    }
+}
+
+void SPHSolver::refreshLevelKernels(const ParticleSystem& particleSystem) {
+    const float h = particleSystem.getSmoothingLength();
+    const float mass = particleSystem.getParticleMass();
+    if (levelKernels.h == h && levelKernels.mass == mass && !levelKernels.kernels.empty()) return;
+
+    //... todos los niveles posibles, así la tabla no depende de maxLevel
+    const int levels = MAX_RESOLUTION_LEVEL + 1;
+    levelKernels.h = h;
+    levelKernels.mass = mass;
+    levelKernels.kernels.clear();
+    levelKernels.weight.clear();
+    levelKernels.support.clear();
+    levelKernels.support2.clear();
+    levelKernels.kernels.reserve(levels * levels);
+    for (int own = 0; own < levels; own++) {
+        for (int other = 0; other < levels; other++) {
+            float pairH = 0.5f * (particleSystem.getLevelSmoothingLength(own) +
+                                  particleSystem.getLevelSmoothingLength(other));
+            float correction = std::pow(pairH / h, static_cast<float>(SPHKernels::normalizationDimension - 2));
+            levelKernels.kernels.push_back(SPHKernels(pairH));
+            levelKernels.weight.push_back(particleSystem.getLevelMass(other) * correction);
+            levelKernels.support.push_back(pairH);
+            levelKernels.support2.push_back(pairH * pairH);
+        }
+    }
+}
+
+void SPHSolver::prepareLevelGrids(const ParticleSystem& particleSystem) {
+    const ParticleData& particles = particleSystem.getData();
+    const int count = static_cast<int>(particles.size());
+    levelMembers.resize(MAX_RESOLUTION_LEVEL + 1);
+    for (auto& members : levelMembers) members.clear();
+    levelCount = 0;
+    for (int i = 0; i < count; i++) {
+        const int level = particles.level[i];
+        levelMembers[level].push_back(i);
+        levelCount = std::max(levelCount, level + 1);
+    }
+    for (int level = 0; level < levelCount; level++) {
+        const float cellSize = particleSystem.getLevelSmoothingLength(level);
+        if (static_cast<int>(levelGrids.size()) <= level) {
+            levelGrids.push_back(SpatialGrid(grid.getDomainWidth(), grid.getDomainHeight(), cellSize));
+        }
+        SpatialGrid& levelGrid = levelGrids[level];
+        levelGrid.setLayout(grid.getLayout());
+        levelGrid.setCellSize(cellSize);
+        levelGrid.updateGrid(particles, levelMembers[level]);
+    }
+}
+
+void SPHSolver::calculateDensityMultires(ParticleSystem& particleSystem) {
+    ParticleData& particles = particleSystem.getData();
+    const int count = static_cast<int>(particles.size());
+    const float* px = particles.x.data();
+    const float* py = particles.y.data();
+    const unsigned char* plevel = particles.level.data();
+    const bool gridSearch = neighborSearch == NeighborSearch::Grid;
+    refreshLevelKernels(particleSystem);
+    const int levels = MAX_RESOLUTION_LEVEL + 1;
+    const SPHKernels* kernel = levelKernels.kernels.data();
+    const float* weight = levelKernels.weight.data();
+    const float* support = levelKernels.support.data();
+    const int grain = chunkGrain(threadPool, count);
+    densityPartials.assign(chunkTotal(count, grain), emptyDensityPartial());
+
+    parallelChunks(threadPool, count, grain, [&](int begin, int end) {
+        DensityPartial partial = emptyDensityPartial();
+        for (int i = begin; i < end; i++) {
+            const int row = plevel[i] * levels;
+            float density = 0.0f;
+            forEachLevelCandidate(levelGrids, levelMembers, levelCount, support, plevel, count,
+                                  gridSearch, row, px[i], py[i], [&](int j, int pair) {
+                float dx = px[i] - px[j];
+                float dy = py[i] - py[j];
+                density += weight[pair] * kernel[pair].density(dx * dx + dy * dy);
+            });
+            float pressure = stiffness * (density - restDensity);
+            particles.density[i] = density;
+            particles.pressure[i] = pressure;
+            accumulateDensity(partial, density, pressure, restDensity);
+        }
+        densityPartials[begin / grain] = partial;
+    });
+    reduceDensityStats(count);
+}
+
+void SPHSolver::calculateForcesMultires(ParticleSystem& particleSystem) {
+    ParticleData& particles = particleSystem.getData();
+    const int count = static_cast<int>(particles.size());
+    const float* px = particles.x.data();
+    const float* py = particles.y.data();
+    const float* pvx = particles.vx.data();
+    const float* pvy = particles.vy.data();
+    const float* pdensity = particles.density.data();
+    const float* ppressure = particles.pressure.data();
+    const unsigned char* plevel = particles.level.data();
+    const bool gridSearch = neighborSearch == NeighborSearch::Grid;
+    refreshLevelKernels(particleSystem);
+    const int levels = MAX_RESOLUTION_LEVEL + 1;
+    const SPHKernels* kernel = levelKernels.kernels.data();
+    const float* weight = levelKernels.weight.data();
+    const float* support = levelKernels.support.data();
+    const float* support2 = levelKernels.support2.data();
+
+    parallelChunks(threadPool, count, chunkGrain(threadPool, count), [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            const int row = plevel[i] * levels;
+            Vec2 pressureForce(0.0f, 0.0f);
+            Vec2 viscosityForce(0.0f, 0.0f);
+
+            forEachLevelCandidate(levelGrids, levelMembers, levelCount, support, plevel, count,
+                                  gridSearch, row, px[i], py[i], [&](int j, int pair) {
+                if (j == i) return;
+                Vec2 diff(px[i] - px[j], py[i] - py[j]);
+                float r2 = diff.x * diff.x + diff.y * diff.y;
+                if (r2 >= support2[pair]) return;
+                float r = std::sqrt(r2);
+
+                //... las mismas fuerzas que calculateForces, con la masa del vecino y el
+                //... kernel del par
+                if (r > 0.0f) {
+                    pressureForce += diff/r * weight[pair] *
+                        (ppressure[i] + ppressure[j])/(2.0f * pdensity[j]) *
+                        kernel[pair].pressureGradient(r);
+                }
+                Vec2 velocityDiff(pvx[j] - pvx[i], pvy[j] - pvy[i]);
+                viscosityForce += weight[pair] * velocityDiff / pdensity[j] *
+                    kernel[pair].viscosityLaplacian(r);
+            });
+
+            Vec2 gravity(0.0f, 981.0f); //... gravedad en cm/s^2
+            Vec2 force = pressureForce * -1.0f +
+                            viscosityForce * viscosity +
+                            gravity;
+            particles.fx[i] = force.x;
+            particles.fy[i] = force.y;
+        }
+    });
+}
@@ -0,0 +1,294 @@
+/*
+Modo incompresible de SPHSolver: PCISPH (predictive-corrective incompressible SPH,
+Solenthaler y Pajarola 2009).
+
+Con la ecuación de estado p = k (densidad - densidad de reposo) la presión solo aparece
+cuando el fluido ya se comprimió, y para que no explote hay que usar una k enorme o
+pasos muy chicos. PCISPH en cambio predice dónde quedarían las partículas con la presión
+actual, mide cuánto se comprimirían y corrige la presión en proporción al error,
+repitiendo hasta que el error de densidad baja de la tolerancia (o se llega al tope).
+
+El factor de corrección delta depende del paso, de h y de la masa; sale de las sumas de
+los kernels sobre una partícula rodeada por el bloque inicial (LatticeReference). Con la
+misma cuadrícula se calibra la densidad de reposo, así el bloque inicial está en reposo.
+
+Las iteraciones usan la búsqueda del grid (o fuerza bruta) con las posiciones del
+inicio del paso: las celdas miden más que h, así que los pares que se acercan durante
+la predicción siguen estando en las celdas vecinas. Densidad y fuerza de presión se
+evalúan en las posiciones predichas, recortadas al dominio, y la cuadrícula de
+referencia se extiende detrás de las paredes para que el fondo sostenga la columna.
+
+Un subpaso que no converge (o que movería alguna partícula más de cflFactor * h) no se
+integra: advance() lo repite con la mitad del paso (updatePCISPH).
+*/
+
+//... sph_pcisph.cpp
+#include "sph_solver.h"
+#include <cmath>
+#include <algorithm>
+
+//... subpasos seguidos que tienen que converger al tope antes de duplicarlo: probar el
+//... paso entero que no converge cuesta todas las iteraciones y se descarta
+static const int STEP_LIMIT_HOLD = 16;
+
+void SPHSolver::calibratePCISPH(const ParticleSystem& particleSystem, float dt) {
+    const LatticeReference& reference = latticeReference(particleSystem.getSmoothingLength(),
+                                                         particleSystem.getParticleSpacing(),
+                                                         particleSystem.getParticleMass());
+    float mass = reference.mass;
+
+    //... delta = 1 / (beta * (|sum grad W|^2 + sum |grad W|^2)), beta = 2 (dt m / rho0)^2
+    pcisphRestDensity = pcisph.restDensity > 0.0f ? pcisph.restDensity : reference.density;
+    float beta = 2.0f * (dt * mass / pcisphRestDensity) * (dt * mass / pcisphRestDensity);
+    float denominator = beta * (dot(reference.gradSum, reference.gradSum) + reference.gradDotSum);
+    pcisphDelta = denominator > 0.0f ? 1.0f / denominator : 0.0f;
+}
+
+void SPHSolver::solvePCISPH(ParticleSystem& particleSystem) {
+    ParticleData& particles = particleSystem.getData();
+    const int count = static_cast<int>(particles.size());
+    const float h = particleSystem.getSmoothingLength();
+    const float mass = particleSystem.getParticleMass();
+    const float dt = particleSystem.getDeltaTime();
+    const bool gridSearch = useGrid(h);
+
+    //... las iteraciones necesitan el grid al día, no la lista de Verlet
+    neighborList.invalidate();
+    if (gridSearch) {
+        ScopedTimer timer(profiler, ProfilePhase::GridRebuild);
+        grid.updateGrid(particles);
+    }
+
+    //... densidad actual (para la viscosidad) y fuerzas sin presión: con la presión en
+    //... cero calculateForces deja solo viscosidad y gravedad
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Density);
+        calculateDensityPressure(particleSystem);
+    }
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Forces);
+        std::fill(particles.pressure.begin(), particles.pressure.end(), 0.0f);
+        calculateForces(particleSystem);
+    }
+
+    ScopedTimer timer(profiler, ProfilePhase::PressureSolve);
+    calibratePCISPH(particleSystem, dt);
+    refreshKernels(h);
+    const SPHKernels& kernel = kernels;
+    const float restDensity0 = pcisphRestDensity;
+    const float delta = pcisphDelta;
+    const float h2 = h * h;
+    const float width = static_cast<float>(particleSystem.getDomainWidth());
+    const float height = static_cast<float>(particleSystem.getDomainHeight());
+
+    PCISPHState& state = pcisphState;
+    state.predictedX.resize(count);
+    state.predictedY.resize(count);
+    state.externalX.assign(particles.fx.begin(), particles.fx.end());
+    state.externalY.assign(particles.fy.begin(), particles.fy.end());
+    state.pressureX.assign(count, 0.0f);
+    state.pressureY.assign(count, 0.0f);
+    state.targetDensity.resize(count);
+
+    const float* px = particles.x.data();
+    const float* py = particles.y.data();
+    const float* pvx = particles.vx.data();
+    const float* pvy = particles.vy.data();
+    float* pdensity = particles.density.data();
+    float* ppressure = particles.pressure.data();
+    float* qx = state.predictedX.data();
+    float* qy = state.predictedY.data();
+    const float* ax = state.externalX.data();
+    const float* ay = state.externalY.data();
+    float* apx = state.pressureX.data();
+    float* apy = state.pressureY.data();
+    float* target = state.targetDensity.data();
+
+    //... paredes: la cuadrícula de referencia sigue del otro lado de cada borde, en filas
+    //... fijas a spacing, 2 spacing... afuera y con las columnas alineadas a la partícula.
+    //... Una partícula apoyada tiene así la densidad de reposo sin que la capa del fondo
+    //... se comprima, y la pared la empuja con su propia presión. Para cada eje, n recorre
+    //... primero las posiciones del fluido (p + k spacing, dentro del dominio) y después
+    //... las filas de afuera; un sitio es de pared si alguna de sus dos coordenadas lo es
+    const float spacing = particleSystem.getParticleSpacing();
+    const int reach = static_cast<int>(std::ceil(h / spacing));
+    auto wallCoordinate = [&](int n, float p, float extent, float& site) {
+        if (n <= 2 * reach) {
+            site = p + (n - reach) * spacing;
+            return site >= 0.0f && site <= extent ? 0 : -1;
+        }
+        int k = n - 2 * reach;
+        site = k <= reach ? -k * spacing : extent + (k - reach) * spacing;
+        return 1;
+    };
+    auto forEachWallSite = [&](float x, float y, auto&& visit) {
+        if (x >= h && x <= width - h && y >= h && y <= height - h) return;
+        for (int nx = 0; nx <= 4 * reach; nx++) {
+            float sx;
+            int wallX = wallCoordinate(nx, x, width, sx);
+            if (wallX < 0 || std::abs(x - sx) >= h) continue;
+            for (int ny = 0; ny <= 4 * reach; ny++) {
+                float sy;
+                int wallY = wallCoordinate(ny, y, height, sy);
+                if (wallY < 0 || wallX + wallY == 0) continue;
+                float dx = x - sx;
+                float dy = y - sy;
+                float r2 = dx * dx + dy * dy;
+                if (r2 < h2) visit(dx, dy, r2);
+            }
+        }
+    };
+
+    const int grain = chunkGrain(threadPool, count);
+    densityPartials.resize(chunkTotal(count, grain));
+
+    //... la compresión que ya trae el paso se corrige a razón de dt / maxTimestep: con
+    //... subpasos chicos (un choque) corregirla entera daría velocidades ~ error / dt
+    const float relax = std::min(1.0f, dt / timestep.maxTimestep);
+    parallelChunks(threadPool, count, grain, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            float density = pdensity[i];
+            forEachWallSite(px[i], py[i], [&](float, float, float r2) {
+                density += mass * kernel.density(r2);
+            });
+            target[i] = restDensity0 + std::max(0.0f, density - restDensity0) * (1.0f - relax);
+        }
+    });
+
+    int iteration = 0;
+    float maxError = 0.0f;
+    float averageError = 0.0f;
+    while (iteration < pcisph.maxIterations) {
+        //... predicción con la misma integración que ParticleSystem (Euler semi-implícito),
+        //... recortada al dominio como resolveCollisions(): si no, la capa que llega al
+        //... fondo se predice del otro lado de la pared y no se ve comprimida
+        parallelChunks(threadPool, count, grain, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                float vx = pvx[i] + dt * (ax[i] + apx[i]);
+                float vy = pvy[i] + dt * (ay[i] + apy[i]);
+                qx[i] = std::min(std::max(px[i] + dt * vx, 0.0f), width);
+                qy[i] = std::min(std::max(py[i] + dt * vy, 0.0f), height);
+            }
+        });
+
+        //... densidad predicha y corrección de la presión; solo cuenta la compresión,
+        //... la presión negativa se recorta para que la superficie libre no se pegue
+        parallelChunks(threadPool, count, grain, [&](int begin, int end) {
+            DensityPartial partial = emptyDensityPartial();
+            for (int i = begin; i < end; i++) {
+                float density = 0.0f;
+                forEachCandidate(px[i], py[i], count, gridSearch, [&](int j) {
+                    float dx = qx[i] - qx[j];
+                    float dy = qy[i] - qy[j];
+                    density += mass * kernel.density(dx * dx + dy * dy);
+                });
+                forEachWallSite(qx[i], qy[i], [&](float, float, float r2) {
+                    density += mass * kernel.density(r2);
+                });
+                pdensity[i] = density;
+                ppressure[i] = std::max(0.0f, ppressure[i] + delta * (density - target[i]));
+                accumulateDensity(partial, density, ppressure[i], target[i]);
+            }
+            densityPartials[begin / grain] = partial;
+        });
+
+        //... las métricas del paso quedan las de la última iteración
+        reduceDensityStats(count);
+        maxError = densityStats.maxError;
+        averageError = densityStats.averageError;
+
+        //... aceleración de presión simétrica con las posiciones y densidades predichas:
+        //... es la que corrige la compresión que se acaba de medir
+        parallelChunks(threadPool, count, grain, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                float sumX = 0.0f, sumY = 0.0f;
+                float termI = ppressure[i] / (pdensity[i] * pdensity[i]);
+                forEachCandidate(px[i], py[i], count, gridSearch, [&](int j) {
+                    if (j == i) return;
+                    float dx = qx[i] - qx[j];
+                    float dy = qy[i] - qy[j];
+                    float r2 = dx * dx + dy * dy;
+                    if (r2 >= h2 || r2 <= 0.0f) return;
+                    float r = std::sqrt(r2);
+                    float scale = mass * (termI + ppressure[j] / (pdensity[j] * pdensity[j])) *
+                                  kernel.pressureGradient(r) / r;
+                    sumX -= scale * dx;
+                    sumY -= scale * dy;
+                });
+                forEachWallSite(qx[i], qy[i], [&](float dx, float dy, float r2) {
+                    float r = std::sqrt(r2);
+                    float scale = mass * 2.0f * termI * kernel.pressureGradient(r) / r;
+                    sumX -= scale * dx;
+                    sumY -= scale * dy;
+                });
+                apx[i] = sumX;
+                apy[i] = sumY;
+            }
+        });
+
+        iteration++;
+        //... el error medido es el de la predicción con la presión anterior
+        if (iteration >= pcisph.minIterations && maxError <= pcisph.tolerance) break;
+    }
+
+    //... con la fuerza final se mide cuánto va a moverse cada partícula en el paso
+    motionPartials.assign(chunkTotal(count, grain), MotionPartial{0.0f, 0.0f});
+    parallelChunks(threadPool, count, grain, [&](int begin, int end) {
+        MotionPartial partial{0.0f, 0.0f};
+        for (int i = begin; i < end; i++) {
+            particles.fx[i] = ax[i] + apx[i];
+            particles.fy[i] = ay[i] + apy[i];
+            float vx = pvx[i] + dt * particles.fx[i];
+            float vy = pvy[i] + dt * particles.fy[i];
+            partial.maxSpeed2 = std::max(partial.maxSpeed2, vx * vx + vy * vy);
+        }
+        motionPartials[begin / grain] = partial;
+    });
+    float maxSpeed2 = 0.0f;
+    for (const auto& partial : motionPartials) {
+        maxSpeed2 = std::max(maxSpeed2, partial.maxSpeed2);
+    }
+
+    pcisphStats.iterations = iteration;
+    pcisphStats.densityError = maxError;
+    pcisphStats.averageError = averageError;
+    pcisphStats.converged = maxError <= pcisph.tolerance;
+    pcisphStats.maxDisplacement = std::sqrt(maxSpeed2) * dt / h;
+}
+
+float SPHSolver::updatePCISPH(ParticleSystem& particleSystem, float dt) {
+    //... la presión que no convergió no se integra: update() no mueve partículas, así
+    //... que basta repetirlo con la mitad del paso. Tampoco un paso que movería alguna
+    //... partícula más de cflFactor * h (un chorro después de un choque): los vecinos
+    //... de las iteraciones salen de las posiciones del inicio del paso. Bajo minTimestep
+    //... se integra igual y queda contado en unconvergedSteps
+    bool accepted = false;
+    bool retried = false;
+    for (;;) {
+        particleSystem.setDeltaTime(dt);
+        update(particleSystem);
+        accepted = pcisphStats.converged && pcisphStats.maxDisplacement <= timestep.cflFactor;
+        if (accepted) break;
+        if (0.5f * dt < timestep.minTimestep) {
+            timestepStats.unconvergedSteps++;
+            break;
+        }
+        dt *= 0.5f;
+        retried = true;
+        timestepStats.pressureRetries++;
+        pcisphStepLimit = dt;
+        pcisphLimitSteps = 0;
+    }
+
+    //... después de un choque el paso vuelve a crecer de a duplicaciones, sin volver a
+    //... probar enseguida el paso entero que acaba de fallar. Cuenta todo subpaso que
+    //... convergió al primer intento: advance() reparte el resto del cuadro en partes
+    //... iguales, que pueden quedar por debajo del tope
+    if (accepted && !retried && pcisphStepLimit > 0.0f &&
+        ++pcisphLimitSteps >= STEP_LIMIT_HOLD) {
+        pcisphLimitSteps = 0;
+        pcisphStepLimit *= 2.0f;
+        if (pcisphStepLimit >= timestep.maxTimestep) pcisphStepLimit = 0.0f;
+    }
+    return dt;
+}
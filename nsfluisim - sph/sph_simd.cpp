@@ -0,0 +1,182 @@
+/*
+Selección en tiempo de ejecución de los bucles SIMD, las versiones escalares de
+referencia y la ruta NEON (aarch64). Las rutas x86 están en sph_simd_x86.cpp.
+
+Las versiones escalares hacen exactamente las mismas cuentas que los lotes SIMD
+(mismas máscaras: fuera de h no suma, con r == 0 no hay presión), así sirven para
+procesar la cola de cada tramo que no llena un registro.
+*/
+
+//... sph_simd.cpp
+#include "sph_simd.h"
+#include <cmath>
+
+#if defined(SPH_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+float densitySpanScalar(const float* px, const float* py,
+                        const int* indices, int count,
+                        float xi, float yi,
+                        const SimdKernelParams& params) {
+    float sum = 0.0f;
+    for (int k = 0; k < count; k++) {
+        int j = indices[k];
+        float dx = xi - px[j];
+        float dy = yi - py[j];
+        float r2 = dx * dx + dy * dy;
+        if (r2 < params.h2) {
+            float t = params.h2 - r2;
+            sum += t * t * t;
+        }
+    }
+    return sum * params.poly6Coeff;
+}
+
+void forceSpanScalar(const SimdParticleView& p, int i,
+                     const int* indices, int count,
+                     const SimdKernelParams& params,
+                     ForceAccumulator& acc) {
+    const float xi = p.x[i], yi = p.y[i];
+    const float vxi = p.vx[i], vyi = p.vy[i];
+    const float pi = p.pressure[i];
+    for (int k = 0; k < count; k++) {
+        int j = indices[k];
+        float dx = xi - p.x[j];
+        float dy = yi - p.y[j];
+        float r2 = dx * dx + dy * dy;
+        if (r2 >= params.h2) continue;
+        float r = std::sqrt(r2);
+        float t = params.h - r;
+        if (r > 0.0f) {
+            float coef = params.mass * (pi + p.pressure[j]) / (2.0f * p.density[j]) *
+                         params.spikyCoeff * t * t / r;
+            acc.pressureX += dx * coef;
+            acc.pressureY += dy * coef;
+        }
+        float viscCoef = params.mass / p.density[j] * params.viscosityCoeff * t;
+        acc.viscosityX += (p.vx[j] - vxi) * viscCoef;
+        acc.viscosityY += (p.vy[j] - vyi) * viscCoef;
+    }
+}
+
+#if defined(SPH_SIMD_NEON)
+//... NEON no tiene gather: se arman los 4 carriles a mano y el resto es vectorial
+static inline float32x4_t gather4(const float* base, const int* idx) {
+    float lanes[4] = { base[idx[0]], base[idx[1]], base[idx[2]], base[idx[3]] };
+    return vld1q_f32(lanes);
+}
+
+float densitySpanNEON(const float* px, const float* py,
+                      const int* indices, int count,
+                      float xi, float yi,
+                      const SimdKernelParams& params) {
+    float32x4_t vxi = vdupq_n_f32(xi);
+    float32x4_t vyi = vdupq_n_f32(yi);
+    float32x4_t vh2 = vdupq_n_f32(params.h2);
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    int k = 0;
+    for (; k + 4 <= count; k += 4) {
+        float32x4_t dx = vsubq_f32(vxi, gather4(px, indices + k));
+        float32x4_t dy = vsubq_f32(vyi, gather4(py, indices + k));
+        float32x4_t r2 = vfmaq_f32(vmulq_f32(dy, dy), dx, dx);
+        uint32x4_t inRange = vcltq_f32(r2, vh2);
+        float32x4_t t = vsubq_f32(vh2, r2);
+        float32x4_t t3 = vmulq_f32(vmulq_f32(t, t), t);
+        acc = vaddq_f32(acc, vreinterpretq_f32_u32(vandq_u32(inRange, vreinterpretq_u32_f32(t3))));
+    }
+    float sum = vaddvq_f32(acc) * params.poly6Coeff;
+    return sum + densitySpanScalar(px, py, indices + k, count - k, xi, yi, params);
+}
+
+void forceSpanNEON(const SimdParticleView& p, int i,
+                   const int* indices, int count,
+                   const SimdKernelParams& params,
+                   ForceAccumulator& acc) {
+    float32x4_t vxi = vdupq_n_f32(p.x[i]), vyi = vdupq_n_f32(p.y[i]);
+    float32x4_t vvxi = vdupq_n_f32(p.vx[i]), vvyi = vdupq_n_f32(p.vy[i]);
+    float32x4_t vpi = vdupq_n_f32(p.pressure[i]);
+    float32x4_t vh = vdupq_n_f32(params.h), vh2 = vdupq_n_f32(params.h2);
+    float32x4_t vzero = vdupq_n_f32(0.0f);
+    float32x4_t vhalfMass = vdupq_n_f32(0.5f * params.mass * params.spikyCoeff);
+    float32x4_t vviscMass = vdupq_n_f32(params.mass * params.viscosityCoeff);
+    float32x4_t apx = vzero, apy = vzero, avx = vzero, avy = vzero;
+    int k = 0;
+    for (; k + 4 <= count; k += 4) {
+        const int* idx = indices + k;
+        float32x4_t dx = vsubq_f32(vxi, gather4(p.x, idx));
+        float32x4_t dy = vsubq_f32(vyi, gather4(p.y, idx));
+        float32x4_t r2 = vfmaq_f32(vmulq_f32(dy, dy), dx, dx);
+        uint32x4_t inRange = vcltq_f32(r2, vh2);
+        uint32x4_t positive = vandq_u32(inRange, vcgtq_f32(r2, vzero));
+        float32x4_t r = vsqrtq_f32(r2);
+        float32x4_t t = vsubq_f32(vh, r);
+        float32x4_t invDensity = vdivq_f32(vdupq_n_f32(1.0f), gather4(p.density, idx));
+
+        float32x4_t pcoef = vmulq_f32(vmulq_f32(vhalfMass, vaddq_f32(vpi, gather4(p.pressure, idx))),
+                                      vmulq_f32(invDensity, vdivq_f32(vmulq_f32(t, t), r)));
+        pcoef = vreinterpretq_f32_u32(vandq_u32(positive, vreinterpretq_u32_f32(pcoef)));
+        apx = vfmaq_f32(apx, dx, pcoef);
+        apy = vfmaq_f32(apy, dy, pcoef);
+
+        float32x4_t vcoef = vmulq_f32(vmulq_f32(vviscMass, invDensity), t);
+        vcoef = vreinterpretq_f32_u32(vandq_u32(inRange, vreinterpretq_u32_f32(vcoef)));
+        avx = vfmaq_f32(avx, vsubq_f32(gather4(p.vx, idx), vvxi), vcoef);
+        avy = vfmaq_f32(avy, vsubq_f32(gather4(p.vy, idx), vvyi), vcoef);
+    }
+    acc.pressureX += vaddvq_f32(apx);
+    acc.pressureY += vaddvq_f32(apy);
+    acc.viscosityX += vaddvq_f32(avx);
+    acc.viscosityY += vaddvq_f32(avy);
+    forceSpanScalar(p, i, indices + k, count - k, params, acc);
+}
+#endif
+
+SimdLevel detectSimdLevel() {
+#if defined(SPH_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SimdLevel::AVX2;
+#elif defined(SPH_SIMD_NEON)
+    return SimdLevel::NEON;
+#endif
+    return SimdLevel::Scalar;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::AVX512: return "AVX-512";
+        case SimdLevel::NEON: return "NEON";
+        default: return "escalar";
+    }
+}
+
+SimdLevel preferredSimdLevel() {
+    SimdLevel supported = detectSimdLevel();
+    return supported == SimdLevel::AVX512 ? SimdLevel::AVX2 : supported;
+}
+
+SimdKernels selectSimdKernels(SimdLevel level) {
+    //... nunca se elige algo que la CPU no soporte
+    SimdLevel supported = detectSimdLevel();
+    bool available = level == SimdLevel::Scalar || level == supported ||
+                     (level == SimdLevel::AVX2 && supported == SimdLevel::AVX512);
+    if (!available) {
+        level = preferredSimdLevel();
+    }
+
+    SimdKernels kernels = { SimdLevel::Scalar, densitySpanScalar, forceSpanScalar };
+#if defined(SPH_SIMD_X86)
+    if (level == SimdLevel::AVX512) {
+        kernels = { SimdLevel::AVX512, densitySpanAVX512, forceSpanAVX512 };
+    } else if (level == SimdLevel::AVX2) {
+        kernels = { SimdLevel::AVX2, densitySpanAVX2, forceSpanAVX2 };
+    }
+#elif defined(SPH_SIMD_NEON)
+    if (level == SimdLevel::NEON) {
+        kernels = { SimdLevel::NEON, densitySpanNEON, forceSpanNEON };
+    }
+#endif
+    return kernels;
+}
@@ -0,0 +1,193 @@
+/*
+Rutas AVX2 (8 carriles) y AVX-512 (16 carriles) de los bucles de densidad y fuerzas.
+
+Cada función lleva su propio atributo target, así este archivo compila sin -mavx2
+ni -mavx512f y el binario sigue corriendo en CPUs sin esas extensiones: solo se
+llaman si detectSimdLevel() confirmó el soporte.
+
+Los vecinos se leen con gather a partir de los índices del grid. Las máscaras
+replican la versión escalar: fuera de h no se suma y con r == 0 no hay presión
+(el coeficiente infinito se anula con AND antes de multiplicar, nunca da NaN).
+*/
+
+//... sph_simd_x86.cpp
+#include "sph_simd.h"
+
+#if defined(SPH_SIMD_X86)
+#include <immintrin.h>
+
+#define SPH_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define SPH_TARGET_AVX512 __attribute__((target("avx512f")))
+
+SPH_TARGET_AVX2
+static inline float horizontalSum256(__m256 v) {
+    __m128 low = _mm256_castps256_ps128(v);
+    __m128 high = _mm256_extractf128_ps(v, 1);
+    __m128 sum = _mm_add_ps(low, high);
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+    return _mm_cvtss_f32(sum);
+}
+
+SPH_TARGET_AVX2
+float densitySpanAVX2(const float* px, const float* py,
+                      const int* indices, int count,
+                      float xi, float yi,
+                      const SimdKernelParams& params) {
+    const __m256 vxi = _mm256_set1_ps(xi);
+    const __m256 vyi = _mm256_set1_ps(yi);
+    const __m256 vh2 = _mm256_set1_ps(params.h2);
+    __m256 acc = _mm256_setzero_ps();
+    int k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + k));
+        __m256 dx = _mm256_sub_ps(vxi, _mm256_i32gather_ps(px, idx, 4));
+        __m256 dy = _mm256_sub_ps(vyi, _mm256_i32gather_ps(py, idx, 4));
+        __m256 r2 = _mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dy, dy));
+        __m256 inRange = _mm256_cmp_ps(r2, vh2, _CMP_LT_OQ);
+        __m256 t = _mm256_sub_ps(vh2, r2);
+        __m256 t3 = _mm256_mul_ps(_mm256_mul_ps(t, t), t);
+        acc = _mm256_add_ps(acc, _mm256_and_ps(inRange, t3));
+    }
+    float sum = horizontalSum256(acc) * params.poly6Coeff;
+    return sum + densitySpanScalar(px, py, indices + k, count - k, xi, yi, params);
+}
+
+SPH_TARGET_AVX2
+void forceSpanAVX2(const SimdParticleView& p, int i,
+                   const int* indices, int count,
+                   const SimdKernelParams& params,
+                   ForceAccumulator& acc) {
+    const __m256 vxi = _mm256_set1_ps(p.x[i]), vyi = _mm256_set1_ps(p.y[i]);
+    const __m256 vvxi = _mm256_set1_ps(p.vx[i]), vvyi = _mm256_set1_ps(p.vy[i]);
+    const __m256 vpi = _mm256_set1_ps(p.pressure[i]);
+    const __m256 vh = _mm256_set1_ps(params.h), vh2 = _mm256_set1_ps(params.h2);
+    const __m256 vzero = _mm256_setzero_ps(), vone = _mm256_set1_ps(1.0f);
+    const __m256 vpressureScale = _mm256_set1_ps(0.5f * params.mass * params.spikyCoeff);
+    const __m256 vviscScale = _mm256_set1_ps(params.mass * params.viscosityCoeff);
+    __m256 apx = vzero, apy = vzero, avx = vzero, avy = vzero;
+    int k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + k));
+        __m256 dx = _mm256_sub_ps(vxi, _mm256_i32gather_ps(p.x, idx, 4));
+        __m256 dy = _mm256_sub_ps(vyi, _mm256_i32gather_ps(p.y, idx, 4));
+        __m256 r2 = _mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dy, dy));
+        __m256 inRange = _mm256_cmp_ps(r2, vh2, _CMP_LT_OQ);
+        __m256 positive = _mm256_and_ps(inRange, _mm256_cmp_ps(r2, vzero, _CMP_GT_OQ));
+        if (_mm256_movemask_ps(inRange) == 0) continue;
+
+        __m256 r = _mm256_sqrt_ps(r2);
+        __m256 t = _mm256_sub_ps(vh, r);
+        __m256 invDensity = _mm256_div_ps(vone, _mm256_i32gather_ps(p.density, idx, 4));
+        __m256 pj = _mm256_i32gather_ps(p.pressure, idx, 4);
+
+        //... presión: m (pi + pj) / (2 rho_j) * spiky * t^2 / r
+        __m256 pcoef = _mm256_mul_ps(_mm256_mul_ps(vpressureScale, _mm256_add_ps(vpi, pj)),
+                                     _mm256_mul_ps(invDensity, _mm256_div_ps(_mm256_mul_ps(t, t), r)));
+        pcoef = _mm256_and_ps(positive, pcoef);
+        apx = _mm256_fmadd_ps(dx, pcoef, apx);
+        apy = _mm256_fmadd_ps(dy, pcoef, apy);
+
+        //... viscosidad: m / rho_j * visc * t * (vj - vi)
+        __m256 vcoef = _mm256_and_ps(inRange, _mm256_mul_ps(_mm256_mul_ps(vviscScale, invDensity), t));
+        __m256 dvx = _mm256_sub_ps(_mm256_i32gather_ps(p.vx, idx, 4), vvxi);
+        __m256 dvy = _mm256_sub_ps(_mm256_i32gather_ps(p.vy, idx, 4), vvyi);
+        avx = _mm256_fmadd_ps(dvx, vcoef, avx);
+        avy = _mm256_fmadd_ps(dvy, vcoef, avy);
+    }
+    acc.pressureX += horizontalSum256(apx);
+    acc.pressureY += horizontalSum256(apy);
+    acc.viscosityX += horizontalSum256(avx);
+    acc.viscosityY += horizontalSum256(avy);
+    forceSpanScalar(p, i, indices + k, count - k, params, acc);
+}
+
+SPH_TARGET_AVX512
+static inline float horizontalSum512(__m512 v) {
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, v);
+    float sum = 0.0f;
+    for (int k = 0; k < 16; k++) {
+        sum += lanes[k];
+    }
+    return sum;
+}
+
+//... AVX-512: la cola del tramo se hace con gathers enmascarados, sin bucle escalar
+SPH_TARGET_AVX512
+float densitySpanAVX512(const float* px, const float* py,
+                        const int* indices, int count,
+                        float xi, float yi,
+                        const SimdKernelParams& params) {
+    const __m512 vxi = _mm512_set1_ps(xi);
+    const __m512 vyi = _mm512_set1_ps(yi);
+    const __m512 vh2 = _mm512_set1_ps(params.h2);
+    __m512 acc = _mm512_setzero_ps();
+    for (int k = 0; k < count; k += 16) {
+        int lanes = count - k < 16 ? count - k : 16;
+        __mmask16 active = static_cast<__mmask16>((1u << lanes) - 1u);
+        __m512i idx = _mm512_maskz_loadu_epi32(active, indices + k);
+        __m512 xj = _mm512_mask_i32gather_ps(vxi, active, idx, px, 4);
+        __m512 yj = _mm512_mask_i32gather_ps(vyi, active, idx, py, 4);
+        __m512 dx = _mm512_sub_ps(vxi, xj);
+        __m512 dy = _mm512_sub_ps(vyi, yj);
+        __m512 r2 = _mm512_fmadd_ps(dx, dx, _mm512_mul_ps(dy, dy));
+        __mmask16 inRange = _mm512_mask_cmp_ps_mask(active, r2, vh2, _CMP_LT_OQ);
+        __m512 t = _mm512_sub_ps(vh2, r2);
+        __m512 t3 = _mm512_mul_ps(_mm512_mul_ps(t, t), t);
+        acc = _mm512_mask_add_ps(acc, inRange, acc, t3);
+    }
+    return horizontalSum512(acc) * params.poly6Coeff;
+}
+
+SPH_TARGET_AVX512
+void forceSpanAVX512(const SimdParticleView& p, int i,
+                     const int* indices, int count,
+                     const SimdKernelParams& params,
+                     ForceAccumulator& acc) {
+    const __m512 vxi = _mm512_set1_ps(p.x[i]), vyi = _mm512_set1_ps(p.y[i]);
+    const __m512 vvxi = _mm512_set1_ps(p.vx[i]), vvyi = _mm512_set1_ps(p.vy[i]);
+    const __m512 vpi = _mm512_set1_ps(p.pressure[i]);
+    const __m512 vh = _mm512_set1_ps(params.h), vh2 = _mm512_set1_ps(params.h2);
+    const __m512 vzero = _mm512_setzero_ps(), vone = _mm512_set1_ps(1.0f);
+    const __m512 vpressureScale = _mm512_set1_ps(0.5f * params.mass * params.spikyCoeff);
+    const __m512 vviscScale = _mm512_set1_ps(params.mass * params.viscosityCoeff);
+    __m512 apx = vzero, apy = vzero, avx = vzero, avy = vzero;
+    for (int k = 0; k < count; k += 16) {
+        int lanes = count - k < 16 ? count - k : 16;
+        __mmask16 active = static_cast<__mmask16>((1u << lanes) - 1u);
+        __m512i idx = _mm512_maskz_loadu_epi32(active, indices + k);
+        __m512 dx = _mm512_sub_ps(vxi, _mm512_mask_i32gather_ps(vxi, active, idx, p.x, 4));
+        __m512 dy = _mm512_sub_ps(vyi, _mm512_mask_i32gather_ps(vyi, active, idx, p.y, 4));
+        __m512 r2 = _mm512_fmadd_ps(dx, dx, _mm512_mul_ps(dy, dy));
+        __mmask16 inRange = _mm512_mask_cmp_ps_mask(active, r2, vh2, _CMP_LT_OQ);
+        if (inRange == 0) continue;
+        __mmask16 positive = _mm512_mask_cmp_ps_mask(inRange, r2, vzero, _CMP_GT_OQ);
+
+        //... raíz enmascarada: fuera de rango da 0 (después se descarta con las máscaras);
+        //... la forma sin máscara parte de _mm512_undefined_ps y GCC avisa -Wmaybe-uninitialized
+        __m512 r = _mm512_maskz_sqrt_ps(inRange, r2);
+        __m512 t = _mm512_sub_ps(vh, r);
+        __m512 rhoj = _mm512_mask_i32gather_ps(vone, inRange, idx, p.density, 4);
+        __m512 invDensity = _mm512_div_ps(vone, rhoj);
+        __m512 pj = _mm512_mask_i32gather_ps(vzero, inRange, idx, p.pressure, 4);
+
+        __m512 pcoef = _mm512_mul_ps(_mm512_mul_ps(vpressureScale, _mm512_add_ps(vpi, pj)),
+                                     _mm512_mul_ps(invDensity, _mm512_div_ps(_mm512_mul_ps(t, t), r)));
+        pcoef = _mm512_maskz_mov_ps(positive, pcoef);
+        apx = _mm512_fmadd_ps(dx, pcoef, apx);
+        apy = _mm512_fmadd_ps(dy, pcoef, apy);
+
+        __m512 vcoef = _mm512_maskz_mov_ps(inRange, _mm512_mul_ps(_mm512_mul_ps(vviscScale, invDensity), t));
+        __m512 dvx = _mm512_sub_ps(_mm512_mask_i32gather_ps(vvxi, inRange, idx, p.vx, 4), vvxi);
+        __m512 dvy = _mm512_sub_ps(_mm512_mask_i32gather_ps(vvyi, inRange, idx, p.vy, 4), vvyi);
+        avx = _mm512_fmadd_ps(dvx, vcoef, avx);
+        avy = _mm512_fmadd_ps(dvy, vcoef, avy);
+    }
+    acc.pressureX += horizontalSum512(apx);
+    acc.pressureY += horizontalSum512(apy);
+    acc.viscosityX += horizontalSum512(avx);
+    acc.viscosityY += horizontalSum512(avy);
+}
+
+#endif
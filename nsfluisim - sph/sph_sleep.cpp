@@ -0,0 +1,187 @@
+/*
+Celdas dormidas de SPHSolver: en un fluido que ya se asentó casi todo el costo del paso
+se va en partículas que no se mueven. Cada celda del grid Dense lleva la cuenta de los
+pasos seguidos en que ella y sus 3x3 vecinas estuvieron quietas (rapidez y aceleración
+neta bajo los umbrales de SleepSettings) y, al llegar a 'steps', se duerme: sus
+partículas quedan con velocidad 0, la pasada de fuerzas las saltea y la integración de
+ParticleSystem también (getSleepMask). La densidad se sigue calculando para todas,
+porque las despiertas de alrededor leen la densidad y la presión de las dormidas.
+
+Una celda dormida se despierta cuando:
+    - una de sus 3x3 vecinas tiene una partícula que no está quieta
+    - cambian las partículas que tiene (entró o salió alguna, por ejemplo de un emisor)
+    - un obstáculo nuevo queda a menos de una celda y media de su centro (y todas si se
+      borran obstáculos)
+    - está junto a la boca de un emisor
+Al despertarse vuelve a contar desde 0, y como sus partículas vuelven a calcular
+fuerzas, si algo las empuja se mueven y despiertan a las de al lado.
+*/
+
+//... sph_sleep.cpp
+#include "sph_solver.h"
+#include <cmath>
+#include <algorithm>
+
+static const unsigned char CELL_MOVING = 1;
+static const unsigned char CELL_DISTURBED = 2;
+
+void SPHSolver::resetSleep() {
+    activity.asleep.clear();
+    activity.quietSteps.clear();
+    activity.population.clear();
+    activity.flags.clear();
+    activity.awake.clear();
+    sleepReady = false;
+    sleepStats = SleepStats{0, 0, 0, 0};
+}
+
+void SPHSolver::updateSleep(ParticleSystem& particleSystem) {
+    ParticleData& particles = particleSystem.getData();
+    const int count = static_cast<int>(particles.size());
+    const int cells = grid.getCellCount();
+    const int gridWidth = grid.getGridWidth();
+    const int gridHeight = grid.getGridHeight();
+    const float cellSize = grid.getCellSize();
+    const std::vector<int>& cellStart = grid.getCellStart();
+    const std::vector<int>& indices = grid.getParticleIndices();
+    const ObstacleField& obstacles = particleSystem.getObstacles();
+
+    //... otro grid o un salto en los pasos (reset, restore, pasos por otro camino): todo
+    //... despierto. Con la población en -1 el primer paso cuenta como cambio en todas
+    if (static_cast<int>(activity.asleep.size()) != cells ||
+        particleSystem.getStepCount() != activity.nextStep) {
+        activity.asleep.assign(cells, 0);
+        activity.quietSteps.assign(cells, 0);
+        activity.population.assign(cells, -1);
+        activity.obstacleRevision = obstacles.getRevision();
+        activity.obstacleCount = obstacles.size();
+    }
+    activity.nextStep = particleSystem.getStepCount() + 1;
+    activity.flags.assign(cells, 0);
+    unsigned char* flags = activity.flags.data();
+
+    //... obstáculos: si solo se agregaron se miran los nuevos; si se borró alguno, todo
+    if (obstacles.getRevision() != activity.obstacleRevision) {
+        const std::vector<Obstacle>& list = obstacles.getObstacles();
+        if (list.size() <= activity.obstacleCount) {
+            std::fill(activity.flags.begin(), activity.flags.end(), CELL_DISTURBED);
+        } else {
+            const float reach = 1.5f * cellSize;
+            for (size_t k = activity.obstacleCount; k < list.size(); k++) {
+                for (int c = 0; c < cells; c++) {
+                    Vec2 center(((c % gridWidth) + 0.5f) * cellSize, ((c / gridWidth) + 0.5f) * cellSize);
+                    Vec2 normal;
+                    if (ObstacleField::signedDistance(list[k], center, normal) < reach) {
+                        flags[c] = CELL_DISTURBED;
+                    }
+                }
+            }
+        }
+        activity.obstacleRevision = obstacles.getRevision();
+        activity.obstacleCount = list.size();
+    }
+    //... la boca de cada emisor y una celda más alrededor
+    for (const Emitter& emitter : particleSystem.getEmitters()) {
+        const float reach = 0.5f * emitter.width + cellSize;
+        const int x0 = std::max(0, static_cast<int>(std::floor((emitter.position.x - reach) / cellSize)));
+        const int x1 = std::min(gridWidth - 1, static_cast<int>(std::floor((emitter.position.x + reach) / cellSize)));
+        const int y0 = std::max(0, static_cast<int>(std::floor((emitter.position.y - reach) / cellSize)));
+        const int y1 = std::min(gridHeight - 1, static_cast<int>(std::floor((emitter.position.y + reach) / cellSize)));
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                flags[cy * gridWidth + cx] = CELL_DISTURBED;
+            }
+        }
+    }
+
+    //... primera pasada: qué celdas despiertas se mueven y cuáles cambiaron de partículas.
+    //... Cada celda escribe solo su marca
+    const float* pvx = particles.vx.data();
+    const float* pvy = particles.vy.data();
+    const float* pfx = particles.fx.data();
+    const float* pfy = particles.fy.data();
+    const float speed2 = sleep.speedThreshold * sleep.speedThreshold;
+    const float force2 = sleep.forceThreshold * sleep.forceThreshold;
+    const int grain = chunkGrain(threadPool, cells);
+    parallelChunks(threadPool, cells, grain, [&](int begin, int end) {
+        for (int c = begin; c < end; c++) {
+            const int first = cellStart[c], last = cellStart[c + 1];
+            if (last - first != activity.population[c]) flags[c] |= CELL_DISTURBED;
+            if (activity.asleep[c]) continue;
+            for (int k = first; k < last; k++) {
+                const int i = indices[k];
+                if (pvx[i] * pvx[i] + pvy[i] * pvy[i] >= speed2 ||
+                    pfx[i] * pfx[i] + pfy[i] * pfy[i] >= force2) {
+                    flags[c] |= CELL_MOVING;
+                    break;
+                }
+            }
+        }
+    });
+
+    //... segunda pasada: cada celda cuenta sus pasos quietos mirando las marcas de sus
+    //... 3x3 vecinas y se duerme o se despierta; las que se duermen frenan sus partículas
+    float* vx = particles.vx.data();
+    float* vy = particles.vy.data();
+    activity.wakeupPartials.assign(chunkTotal(cells, grain), 0);
+    parallelChunks(threadPool, cells, grain, [&](int begin, int end) {
+        unsigned long long wakeups = 0;
+        for (int c = begin; c < end; c++) {
+            const int cx = c % gridWidth, cy = c / gridWidth;
+            bool calm = (flags[c] & CELL_DISTURBED) == 0;
+            for (int ny = std::max(0, cy - 1); calm && ny <= std::min(gridHeight - 1, cy + 1); ny++) {
+                for (int nx = std::max(0, cx - 1); nx <= std::min(gridWidth - 1, cx + 1); nx++) {
+                    if (flags[ny * gridWidth + nx] & CELL_MOVING) calm = false;
+                }
+            }
+            int& quiet = activity.quietSteps[c];
+            quiet = calm ? std::min(quiet + 1, sleep.steps) : 0;
+
+            const int first = cellStart[c], last = cellStart[c + 1];
+            const bool asleep = quiet >= sleep.steps && last > first;
+            if (activity.asleep[c] && !asleep) {
+                wakeups++;
+            } else if (asleep && !activity.asleep[c]) {
+                for (int k = first; k < last; k++) {
+                    vx[indices[k]] = 0.0f;
+                    vy[indices[k]] = 0.0f;
+                }
+            }
+            activity.asleep[c] = asleep ? 1 : 0;
+            activity.population[c] = last - first;
+        }
+        activity.wakeupPartials[begin / grain] = wakeups;
+    });
+    for (unsigned long long wakeups : activity.wakeupPartials) {
+        sleepStats.wakeups += wakeups;
+    }
+
+    //... máscara para la integración y partículas que calculan fuerzas, en orden de índice
+    std::vector<unsigned char>& mask = particleSystem.getSleepMask();
+    mask.assign(count, 0);
+    size_t sleepingCells = 0, occupiedCells = 0, sleepingParticles = 0;
+    for (int c = 0; c < cells; c++) {
+        const int first = cellStart[c], last = cellStart[c + 1];
+        if (first == last) continue;
+        occupiedCells++;
+        if (!activity.asleep[c]) continue;
+        sleepingCells++;
+        sleepingParticles += last - first;
+        for (int k = first; k < last; k++) {
+            mask[indices[k]] = 1;
+        }
+    }
+    activity.awake.clear();
+    if (sleepingParticles > 0) {
+        activity.awake.reserve(count - sleepingParticles);
+        for (int i = 0; i < count; i++) {
+            if (!mask[i]) activity.awake.push_back(i);
+        }
+    } else {
+        mask.clear();
+    }
+    sleepReady = sleepingParticles > 0;
+    sleepStats.sleepingCells = sleepingCells;
+    sleepStats.occupiedCells = occupiedCells;
+    sleepStats.sleepingParticles = sleepingParticles;
+}
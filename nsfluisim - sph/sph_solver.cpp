@@ -10,76 +10,506 @@ Este código es solo una implementación básica y no optimizada de una simulaci
 //... sph_solver.cpp
 #include "sph_solver.h"
 #include <cmath>
+#include <algorithm>
+#include <limits>
 
-float SPHSolver::kernelPoly6(float r, float h) {
-    if (r > h) return 0.0f;
-    float term = h * h - r * r;
-    return 315.0f / (64.0f * M_PI * pow(h, 9)) * term * term * term;
+void SPHSolver::refreshKernels(float h) {
+    if (kernels.supportRadius() != h) {
+        kernels = SPHKernels(h);
+    }
+}
+
+//... el grid solo sirve si una celda cubre al menos el radio de suavizado,
+//... si no las 3x3 celdas vecinas no alcanzan y se usa fuerza bruta
+bool SPHSolver::useGrid(float h) const {
+    return neighborSearch == NeighborSearch::Grid && grid.getCellSize() >= h;
+}
+
+bool SPHSolver::useSimd(float h) const {
+#if defined(SPH_KERNELS_MULLER)
+    return simd.level != SimdLevel::Scalar && useGrid(h);
+#else
+    (void)h;
+    return false;
+#endif
+}
+
+SimdKernelParams SPHSolver::simdParams(float mass) const {
+    SimdKernelParams params = {};
+#if defined(SPH_KERNELS_MULLER)
+    params.h = kernels.h;
+    params.h2 = kernels.h2;
+    params.mass = mass;
+    params.poly6Coeff = kernels.poly6Coeff;
+    params.spikyCoeff = kernels.spikyCoeff;
+    params.viscosityCoeff = kernels.viscosityCoeff;
+#else
+    (void)mass;
+#endif
+    return params;
+}
+
+float SPHSolver::listRadius(float h) const {
+    return neighborCache == NeighborCache::Verlet ? h + verletSkin : h;
+}
+
+bool SPHSolver::useList(float h) const {
+    return neighborCache != NeighborCache::Off &&
+           neighborSearch == NeighborSearch::Grid &&
+           grid.getCellSize() >= listRadius(h);
 }
 
-float SPHSolver::kernelSpikyGradient(float r, float h) {
-    if (r > h) return 0.0f;
-    float term = h - r;
-    return -45.0f / (M_PI * pow(h, 6)) * term * term;
+bool SPHSolver::useCompact(float h) const {
+    return compactStorage && useGrid(h) && grid.getLayout() == GridLayout::Dense;
 }
 
-float SPHSolver::kernelViscosityLaplacian(float r, float h) {
-    if (r > h) return 0.0f;
-    return 45.0f / (M_PI * pow(h, 6)) * (h - r);
+bool SPHSolver::useSleep(const ParticleSystem& particleSystem) const {
+    return sleep.enabled && sleepInactiveReason(particleSystem) == nullptr;
+}
+
+const char* SPHSolver::sleepInactiveReason(const ParticleSystem& particleSystem) const {
+    const float h = particleSystem.getSmoothingLength();
+    if (useMultires(particleSystem)) return "resolución adaptativa";
+    if (usePCISPH(particleSystem)) return "PCISPH";
+    if (!useGrid(h)) return "fuerza bruta (sin grid o con celdas menores que h)";
+    if (grid.getLayout() != GridLayout::Dense) return "grid hashed";
+    if (useList(h)) return "lista de vecinos";
+    if (useCompact(h)) return "copia compacta";
+    return nullptr;
+}
+
+void SPHSolver::fitGrid(float h) {
+    float cellSize = gridCellSize > 0.0f ? gridCellSize : listRadius(h);
+    if (grid.getCellSize() != cellSize) {
+        grid.setCellSize(cellSize);
+        neighborList.invalidate();
+    }
+}
+
+NeighborListStats SPHSolver::getNeighborListStats() const {
+    NeighborListStats stats;
+    stats.steps = listSteps;
+    stats.rebuilds = listRebuilds;
+    stats.rebuildFrequency = listSteps > 0 ? static_cast<float>(listRebuilds) / listSteps : 0.0f;
+    stats.averageNeighbors = 0.0f;
+    if (neighborList.isValid() && neighborList.getParticleCount() > 0) {
+        stats.averageNeighbors = static_cast<float>(neighborList.getPairCount()) /
+                                 neighborList.getParticleCount();
+    }
+    return stats;
+}
+
+SPHSolver::DensityPartial SPHSolver::emptyDensityPartial() {
+    return DensityPartial{0.0f, 0.0f, 0.0f, 0.0f, std::numeric_limits<float>::max(),
+                          std::numeric_limits<float>::lowest()};
+}
+
+void SPHSolver::reduceDensityStats(int count) {
+    DensityPartial total = emptyDensityPartial();
+    for (const auto& partial : densityPartials) {
+        total.densitySum += partial.densitySum;
+        total.maxDensity = std::max(total.maxDensity, partial.maxDensity);
+        total.maxError = std::max(total.maxError, partial.maxError);
+        total.errorSum += partial.errorSum;
+        total.minPressure = std::min(total.minPressure, partial.minPressure);
+        total.maxPressure = std::max(total.maxPressure, partial.maxPressure);
+    }
+    if (count == 0) {
+        densityStats = DensityStats{0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        return;
+    }
+    densityStats.averageDensity = total.densitySum / count;
+    densityStats.maxDensity = total.maxDensity;
+    densityStats.maxError = total.maxError;
+    densityStats.averageError = total.errorSum / count;
+    densityStats.minPressure = total.minPressure;
+    densityStats.maxPressure = total.maxPressure;
 }
 
 void SPHSolver::calculateDensityPressure(ParticleSystem& particleSystem) {
-    auto& particles = particleSystem.getParticles();
+    ParticleData& particles = particleSystem.getData();
+    if (useMultires(particleSystem)) {
+        calculateDensityMultires(particleSystem);
+        return;
+    }
+    //... con la copia compacta armada en este paso se usa esa
+    if (compactReady && compact.size() == particles.size()) {
+        calculateDensityCompact(particleSystem);
+        return;
+    }
+    densityPass(particleSystem, nullptr, static_cast<int>(particles.size()));
+}
+
+void SPHSolver::densityPass(ParticleSystem& particleSystem, const int* subset, int subsetCount) {
+    ParticleData& particles = particleSystem.getData();
+    const int count = static_cast<int>(particles.size());
+    const float* px = particles.x.data();
+    const float* py = particles.y.data();
     float h = particleSystem.getSmoothingLength();
     float mass = particleSystem.getParticleMass();
+    bool gridSearch = useGrid(h);
+    refreshKernels(h);
+    const SPHKernels& kernel = kernels;
+    const bool simdSearch = useSimd(h);
+    const SimdKernelParams params = simdParams(mass);
+    const bool listSearch = useList(h) && neighborList.isValid();
+    const int grain = chunkGrain(threadPool, subsetCount);
+    densityPartials.assign(chunkTotal(subsetCount, grain), emptyDensityPartial());
     
-    for (auto& particle : particles) {
-        particle.density = 0.0f;
-        for (const auto& other : particles) {
-            sf::Vector2f diff = particle.position - other.position;
-            float r = sqrt(diff.x * diff.x + diff.y * diff.y);
-            particle.density += mass * kernelPoly6(r, h);
+    parallelChunks(threadPool, subsetCount, grain, [&](int begin, int end) {
+        DensityPartial partial = emptyDensityPartial();
+        for (int k = begin; k < end; k++) {
+            const int i = subset ? subset[k] : k;
+            float density = 0.0f;
+            auto accumulate = [&](int j) {
+                float dx = px[i] - px[j];
+                float dy = py[i] - py[j];
+                density += mass * kernel.density(dx * dx + dy * dy);
+            };
+
+            if (listSearch && simdSearch) {
+                const int* first = neighborList.begin(i);
+                density = mass * simd.density(px, py, first,
+                                              static_cast<int>(neighborList.end(i) - first),
+                                              px[i], py[i], params);
+            } else if (listSearch) {
+                for (const int* it = neighborList.begin(i); it != neighborList.end(i); ++it) {
+                    accumulate(*it);
+                }
+            } else if (simdSearch) {
+                float kernelSum = 0.0f;
+                grid.forEachNeighborSpan(px[i], py[i], [&](const int* first, const int* last) {
+                    kernelSum += simd.density(px, py, first, static_cast<int>(last - first),
+                                              px[i], py[i], params);
+                });
+                density = mass * kernelSum;
+            } else if (gridSearch) {
+                grid.forEachNeighbor(px[i], py[i], accumulate);
+            } else {
+                for (int j = 0; j < count; j++) {
+                    accumulate(j);
+                }
+            }
+            float pressure = stiffness * (density - restDensity);
+            particles.density[i] = density;
+            particles.pressure[i] = pressure;
+            accumulateDensity(partial, density, pressure, restDensity);
         }
-        particle.pressure = stiffness * (particle.density - restDensity);
-    }
+        densityPartials[begin / grain] = partial;
+    });
+    reduceDensityStats(subsetCount);
 }
 
 void SPHSolver::calculateForces(ParticleSystem& particleSystem) {
-    auto& particles = particleSystem.getParticles();
+    ParticleData& particles = particleSystem.getData();
+    if (useMultires(particleSystem)) {
+        calculateForcesMultires(particleSystem);
+        return;
+    }
+    if (compactReady && compact.size() == particles.size()) {
+        calculateForcesCompact(particleSystem);
+        return;
+    }
+    forcesPass(particleSystem, nullptr, static_cast<int>(particles.size()));
+}
+
+void SPHSolver::forcesPass(ParticleSystem& particleSystem, const int* subset, int subsetCount) {
+    ParticleData& particles = particleSystem.getData();
+    const int count = static_cast<int>(particles.size());
+    const float* px = particles.x.data();
+    const float* py = particles.y.data();
+    const float* pvx = particles.vx.data();
+    const float* pvy = particles.vy.data();
+    const float* pdensity = particles.density.data();
+    const float* ppressure = particles.pressure.data();
     float h = particleSystem.getSmoothingLength();
     float mass = particleSystem.getParticleMass();
+    bool gridSearch = useGrid(h);
+    refreshKernels(h);
+    const SPHKernels& kernel = kernels;
+    const float h2 = h * h;
+    const bool simdSearch = useSimd(h);
+    const SimdKernelParams params = simdParams(mass);
+    const SimdParticleView view = { px, py, pvx, pvy, pdensity, ppressure };
+    const bool listSearch = useList(h) && neighborList.isValid();
     
-    for (auto& particle : particles) {
-        sf::Vector2f pressureForce(0.0f, 0.0f);
-        sf::Vector2f viscosityForce(0.0f, 0.0f);
+    parallelChunks(threadPool, subsetCount, chunkGrain(threadPool, subsetCount), [&](int begin, int end) {
+        for (int k = begin; k < end; k++) {
+            const int i = subset ? subset[k] : k;
+            Vec2 pressureForce(0.0f, 0.0f);
+            Vec2 viscosityForce(0.0f, 0.0f);
         
-        for (const auto& other : particles) {
-            if (&other == &particle) continue;
+            auto accumulate = [&](int j) {
+                if (j == i) return;
             
-            sf::Vector2f diff = particle.position - other.position;
-            float r = sqrt(diff.x * diff.x + diff.y * diff.y);
-            if (r < h) {
-                //... fuerza de presión
-                float pressureGrad = kernelSpikyGradient(r, h);
-                pressureForce += diff/r * mass * 
-                    (particle.pressure + other.pressure)/(2.0f * other.density) * 
-                    pressureGrad;
+                Vec2 diff(px[i] - px[j], py[i] - py[j]);
+                float r2 = diff.x * diff.x + diff.y * diff.y;
+                if (r2 >= h2) return;
+                float r = std::sqrt(r2);
+
+                //... fuerza de presión; con r == 0 la dirección no está definida
+                //... (antes daba 0/0 = NaN con partículas apiladas en una esquina)
+                if (r > 0.0f) {
+                    float pressureGrad = kernel.pressureGradient(r);
+                    pressureForce += diff/r * mass * 
+                        (ppressure[i] + ppressure[j])/(2.0f * pdensity[j]) * 
+                        pressureGrad;
+                }
                 
                 //... fuerza de viscosidad
-                float viscLap = kernelViscosityLaplacian(r, h);
-                viscosityForce += mass * (other.velocity - particle.velocity) / 
-                    other.density * viscLap;
+                float viscLap = kernel.viscosityLaplacian(r);
+                Vec2 velocityDiff(pvx[j] - pvx[i], pvy[j] - pvy[i]);
+                viscosityForce += mass * velocityDiff / 
+                    pdensity[j] * viscLap;
+            };
+
+            if (listSearch && simdSearch) {
+                ForceAccumulator acc = { 0.0f, 0.0f, 0.0f, 0.0f };
+                const int* first = neighborList.begin(i);
+                simd.force(view, i, first, static_cast<int>(neighborList.end(i) - first),
+                           params, acc);
+                pressureForce = Vec2(acc.pressureX, acc.pressureY);
+                viscosityForce = Vec2(acc.viscosityX, acc.viscosityY);
+            } else if (listSearch) {
+                for (const int* it = neighborList.begin(i); it != neighborList.end(i); ++it) {
+                    accumulate(*it);
+                }
+            } else if (simdSearch) {
+                ForceAccumulator acc = { 0.0f, 0.0f, 0.0f, 0.0f };
+                grid.forEachNeighborSpan(px[i], py[i], [&](const int* first, const int* last) {
+                    simd.force(view, i, first, static_cast<int>(last - first), params, acc);
+                });
+                pressureForce = Vec2(acc.pressureX, acc.pressureY);
+                viscosityForce = Vec2(acc.viscosityX, acc.viscosityY);
+            } else if (gridSearch) {
+                grid.forEachNeighbor(px[i], py[i], accumulate);
+            } else {
+                for (int j = 0; j < count; j++) {
+                    accumulate(j);
+                }
             }
-        }
         
-        sf::Vector2f gravity(0.0f, 981.0f); //... gravedad en cm/s^2
-        particle.force = pressureForce * -1.0f + 
-                        viscosityForce * viscosity + 
-                        gravity;
+            Vec2 gravity(0.0f, 981.0f); //... gravedad en cm/s^2
+            Vec2 force = pressureForce * -1.0f + 
+                            viscosityForce * viscosity + 
+                            gravity;
+            particles.fx[i] = force.x;
+            particles.fy[i] = force.y;
+        }
+    });
+}
+
+void SPHSolver::prepareNeighbors(ParticleSystem& particleSystem) {
+    const ParticleData& particles = particleSystem.getData();
+    float h = particleSystem.getSmoothingLength();
+
+    //... con varios niveles cada uno tiene su grid (ver sph_multires.cpp)
+    if (useMultires(particleSystem)) {
+        neighborList.invalidate();
+        if (neighborSearch == NeighborSearch::Grid) {
+            ScopedTimer timer(profiler, ProfilePhase::GridRebuild);
+            prepareLevelGrids(particleSystem);
+        }
+        return;
+    }
+
+    //... la copia compacta va en el orden del grid y se recorre por celdas: sin lista
+    if (useCompact(h)) {
+        neighborList.invalidate();
+        ScopedTimer timer(profiler, ProfilePhase::GridRebuild);
+        grid.updateGrid(particles);
+        compact.build(particles, grid, threadPool);
+        compactReady = true;
+        return;
+    }
+
+    if (useList(h)) {
+        listSteps++;
+        unsigned revision = particleSystem.getIndexRevision();
+        //... la lista de Verlet sobrevive al paso mientras siga siendo válida; el grid
+        //... solo se pide para rearmarla
+        if (neighborCache == NeighborCache::PerStep || 
+            neighborList.needsRebuild(particles, h, revision)) {
+            {
+                ScopedTimer timer(profiler, ProfilePhase::GridRebuild);
+                grid.updateGrid(particles);
+            }
+            ScopedTimer timer(profiler, ProfilePhase::NeighborList);
+            neighborList.build(particles, grid, listRadius(h), revision, threadPool);
+            listRebuilds++;
+        }
+        return;
+    }
+
+    //... sin lista el grid se reconstruye una sola vez por paso y lo comparten ambas pasadas
+    neighborList.invalidate();
+    if (useGrid(h)) {
+        ScopedTimer timer(profiler, ProfilePhase::GridRebuild);
+        grid.updateGrid(particles);
     }
 }
 
 void SPHSolver::update(ParticleSystem& particleSystem) {
-    calculateDensityPressure(particleSystem);
-    calculateForces(particleSystem);
+    compactReady = false;
+    fitGrid(particleSystem.getSmoothingLength());
+    //... reordenar antes de armar el grid, para que los tramos de cada celda queden
+    //... contiguos también en los arreglos de posición y las pasadas lean en secuencia
+    particleSystem.maybeReorder(grid.getCellSize());
+
+    if (usePCISPH(particleSystem)) {
+        solvePCISPH(particleSystem);
+        return;
+    }
+
+    prepareNeighbors(particleSystem);
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Density);
+        calculateDensityPressure(particleSystem);
+    }
+    sleepReady = false;
+    if (useSleep(particleSystem)) {
+        ScopedTimer timer(profiler, ProfilePhase::Activity);
+        updateSleep(particleSystem);
+    } else if (!activity.asleep.empty()) {
+        //... sin el grid del paso no hay celdas: todo despierto hasta que vuelva a haberlo
+        resetSleep();
+    }
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Forces);
+        //... las dormidas conservan la fuerza del paso en que se durmieron
+        if (sleepReady) {
+            forcesPass(particleSystem, activity.awake.data(), static_cast<int>(activity.awake.size()));
+        } else {
+            calculateForces(particleSystem);
+        }
+    }
+}
+
+const LatticeReference& SPHSolver::latticeReference(float h, float spacing, float mass) {
+    if (lattice.h == h && lattice.spacing == spacing && lattice.mass == mass) {
+        return lattice;
+    }
+    refreshKernels(h);
+
+    lattice = LatticeReference{h, spacing, mass, 0.0f, Vec2(), 0.0f, 0.0f};
+    int reach = static_cast<int>(std::ceil(h / spacing));
+    float perNeighborLaplacian = 0.0f;
+    for (int gy = -reach; gy <= reach; gy++) {
+        for (int gx = -reach; gx <= reach; gx++) {
+            Vec2 diff(gx * spacing, gy * spacing);
+            float r2 = dot(diff, diff);
+            if (r2 >= h * h) continue;
+            lattice.density += mass * kernels.density(r2);
+            float r = std::sqrt(r2);
+            if (r > 0.0f) {
+                Vec2 grad = diff / r * kernels.pressureGradient(r);
+                lattice.gradSum += grad;
+                lattice.gradDotSum += dot(grad, grad);
+                perNeighborLaplacian += kernels.viscosityLaplacian(r);
+            }
+        }
+    }
+    lattice.laplacianSum = perNeighborLaplacian;
+    return lattice;
+}
+
+float SPHSolver::computeStableTimestep(ParticleSystem& particleSystem) {
+    const ParticleData& particles = particleSystem.getData();
+    const int count = static_cast<int>(particles.size());
+    if (count == 0) return timestep.maxTimestep;
+
+    //... la fuerza que guarda el solver ya es aceleración: la integración hace v += f * dt
+    const int grain = chunkGrain(threadPool, count);
+    motionPartials.assign(chunkTotal(count, grain), MotionPartial{0.0f, 0.0f});
+    parallelChunks(threadPool, count, grain, [&](int begin, int end) {
+        MotionPartial partial{0.0f, 0.0f};
+        for (int i = begin; i < end; i++) {
+            float speed2 = particles.vx[i] * particles.vx[i] + particles.vy[i] * particles.vy[i];
+            float accel2 = particles.fx[i] * particles.fx[i] + particles.fy[i] * particles.fy[i];
+            partial.maxSpeed2 = std::max(partial.maxSpeed2, speed2);
+            partial.maxAccel2 = std::max(partial.maxAccel2, accel2);
+        }
+        motionPartials[begin / grain] = partial;
+    });
+
+    MotionPartial total = motionPartials[0];
+    for (const auto& partial : motionPartials) {
+        total.maxSpeed2 = std::max(total.maxSpeed2, partial.maxSpeed2);
+        total.maxAccel2 = std::max(total.maxAccel2, partial.maxAccel2);
+    }
+
+    //... con varios niveles manda el más fino que se puede pedir: h y separación / sqrt(2)
+    //... por nivel (con los kernels de cada nivel normalizados igual que los de la escena,
+    //... la tasa de viscosidad del bloque no depende de esa corrección)
+    const int finest = particleSystem.getFinestLevel();
+    float h = particleSystem.getLevelSmoothingLength(finest);
+    //... PCISPH no tiene velocidad del sonido: la incompresibilidad la imponen las iteraciones
+    float soundSpeed = usePCISPH(particleSystem) ? 0.0f : std::sqrt(stiffness);
+    float dt = timestep.maxTimestep;
+    dt = std::min(dt, timestep.cflFactor * h / (soundSpeed + std::sqrt(total.maxSpeed2)));
+    if (total.maxAccel2 > 0.0f) {
+        dt = std::min(dt, timestep.forceFactor * std::sqrt(h / std::sqrt(total.maxAccel2)));
+    }
+    //... con los kernels de este código (normalización 3D) h^2/nu no sirve de escala;
+    //... se usa la tasa de difusión real de una partícula del bloque en reposo
+    const LatticeReference& reference = latticeReference(h, particleSystem.getLevelSpacing(finest),
+                                                         particleSystem.getLevelMass(finest));
+    float viscousRate = viscosity * reference.mass / reference.density * reference.laplacianSum;
+    if (viscousRate > 0.0f) {
+        dt = std::min(dt, timestep.viscousFactor / viscousRate);
+    }
+    return std::max(dt, timestep.minTimestep);
+}
+
+int SPHSolver::advance(ParticleSystem& particleSystem, float frameDt) {
+    //... PCISPH calibra la presión para el paso con que se va a integrar, así que ahí el
+    //... paso se elige antes, con las fuerzas del subpaso anterior, y puede achicarse
+    //... después si las iteraciones no convergen
+    const bool pcisphStep = usePCISPH(particleSystem);
+    if (!timestep.adaptive && !pcisphStep) {
+        particleSystem.setDeltaTime(frameDt);
+        update(particleSystem);
+        particleSystem.update();
+        timestepStats.lastSubsteps = 1;
+        timestepStats.lastTimestep = frameDt;
+        return 1;
+    }
+
+    //... cada subpaso calcula fuerzas, elige el paso con ellas y recién ahí integra;
+    //... los subpasos se ajustan para caer justo en frameDt. Con paso fijo solo
+    //... PCISPH llega acá, y subdivide únicamente cuando no converge
+    float remaining = frameDt;
+    int substeps = 0;
+    while (remaining > 0.0f && substeps < timestep.maxSubsteps) {
+        if (!pcisphStep) update(particleSystem);
+        float dt = timestep.adaptive ? std::min(computeStableTimestep(particleSystem), remaining)
+                                     : remaining;
+        if (pcisphStep && pcisphStepLimit > 0.0f) dt = std::min(dt, pcisphStepLimit);
+        //... reparte lo que falta en partes iguales que no pasen del paso estable, así
+        //... el último subpaso no queda diminuto ni más largo de lo permitido
+        if (dt < remaining) {
+            dt = remaining / std::ceil(remaining / dt);
+        }
+        particleSystem.setDeltaTime(dt);
+        if (pcisphStep) dt = updatePCISPH(particleSystem, dt);
+        particleSystem.update();
+        remaining -= dt;
+        substeps++;
+        timestepStats.lastTimestep = dt;
+        timestepStats.smallestTimestep = std::min(timestepStats.smallestTimestep, dt);
+    }
+    if (remaining > 0.0f) {
+        timestepStats.droppedTime += remaining;
+    }
+    timestepStats.lastSubsteps = substeps;
+    return substeps;
+}
+
+void SPHSolver::resetTimestepStats() {
+    timestepStats.lastSubsteps = 0;
+    timestepStats.lastTimestep = timestep.maxTimestep;
+    timestepStats.smallestTimestep = timestep.maxTimestep;
+    timestepStats.droppedTime = 0.0;
+    timestepStats.pressureRetries = 0;
+    timestepStats.unconvergedSteps = 0;
 }
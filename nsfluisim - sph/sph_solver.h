@@ -1,29 +1,450 @@
 // sph_solver.h
 #pragma once
+#include <algorithm>
 #include "particle_system.h"
 #include "spatial_grid.h"
+#include "sph_kernels.h"
+#include "sph_simd.h"
+#include "neighbor_list.h"
+#include "compact_particles.h"
+#include "halo_exchange.h"
+
+//... modo de búsqueda de vecinos: BruteForce es el O(n^2) original, se deja como referencia
+enum class NeighborSearch {
+    BruteForce,
+    Grid
+};
+
+//... caché de vecinos: Off busca en el grid en cada pasada, PerStep arma una lista por
+//... paso que comparten densidad y fuerzas, Verlet la reutiliza con una piel extra
+enum class NeighborCache {
+    Off,
+    PerStep,
+    Verlet
+};
+
+//... para ajustar la piel: cada cuántos pasos se rearma la lista de Verlet
+struct NeighborListStats {
+    unsigned steps;
+    unsigned rebuilds;
+    float rebuildFrequency;     //... rearmados / pasos (1 = cada paso)
+    float averageNeighbors;     //... vecinos por partícula en la última lista
+};
+
+//... cálculo de la presión: EquationOfState es p = stiffness * (densidad - restDensity),
+//... débilmente compresible; PCISPH (Solenthaler y Pajarola 2009) itera predicción y
+//... corrección de la presión hasta que el error de densidad baja de la tolerancia
+enum class PressureSolver {
+    EquationOfState,
+    PCISPH
+};
+
+struct PCISPHSettings {
+    //... error de densidad máximo admitido, relativo a la densidad de reposo (0.01 = 1%)
+    float tolerance;
+    int minIterations;
+    int maxIterations;
+    //... densidad de reposo; <= 0 la calibra con una partícula rodeada por el bloque
+    //... inicial (ver ParticleSystem::getParticleSpacing)
+    float restDensity;
+};
+
+struct PressureSolveStats {
+    int iterations;             //... iteraciones del último paso
+    float densityError;         //... compresión máxima relativa al terminar
+    float averageError;         //... compresión media relativa al terminar
+    bool converged;             //... false si se llegó al tope de iteraciones
+    float maxDisplacement;      //... mayor desplazamiento del paso, en unidades de h
+};
+
+//... métricas del fluido en el último paso, acumuladas en la misma pasada que calcula
+//... la densidad (o en la última iteración de PCISPH), sin recorrer las partículas otra
+//... vez. El error es la compresión relativa a la densidad de reposo del modo activo;
+//... la expansión de la superficie libre no cuenta, igual que en PressureSolveStats
+struct DensityStats {
+    float averageDensity;
+    float maxDensity;
+    float maxError;             //... max((densidad - reposo) / reposo, 0)
+    float averageError;         //... media de lo mismo
+    float minPressure;
+    float maxPressure;
+};
+
+//... control de paso adaptativo: el paso estable es el mínimo de tres criterios
+//...   Courant:    cflFactor * h / (c + vmax), con c = sqrt(stiffness) de la ecuación de estado
+//...   fuerza:     forceFactor * sqrt(h / amax)
+//...   viscosidad: viscousFactor / (viscosity * sum_j m/rho_j lap W_ij) de una partícula del
+//...               bloque en reposo: la tasa con que la viscosidad explícita iguala velocidades
+//... y se acota a [minTimestep, maxTimestep]
+struct TimestepSettings {
+    bool adaptive;
+    float cflFactor;
+    float forceFactor;
+    float viscousFactor;
+    float minTimestep;
+    float maxTimestep;
+    //... tope de subpasos por llamada a advance(); lo que sobre se descarta
+    int maxSubsteps;
+};
+
+struct TimestepStats {
+    int lastSubsteps;           //... subpasos del último advance()
+    float lastTimestep;         //... último paso usado
+    float smallestTimestep;     //... paso más chico desde resetTimestepStats()
+    double droppedTime;         //... tiempo simulado descartado por el tope de subpasos
+    //... PCISPH: subpasos que no convergieron y se repitieron con la mitad del paso, y
+    //... los que se integraron igual porque la mitad ya quedaba bajo minTimestep
+    unsigned long long pressureRetries;
+    unsigned long long unconvergedSteps;
+};
+
+//... celdas dormidas (ver sph_sleep.cpp): una celda del grid cuyas partículas siguen
+//... quietas durante 'steps' pasos seguidos, con las 3x3 de alrededor igual de quietas,
+//... se duerme: sus partículas quedan con velocidad 0, no calculan fuerzas y no se
+//... integran, aunque siguen sumando densidad y presión a sus vecinas. Quieta es rapidez
+//... menor que speedThreshold y aceleración neta menor que forceThreshold (en reposo la
+//... presión equilibra la gravedad; contra el fondo queda la gravedad sola)
+struct SleepSettings {
+    bool enabled;
+    float speedThreshold;       //... cm/s
+    float forceThreshold;       //... cm/s^2
+    int steps;
+};
+
+struct SleepStats {
+    size_t sleepingCells;       //... del último paso, entre las celdas con partículas
+    size_t occupiedCells;
+    size_t sleepingParticles;
+    unsigned long long wakeups; //... celdas despertadas desde resetSleep()
+};
+
+//... sumas de los kernels sobre una partícula rodeada por el bloque inicial (una
+//... cuadrícula regular con la separación de ParticleSystem); las usan la calibración
+//... de PCISPH y el criterio de paso por viscosidad
+struct LatticeReference {
+    float h, spacing, mass;
+    float density;
+    Vec2 gradSum;
+    float gradDotSum;
+    float laplacianSum;
+};
 
 class SPHSolver {
 private:
+    NeighborSearch neighborSearch;
     float viscosity;
     float stiffness;
     float restDensity;
-    float deltaTime;
     SpatialGrid grid;
+    //... lado de celda pedido; 0 = el radio de búsqueda (ver fitGrid)
+    float gridCellSize;
+    ThreadPool* threadPool;
+    Profiler* profiler;
     
-    float kernelPoly6(float r, float h);
-    float kernelSpikyGradient(float r, float h);
-    float kernelViscosityLaplacian(float r, float h);
+    SPHKernels kernels;
+    SimdKernels simd;
+
+    NeighborCache neighborCache;
+    float verletSkin;
+    NeighborList neighborList;
+    unsigned listSteps;
+    unsigned listRebuilds;
+
+    //... copia reducida por paso para densidad y fuerzas (ver setCompactStorage)
+    bool compactStorage;
+    CompactParticles compact;
+    //... la copia es de las posiciones del update() en curso (PCISPH no la arma)
+    bool compactReady;
+
+    //... kernels por par de niveles de resolución (ver sph_multires.cpp), fila = nivel
+    //... de la partícula, columna = nivel del vecino; se rearman si cambian h o la masa
+    struct LevelKernelTable {
+        float h, mass;
+        std::vector<SPHKernels> kernels;
+        //... masa del vecino por la corrección de normalización del par
+        std::vector<float> weight;
+        std::vector<float> support;
+        std::vector<float> support2;
+    } levelKernels;
+    //... un grid por nivel, con celdas del h del nivel y solo sus partículas; se arman
+    //... en cada paso hasta el nivel más fino que haya
+    std::vector<SpatialGrid> levelGrids;
+    std::vector<std::vector<int>> levelMembers;
+    int levelCount;
+
+    //... paso repartido entre procesos (ver sph_distributed.cpp): las partículas que se
+    //... calculan antes de que lleguen las fantasmas y las que esperan a tenerlas
+    struct HaloSets {
+        std::vector<int> innerDensity, edgeDensity;
+        std::vector<int> innerForces, edgeForces;
+    } haloSets;
+
+    //... estado por celda del grid Dense para dormir las quietas; se vacía si cambia la
+    //... cantidad de celdas. 'awake' son las partículas que calculan fuerzas en el paso
+    SleepSettings sleep;
+    SleepStats sleepStats;
+    struct CellActivity {
+        std::vector<unsigned char> asleep;
+        std::vector<int> quietSteps;
+        //... partículas de la celda en el paso anterior: si cambia, algo entró o salió
+        std::vector<int> population;
+        //... del paso en curso: MOVING (alguna partícula no está quieta) y DISTURBED
+        std::vector<unsigned char> flags;
+        std::vector<int> awake;
+        unsigned obstacleRevision;
+        size_t obstacleCount;
+        //... getStepCount() que tiene que tener el próximo paso; si no, se empieza de nuevo
+        unsigned long long nextStep;
+        std::vector<unsigned long long> wakeupPartials;
+    } activity;
+    //... la última llamada a updateSleep() dejó partículas dormidas
+    bool sleepReady;
+
+    TimestepSettings timestep;
+    TimestepStats timestepStats;
+    //... parciales por trozo de rapidez y aceleración máximas (al cuadrado)
+    struct MotionPartial {
+        float maxSpeed2;
+        float maxAccel2;
+    };
+    std::vector<MotionPartial> motionPartials;
+
+    PressureSolver pressureSolver;
+    PCISPHSettings pcisph;
+    PressureSolveStats pcisphStats;
+    //... estado de las iteraciones: posiciones predichas, aceleración sin presión
+    //... y aceleración de presión
+    struct PCISPHState {
+        std::vector<float> predictedX, predictedY;
+        std::vector<float> externalX, externalY;
+        std::vector<float> pressureX, pressureY;
+        std::vector<float> targetDensity;
+    } pcisphState;
+    float pcisphDelta;
+    float pcisphRestDensity;
+    //... tope del subpaso después de partir uno que no convergió (0 = sin tope); se
+    //... duplica cuando convergen STEP_LIMIT_HOLD subpasos seguidos (ver sph_pcisph.cpp)
+    float pcisphStepLimit;
+    int pcisphLimitSteps;
+    LatticeReference lattice;
+    //... parciales por trozo de DensityStats (los comparten la ecuación de estado y PCISPH)
+    struct DensityPartial {
+        float densitySum;
+        float maxDensity;
+        float maxError;
+        float errorSum;
+        float minPressure;
+        float maxPressure;
+    };
+    std::vector<DensityPartial> densityPartials;
+    DensityStats densityStats;
+
+    //... suma los parciales en orden de trozo y deja el resultado en densityStats
+    void reduceDensityStats(int count);
+    static DensityPartial emptyDensityPartial();
+    static void accumulateDensity(DensityPartial& partial, float density, float pressure,
+                                  float restDensity) {
+        float relative = std::max(0.0f, density - restDensity) / restDensity;
+        partial.densitySum += density;
+        partial.maxDensity = std::max(partial.maxDensity, density);
+        partial.maxError = std::max(partial.maxError, relative);
+        partial.errorSum += relative;
+        partial.minPressure = std::min(partial.minPressure, pressure);
+        partial.maxPressure = std::max(partial.maxPressure, pressure);
+    }
+
+    //... recalcula las constantes de los kernels solo si cambió h
+    void refreshKernels(float h);
+    bool useGrid(float h) const;
+    //... la ruta SIMD necesita el grid (tramos de candidatos) y los kernels de Müller
+    bool useSimd(float h) const;
+    SimdKernelParams simdParams(float mass) const;
+    //... radio de búsqueda de la lista; el grid tiene que cubrirlo para usarla
+    float listRadius(float h) const;
+    bool useList(float h) const;
+    //... la copia compacta necesita el grid Dense con celdas que cubran h
+    bool useCompact(float h) const;
+    //... con resolución adaptativa van las pasadas de varios niveles (masa y h por
+    //... partícula); tienen prioridad sobre todo lo demás y PCISPH queda sin usar
+    bool useMultires(const ParticleSystem& particleSystem) const {
+        return particleSystem.getMaxResolutionLevel() > 0 || particleSystem.hasRefinedParticles();
+    }
+    bool usePCISPH(const ParticleSystem& particleSystem) const {
+        return pressureSolver == PressureSolver::PCISPH && !useMultires(particleSystem);
+    }
+    void refreshLevelKernels(const ParticleSystem& particleSystem);
+    //... las celdas dormidas usan las del grid Dense armado en el paso: sin la lista de
+    //... vecinos (que no lo rearma en cada paso), la copia compacta ni varios niveles
+    bool useSleep(const ParticleSystem& particleSystem) const;
+    //... ajusta el lado de celda del grid a gridCellSize o, si es 0, al radio de búsqueda
+    void fitGrid(float h);
+    //... arma o reutiliza la lista (o solo el grid) antes de las pasadas
+    void prepareNeighbors(ParticleSystem& particleSystem);
+    //... densidad y presión de la ecuación de estado y fuerzas, con la lista, SIMD, el grid
+    //... o fuerza bruta; con 'subset' solo para esas partículas (las demás no se tocan,
+    //... pero todas son vecinas) y las estadísticas son de ellas
+    void densityPass(ParticleSystem& particleSystem, const int* subset, int subsetCount);
+    void forcesPass(ParticleSystem& particleSystem, const int* subset, int subsetCount);
+
+    //... se recalcula solo si cambian h, la separación o la masa
+    const LatticeReference& latticeReference(float h, float spacing, float mass);
+
+    //... implementadas en sph_pcisph.cpp
+    void calibratePCISPH(const ParticleSystem& particleSystem, float dt);
+    void solvePCISPH(ParticleSystem& particleSystem);
+    //... update() con PCISPH para un subpaso de dt: si no converge lo repite con la mitad
+    //... del paso; devuelve el paso con que quedó calculada la presión
+    float updatePCISPH(ParticleSystem& particleSystem, float dt);
+    //... implementadas en sph_compact.cpp
+    void calculateDensityCompact(ParticleSystem& particleSystem);
+    void calculateForcesCompact(ParticleSystem& particleSystem);
+    //... implementadas en sph_multires.cpp
+    void prepareLevelGrids(const ParticleSystem& particleSystem);
+    void calculateDensityMultires(ParticleSystem& particleSystem);
+    void calculateForcesMultires(ParticleSystem& particleSystem);
+    //... implementada en sph_sleep.cpp: duerme y despierta celdas con el grid del paso y
+    //... deja en activity.awake las partículas que calculan fuerzas
+    void updateSleep(ParticleSystem& particleSystem);
+    //... implementada en sph_distributed.cpp: densityStats de las primeras 'count'
+    void collectDensityStats(const ParticleData& particles, int count);
+    //... candidatos para la partícula i según el modo de búsqueda: grid o todas
+    template <typename Visitor>
+    void forEachCandidate(float x, float y, int count, bool gridSearch, Visitor&& visit) const {
+        if (gridSearch) {
+            grid.forEachNeighbor(x, y, visit);
+        } else {
+            for (int j = 0; j < count; j++) {
+                visit(j);
+            }
+        }
+    }
 
 public:
-    SPHSolver() 
-        : viscosity(250.0f),
+    //... el grid cubre el dominio del ParticleSystem con el que se va a usar; sus celdas
+    //... se ajustan solas al radio de suavizado del sistema en cada paso
+    explicit SPHSolver(int width = WINDOW_WIDTH, int height = WINDOW_HEIGHT)
+        : neighborSearch(NeighborSearch::Grid),
+          viscosity(250.0f),
           stiffness(50.0f),
           restDensity(1000.0f),
-          deltaTime(1.0f/60.0f),
-          grid(WINDOW_WIDTH, WINDOW_HEIGHT, 30.0f) {}
+          grid(width, height, DEFAULT_SMOOTHING_LENGTH),
+          gridCellSize(0.0f),
+          threadPool(nullptr),
+          profiler(nullptr),
+          kernels(DEFAULT_SMOOTHING_LENGTH),
+          simd(selectSimdKernels(preferredSimdLevel())),
+          neighborCache(NeighborCache::Off),
+          verletSkin(3.0f),
+          listSteps(0),
+          listRebuilds(0),
+          compactStorage(false),
+          compactReady(false),
+          levelKernels{0.0f, 0.0f, {}, {}, {}, {}},
+          levelCount(0),
+          sleep{false, 20.0f, 2000.0f, 30},
+          sleepStats{0, 0, 0, 0},
+          activity{{}, {}, {}, {}, {}, 0, 0, 0, {}},
+          sleepReady(false),
+          timestep{false, 0.4f, 0.25f, 0.25f, 1.0e-5f, DEFAULT_TIMESTEP, 64},
+          timestepStats{0, DEFAULT_TIMESTEP, DEFAULT_TIMESTEP, 0.0, 0, 0},
+          pressureSolver(PressureSolver::EquationOfState),
+          pcisph{0.01f, 3, 50, 0.0f},
+          pcisphStats{0, 0.0f, 0.0f, true, 0.0f},
+          pcisphDelta(0.0f),
+          pcisphRestDensity(0.0f),
+          pcisphStepLimit(0.0f),
+          pcisphLimitSteps(0),
+          lattice{0.0f, 0.0f, 0.0f, 0.0f, Vec2(), 0.0f, 0.0f},
+          densityStats{0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f} {}
 
+    //... un paso: densidad, presión y fuerzas (la integración la hace ParticleSystem)
     void update(ParticleSystem& particles);
+    //... avanza frameDt de tiempo simulado: con paso fijo es un update() + integración
+    //... con frameDt; con paso adaptativo subdivide frameDt en pasos estables. Con PCISPH
+    //... un subpaso que no converge se parte a la mitad en vez de integrarse.
+    //... Devuelve los subpasos hechos
+    int advance(ParticleSystem& particles, float frameDt);
+    //... update() con el dominio repartido entre procesos: agrega las fantasmas de
+    //... 'halo' a menos de 2h de los bordes compartidos, calcula densidad y fuerzas de las
+    //... partículas propias y las vuelve a sacar. Ecuación de estado sobre los arreglos
+    //... float (grid o fuerza bruta, con SIMD si está): la lista de vecinos, la copia
+    //... compacta, PCISPH y la resolución adaptativa no entran (ver sph_distributed.cpp)
+    void updateDistributed(ParticleSystem& particles, HaloExchange& halo);
+    //... paso estable según las velocidades y las fuerzas actuales (llamar tras update)
+    float computeStableTimestep(ParticleSystem& particles);
     void calculateDensityPressure(ParticleSystem& particles);
     void calculateForces(ParticleSystem& particles);
+    void setViscosity(float value) { viscosity = value; }
+    float getViscosity() const { return viscosity; }
+    void setStiffness(float value) { stiffness = value; }
+    float getStiffness() const { return stiffness; }
+    void setRestDensity(float value) { restDensity = value; }
+    float getRestDensity() const { return restDensity; }
+    void setNeighborSearch(NeighborSearch mode) { neighborSearch = mode; }
+    NeighborSearch getNeighborSearch() const { return neighborSearch; }
+    //... Dense cubre el dominio del constructor; Hashed guarda solo las celdas ocupadas
+    //... (dominios grandes o partículas fuera del dominio)
+    void setGridLayout(GridLayout mode) { grid.setLayout(mode); neighborList.invalidate(); }
+    GridLayout getGridLayout() const { return grid.getLayout(); }
+    const SpatialGrid& getGrid() const { return grid; }
+    //... lado de celda fijo del grid; 0 (por defecto) = h, o h + piel con la lista de
+    //... Verlet: la celda más chica con la que las 3x3 vecinas cubren la búsqueda. Con
+    //... un lado menor que el radio el grid no alcanza y se busca por fuerza bruta
+    void setGridCellSize(float size) { gridCellSize = size > 0.0f ? size : 0.0f; }
+    float getGridCellSize() const { return gridCellSize; }
+    //... las pasadas se reparten por partícula; el grid se sigue armando en serie
+    void setThreadPool(ThreadPool* pool) { threadPool = pool; }
+    //... mide grid, densidad y fuerzas; nullptr = sin instrumentación
+    void setProfiler(Profiler* p) { profiler = p; }
+    //... por defecto preferredSimdLevel(); Scalar fuerza el bucle escalar de referencia
+    void setSimdLevel(SimdLevel level) { simd = selectSimdKernels(level); }
+    SimdLevel getSimdLevel() const { return simd.level; }
+    //... la lista necesita el grid con celdas de al menos h + piel; si no, se ignora
+    void setNeighborCache(NeighborCache mode) { neighborCache = mode; neighborList.invalidate(); }
+    NeighborCache getNeighborCache() const { return neighborCache; }
+    void setVerletSkin(float skin) { verletSkin = skin; neighborList.invalidate(); }
+    float getVerletSkin() const { return verletSkin; }
+    NeighborListStats getNeighborListStats() const;
+    //... densidad y fuerzas sobre una copia de 12 bytes por partícula en el orden del grid
+    //... (compact_particles.h) en vez de los arreglos float: menos memoria por vecino a
+    //... cambio de un error relativo de ~1e-3. Solo con el grid Dense; tiene prioridad
+    //... sobre la lista de vecinos y la ruta SIMD, y PCISPH no lo usa
+    void setCompactStorage(bool enabled) {
+        compactStorage = enabled;
+        compactReady = false;
+        compact.clear();
+    }
+    bool getCompactStorage() const { return compactStorage; }
+    //... con la resolución adaptativa del ParticleSystem (ResolutionSettings) densidad y
+    //... fuerzas van por las pasadas de varios niveles, con el grid o fuerza bruta: la
+    //... copia compacta, la lista de vecinos y la ruta SIMD no se usan, y la presión es
+    //... la de la ecuación de estado aunque esté elegido PCISPH
+    bool isMultiresolution(const ParticleSystem& particleSystem) const { return useMultires(particleSystem); }
+    const CompactParticles& getCompactParticles() const { return compact; }
+    //... celdas dormidas (SleepSettings); apagado por defecto. Cambiar la configuración
+    //... despierta todo. Solo con la ecuación de estado sobre el grid Dense sin lista de
+    //... vecinos ni copia compacta, con un solo nivel y sin repartir entre procesos; si
+    //... no, todas las partículas siguen despiertas
+    //... sleepInactiveReason() dice cuál de esas condiciones falta (nullptr si se pueden
+    //... dormir celdas); no mira 'enabled' ni el reparto entre procesos, que es de afuera
+    const char* sleepInactiveReason(const ParticleSystem& particleSystem) const;
+    void setSleepSettings(const SleepSettings& settings) { sleep = settings; resetSleep(); }
+    const SleepSettings& getSleepSettings() const { return sleep; }
+    const SleepStats& getSleepStats() const { return sleepStats; }
+    //... despierta todas las celdas y pone los contadores en 0 (al cambiar la escena)
+    void resetSleep();
+    void resetNeighborListStats() { listSteps = 0; listRebuilds = 0; }
+    void setTimestepSettings(const TimestepSettings& settings) { timestep = settings; }
+    const TimestepSettings& getTimestepSettings() const { return timestep; }
+    void setAdaptiveTimestep(bool enabled) { timestep.adaptive = enabled; }
+    const TimestepStats& getTimestepStats() const { return timestepStats; }
+    void resetTimestepStats();
+    void setPressureSolver(PressureSolver solver) { pressureSolver = solver; }
+    PressureSolver getPressureSolver() const { return pressureSolver; }
+    void setPCISPHSettings(const PCISPHSettings& settings) { pcisph = settings; }
+    const PCISPHSettings& getPCISPHSettings() const { return pcisph; }
+    const PressureSolveStats& getPressureSolveStats() const { return pcisphStats; }
+    //... densidad de reposo efectiva del modo PCISPH (0 hasta el primer paso)
+    float getPCISPHRestDensity() const { return pcisphRestDensity; }
+    const DensityStats& getDensityStats() const { return densityStats; }
 };
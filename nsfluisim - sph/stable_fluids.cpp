@@ -0,0 +1,526 @@
+/*
+Fluidos estables de Jos Stam ("Real-Time Fluid Dynamics for Games", 2003) en C++, sobre la
+malla de GridFluid. Es el mismo esquema de "nsfluisim - jos stam.py": difusión implícita,
+advección semi-lagrangiana con interpolación bilineal y proyección de Helmholtz-Hodge
+resolviendo una ecuación de Poisson para la presión.
+
+En Python las resoluciones lineales eran 20 iteraciones de Jacobi/Gauss-Seidel con
+slices de NumPy. Aquí todas usan Gauss-Seidel rojo-negro: en cada media pasada se
+actualizan solo las celdas de un color, que solo leen vecinas del otro, así las filas se
+reparten entre hilos sin carreras y el resultado no depende de cuántos hay.
+
+Las difusiones son SOR con el omega óptimo de su sistema (ver optimalOmega); con la
+diagonal 1 + 4a dominante convergen en pocas iteraciones. Cada cuatro se mide el residuo
+y se corta al llegar a la tolerancia.
+
+La presión (Poisson, sin diagonal dominante) es multigrid: incluso con el omega óptimo SOR
+necesitaba unas 160 iteraciones por proyección en 256 x 192, arrancando de la presión del
+paso anterior, y el paso no llegaba a 60 por segundo. Cada ciclo V hace 2 pasadas de
+Gauss-Seidel, pasa la suma 2x2 del residuo a una malla de la mitad de lado, corrige
+recursivamente ahí (hasta una de unas pocas celdas por lado), interpola la corrección
+bilineal de vuelta y hace 2 pasadas más. El residuo se mide después de cada ciclo; en
+régimen bastan 3 o 4 ciclos, que cuestan como unas 30 pasadas de SOR.
+
+Los sólidos entran en el sistema como vecinas con derivada normal nula: una vecina
+sólida vale lo mismo que la propia celda, así que solo se cuentan las abiertas en la
+diagonal (1 / (d + a n) por celda, precalculado) y se multiplica cada vecina por su
+marca de abierta. El bucle interno no tiene saltos.
+*/
+
+//... stable_fluids.cpp
+#include "stable_fluids.h"
+#include "constants.h"
+#include <cmath>
+#include <algorithm>
+
+//... cada cuántas iteraciones se mide el residuo
+static const int RESIDUAL_CHECK_INTERVAL = 4;
+//... tope de iteraciones de cada difusión
+static const int DEFAULT_MAX_ITERATIONS = 200;
+//... tope de ciclos V por proyección; cada uno baja el residuo unas 5 veces
+static const int DEFAULT_MAX_CYCLES = 20;
+static const float DEFAULT_TOLERANCE = 1.0e-3f;
+//... pasadas de Gauss-Seidel antes y después de corregir con la malla gruesa, y en la
+//... más gruesa (de unas pocas celdas por lado, donde se resuelve casi del todo)
+static const int PRE_SWEEPS = 2;
+static const int POST_SWEEPS = 2;
+static const int COARSEST_SWEEPS = 16;
+//... se deja de engrosar cuando un lado interior tiene esta cantidad de celdas o menos
+static const int COARSEST_CELLS = 4;
+
+//... omega óptimo de SOR para (d + a n) x_c - a sum x_vecinas = rhs en una malla de n
+//... celdas por lado, 2 / (1 + sqrt(1 - rho^2)) con rho = 4a cos(pi / n) / (d + 4a) el radio
+//... espectral de Jacobi. Para Poisson (d = 0) es 2 / (1 + sin(pi / n)), 1.98 en 256 x 192;
+//... para la difusión, con d = 1 y a = dt * viscosidad chico, queda cerca de 1, y usar el
+//... de Poisson ahí la hace converger mucho más lento que Gauss-Seidel sin sobrerrelajar
+static float optimalOmega(int w, int h, float a, float d) {
+    const int n = std::max(std::max(w, h) - 2, 2);
+    const float rho = 4.0f * a * std::cos(PI / n) / (d + 4.0f * a);
+    return 2.0f / (1.0f + std::sqrt(std::max(0.0f, 1.0f - rho * rho)));
+}
+
+StableFluidsSolver::StableFluidsSolver(int w, int h)
+    : GridFluid(w, h),
+      settings{0.0f, 0.0f, DEFAULT_MAX_ITERATIONS, DEFAULT_MAX_CYCLES, DEFAULT_TOLERANCE},
+      diagonalA(0.0f),
+      diagonalD(0.0f),
+      diagonalValid(false),
+      levelsValid(false) {
+    onSolidChanged();
+    reset();
+}
+
+void StableFluidsSolver::reset() {
+    const size_t cells = static_cast<size_t>(getCellCount());
+    std::fill(density.begin(), density.end(), 0.0f);
+    std::fill(velocityX.begin(), velocityX.end(), 0.0f);
+    std::fill(velocityY.begin(), velocityY.end(), 0.0f);
+    previousX.assign(cells, 0.0f);
+    previousY.assign(cells, 0.0f);
+    previousDensity.assign(cells, 0.0f);
+    pressure.assign(cells, 0.0f);
+    divergence.assign(cells, 0.0f);
+    sources.clear();
+    stepCount = 0;
+}
+
+void StableFluidsSolver::onSolidChanged() {
+    open.resize(solid.size());
+    for (size_t c = 0; c < solid.size(); c++) {
+        open[c] = solid[c] ? 0.0f : 1.0f;
+        if (solid[c]) density[c] = 0.0f;
+    }
+    diagonalValid = false;
+    levelsValid = false;
+}
+
+void StableFluidsSolver::addSource(float x, float y, float radius, float amount, float vx, float vy) {
+    sources.push_back(PendingSource{x, y, radius, amount, vx, vy});
+}
+
+void StableFluidsSolver::applySources(float dt) {
+    for (const PendingSource& source : sources) {
+        const int x0 = std::max(1, static_cast<int>(std::floor(source.x - source.radius)));
+        const int x1 = std::min(width - 2, static_cast<int>(std::ceil(source.x + source.radius)));
+        const int y0 = std::max(1, static_cast<int>(std::floor(source.y - source.radius)));
+        const int y1 = std::min(height - 2, static_cast<int>(std::ceil(source.y + source.radius)));
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                const float dx = cx + 0.5f - source.x, dy = cy + 0.5f - source.y;
+                const int c = cy * width + cx;
+                if (dx * dx + dy * dy > source.radius * source.radius || solid[c]) continue;
+                density[c] += source.amount * dt;
+                velocityX[c] = source.vx;
+                velocityY[c] = source.vy;
+            }
+        }
+    }
+    sources.clear();
+}
+
+void StableFluidsSolver::setBoundary(int b, std::vector<float>& field) const {
+    float* f = field.data();
+    const int last = height - 1;
+    for (int x = 1; x < width - 1; x++) {
+        f[x] = b == 2 ? -f[width + x] : f[width + x];
+        f[last * width + x] = b == 2 ? -f[(last - 1) * width + x] : f[(last - 1) * width + x];
+    }
+    for (int y = 1; y < height - 1; y++) {
+        const int row = y * width;
+        f[row] = b == 1 ? -f[row + 1] : f[row + 1];
+        f[row + width - 1] = b == 1 ? -f[row + width - 2] : f[row + width - 2];
+    }
+    f[0] = 0.5f * (f[1] + f[width]);
+    f[width - 1] = 0.5f * (f[width - 2] + f[2 * width - 1]);
+    f[last * width] = 0.5f * (f[last * width + 1] + f[(last - 1) * width]);
+    f[last * width + width - 1] = 0.5f * (f[last * width + width - 2] + f[(last - 1) * width + width - 1]);
+}
+
+void StableFluidsSolver::prepareDiagonal(float a, float d) {
+    if (diagonalValid && diagonalA == a && diagonalD == d) return;
+    inverseDiagonal.assign(open.size(), 0.0f);
+    const float* o = open.data();
+    for (int y = 1; y < height - 1; y++) {
+        for (int x = 1; x < width - 1; x++) {
+            const int c = y * width + x;
+            const float neighbors = o[c - 1] + o[c + 1] + o[c - width] + o[c + width];
+            const float diagonal = d + a * neighbors;
+            inverseDiagonal[c] = o[c] > 0.0f && diagonal > 0.0f ? 1.0f / diagonal : 0.0f;
+        }
+    }
+    diagonalA = a;
+    diagonalD = d;
+    diagonalValid = true;
+}
+
+float StableFluidsSolver::residualOf(const std::vector<float>& field, const std::vector<float>& rhs,
+                                     float a, float d) {
+    const int grain = chunkGrain(threadPool, height);
+    residualPartials.assign(2 * chunkTotal(height, grain), 0.0f);
+    const float* x = field.data();
+    const float* r = rhs.data();
+    const float* o = open.data();
+    parallelChunks(threadPool, height, grain, [&](int y0, int y1) {
+        float maxResidual = 0.0f, maxRhs = 0.0f;
+        for (int y = std::max(y0, 1); y < std::min(y1, height - 1); y++) {
+            for (int c = y * width + 1; c < (y + 1) * width - 1; c++) {
+                const float neighbors = o[c - 1] + o[c + 1] + o[c - width] + o[c + width];
+                const float sum = o[c - 1] * x[c - 1] + o[c + 1] * x[c + 1] +
+                                  o[c - width] * x[c - width] + o[c + width] * x[c + width];
+                const float residual = r[c] + a * sum - (d + a * neighbors) * x[c];
+                maxResidual = std::max(maxResidual, o[c] * std::fabs(residual));
+                maxRhs = std::max(maxRhs, o[c] * std::fabs(r[c]));
+            }
+        }
+        residualPartials[2 * (y0 / grain)] = maxResidual;
+        residualPartials[2 * (y0 / grain) + 1] = maxRhs;
+    });
+    float maxResidual = 0.0f, maxRhs = 0.0f;
+    for (size_t k = 0; k < residualPartials.size(); k += 2) {
+        maxResidual = std::max(maxResidual, residualPartials[k]);
+        maxRhs = std::max(maxRhs, residualPartials[k + 1]);
+    }
+    return maxRhs > 0.0f ? maxResidual / maxRhs : 0.0f;
+}
+
+int StableFluidsSolver::relax(int b, std::vector<float>& field, const std::vector<float>& rhs,
+                              float a, float d, float& residual) {
+    prepareDiagonal(a, d);
+    float* x = field.data();
+    const float* r = rhs.data();
+    const float* o = open.data();
+    const float* inverse = inverseDiagonal.data();
+    const float omega = optimalOmega(width, height, a, d);
+    const int maxIterations = std::max(1, settings.maxIterations);
+
+    residual = 0.0f;
+    int iteration = 0;
+    while (iteration < maxIterations) {
+        iteration++;
+        for (int color = 0; color < 2; color++) {
+            forRows([&](int y0, int y1) {
+                for (int y = std::max(y0, 1); y < std::min(y1, height - 1); y++) {
+                    //... la primera celda del color en la fila: (x + y) % 2 == color
+                    const int first = 1 + ((1 + y + color) & 1);
+                    for (int c = y * width + first; c < (y + 1) * width - 1; c += 2) {
+                        const float sum = o[c - 1] * x[c - 1] + o[c + 1] * x[c + 1] +
+                                          o[c - width] * x[c - width] + o[c + width] * x[c + width];
+                        const float target = (r[c] + a * sum) * inverse[c];
+                        x[c] = o[c] * (x[c] + omega * (target - x[c]));
+                    }
+                }
+            });
+        }
+        setBoundary(b, field);
+        if (iteration % RESIDUAL_CHECK_INTERVAL == 0 || iteration == maxIterations) {
+            residual = residualOf(field, rhs, a, d);
+            if (residual <= settings.tolerance) break;
+        }
+    }
+    return iteration;
+}
+
+void StableFluidsSolver::diffuse(int b, std::vector<float>& x, const std::vector<float>& x0,
+                                 float rate, float dt) {
+    x = x0;
+    if (rate <= 0.0f) return;
+    float residual;
+    relax(b, x, x0, dt * rate, 1.0f, residual);
+}
+
+void StableFluidsSolver::advect(int b, std::vector<float>& d, const std::vector<float>& d0,
+                                const std::vector<float>& u, const std::vector<float>& v, float dt) {
+    const float* source = d0.data();
+    const float* pu = u.data();
+    const float* pv = v.data();
+    const float* o = open.data();
+    float* target = d.data();
+    const float maxX = width - 1.5f;
+    const float maxY = height - 1.5f;
+    forRows([&](int y0, int y1) {
+        for (int y = std::max(y0, 1); y < std::min(y1, height - 1); y++) {
+            for (int x = 1; x < width - 1; x++) {
+                const int c = y * width + x;
+                //... de dónde viene lo que llega a la celda en este paso
+                const float px = std::min(std::max(x - dt * pu[c], 0.5f), maxX);
+                const float py = std::min(std::max(y - dt * pv[c], 0.5f), maxY);
+                const int i0 = static_cast<int>(px);
+                const int j0 = static_cast<int>(py);
+                const float s1 = px - i0, s0 = 1.0f - s1;
+                const float t1 = py - j0, t0 = 1.0f - t1;
+                const int k = j0 * width + i0;
+                target[c] = o[c] * (s0 * (t0 * source[k] + t1 * source[k + width]) +
+                                    s1 * (t0 * source[k + 1] + t1 * source[k + width + 1]));
+            }
+        }
+    });
+    setBoundary(b, d);
+}
+
+void StableFluidsSolver::project(std::vector<float>& u, std::vector<float>& v) {
+    float* pu = u.data();
+    float* pv = v.data();
+    float* div = divergence.data();
+    const float* o = open.data();
+    forRows([&](int y0, int y1) {
+        for (int y = std::max(y0, 1); y < std::min(y1, height - 1); y++) {
+            for (int c = y * width + 1; c < (y + 1) * width - 1; c++) {
+                div[c] = -0.5f * (pu[c + 1] - pu[c - 1] + pv[c + width] - pv[c - width]);
+            }
+        }
+    });
+    //... con las paredes y los sólidos cerrados la presión está definida a menos de una
+    //... constante, y solo tiene solución si la divergencia suma 0; una fuente que mete
+    //... fluido la deja con suma distinta, y sin restarle la media la presión deriva de
+    //... paso en paso hasta que la precisión de float no deja bajar el residuo
+    removeMeans();
+    setBoundary(0, divergence);
+
+    //... la presión arranca de la de la proyección anterior
+    float residual;
+    stats.iterations = solvePressure(residual);
+    stats.residual = residual;
+    stats.tolerance = settings.tolerance;
+
+    const float* p = pressure.data();
+    forRows([&](int y0, int y1) {
+        for (int y = std::max(y0, 1); y < std::min(y1, height - 1); y++) {
+            for (int c = y * width + 1; c < (y + 1) * width - 1; c++) {
+                //... contra un sólido el gradiente normal es 0
+                const float pc = p[c];
+                const float right = pc + o[c + 1] * (p[c + 1] - pc);
+                const float left = pc + o[c - 1] * (p[c - 1] - pc);
+                const float down = pc + o[c + width] * (p[c + width] - pc);
+                const float up = pc + o[c - width] * (p[c - width] - pc);
+                pu[c] = o[c] * (pu[c] - 0.5f * (right - left));
+                pv[c] = o[c] * (pv[c] - 0.5f * (down - up));
+            }
+        }
+    });
+    setBoundary(1, u);
+    setBoundary(2, v);
+}
+
+void StableFluidsSolver::removeMeans() {
+    const int grain = chunkGrain(threadPool, height);
+    meanPartials.assign(3 * chunkTotal(height, grain), 0.0);
+    float* div = divergence.data();
+    float* p = pressure.data();
+    const float* o = open.data();
+    forRows([&](int y0, int y1) {
+        double divSum = 0.0, pressureSum = 0.0, cells = 0.0;
+        for (int y = std::max(y0, 1); y < std::min(y1, height - 1); y++) {
+            for (int c = y * width + 1; c < (y + 1) * width - 1; c++) {
+                divSum += o[c] * div[c];
+                pressureSum += o[c] * p[c];
+                cells += o[c];
+            }
+        }
+        meanPartials[3 * (y0 / grain)] = divSum;
+        meanPartials[3 * (y0 / grain) + 1] = pressureSum;
+        meanPartials[3 * (y0 / grain) + 2] = cells;
+    });
+    double divSum = 0.0, pressureSum = 0.0, cells = 0.0;
+    for (size_t k = 0; k < meanPartials.size(); k += 3) {
+        divSum += meanPartials[k];
+        pressureSum += meanPartials[k + 1];
+        cells += meanPartials[k + 2];
+    }
+    if (cells <= 0.0) return;
+    const float divMean = static_cast<float>(divSum / cells);
+    const float pressureMean = static_cast<float>(pressureSum / cells);
+    forRows([&](int y0, int y1) {
+        for (int y = std::max(y0, 1); y < std::min(y1, height - 1); y++) {
+            for (int c = y * width + 1; c < (y + 1) * width - 1; c++) {
+                div[c] -= o[c] * divMean;
+                p[c] -= o[c] * pressureMean;
+            }
+        }
+    });
+    setBoundary(0, pressure);
+}
+
+void StableFluidsSolver::buildLevels() {
+    levels.clear();
+    PoissonLevel fine;
+    fine.width = width;
+    fine.height = height;
+    fine.open = open;
+    levels.push_back(std::move(fine));
+    for (;;) {
+        const PoissonLevel& finer = levels.back();
+        const int fineWidth = finer.width - 2, fineHeight = finer.height - 2;
+        if (fineWidth <= COARSEST_CELLS || fineHeight <= COARSEST_CELLS) break;
+        PoissonLevel coarse;
+        coarse.width = (fineWidth + 1) / 2 + 2;
+        coarse.height = (fineHeight + 1) / 2 + 2;
+        coarse.open.assign(static_cast<size_t>(coarse.width) * coarse.height, 0.0f);
+        for (int y = 1; y < coarse.height - 1; y++) {
+            for (int x = 1; x < coarse.width - 1; x++) {
+                for (int fy = 2 * y - 1; fy <= std::min(2 * y, fineHeight); fy++) {
+                    for (int fx = 2 * x - 1; fx <= std::min(2 * x, fineWidth); fx++) {
+                        if (finer.open[fy * finer.width + fx] > 0.0f) coarse.open[y * coarse.width + x] = 1.0f;
+                    }
+                }
+            }
+        }
+        coarse.solution.assign(coarse.open.size(), 0.0f);
+        coarse.rhs.assign(coarse.open.size(), 0.0f);
+        levels.push_back(std::move(coarse));
+    }
+    //... en la malla propia el anillo de borde cuenta como abierto: es la celda fantasma
+    //... que setBoundary iguala a su vecina, o sea derivada normal nula como en las demás
+    for (PoissonLevel& level : levels) {
+        level.inverseDiagonal.assign(level.open.size(), 0.0f);
+        const float* o = level.open.data();
+        for (int y = 1; y < level.height - 1; y++) {
+            for (int c = y * level.width + 1; c < (y + 1) * level.width - 1; c++) {
+                const float neighbors = o[c - 1] + o[c + 1] + o[c - level.width] + o[c + level.width];
+                level.inverseDiagonal[c] = o[c] > 0.0f && neighbors > 0.0f ? 1.0f / neighbors : 0.0f;
+            }
+        }
+    }
+    levelsValid = true;
+}
+
+void StableFluidsSolver::smooth(size_t level, int sweeps) {
+    const PoissonLevel& grid = levels[level];
+    const int w = grid.width, h = grid.height;
+    float* x = level == 0 ? pressure.data() : levels[level].solution.data();
+    const float* r = level == 0 ? divergence.data() : grid.rhs.data();
+    const float* o = grid.open.data();
+    const float* inverse = grid.inverseDiagonal.data();
+    const int grain = chunkGrain(threadPool, h);
+    for (int sweep = 0; sweep < sweeps; sweep++) {
+        for (int color = 0; color < 2; color++) {
+            parallelChunks(threadPool, h, grain, [&](int y0, int y1) {
+                for (int y = std::max(y0, 1); y < std::min(y1, h - 1); y++) {
+                    const int first = 1 + ((1 + y + color) & 1);
+                    for (int c = y * w + first; c < (y + 1) * w - 1; c += 2) {
+                        const float sum = o[c - 1] * x[c - 1] + o[c + 1] * x[c + 1] +
+                                          o[c - w] * x[c - w] + o[c + w] * x[c + w];
+                        x[c] = (r[c] + sum) * inverse[c];
+                    }
+                }
+            });
+        }
+        if (level == 0) setBoundary(0, pressure);
+    }
+}
+
+void StableFluidsSolver::restrictResidual(size_t level) {
+    const PoissonLevel& fine = levels[level];
+    PoissonLevel& coarse = levels[level + 1];
+    const int w = fine.width;
+    const int fineWidth = fine.width - 2, fineHeight = fine.height - 2;
+    const float* x = level == 0 ? pressure.data() : fine.solution.data();
+    const float* r = level == 0 ? divergence.data() : fine.rhs.data();
+    const float* o = fine.open.data();
+    std::fill(coarse.solution.begin(), coarse.solution.end(), 0.0f);
+    float* target = coarse.rhs.data();
+    //... la malla gruesa tiene el doble de lado: su ecuación lleva 4 veces el residuo
+    //... medio de las hijas, o sea la suma
+    parallelChunks(threadPool, coarse.height, chunkGrain(threadPool, coarse.height), [&](int y0, int y1) {
+        for (int y = std::max(y0, 1); y < std::min(y1, coarse.height - 1); y++) {
+            for (int cx = 1; cx < coarse.width - 1; cx++) {
+                float sum = 0.0f;
+                for (int fy = 2 * y - 1; fy <= std::min(2 * y, fineHeight); fy++) {
+                    for (int fx = 2 * cx - 1; fx <= std::min(2 * cx, fineWidth); fx++) {
+                        const int c = fy * w + fx;
+                        const float neighbors = o[c - 1] + o[c + 1] + o[c - w] + o[c + w];
+                        const float around = o[c - 1] * x[c - 1] + o[c + 1] * x[c + 1] +
+                                             o[c - w] * x[c - w] + o[c + w] * x[c + w];
+                        sum += o[c] * (r[c] + around - neighbors * x[c]);
+                    }
+                }
+                target[y * coarse.width + cx] = sum;
+            }
+        }
+    });
+}
+
+void StableFluidsSolver::prolongate(size_t level) {
+    const PoissonLevel& fine = levels[level];
+    const PoissonLevel& coarse = levels[level + 1];
+    const int w = fine.width, cw = coarse.width;
+    float* x = level == 0 ? pressure.data() : levels[level].solution.data();
+    const float* o = fine.open.data();
+    const float* e = coarse.solution.data();
+    const float* co = coarse.open.data();
+    //... centrada en celdas: cada hija toma 9/16 de su madre, 3/16 de las dos gruesas
+    //... vecinas de su lado y 1/16 de la diagonal, contando solo las abiertas
+    parallelChunks(threadPool, fine.height, chunkGrain(threadPool, fine.height), [&](int y0, int y1) {
+        for (int y = std::max(y0, 1); y < std::min(y1, fine.height - 1); y++) {
+            const int cy = (y + 1) / 2;
+            const int ny = (y & 1) ? cy - 1 : cy + 1;
+            for (int fx = 1; fx < w - 1; fx++) {
+                const int c = y * w + fx;
+                if (o[c] <= 0.0f) continue;
+                const int cx = (fx + 1) / 2;
+                const int nx = (fx & 1) ? cx - 1 : cx + 1;
+                const int k00 = cy * cw + cx, k01 = cy * cw + nx;
+                const int k10 = ny * cw + cx, k11 = ny * cw + nx;
+                const float w00 = 9.0f * co[k00], w01 = 3.0f * co[k01];
+                const float w10 = 3.0f * co[k10], w11 = co[k11];
+                x[c] += (w00 * e[k00] + w01 * e[k01] + w10 * e[k10] + w11 * e[k11]) /
+                        (w00 + w01 + w10 + w11);
+            }
+        }
+    });
+    if (level == 0) setBoundary(0, pressure);
+}
+
+void StableFluidsSolver::cycle(size_t level) {
+    if (level + 1 == levels.size()) {
+        smooth(level, COARSEST_SWEEPS);
+        return;
+    }
+    smooth(level, PRE_SWEEPS);
+    restrictResidual(level);
+    cycle(level + 1);
+    prolongate(level);
+    smooth(level, POST_SWEEPS);
+}
+
+int StableFluidsSolver::solvePressure(float& residual) {
+    if (!levelsValid) buildLevels();
+    const int maxCycles = std::max(1, settings.maxCycles);
+    int cycles = 0;
+    do {
+        cycle(0);
+        cycles++;
+        residual = residualOf(pressure, divergence, 1.0f, 0.0f);
+    } while (residual > settings.tolerance && cycles < maxCycles);
+    return cycles;
+}
+
+void StableFluidsSolver::step(float dt) {
+    applySources(dt);
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Diffusion);
+        diffuse(1, previousX, velocityX, settings.viscosity, dt);
+        diffuse(2, previousY, velocityY, settings.viscosity, dt);
+    }
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Projection);
+        project(previousX, previousY);
+    }
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Advection);
+        advect(1, velocityX, previousX, previousX, previousY, dt);
+        advect(2, velocityY, previousY, previousX, previousY, dt);
+    }
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Projection);
+        project(velocityX, velocityY);
+    }
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Diffusion);
+        diffuse(0, previousDensity, density, settings.diffusion, dt);
+    }
+    {
+        ScopedTimer timer(profiler, ProfilePhase::Advection);
+        advect(0, density, previousDensity, velocityX, velocityY, dt);
+    }
+    stepCount++;
+}
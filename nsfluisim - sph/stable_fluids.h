@@ -0,0 +1,101 @@
+// stable_fluids.h
+#pragma once
+#include "grid_fluid.h"
+
+//... viscosidad y difusión del colorante en celdas^2/s (0 = sin ese paso). Las
+//... difusiones de u, v y el colorante son Gauss-Seidel rojo-negro sobrerrelajado, con
+//... el omega óptimo de cada sistema, hasta maxIterations; la presión son ciclos V de
+//... multigrid, hasta maxCycles. Las dos cortan cuando el residuo relativo baja de
+//... 'tolerance'
+struct StableFluidsSettings {
+    float viscosity;
+    float diffusion;
+    int maxIterations;
+    int maxCycles;
+    float tolerance;
+};
+
+//... fluidos estables de Stam (el de "nsfluisim - jos stam.py" y "nsfluisim - navier
+//... stokes.py") sobre la malla de GridFluid: la fila y columna de cada borde son las
+//... paredes (celdas fantasma con la velocidad normal reflejada) y el fluido está en el
+//... interior. Cada step(dt) suma las fuentes, difunde, proyecta, advecta y vuelve a
+//... proyectar la velocidad, y difunde y advecta el colorante (la densidad de
+//... GridFluid). Velocidades en celdas por segundo; dt en segundos. Contra los sólidos
+//... la presión tiene derivada normal nula y la velocidad queda en 0
+class StableFluidsSolver : public GridFluid {
+public:
+    StableFluidsSolver(int width, int height);
+
+    void step(float dt) override;
+    //... fluido quieto y sin colorante
+    void reset() override;
+    //... en el disco la velocidad pasa a ser (vx, vy) y el colorante crece 'amount' por
+    //... segundo del paso
+    void addSource(float x, float y, float radius, float amount, float vx, float vy) override;
+    const char* getName() const override { return "Fluidos estables"; }
+    FieldShading getShading() const override { return FieldShading::Density; }
+
+    void setSettings(const StableFluidsSettings& value) { settings = value; }
+    const StableFluidsSettings& getSettings() const { return settings; }
+
+private:
+    StableFluidsSettings settings;
+    //... campos del paso anterior (los que se difunden o advectan), presión y divergencia
+    std::vector<float> previousX, previousY, previousDensity;
+    std::vector<float> pressure, divergence;
+    //... 1 fluido, 0 sólido; y, por celda, 1 / (d + a * vecinas abiertas) del último
+    //... sistema armado (ver relax), que se rehace si cambian a, d o los sólidos
+    std::vector<float> open;
+    std::vector<float> inverseDiagonal;
+    float diagonalA, diagonalD;
+    bool diagonalValid;
+    struct PendingSource {
+        float x, y, radius, amount, vx, vy;
+    };
+    std::vector<PendingSource> sources;
+    //... parciales por trozo de filas del residuo
+    std::vector<float> residualPartials;
+    //... mallas de la presión para multigrid: levels[0] es la propia (solution y rhs
+    //... vacíos, se usan pressure y divergence) y cada una de las siguientes junta 2x2
+    //... celdas de la anterior, con su anillo de borde cerrado. Una celda gruesa está
+    //... abierta si alguna de sus hijas lo está; inverseDiagonal es 1 / vecinas abiertas
+    struct PoissonLevel {
+        int width, height;
+        std::vector<float> open, inverseDiagonal;
+        std::vector<float> solution, rhs;
+    };
+    std::vector<PoissonLevel> levels;
+    bool levelsValid;
+    //... parciales por trozo de filas de las sumas de divergencia y presión
+    std::vector<double> meanPartials;
+
+    void onSolidChanged() override;
+    void applySources(float dt);
+    //... b = 0 escalar, 1 componente x (se refleja en las paredes izquierda y derecha),
+    //... 2 componente y (arriba y abajo)
+    void setBoundary(int b, std::vector<float>& field) const;
+    //... resuelve (d + a n) x_c - a sum x_vecinas = rhs_c, con n las vecinas abiertas
+    //... (una vecina sólida vale como la propia celda); devuelve las iteraciones
+    int relax(int b, std::vector<float>& x, const std::vector<float>& rhs, float a, float d,
+              float& residual);
+    void prepareDiagonal(float a, float d);
+    //... residuo máximo relativo a max |rhs|
+    float residualOf(const std::vector<float>& x, const std::vector<float>& rhs, float a, float d);
+    void diffuse(int b, std::vector<float>& x, const std::vector<float>& x0, float rate, float dt);
+    void advect(int b, std::vector<float>& d, const std::vector<float>& d0,
+                const std::vector<float>& u, const std::vector<float>& v, float dt);
+    void project(std::vector<float>& u, std::vector<float>& v);
+    //... rearma 'levels' después de cambiar los sólidos
+    void buildLevels();
+    //... resta a divergence y a pressure su media en las celdas abiertas (ver project)
+    void removeMeans();
+    //... ciclos V sobre pressure con divergence de lado derecho; devuelve los ciclos
+    int solvePressure(float& residual);
+    void cycle(size_t level);
+    //... 'sweeps' pasadas de Gauss-Seidel rojo-negro (sin sobrerrelajar) en un nivel
+    void smooth(size_t level, int sweeps);
+    //... residuo de 'level' sumado de a 2x2 en el lado derecho de 'level' + 1
+    void restrictResidual(size_t level);
+    //... suma a 'level' la corrección de 'level' + 1, interpolada bilineal
+    void prolongate(size_t level);
+};
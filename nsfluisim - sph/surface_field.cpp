@@ -0,0 +1,227 @@
+/*
+Superficie del fluido para el modo de dibujo por superficie.
+
+Dibujar cada partícula como un círculo cuesta relleno de pantalla por partícula aunque
+casi todas estén en el interior, tapadas por sus vecinas, y con muchas partículas el
+borde se ve ruidoso. Aquí el fluido se convierte en un campo escalar de baja resolución
+y se dibuja solo su contorno relleno, como una malla de triángulos.
+
+Campo: en cada muestra se suma el área de las partículas cercanas pesada con
+w(r) = (1 - r^2 / h^2)^3, normalizada para que integre 1. Las partículas se reparten
+primero en un SpatialGrid con celdas de lado h, el mismo counting sort del solver: las
+muestras de una celda solo pueden ver partículas de las 3 x 3 celdas de alrededor, así
+que los tres tramos de índices se buscan una vez por celda y sirven para todas sus
+muestras. Cada trozo del ThreadPool toma filas de celdas enteras y escribe solo las
+filas de muestras de esas celdas, sin atómicos.
+
+Contorno: marching squares sobre los cuadrados entre muestras, también por trozos de
+filas. Un cuadrado con las 4 esquinas adentro se junta con los siguientes de la fila en
+un solo rectángulo, así el interior cuesta 2 triángulos por tramo y no por cuadrado; en
+los de borde se recorren las esquinas en orden intercalando los cruces (interpolados
+linealmente) y el polígono, convexo, se abre en abanico. En las sillas (dos esquinas
+opuestas adentro) decide el promedio de las cuatro.
+*/
+
+//... surface_field.cpp
+#include "surface_field.h"
+#include "constants.h"
+#include <cmath>
+#include <algorithm>
+
+//... umbral del contorno y muestras por lado de celda por defecto: con 0.35 el borde queda
+//... un poco por fuera de las partículas de la superficie (campo 1/2), como los círculos
+static const float DEFAULT_SURFACE_THRESHOLD = 0.35f;
+static const int DEFAULT_SAMPLES_PER_CELL = 2;
+
+SurfaceField::SurfaceField(int domainWidth, int domainHeight)
+    : grid(domainWidth, domainHeight, DEFAULT_SMOOTHING_LENGTH),
+      samplesPerCell(DEFAULT_SAMPLES_PER_CELL),
+      threshold(DEFAULT_SURFACE_THRESHOLD),
+      threadPool(nullptr),
+      samplesX(0),
+      samplesY(0),
+      sampleStep(0.0f) {}
+
+void SurfaceField::setSamplesPerCell(int samples) {
+    samplesPerCell = std::max(1, samples);
+}
+
+void SurfaceField::build(const ParticleSystem& particleSystem) {
+    const float h = particleSystem.getSmoothingLength();
+    if (grid.getDomainWidth() != particleSystem.getDomainWidth() ||
+        grid.getDomainHeight() != particleSystem.getDomainHeight()) {
+        grid = SpatialGrid(particleSystem.getDomainWidth(), particleSystem.getDomainHeight(), h);
+    } else {
+        grid.setCellSize(h);
+    }
+    const ParticleData& particles = particleSystem.getData();
+    grid.updateGrid(particles);
+
+    levelArea.resize(MAX_RESOLUTION_LEVEL + 1);
+    for (size_t level = 0; level < levelArea.size(); level++) {
+        const float spacing = particleSystem.getLevelSpacing(static_cast<int>(level));
+        levelArea[level] = spacing * spacing;
+    }
+
+    sampleStep = h / samplesPerCell;
+    samplesX = grid.getGridWidth() * samplesPerCell + 1;
+    samplesY = grid.getGridHeight() * samplesPerCell + 1;
+    field.assign(static_cast<size_t>(samplesX) * samplesY, 0.0f);
+    splat(particles, h);
+    extract();
+}
+
+void SurfaceField::splat(const ParticleData& particles, float radius) {
+    const int gridWidth = grid.getGridWidth();
+    const int gridHeight = grid.getGridHeight();
+    const int* cellStart = grid.getCellStart().data();
+    const int* indices = grid.getParticleIndices().data();
+    const float* px = particles.x.data();
+    const float* py = particles.y.data();
+    const unsigned char* level = particles.level.size() == particles.size() ? particles.level.data() : nullptr;
+    const float* area = levelArea.data();
+    const float inverseR2 = 1.0f / (radius * radius);
+    //... la integral de w sobre el disco es pi h^2 / 4
+    const float normalization = 4.0f * inverseR2 / PI;
+    const int k = samplesPerCell;
+
+    const int grain = chunkGrain(threadPool, gridHeight);
+    parallelChunks(threadPool, gridHeight, grain, [&](int cy0, int cy1) {
+        for (int cy = cy0; cy < cy1; cy++) {
+            //... la última fila (y columna) de celdas se queda también con las muestras del borde
+            const int j0 = cy * k;
+            const int j1 = cy == gridHeight - 1 ? samplesY : j0 + k;
+            const int ny0 = std::max(cy - 1, 0), ny1 = std::min(cy + 1, gridHeight - 1);
+            for (int cx = 0; cx < gridWidth; cx++) {
+                const int nx0 = std::max(cx - 1, 0), nx1 = std::min(cx + 1, gridWidth - 1);
+                int spanBegin[3], spanEnd[3];
+                int spans = 0;
+                for (int ny = ny0; ny <= ny1; ny++) {
+                    const int begin = cellStart[ny * gridWidth + nx0];
+                    const int end = cellStart[ny * gridWidth + nx1 + 1];
+                    if (begin == end) continue;
+                    spanBegin[spans] = begin;
+                    spanEnd[spans] = end;
+                    spans++;
+                }
+                if (spans == 0) continue;
+
+                const int i0 = cx * k;
+                const int i1 = cx == gridWidth - 1 ? samplesX : i0 + k;
+                for (int j = j0; j < j1; j++) {
+                    const float sy = j * sampleStep;
+                    float* row = field.data() + static_cast<size_t>(j) * samplesX;
+                    for (int i = i0; i < i1; i++) {
+                        const float sx = i * sampleStep;
+                        float sum = 0.0f;
+                        for (int s = 0; s < spans; s++) {
+                            for (int e = spanBegin[s]; e < spanEnd[s]; e++) {
+                                const int p = indices[e];
+                                const float dx = px[p] - sx, dy = py[p] - sy;
+                                const float q = 1.0f - (dx * dx + dy * dy) * inverseR2;
+                                if (q <= 0.0f) continue;
+                                sum += area[level ? level[p] : 0] * q * q * q;
+                            }
+                        }
+                        row[i] = sum * normalization;
+                    }
+                }
+            }
+        }
+    });
+}
+
+void SurfaceField::extract() {
+    const int rows = samplesY - 1;
+    const int grain = chunkGrain(threadPool, rows);
+    chunkTriangles.resize(chunkTotal(rows, grain));
+    parallelChunks(threadPool, rows, grain, [&](int j0, int j1) {
+        std::vector<float>& out = chunkTriangles[j0 / grain];
+        out.clear();
+        for (int j = j0; j < j1; j++) {
+            extractRow(j, out);
+        }
+    });
+    triangles.clear();
+    for (const auto& chunk : chunkTriangles) {
+        triangles.insert(triangles.end(), chunk.begin(), chunk.end());
+    }
+}
+
+void SurfaceField::extractRow(int j, std::vector<float>& out) const {
+    const float* top = field.data() + static_cast<size_t>(j) * samplesX;
+    const float* bottom = top + samplesX;
+    const float y0 = j * sampleStep, y1 = y0 + sampleStep;
+    auto triangle = [&](const float* a, const float* b, const float* c) {
+        out.insert(out.end(), {a[0], a[1], b[0], b[1], c[0], c[1]});
+    };
+    auto rectangle = [&](float x0, float x1) {
+        const float corners[4][2] = {{x0, y0}, {x1, y0}, {x1, y1}, {x0, y1}};
+        triangle(corners[0], corners[1], corners[2]);
+        triangle(corners[0], corners[2], corners[3]);
+    };
+
+    //... comienzo del tramo de cuadrados llenos en curso, o -1
+    int runStart = -1;
+    for (int i = 0; i < samplesX - 1; i++) {
+        //... esquinas en orden: arriba-izquierda, arriba-derecha, abajo-derecha, abajo-izquierda
+        const float value[4] = {top[i], top[i + 1], bottom[i + 1], bottom[i]};
+        int mask = 0;
+        for (int c = 0; c < 4; c++) {
+            if (value[c] >= threshold) mask |= 1 << c;
+        }
+        if (mask == 15) {
+            if (runStart < 0) runStart = i;
+            continue;
+        }
+        if (runStart >= 0) {
+            rectangle(runStart * sampleStep, i * sampleStep);
+            runStart = -1;
+        }
+        if (mask == 0) continue;
+
+        const float x0 = i * sampleStep, x1 = x0 + sampleStep;
+        const float corner[4][2] = {{x0, y0}, {x1, y0}, {x1, y1}, {x0, y1}};
+        auto inside = [&](int c) { return (mask >> (c & 3)) & 1; };
+        //... cruce del umbral en el lado de la esquina a a la b
+        auto crossing = [&](int a, int b, float* point) {
+            const float t = (threshold - value[a]) / (value[b] - value[a]);
+            point[0] = corner[a][0] + t * (corner[b][0] - corner[a][0]);
+            point[1] = corner[a][1] + t * (corner[b][1] - corner[a][1]);
+        };
+
+        const bool saddle = mask == 5 || mask == 10;
+        if (saddle && (value[0] + value[1] + value[2] + value[3]) * 0.25f < threshold) {
+            //... el centro queda afuera: un triángulo por cada esquina de adentro
+            for (int c = 0; c < 4; c++) {
+                if (!inside(c)) continue;
+                float next[2], previous[2];
+                crossing(c, (c + 1) & 3, next);
+                crossing(c, (c + 3) & 3, previous);
+                triangle(corner[c], next, previous);
+            }
+            continue;
+        }
+
+        float polygon[8][2];
+        int count = 0;
+        for (int c = 0; c < 4; c++) {
+            const int next = (c + 1) & 3;
+            if (inside(c)) {
+                polygon[count][0] = corner[c][0];
+                polygon[count][1] = corner[c][1];
+                count++;
+            }
+            if (inside(c) != inside(next)) {
+                crossing(c, next, polygon[count]);
+                count++;
+            }
+        }
+        for (int m = 1; m + 1 < count; m++) {
+            triangle(polygon[0], polygon[m], polygon[m + 1]);
+        }
+    }
+    if (runStart >= 0) {
+        rectangle(runStart * sampleStep, (samplesX - 1) * sampleStep);
+    }
+}
@@ -0,0 +1,56 @@
+// surface_field.h
+#pragma once
+#include <vector>
+#include "particle_system.h"
+#include "spatial_grid.h"
+#include "thread_pool.h"
+
+//... superficie del fluido para dibujarlo como una sola malla en vez de un círculo por
+//... partícula. build() reparte las partículas en un SpatialGrid con celdas de lado h,
+//... evalúa en una malla de muestras (samplesPerCell por lado de celda) cuánto fluido
+//... hay alrededor, y con marching squares saca los triángulos de la región donde ese
+//... campo pasa 'threshold'. El campo es la fracción de área cubierta: 1 dentro de un
+//... fluido con la separación de reposo, 1/2 justo sobre una superficie libre.
+//... Como ParticleSystem, no conoce SFML, y reparte las dos pasadas en el ThreadPool
+class SurfaceField {
+public:
+    SurfaceField(int domainWidth, int domainHeight);
+
+    //... nullptr = todo en el hilo actual
+    void setThreadPool(ThreadPool* pool) { threadPool = pool; }
+    //... valen desde el próximo build()
+    void setSamplesPerCell(int samples);
+    int getSamplesPerCell() const { return samplesPerCell; }
+    void setThreshold(float value) { threshold = value; }
+    float getThreshold() const { return threshold; }
+
+    void build(const ParticleSystem& particleSystem);
+
+    //... x, y de los vértices, de a tres por triángulo, en unidades del dominio
+    const std::vector<float>& getTriangles() const { return triangles; }
+    size_t getTriangleCount() const { return triangles.size() / 6; }
+    //... muestras del campo fila por fila: la (i, j) está en (i, j) * getSampleStep()
+    const std::vector<float>& getField() const { return field; }
+    int getSamplesX() const { return samplesX; }
+    int getSamplesY() const { return samplesY; }
+    float getSampleStep() const { return sampleStep; }
+
+private:
+    SpatialGrid grid;
+    int samplesPerCell;
+    float threshold;
+    ThreadPool* threadPool;
+
+    int samplesX, samplesY;
+    float sampleStep;
+    std::vector<float> field;
+    //... área de una partícula por nivel de resolución
+    std::vector<float> levelArea;
+    //... triángulos de cada trozo de filas, que se juntan en orden
+    std::vector<std::vector<float>> chunkTriangles;
+    std::vector<float> triangles;
+
+    void splat(const ParticleData& particles, float radius);
+    void extract();
+    void extractRow(int j, std::vector<float>& out) const;
+};
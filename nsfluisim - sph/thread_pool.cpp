@@ -0,0 +1,105 @@
+/*
+Pool de hilos sencillo para el paso SPH.
+
+Cada parallelFor publica un trabajo (rango + tamaño de trozo) y despierta a los hilos;
+todos, incluido el que llama, toman trozos con un contador atómico hasta agotarlos.
+Las pasadas de densidad, fuerzas e integración solo escriben en su propia partícula,
+así que el resultado no depende de qué hilo procesa cada trozo. Para las reducciones
+(estadísticas) cada trozo deja un parcial y se suman en orden de trozo.
+*/
+
+//... thread_pool.cpp
+#include "thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : stopping(false), generation(0), job(nullptr),
+      jobBegin(0), jobEnd(0), jobGrain(1), nextChunk(0),
+      chunkCount(0), activeWorkers(0), deterministic(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 1; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::grainFor(int count) const {
+    //... trozo fijo en modo determinista; si no, unos 4 trozos por hilo para balancear
+    const int deterministicGrain = 1024;
+    if (deterministic) return deterministicGrain;
+    int chunks = static_cast<int>(getThreadCount()) * 4;
+    return std::max(64, (count + chunks - 1) / chunks);
+}
+
+void ThreadPool::runChunks() {
+    for (;;) {
+        int chunk = nextChunk.fetch_add(1);
+        if (chunk >= chunkCount) break;
+        int begin = jobBegin + chunk * jobGrain;
+        int end = std::min(jobEnd, begin + jobGrain);
+        (*job)(begin, end);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    unsigned seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+        }
+
+        runChunks();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            activeWorkers--;
+        }
+        doneCondition.notify_one();
+    }
+}
+
+void ThreadPool::parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& fn) {
+    if (end <= begin) return;
+    grain = std::max(1, grain);
+    int chunks = (end - begin + grain - 1) / grain;
+    if (workers.empty() || chunks == 1) {
+        for (int b = begin; b < end; b += grain) {
+            fn(b, std::min(end, b + grain));
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobBegin = begin;
+        jobEnd = end;
+        jobGrain = grain;
+        chunkCount = chunks;
+        nextChunk.store(0);
+        activeWorkers = static_cast<int>(workers.size());
+        generation++;
+    }
+    wakeCondition.notify_all();
+
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [&] { return activeWorkers == 0; });
+    job = nullptr;
+}
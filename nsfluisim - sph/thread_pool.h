@@ -0,0 +1,73 @@
+// thread_pool.h
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+//... pool de hilos fijo para repartir las pasadas por partícula en trozos;
+//... el hilo que llama también trabaja y parallelFor bloquea hasta terminar
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+    bool stopping;
+    unsigned generation;
+
+    //... trabajo actual, repartido por trozos con un contador atómico
+    const std::function<void(int, int)>* job;
+    int jobBegin, jobEnd, jobGrain;
+    std::atomic<int> nextChunk;
+    int chunkCount;
+    int activeWorkers;
+
+    bool deterministic;
+
+    void workerLoop();
+    void runChunks();
+
+public:
+    //... threadCount cuenta al hilo que llama; 0 usa hardware_concurrency
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    //... ejecuta fn(chunkBegin, chunkEnd) sobre [begin, end) en trozos de 'grain'
+    void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& fn);
+
+    //... en modo determinista el tamaño de trozo solo depende del número de elementos,
+    //... así las reducciones por trozo suman en el mismo orden con cualquier número de hilos
+    void setDeterministic(bool enabled) { deterministic = enabled; }
+    bool isDeterministic() const { return deterministic; }
+    int grainFor(int count) const;
+};
+
+//... atajo para código que puede correr sin pool (pool == nullptr -> un solo trozo, serial)
+inline int chunkGrain(const ThreadPool* pool, int count) {
+    if (count <= 0) return 1;
+    return pool ? pool->grainFor(count) : count;
+}
+
+inline int chunkTotal(int count, int grain) {
+    return count <= 0 ? 0 : (count + grain - 1) / grain;
+}
+
+template <typename ChunkFn>
+void parallelChunks(ThreadPool* pool, int count, int grain, ChunkFn&& fn) {
+    if (count <= 0) return;
+    if (!pool || grain >= count) {
+        for (int begin = 0; begin < count; begin += grain) {
+            fn(begin, begin + grain < count ? begin + grain : count);
+        }
+        return;
+    }
+    std::function<void(int, int)> job = fn;
+    pool->parallelFor(0, count, grain, job);
+}
@@ -0,0 +1,8 @@
+//... ui_constants.h
+#pragma once
+#include <SFML/Graphics.hpp>
+
+//... colores para la interfaz
+const sf::Color BUTTON_COLOR(100, 100, 200);
+const sf::Color BUTTON_HOVER_COLOR(150, 150, 255);
+const sf::Color TEXT_COLOR(255, 255, 255);
\ No newline at end of file
@@ -0,0 +1,22 @@
+// vec2.h
+#pragma once
+
+//... vector 2D propio del núcleo físico, para no depender de sf::Vector2f
+struct Vec2 {
+    float x;
+    float y;
+
+    Vec2() : x(0.0f), y(0.0f) {}
+    Vec2(float x, float y) : x(x), y(y) {}
+
+    Vec2& operator+=(const Vec2& other) { x += other.x; y += other.y; return *this; }
+    Vec2& operator-=(const Vec2& other) { x -= other.x; y -= other.y; return *this; }
+    Vec2& operator*=(float s) { x *= s; y *= s; return *this; }
+};
+
+inline Vec2 operator+(const Vec2& a, const Vec2& b) { return Vec2(a.x + b.x, a.y + b.y); }
+inline Vec2 operator-(const Vec2& a, const Vec2& b) { return Vec2(a.x - b.x, a.y - b.y); }
+inline Vec2 operator*(const Vec2& a, float s) { return Vec2(a.x * s, a.y * s); }
+inline Vec2 operator*(float s, const Vec2& a) { return Vec2(a.x * s, a.y * s); }
+inline Vec2 operator/(const Vec2& a, float s) { return Vec2(a.x / s, a.y / s); }
+inline float dot(const Vec2& a, const Vec2& b) { return a.x * b.x + a.y * b.y; }